@@ -0,0 +1,39 @@
+/*
+Copyright 2018 Jonathan Crockett
+ 
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+using System.Runtime.InteropServices;
+
+namespace PowerKraut_Core.kraut.netwrapper{
+    /// <summary>
+    /// Mirrors KrautVK's BenchmarkStats. Times are in milliseconds.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct BenchmarkStats{
+        public double Mean, Median, P95, P99, StdDev, Min, Max;
+        public uint Samples;
+    }
+
+    /// <summary>
+    /// Mirrors KrautVK's BenchmarkResult. Gpu has no samples and MegapixelsPerSecond is 0 on devices without timestamp support.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct BenchmarkResult{
+        public BenchmarkStats Cpu, Gpu;
+        public double MegapixelsPerSecond;
+        public uint Width, Height;
+        public uint Offscreen;
+    }
+}
@@ -0,0 +1,37 @@
+/*
+Copyright 2018 Jonathan Crockett
+ 
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+using System.Runtime.InteropServices;
+
+namespace PowerKraut_Core.kraut.netwrapper{
+    /// <summary>
+    /// Mirrors KrautVK's DeviceReport. Families without a dedicated queue are uint.MaxValue, flags are 1 or 0.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+    internal struct DeviceReport{
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 256)]
+        public string Name;
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 16)]
+        public byte[] Uuid;
+        public ulong DeviceLocalMemory, SharedMemory;
+        public long Score;
+        public uint VendorId, DeviceId, DeviceType, ApiVersion, DriverVersion;
+        public uint GraphicsFamily, PresentFamily, ComputeFamily, TransferFamily;
+        public uint MaxImageDimension2D;
+        public uint FloatTargets, StorageTarget, Bindless, MemoryBudget, Timestamps;
+        public uint Selected;
+    }
+}
\ No newline at end of file
@@ -22,10 +22,14 @@ using PowerKraut_Core.kraut.util.exceptions;
 namespace PowerKraut_Core.kraut.netwrapper{
     internal static class KrautVK{
         [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautInit")]
-        private static extern int Init(int width, int height, string title, bool fullscreen, string dllPath);
+        private static extern int Init(int width, int height, string title, bool fullscreen, string dllPath, string device);
 
-        internal static void InitKrautVK(int width, int height, string title, bool fullscreen){
-            var status = Init(width, height, title, fullscreen, AppDomain.CurrentDomain.BaseDirectory + "lib");
+        /// <summary>
+        /// device pins a GPU by name, part of its name or UUID. Left null the highest ranked device is used,
+        /// GetDeviceReports shows how each one ranked.
+        /// </summary>
+        internal static void InitKrautVK(int width, int height, string title, bool fullscreen, string device = null){
+            var status = Init(width, height, title, fullscreen, AppDomain.CurrentDomain.BaseDirectory + "lib", device);
 
             switch (status){
                 case 0:
@@ -73,5 +77,650 @@ namespace PowerKraut_Core.kraut.netwrapper{
 
         [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautDraw")]
         internal static extern void Draw();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSetShaderVariant")]
+        private static extern int SetShaderVariant(string shaderPath, uint[] constantIds, uint[] values, int count);
+
+        /// <summary>
+        /// Switches to the given shader compiled with the given specialization constants. Variants are cached
+        /// natively, so switching back to one that was used before does not recompile it.
+        /// </summary>
+        internal static void SetShaderVariant(string shaderPath, uint[] constantIds, uint[] values){
+            if (constantIds.Length != values.Length)
+                throw new ArgumentException("Every specialization constant needs a value");
+
+            if (SetShaderVariant(shaderPath, constantIds, values, constantIds.Length) != 0)
+                throw new KrautVKVulkanPipelineCreationFailed();
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautRenderGraphReset")]
+        internal static extern void RenderGraphReset();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautRenderGraphAddImage")]
+        internal static extern int RenderGraphAddImage(string name, int vkFormat);
+
+        /// <summary>
+        /// Adds a double buffered image that keeps its contents between frames. The pass writing it may also
+        /// read it and gets the previous frame's contents, every other pass reading it gets this frame's.
+        /// Float formats such as VK_FORMAT_R16G16B16A16_SFLOAT (97) or VK_FORMAT_R32G32B32A32_SFLOAT (109)
+        /// keep simulation state from quantizing.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautRenderGraphAddFeedbackImage")]
+        internal static extern int RenderGraphAddFeedbackImage(string name, int vkFormat);
+
+        /// <summary>
+        /// Clears every feedback image to zero before the next frame.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautRenderGraphResetFeedback")]
+        internal static extern void RenderGraphResetFeedback();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautRenderGraphAddPass")]
+        private static extern int RenderGraphAddPass(string name, string shaderPath, uint[] inputs, int inputCount, int output);
+
+        /// <summary>
+        /// Adds a full screen pass reading the given images and writing output. Image 0 is the backbuffer and
+        /// must be written by exactly one pass.
+        /// </summary>
+        internal static int RenderGraphAddPass(string name, string shaderPath, uint[] inputs, int output){
+            return RenderGraphAddPass(name, shaderPath, inputs, inputs.Length, output);
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautRenderGraphBuild")]
+        private static extern int RenderGraphBuildNative();
+
+        /// <summary>
+        /// Orders the passes, computes the barriers between them and allocates the intermediate images. Passes
+        /// the backbuffer does not depend on are dropped.
+        /// </summary>
+        internal static void RenderGraphBuild(){
+            switch (RenderGraphBuildNative()){
+                case 0:
+                    return;
+                case -15:
+                    throw new KrautVKVulkanRenderGraphCreationFailed();
+                default:
+                    throw new KrautVKUndefinedException();
+            }
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSetComputeEffect")]
+        private static extern int SetComputeEffectNative(string shaderPath, int workgroupX, int workgroupY);
+
+        /// <summary>
+        /// Runs the given compute shader over a storage image the size of the window instead of the raster
+        /// pipeline, and blits the result to the screen. A workgroup size of 0 uses the default.
+        /// </summary>
+        internal static void SetComputeEffect(string shaderPath, int workgroupX = 0, int workgroupY = 0){
+            switch (SetComputeEffectNative(shaderPath, workgroupX, workgroupY)){
+                case 0:
+                    return;
+                case -16:
+                    throw new KrautVKVulkanComputePipelineCreationFailed();
+                default:
+                    throw new KrautVKUndefinedException();
+            }
+        }
+
+        /// <summary>
+        /// Switches back to the raster pipeline.
+        /// </summary>
+        internal static void DisableComputeEffect(){
+            SetComputeEffectNative(null, 0, 0);
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSetProgressive")]
+        private static extern int SetProgressiveNative(int samplesPerFrame, int maxSamples);
+
+        /// <summary>
+        /// Dispatches the compute effect samplesPerFrame times a frame, passing each dispatch its sample index
+        /// and a floating point accumulation image at binding 2 that holds the running sum. Anything that changes
+        /// the frame starts the accumulation over. With a maxSamples other than 0 it stops there, and frames stop
+        /// rendering until something changes. 0 samples per frame turns it off.
+        /// </summary>
+        internal static void SetProgressive(int samplesPerFrame, int maxSamples = 0){
+            switch (SetProgressiveNative(samplesPerFrame, maxSamples)){
+                case 0:
+                    return;
+                case -16:
+                    throw new KrautVKVulkanComputePipelineCreationFailed();
+                default:
+                    throw new KrautVKUndefinedException();
+            }
+        }
+
+        /// <summary>
+        /// Starts the accumulation over, for changes the renderer can't see.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautResetAccumulation")]
+        internal static extern void ResetAccumulation();
+
+        /// <summary>
+        /// Samples in the progressive accumulation so far.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetAccumulatedSamples")]
+        internal static extern int GetAccumulatedSamples();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSetDynamicResolution")]
+        private static extern int SetDynamicResolutionNative(double targetMilliseconds, float minimumScale, float sharpness);
+
+        /// <summary>
+        /// Renders the scene at a fraction of the window's resolution, chosen each frame from the measured GPU
+        /// time so frames stay under the target, and upscales it with an optional sharpening pass.
+        /// </summary>
+        internal static void SetDynamicResolution(double targetMilliseconds, float minimumScale = 0.5f, float sharpness = 0.2f){
+            switch (SetDynamicResolutionNative(targetMilliseconds, minimumScale, sharpness)){
+                case 0:
+                    return;
+                case -3:
+                    throw new KrautVKVulkanNotSupportedException();
+                case -9:
+                    throw new KrautVKVulkanFramebufferCreationFailed();
+                case -10:
+                    throw new KrautVKVulkanPipelineCreationFailed();
+                default:
+                    throw new KrautVKUndefinedException();
+            }
+        }
+
+        /// <summary>
+        /// Renders at the window's full resolution again.
+        /// </summary>
+        internal static void DisableDynamicResolution(){
+            SetDynamicResolutionNative(0.0, 1.0f, 0.0f);
+        }
+
+        /// <summary>
+        /// Fraction of the window's width and height the scene is currently rendered at, 1 when dynamic
+        /// resolution is off.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetResolutionScale")]
+        internal static extern float GetResolutionScale();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautLayerAdd")]
+        private static extern uint LayerAddNative(string shaderPath, uint image, int blend, float opacity);
+
+        /// <summary>
+        /// Adds a layer on top of the others and returns its handle. The shader renders the image, an image handle
+        /// from ImageLoad or 0 for the demo image, into a target of its own that is only rendered again when the
+        /// layer changes. A null shader shows the image as it is.
+        /// </summary>
+        internal static uint LayerAdd(string shaderPath, uint image, LayerBlend blend = LayerBlend.Normal, float opacity = 1.0f){
+            var layer = LayerAddNative(shaderPath, image, (int) blend, opacity);
+            if (layer == 0)
+                throw new KrautVKVulkanPipelineCreationFailed();
+
+            return layer;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautLayerSetBlend")]
+        private static extern int LayerSetBlendNative(uint layer, int blend, float opacity);
+
+        /// <summary>
+        /// Changes how a layer is blended onto the ones below it. The layer itself doesn't render again.
+        /// </summary>
+        internal static void LayerSetBlend(uint layer, LayerBlend blend, float opacity = 1.0f){
+            if (LayerSetBlendNative(layer, (int) blend, opacity) != 0)
+                throw new KrautVKVulkanPipelineCreationFailed();
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautLayerSetAnimated")]
+        private static extern int LayerSetAnimatedNative(uint layer, int animated);
+
+        /// <summary>
+        /// Animated layers render every frame, the others keep their last result. Returns false for unknown layers.
+        /// </summary>
+        internal static bool LayerSetAnimated(uint layer, bool animated){
+            return LayerSetAnimatedNative(layer, animated ? 1 : 0) != 0;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautLayerInvalidate")]
+        private static extern int LayerInvalidateNative(uint layer);
+
+        /// <summary>
+        /// Renders a static layer once more in the next frame. Returns false for unknown layers.
+        /// </summary>
+        internal static bool LayerInvalidate(uint layer){
+            return LayerInvalidateNative(layer) != 0;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautLayerRemove")]
+        private static extern int LayerRemoveNative(uint layer);
+
+        /// <summary>
+        /// Removes a layer. Without layers the main pipeline draws the scene again. Returns false for unknown layers.
+        /// </summary>
+        internal static bool LayerRemove(uint layer){
+            return LayerRemoveNative(layer) != 0;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSetAnimated")]
+        private static extern void SetAnimatedNative(int animated);
+
+        /// <summary>
+        /// Frames are only rendered when something they show changed. Shaders whose output changes over time
+        /// have to be declared animated so every frame renders.
+        /// </summary>
+        internal static void SetAnimated(bool animated){
+            SetAnimatedNative(animated ? 1 : 0);
+        }
+
+        /// <summary>
+        /// Frames rendered since startup.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetRenderedFrameCount")]
+        internal static extern ulong GetRenderedFrameCount();
+
+        /// <summary>
+        /// Frames skipped since startup because nothing changed. The last rendered frame stays on screen without being
+        /// presented again, and offscreen ReadOutputFrame keeps returning it.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetSkippedFrameCount")]
+        internal static extern ulong GetSkippedFrameCount();
+
+        /// <summary>
+        /// GPU time in milliseconds of the last completed frame's effect work, or -1 if the device can't
+        /// timestamp the graphics queue.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetEffectTime")]
+        internal static extern double GetEffectTime();
+
+        /// <summary>
+        /// CPU time in milliseconds the last frame spent recording and submitting its command buffer.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetRecordTime")]
+        internal static extern double GetRecordTime();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetDeviceCount")]
+        private static extern int GetDeviceCount();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetDeviceReport")]
+        private static extern int GetDeviceReport(int index, out DeviceReport report);
+
+        /// <summary>
+        /// Every physical device with the score it got when the device was picked, -1 for unsupported ones.
+        /// The one in use has Selected set.
+        /// </summary>
+        internal static DeviceReport[] GetDeviceReports(){
+            var reports = new DeviceReport[GetDeviceCount()];
+            for (var i = 0; i < reports.Length; i++)
+                GetDeviceReport(i, out reports[i]);
+
+            return reports;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetInitStageCount")]
+        private static extern int GetInitStageCount();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetInitStage")]
+        private static extern int GetInitStage(int index, out InitStage stage);
+
+        /// <summary>
+        /// The tasks the last InitKrautVK ran, in the order they started, with the thread each one ran on.
+        /// </summary>
+        internal static InitStage[] GetInitStages(){
+            var stages = new InitStage[GetInitStageCount()];
+            for (var i = 0; i < stages.Length; i++)
+                GetInitStage(i, out stages[i]);
+
+            return stages;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSetOffscreen")]
+        private static extern int SetOffscreenNative(int width, int height);
+
+        /// <summary>
+        /// Renders frames into a width x height target instead of the window, nothing is presented. 0 x 0 goes
+        /// back to the window. With an output format set the width has to be a multiple of 8 and the height even.
+        /// </summary>
+        internal static void SetOffscreen(int width, int height){
+            switch (SetOffscreenNative(width, height)){
+                case 0:
+                    return;
+                case -3:
+                    throw new KrautVKVulkanNotSupportedException();
+                case -9:
+                    throw new KrautVKVulkanTextureCreationFailed();
+                default:
+                    throw new KrautVKUndefinedException();
+            }
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSetOutputFormat")]
+        private static extern int SetOutputFormatNative(int format, int fullRange);
+
+        /// <summary>
+        /// Converts every offscreen frame to BT.709 YUV 4:2:0, or RGBA, on the GPU for an encoder to read back,
+        /// limited range unless fullRange. This is the main output at the frame's size, OutputFormat.None
+        /// removes it.
+        /// </summary>
+        internal static void SetOutputFormat(OutputFormat format, bool fullRange = false){
+            switch (SetOutputFormatNative((int) format, fullRange ? 1 : 0)){
+                case 0:
+                    return;
+                case -3:
+                    throw new KrautVKVulkanNotSupportedException();
+                case -11:
+                    throw new KrautVKVulkanVertexCreationFailed();
+                case -16:
+                    throw new KrautVKVulkanComputePipelineCreationFailed();
+                default:
+                    throw new KrautVKUndefinedException();
+            }
+        }
+
+        /// <summary>
+        /// Bytes of a converted frame, 0 while frames are not converted.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetOutputFrameSize")]
+        internal static extern uint GetOutputFrameSize();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautReadOutputFrame")]
+        private static extern ulong ReadOutputFrameNative(byte[] data, uint size, int wait);
+
+        /// <summary>
+        /// Copies the newest converted frame the GPU has finished into data, which holds at least
+        /// GetOutputFrameSize bytes. Returns the frame's number, or 0 if no frame was ready. With wait the
+        /// last submitted frame is waited for. While frames are skipped the last rendered frame is returned again,
+        /// with the same number.
+        /// </summary>
+        internal static ulong ReadOutputFrame(byte[] data, bool wait = false){
+            return ReadOutputFrameNative(data, (uint) data.Length, wait ? 1 : 0);
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautOutputAdd")]
+        private static extern uint OutputAddNative(int width, int height, int format, int filter, int fullRange);
+
+        /// <summary>
+        /// Adds an output converted from every offscreen frame, downsampled to width x height with filter, or at
+        /// the frame's size when either is 0. Outputs are never larger than the frame. Returns the output's handle.
+        /// </summary>
+        internal static uint OutputAdd(int width, int height, OutputFormat format, DownsampleFilter filter = DownsampleFilter.Box, bool fullRange = false){
+            var output = OutputAddNative(width, height, (int) format, (int) filter, fullRange ? 1 : 0);
+            if (output == 0)
+                throw new KrautVKVulkanComputePipelineCreationFailed();
+
+            return output;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautOutputRemove")]
+        private static extern int OutputRemoveNative(uint output);
+
+        /// <summary>
+        /// Removes an output added with OutputAdd. Returns false if there was no such output.
+        /// </summary>
+        internal static bool OutputRemove(uint output){
+            return OutputRemoveNative(output) != 0;
+        }
+
+        /// <summary>
+        /// Bytes of the output's frames, 0 while it is not converted.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautOutputGetSize")]
+        internal static extern uint OutputGetSize(uint output);
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautOutputRead")]
+        private static extern ulong OutputReadNative(uint output, byte[] data, uint size, int wait);
+
+        /// <summary>
+        /// Copies the output from the newest frame the GPU has finished into data, which holds at least
+        /// OutputGetSize bytes. Returns the frame's number, or 0 if no frame was ready.
+        /// </summary>
+        internal static ulong OutputRead(uint output, byte[] data, bool wait = false){
+            return OutputReadNative(output, data, (uint) data.Length, wait ? 1 : 0);
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautCaptureStart")]
+        private static extern int CaptureStartNative(string path, int format, int width, int height, int fps);
+
+        /// <summary>
+        /// Renders offscreen at width x height into path from now on, on a clock of fps frames a second that only
+        /// moves when a frame renders. Draw each frame for CaptureGetTime, nothing is presented so frames come as
+        /// fast as the device renders them. A PNG capture's path is the prefix of every frame's file.
+        /// </summary>
+        internal static void CaptureStart(string path, CaptureFormat format, int width, int height, int fps){
+            switch (CaptureStartNative(path, (int) format, width, height, fps)){
+                case 0:
+                    return;
+                case -3:
+                    throw new KrautVKVulkanNotSupportedException();
+                case -9:
+                    throw new KrautVKVulkanTextureCreationFailed();
+                case -16:
+                    throw new KrautVKVulkanComputePipelineCreationFailed();
+                case -18:
+                    throw new KrautVKCaptureFailed();
+                default:
+                    throw new KrautVKUndefinedException();
+            }
+        }
+
+        /// <summary>
+        /// Seconds into the capture of the frame the next Draw renders.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautCaptureGetTime")]
+        internal static extern double CaptureGetTime();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautCaptureStop")]
+        private static extern int CaptureStopNative();
+
+        /// <summary>
+        /// Waits for every frame rendered to be written, then goes back to wherever frames went before.
+        /// </summary>
+        internal static void CaptureStop(){
+            switch (CaptureStopNative()){
+                case 0:
+                    return;
+                case -18:
+                    throw new KrautVKCaptureFailed();
+                default:
+                    throw new KrautVKUndefinedException();
+            }
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautBenchmark")]
+        private static extern int BenchmarkNative(string shaderPath, int width, int height, int warmupFrames, int measuredFrames, string reportPath, out BenchmarkResult result);
+
+        /// <summary>
+        /// Renders the shader for warmupFrames unmeasured frames and then measuredFrames timed ones, offscreen at
+        /// width x height, or on the window when either is 0. A null shader benchmarks the current pipeline, a
+        /// null reportPath skips writing the JSON report.
+        /// </summary>
+        internal static BenchmarkResult Benchmark(string shaderPath, int width, int height, int warmupFrames, int measuredFrames, string reportPath = null){
+            switch (BenchmarkNative(shaderPath, width, height, warmupFrames, measuredFrames, reportPath, out var result)){
+                case 0:
+                    return result;
+                case -10:
+                    throw new KrautVKVulkanPipelineCreationFailed();
+                case -17:
+                    throw new KrautVKBenchmarkFailed();
+                default:
+                    throw new KrautVKUndefinedException();
+            }
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSpriteLoadTexture")]
+        private static extern int SpriteLoadTextureNative(string path);
+
+        /// <summary>
+        /// Loads a texture sprites can reference by the returned index. Index 0 is the demo texture.
+        /// On devices with descriptor indexing the index is a slot in the bindless texture table.
+        /// </summary>
+        internal static uint SpriteLoadTexture(string path){
+            var index = SpriteLoadTextureNative(path);
+            if (index < 0)
+                throw new KrautVKVulkanTextureCreationFailed();
+
+            return (uint) index;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSpriteAddPipeline")]
+        private static extern int SpriteAddPipelineNative(string shaderPath);
+
+        /// <summary>
+        /// Builds a sprite pipeline around the given fragment shader, referenced by sprites through the returned
+        /// index. Index 0 is the default sprite shader.
+        /// </summary>
+        internal static uint SpriteAddPipeline(string shaderPath){
+            var index = SpriteAddPipelineNative(shaderPath);
+            if (index < 0)
+                throw new KrautVKVulkanPipelineCreationFailed();
+
+            return (uint) index;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSpriteSubmit")]
+        private static extern void SpriteSubmit(SpriteData[] sprites, int count);
+
+        /// <summary>
+        /// Queues sprites for the next Draw. They are drawn sorted by layer, then batched by pipeline and texture,
+        /// so order is only kept between layers.
+        /// </summary>
+        internal static void SpriteSubmit(SpriteData[] sprites){
+            SpriteSubmit(sprites, sprites.Length);
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautAtlasLoadImage")]
+        private static extern int AtlasLoadImageNative(string path, out AtlasRegion region);
+
+        /// <summary>
+        /// Packs a small image into a shared atlas page and returns the page's sprite texture index with the image's
+        /// UV rect. Images over the atlas size threshold get a texture of their own covering the full UV range.
+        /// </summary>
+        internal static AtlasRegion AtlasLoadImage(string path){
+            AtlasRegion region;
+            var status = AtlasLoadImageNative(path, out region);
+            if (status != 0)
+                throw new KrautVKVulkanTextureCreationFailed();
+
+            return region;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautAtlasGetPageCount")]
+        internal static extern int AtlasGetPageCount();
+
+        /// <summary>
+        /// Fraction of an atlas page taken by packed images, including their gutters and padding.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautAtlasGetOccupancy")]
+        internal static extern float AtlasGetOccupancy(int page);
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautImageLoad")]
+        private static extern uint ImageLoadNative(string path);
+
+        /// <summary>
+        /// Loads an image and returns a handle to it. The image lives until ResourceDestroy is called on the handle,
+        /// or the engine terminates.
+        /// </summary>
+        internal static uint ImageLoad(string path){
+            var handle = ImageLoadNative(path);
+            if (handle == 0)
+                throw new KrautVKVulkanTextureCreationFailed();
+
+            return handle;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautPipelineLoad")]
+        private static extern uint PipelineLoadNative(string shaderPath);
+
+        /// <summary>
+        /// Builds the main pass pipeline for a fragment shader and returns a handle to it.
+        /// </summary>
+        internal static uint PipelineLoad(string shaderPath){
+            var handle = PipelineLoadNative(shaderPath);
+            if (handle == 0)
+                throw new KrautVKVulkanPipelineCreationFailed();
+
+            return handle;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautPipelineUse")]
+        private static extern int PipelineUseNative(uint handle);
+
+        /// <summary>
+        /// Draws the main pass with a pipeline from PipelineLoad from the next frame on.
+        /// </summary>
+        internal static void PipelineUse(uint handle){
+            if (PipelineUseNative(handle) != 0)
+                throw new KrautVKVulkanPipelineCreationFailed();
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautResourceValid")]
+        private static extern int ResourceValidNative(uint handle);
+
+        /// <summary>
+        /// False once the resource behind a handle has been destroyed, even if its slot has been reused since.
+        /// </summary>
+        internal static bool ResourceValid(uint handle){
+            return ResourceValidNative(handle) != 0;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautResourceDestroy")]
+        private static extern int ResourceDestroyNative(uint handle);
+
+        /// <summary>
+        /// Releases the image, buffer or pipeline behind a handle. Returns false for stale handles.
+        /// </summary>
+        internal static bool ResourceDestroy(uint handle){
+            return ResourceDestroyNative(handle) != 0;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautResourceSetEvictable")]
+        private static extern int ResourceSetEvictableNative(uint handle, int evictable);
+
+        /// <summary>
+        /// Lets the engine destroy an image when memory runs over budget, after which the handle is no longer valid.
+        /// Images are never evicted unless marked. Returns false for anything but a valid image handle.
+        /// </summary>
+        internal static bool ResourceSetEvictable(uint handle, bool evictable){
+            return ResourceSetEvictableNative(handle, evictable ? 1 : 0) != 0;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetMemoryStats")]
+        private static extern void GetMemoryStats(out MemoryStats stats);
+
+        /// <summary>
+        /// Device memory usage against the eviction budget, and how many images and pipelines were evicted so far.
+        /// </summary>
+        internal static MemoryStats GetMemoryStats(){
+            MemoryStats stats;
+            GetMemoryStats(out stats);
+            return stats;
+        }
+
+        /// <summary>
+        /// Bytes of device local memory to stay under. Least recently used evictable images and unused pipelines are
+        /// evicted above it. 0 goes back to a share of what the driver reports.
+        /// </summary>
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautSetMemoryBudget")]
+        internal static extern void SetMemoryBudget(ulong bytes);
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautGetHeapUsage")]
+        internal static extern ulong GetHeapUsage(int heap);
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautCreateContext")]
+        internal static extern uint CreateContext();
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautMakeCurrent")]
+        private static extern int MakeCurrentNative(uint context);
+
+        /// <summary>
+        /// Points every following call on the calling thread at a context from CreateContext, or at context 1, the one
+        /// every thread starts on. Init on a new context opens its own window on the device the first context picked.
+        /// Contexts can render on threads of their own, but Init, Terminate and PollEvents stay on the one thread.
+        /// </summary>
+        internal static bool MakeCurrent(uint context){
+            return MakeCurrentNative(context) != 0;
+        }
+
+        [DllImport("lib\\krautvk", CallingConvention = CallingConvention.StdCall, EntryPoint = "KrautDestroyContext")]
+        private static extern int DestroyContextNative(uint context);
+
+        /// <summary>
+        /// Terminates a context and frees its handle. Context 1 cannot be destroyed, only terminated. No other thread
+        /// may still have the context current.
+        /// </summary>
+        internal static bool DestroyContext(uint context){
+            return DestroyContextNative(context) != 0;
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+/*
+Copyright 2018 Jonathan Crockett
+ 
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+using System.Runtime.InteropServices;
+
+namespace PowerKraut_Core.kraut.netwrapper{
+    /// <summary>
+    /// Mirrors KrautVK's MemoryStats. Usage and Budget cover device local heaps only, Allocated every heap.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct MemoryStats{
+        public ulong Usage, Budget, Allocated;
+        public uint EvictedImages, EvictedPipelines;
+        public uint DriverBudget;
+    }
+}
@@ -0,0 +1,27 @@
+/*
+Copyright 2018 Jonathan Crockett
+ 
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace PowerKraut_Core.kraut.netwrapper{
+    /// <summary>
+    /// Mirrors KrautVK's OutputFormat, the planar YUV 4:2:0 layout or packed RGBA offscreen frames are converted to.
+    /// </summary>
+    internal enum OutputFormat : uint{
+        None = 0,
+        NV12 = 1,
+        I420 = 2,
+        RGBA = 3
+    }
+}
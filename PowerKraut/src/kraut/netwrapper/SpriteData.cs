@@ -0,0 +1,31 @@
+/*
+Copyright 2018 Jonathan Crockett
+ 
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+using System.Runtime.InteropServices;
+
+namespace PowerKraut_Core.kraut.netwrapper{
+    /// <summary>
+    /// Mirrors KrautVK's SpriteData, which is copied as is into the instance buffer.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct SpriteData{
+        public float X, Y, Width, Height;
+        public float U0, V0, U1, V1;
+        public float R, G, B, A;
+        public float Rotation;
+        public uint Layer, Texture, Pipeline;
+    }
+}
@@ -0,0 +1,18 @@
+#version 450
+
+layout(set=0, binding=0) uniform sampler2D u_Texture;
+
+//The layer's cached result, premultiplied here since every blend mode is done by fixed function blending
+layout(push_constant) uniform Composite {
+  float Opacity;
+} u_Composite;
+
+layout(location = 0) in vec2 v_Texcoord;
+
+layout(location = 0) out vec4 o_Color;
+
+void main() {
+  vec4 color = texture( u_Texture, v_Texcoord );
+  float alpha = color.a * u_Composite.Opacity;
+  o_Color = vec4( color.rgb * alpha, alpha );
+}
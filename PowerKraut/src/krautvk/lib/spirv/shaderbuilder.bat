@@ -2,4 +2,14 @@ echo off
 cd /d %~dp0
 C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V shader.vert -o shadervert.spv
 C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V shader.frag -o shaderfrag.spv
+C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V shader.comp -o shadercomp.spv
+C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V progressive.comp -o progressivecomp.spv
+C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V sprite.vert -o spritevert.spv
+C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V sprite.frag -o spritefrag.spv
+C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V spritebindless.frag -o spritebindlessfrag.spv
+C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V upscale.frag -o upscalefrag.spv
+C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V composite.frag -o compositefrag.spv
+C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V yuv.comp -o yuvcomp.spv
+C:\VulkanSDK\1.2.162.0\Bin\glslangvalidator -V downsample.comp -o downsamplecomp.spv
+if not "%~1"=="" copy /y *.spv "%~1" > nul
 echo on
\ No newline at end of file
@@ -0,0 +1,34 @@
+#version 450
+
+layout(push_constant) uniform Viewport {
+  vec2 u_InverseSize;
+};
+
+layout(location = 0) in vec4 i_Position;
+layout(location = 1) in vec2 i_Coord;
+layout(location = 2) in vec4 i_Transform;
+layout(location = 3) in vec4 i_UVRect;
+layout(location = 4) in vec4 i_Color;
+layout(location = 5) in float i_Rotation;
+layout(location = 6) in uint i_Texture;
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+layout(location = 0) out vec2 v_Texcoord;
+layout(location = 1) out vec4 v_Color;
+layout(location = 2) flat out uint v_Texture;
+
+void main() {
+    vec2 corner = i_Position.xy * 0.5 * i_Transform.zw;
+    float s = sin( i_Rotation );
+    float c = cos( i_Rotation );
+    vec2 pixel = i_Transform.xy + vec2( c * corner.x - s * corner.y, s * corner.x + c * corner.y );
+
+    gl_Position = vec4( pixel * 2.0 * u_InverseSize - 1.0, 0.0, 1.0 );
+    v_Texcoord = mix( i_UVRect.xy, i_UVRect.zw, i_Coord );
+    v_Color = i_Color;
+    v_Texture = i_Texture;
+}
@@ -0,0 +1,14 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set=0, binding=0) uniform sampler2D u_Textures[];
+
+layout(location = 0) in vec2 v_Texcoord;
+layout(location = 1) in vec4 v_Color;
+layout(location = 2) flat in uint v_Texture;
+
+layout(location = 0) out vec4 o_Color;
+
+void main() {
+  o_Color = texture( u_Textures[nonuniformEXT( v_Texture )], v_Texcoord ) * v_Color;
+}
@@ -0,0 +1,30 @@
+#version 450
+
+layout(set=0, binding=0) uniform sampler2D u_Texture;
+
+//The scene only covers Scale of the target, Limit keeps the filter from reaching past it
+layout(push_constant) uniform Upscale {
+  vec2 Scale;
+  vec2 Limit;
+  vec2 Texel;
+  float Sharpness;
+} u_Upscale;
+
+layout(location = 0) in vec2 v_Texcoord;
+
+layout(location = 0) out vec4 o_Color;
+
+vec4 fetch(vec2 coord) {
+  return texture( u_Texture, min( coord, u_Upscale.Limit ) );
+}
+
+void main() {
+  vec2 coord = v_Texcoord * u_Upscale.Scale;
+  vec4 center = fetch( coord );
+
+  //Unsharp mask against the four neighbours, undoing some of the blur bilinear upscaling adds
+  vec4 neighbours = fetch( coord + vec2( u_Upscale.Texel.x, 0.0 ) ) + fetch( coord - vec2( u_Upscale.Texel.x, 0.0 ) ) +
+                    fetch( coord + vec2( 0.0, u_Upscale.Texel.y ) ) + fetch( coord - vec2( 0.0, u_Upscale.Texel.y ) );
+
+  o_Color = clamp( center + u_Upscale.Sharpness * ( 4.0 * center - neighbours ), 0.0, 1.0 );
+}
@@ -17,7 +17,7 @@ limitations under the License.
 #include "KrautVK.h"
 
 //Easier access to kraut resources
-#define kraut Com::kraut
+#define kraut (*Com::Current)
 
 //Temporary hard-coded vertex data for alpha developement and testing
 const std::vector<float> GlobalVertexData = {
@@ -56,8 +56,18 @@ namespace KVKBase {
             return GLFW_WINDOW_CREATION_FAILED;
         }
 
-        glfwSetWindowSizeCallback(kraut.GLFW.Window, [](GLFWwindow *unusedWindow, int width, int height) {
+        //Events for every window arrive through one poll, resize the swap chain of the context owning this one
+        glfwSetWindowUserPointer(kraut.GLFW.Window, Com::Current);
+        glfwSetWindowSizeCallback(kraut.GLFW.Window, [](GLFWwindow *window, int, int) {
+            Com::KrautCommon *previous = Com::Current;
+            Com::Current = static_cast<Com::KrautCommon *>(glfwGetWindowUserPointer(window));
             kvkOnWindowSizeChanged();
+            Com::Current = previous;
+        });
+
+        //Without a compositor, uncovered parts of the window are lost and the frame has to be drawn again
+        glfwSetWindowRefreshCallback(kraut.GLFW.Window, [](GLFWwindow *window) {
+            static_cast<Com::KrautCommon *>(glfwGetWindowUserPointer(window))->Idle.Changed = true;
         });
 
         return SUCCESS;
@@ -80,15 +90,15 @@ namespace KVKBase {
 
     //This is where we set up our command buffers and queue families and select our device.
     //When updating system requirments, start here.
-    int KrautVK::kvkCheckDeviceProperties(VkPhysicalDevice physicalDevice, uint32_t &selectedGraphicsCommandBuffer, uint32_t &selectedPresentationCommandBuffer) {
+    int KrautVK::kvkCheckDeviceProperties(VkPhysicalDevice physicalDevice, Com::DeviceParameters &device, uint32_t &selectedGraphicsCommandBuffer, uint32_t &selectedPresentationCommandBuffer) {
         uint32_t extensionsCount = 0;
-        if ((enumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionsCount, nullptr) != VK_SUCCESS) ||
+        if ((vki.enumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionsCount, nullptr) != VK_SUCCESS) ||
             (extensionsCount == 0)) {
             return false;
         }
 
         std::vector<VkExtensionProperties> availableExtensions(extensionsCount);
-        if (enumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionsCount, &availableExtensions[0]) !=
+        if (vki.enumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionsCount, &availableExtensions[0]) !=
             VK_SUCCESS) {
             return false;
         }
@@ -102,26 +112,26 @@ namespace KVKBase {
             }
         }
 
-        getPhysicalDeviceProperties(physicalDevice, &kraut.Vulkan.Device.Properties);
-        getPhysicalDeviceFeatures(physicalDevice, &kraut.Vulkan.Device.Features);
-        getPhysicalDeviceMemoryProperties(physicalDevice, &kraut.Vulkan.Device.MemoryProperties);
+        vki.getPhysicalDeviceProperties(physicalDevice, &device.Properties);
+        vki.getPhysicalDeviceFeatures(physicalDevice, &device.Features);
+        vki.getPhysicalDeviceMemoryProperties(physicalDevice, &device.MemoryProperties);
 
-        uint32_t majorVersion = VK_VERSION_MAJOR(kraut.Vulkan.Device.Properties.apiVersion);
-        uint32_t minorVersion = VK_VERSION_MINOR(kraut.Vulkan.Device.Properties.apiVersion);  //Reserved for when it's time to expect finer version requirements
-        uint32_t patchVersion = VK_VERSION_PATCH(kraut.Vulkan.Device.Properties.apiVersion);
+        uint32_t majorVersion = VK_VERSION_MAJOR(device.Properties.apiVersion);
+        uint32_t minorVersion = VK_VERSION_MINOR(device.Properties.apiVersion);  //Reserved for when it's time to expect finer version requirements
+        uint32_t patchVersion = VK_VERSION_PATCH(device.Properties.apiVersion);
 
-        if ((majorVersion < 1) || (kraut.Vulkan.Device.Properties.limits.maxImageDimension2D < 4096)) {
+        if ((majorVersion < 1) || (device.Properties.limits.maxImageDimension2D < 4096)) {
             return false;
         }
 
         uint32_t qFamilyCount = 0;
-        getPhysicalDeviceQueueFamilyProperties(physicalDevice, &qFamilyCount, nullptr);
+        vki.getPhysicalDeviceQueueFamilyProperties(physicalDevice, &qFamilyCount, nullptr);
         if (qFamilyCount == 0) {
             return false;
         }
 
         std::vector<VkQueueFamilyProperties> qFamilyProperties(qFamilyCount);
-        getPhysicalDeviceQueueFamilyProperties(physicalDevice, &qFamilyCount, qFamilyProperties.data());
+        vki.getPhysicalDeviceQueueFamilyProperties(physicalDevice, &qFamilyCount, qFamilyProperties.data());
 
         uint32_t currentGraphicsQueueFamilyIndex = UINT32_MAX;
         uint32_t currentPresentationQueueFamilyIndex = UINT32_MAX;
@@ -141,8 +151,7 @@ namespace KVKBase {
             if ((currentGraphicsQueueFamilyIndex != UINT32_MAX && currentPresentationQueueFamilyIndex != UINT32_MAX)) {
                 selectedGraphicsCommandBuffer = currentGraphicsQueueFamilyIndex;
                 selectedPresentationCommandBuffer = currentPresentationQueueFamilyIndex;
-
-                std::cout << "Selected Device: " << kraut.Vulkan.Device.Properties.deviceName << std::endl;
+                device.PhysicalDevice = physicalDevice;
                 return true;
             }
         }
@@ -150,14 +159,159 @@ namespace KVKBase {
         return false;
     }
 
+    bool KrautVK::kvkCheckFormatFeatures(VkPhysicalDevice physicalDevice, VkFormat format, VkFormatFeatureFlags features) {
+        VkFormatProperties formatProperties;
+        vki.getPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+
+        return (formatProperties.optimalTilingFeatures & features) == features;
+    }
+
+    //Fills in the report for any device, and scores the ones kvkCheckDeviceProperties accepts. Device type counts most,
+    //then memory, then the queues, formats and features the engine makes use of when they are there
+    int64_t KrautVK::kvkScoreDevice(VkPhysicalDevice physicalDevice, DeviceReport &report) {
+        Com::DeviceParameters device;
+        uint32_t graphicsFamily = UINT32_MAX;
+        uint32_t presentFamily = UINT32_MAX;
+        bool suitable = kvkCheckDeviceProperties(physicalDevice, device, graphicsFamily, presentFamily) != 0;
+
+        //The check bails out early for devices without the required extensions
+        vki.getPhysicalDeviceProperties(physicalDevice, &device.Properties);
+        vki.getPhysicalDeviceMemoryProperties(physicalDevice, &device.MemoryProperties);
+
+        report = DeviceReport();
+        memcpy(report.name, device.Properties.deviceName, sizeof(report.name));
+        memcpy(report.uuid, device.Properties.pipelineCacheUUID, sizeof(report.uuid));
+
+        //The device UUID stays the same across driver updates, the pipeline cache UUID only stands in on 1.0 devices
+        if (vki.getPhysicalDeviceProperties2 != nullptr && device.Properties.apiVersion >= VK_API_VERSION_1_1) {
+            VkPhysicalDeviceIDProperties idProperties = {};
+            idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+            VkPhysicalDeviceProperties2 properties = {
+                    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, // VkStructureType                sType
+                    &idProperties,                                  // void                          *pNext
+                    {}                                              // VkPhysicalDeviceProperties     properties
+            };
+
+            vki.getPhysicalDeviceProperties2(physicalDevice, &properties);
+            memcpy(report.uuid, idProperties.deviceUUID, sizeof(report.uuid));
+        }
+        report.vendorID = device.Properties.vendorID;
+        report.deviceID = device.Properties.deviceID;
+        report.deviceType = device.Properties.deviceType;
+        report.apiVersion = device.Properties.apiVersion;
+        report.driverVersion = device.Properties.driverVersion;
+        report.graphicsFamily = graphicsFamily;
+        report.presentFamily = presentFamily;
+        report.computeFamily = UINT32_MAX;
+        report.transferFamily = UINT32_MAX;
+        report.maxImageDimension2D = device.Properties.limits.maxImageDimension2D;
+        report.timestamps = device.Properties.limits.timestampComputeAndGraphics == VK_TRUE;
+
+        for (uint32_t i = 0; i < device.MemoryProperties.memoryHeapCount; ++i) {
+            const VkMemoryHeap &heap = device.MemoryProperties.memoryHeaps[i];
+            if (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+                report.deviceLocalMemory += heap.size;
+            else
+                report.sharedMemory += heap.size;
+        }
+
+        uint32_t qFamilyCount = 0;
+        vki.getPhysicalDeviceQueueFamilyProperties(physicalDevice, &qFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> qFamilyProperties(qFamilyCount);
+        if (qFamilyCount > 0)
+            vki.getPhysicalDeviceQueueFamilyProperties(physicalDevice, &qFamilyCount, qFamilyProperties.data());
+
+        for (uint32_t i = 0; i < qFamilyCount; ++i) {
+            VkQueueFlags flags = qFamilyProperties[i].queueFlags;
+            if (qFamilyProperties[i].queueCount == 0 || (flags & VK_QUEUE_GRAPHICS_BIT))
+                continue;
+
+            if ((flags & VK_QUEUE_COMPUTE_BIT) && report.computeFamily == UINT32_MAX)
+                report.computeFamily = i;
+            else if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_COMPUTE_BIT) && report.transferFamily == UINT32_MAX)
+                report.transferFamily = i;
+        }
+
+        report.floatTargets = kvkCheckFormatFeatures(physicalDevice, VK_FORMAT_R16G16B16A16_SFLOAT,
+                                                     VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+        report.storageTarget = kvkCheckFormatFeatures(physicalDevice, KVK_COMPUTE_TARGET_FORMAT,
+                                                      VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT);
+
+        uint32_t extensionsCount = 0;
+        if (vki.enumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionsCount, nullptr) == VK_SUCCESS && extensionsCount > 0) {
+            std::vector<VkExtensionProperties> availableExtensions(extensionsCount);
+            if (vki.enumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionsCount, &availableExtensions[0]) == VK_SUCCESS) {
+                report.bindless = kvkCheckExtensionAvailability(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, availableExtensions);
+                report.memoryBudget = kvkCheckExtensionAvailability(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, availableExtensions);
+            }
+        }
+
+        if (!suitable) {
+            report.score = -1;
+            return report.score;
+        }
+
+        int64_t score = 0;
+        switch (device.Properties.deviceType) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+                score += KVK_SCORE_DISCRETE_GPU;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+                score += KVK_SCORE_INTEGRATED_GPU;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+                score += KVK_SCORE_VIRTUAL_GPU;
+                break;
+            default:
+                break;
+        }
+
+        score += KVK_SCORE_PER_GIB * static_cast<int64_t>(std::min<uint64_t>(report.deviceLocalMemory >> 30, KVK_SCORE_MAX_GIB));
+
+        if (report.computeFamily != UINT32_MAX)
+            score += KVK_SCORE_QUEUE_FAMILY;
+
+        if (report.transferFamily != UINT32_MAX)
+            score += KVK_SCORE_QUEUE_FAMILY;
+
+        if (graphicsFamily == presentFamily)
+            score += KVK_SCORE_SHARED_PRESENT;
+
+        score += KVK_SCORE_FEATURE * (report.floatTargets + report.storageTarget + report.bindless + report.memoryBudget + report.timestamps);
+
+        report.score = score;
+        return score;
+    }
+
+    //A device is asked for by name, or a part of it, or by its UUID as 32 hex digits, dashes allowed
+    bool KrautVK::kvkMatchDevice(const DeviceReport &report, const std::string &preferredDevice) {
+        std::string digits;
+        for (char c : preferredDevice) {
+            if (c != '-')
+                digits += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+
+        if (digits.size() == 2 * VK_UUID_SIZE && digits.find_first_not_of("0123456789abcdef") == std::string::npos) {
+            char uuid[2 * VK_UUID_SIZE + 1];
+            for (uint32_t i = 0; i < VK_UUID_SIZE; ++i)
+                snprintf(&uuid[2 * i], 3, "%02x", report.uuid[i]);
+
+            return digits == uuid;
+        }
+
+        return strstr(report.name, preferredDevice.c_str()) != nullptr;
+    }
+
     int KrautVK::kvkCreateInstance(const char *title) {
 
         //CREATE VULKAN INSTANCE
         if (!glfwVulkanSupported())
             return VULKAN_NOT_SUPPORTED;
 
-        //initialize function pointers and create Vulkan instance
-        createInstance = (PFN_vkCreateInstance) glfwGetInstanceProcAddress(nullptr, "vkCreateInstance");
+        //initialize the loader level entry point and create Vulkan instance
+        PFN_vkGetInstanceProcAddr getInstanceProcAddr = (PFN_vkGetInstanceProcAddr) glfwGetInstanceProcAddress(nullptr, "vkGetInstanceProcAddr");
+        kraut.Vulkan.Dispatch.createInstance = (PFN_vkCreateInstance) getInstanceProcAddr(nullptr, "vkCreateInstance");
 
 
         VkApplicationInfo applicationInfo = {
@@ -187,54 +341,71 @@ namespace KVKBase {
                 reqdExtensions                                  // const char * const        *ppEnabledExtensionNames
         };
 
-        if (createInstance(&instanceCreateInfo, nullptr, &kraut.Vulkan.Instance) != SUCCESS)
+        if (vki.createInstance(&instanceCreateInfo, nullptr, &kraut.Vulkan.Instance) != SUCCESS)
             return VULKAN_INSTANCE_CREATION_FAILED;
 
-        createDevice = (PFN_vkCreateDevice)                                                         glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkCreateDevice");
-        enumeratePhysicalDevices = (PFN_vkEnumeratePhysicalDevices)                                 glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkEnumeratePhysicalDevices");
-        getPhysicalDeviceProperties = (PFN_vkGetPhysicalDeviceProperties)                           glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkGetPhysicalDeviceProperties");
-        getPhysicalDeviceFeatures = (PFN_vkGetPhysicalDeviceFeatures)                               glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkGetPhysicalDeviceFeatures");
-        getPhysicalDeviceQueueFamilyProperties = (PFN_vkGetPhysicalDeviceQueueFamilyProperties)     glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkGetPhysicalDeviceQueueFamilyProperties");
-        destroyInstance = (PFN_vkDestroyInstance)                                                   glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkDestroyInstance");
-        destroySurfaceKHR = (PFN_vkDestroySurfaceKHR)                                               glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkDestroySurfaceKHR");
-        enumerateDeviceExtensionProperties = (PFN_vkEnumerateDeviceExtensionProperties)             glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkEnumerateDeviceExtensionProperties");
-        getPhysicalDeviceSurfaceCapabilitiesKHR = (PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR)   glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkGetPhysicalDeviceSurfaceCapabilitiesKHR");
-        getPhysicalDeviceSurfaceFormatsKHR = (PFN_vkGetPhysicalDeviceSurfaceFormatsKHR)             glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkGetPhysicalDeviceSurfaceFormatsKHR");
-        getPhysicalDeviceSurfacePresentModesKHR = (PFN_vkGetPhysicalDeviceSurfacePresentModesKHR)   glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkGetPhysicalDeviceSurfacePresentModesKHR");
-        getPhysicalDeviceMemoryProperties = (PFN_vkGetPhysicalDeviceMemoryProperties)               glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkGetPhysicalDeviceMemoryProperties");
+        if (!kraut.Vulkan.Dispatch.load(getInstanceProcAddr, kraut.Vulkan.Instance))
+            return VULKAN_INSTANCE_CREATION_FAILED;
 
 
         return SUCCESS;
     }
 
-    int KrautVK::kvkCreateDevice() {
+    int KrautVK::kvkCreateDevice(const char *preferredDevice) {
         if (glfwCreateWindowSurface(kraut.Vulkan.Instance, kraut.GLFW.Window, nullptr, &kraut.Vulkan.ApplicationSurface))
             return VULKAN_SURFACE_CREATION_FAILED;
 
         //INITIALIZE PHYSICAL DEVICES
         printf("Enumerating physical devices...\n");
         uint32_t deviceCount;
-        if (enumeratePhysicalDevices(kraut.Vulkan.Instance, &deviceCount, nullptr) != SUCCESS || deviceCount == 0)
+        if (vki.enumeratePhysicalDevices(kraut.Vulkan.Instance, &deviceCount, nullptr) != SUCCESS || deviceCount == 0)
             return VULKAN_NOT_SUPPORTED;
 
         std::vector<VkPhysicalDevice> devices(deviceCount);
-        if (enumeratePhysicalDevices(kraut.Vulkan.Instance, &deviceCount, &devices[0]) != SUCCESS)
+        if (vki.enumeratePhysicalDevices(kraut.Vulkan.Instance, &deviceCount, &devices[0]) != SUCCESS)
             return VULKAN_NOT_SUPPORTED;
 
-        uint32_t selectedGraphicsQueueFamilyIndex = UINT32_MAX;
-        uint32_t selectedPresentationQueueFamilyIndex = UINT32_MAX;
+        //Rank every device, a device asked for by name or UUID wins over the ranking if it can run the engine
+        std::string preference = preferredDevice != nullptr ? preferredDevice : "";
+        kraut.Vulkan.DeviceReports.assign(deviceCount, DeviceReport());
+
+        uint32_t selected = UINT32_MAX;
+        bool preferred = false;
 
         for (uint32_t i = 0; i < deviceCount; i++) {
-            if (kvkCheckDeviceProperties(devices[i], selectedGraphicsQueueFamilyIndex,
-                                         selectedPresentationQueueFamilyIndex)) {
-                kraut.Vulkan.Device.PhysicalDevice = devices[i];
-                break;
+            DeviceReport &report = kraut.Vulkan.DeviceReports[i];
+            if (kvkScoreDevice(devices[i], report) < 0) {
+                printf("  %s: unsupported\n", report.name);
+                continue;
+            }
+
+            printf("  %s: score %lld\n", report.name, static_cast<long long>(report.score));
+
+            bool match = !preference.empty() && kvkMatchDevice(report, preference);
+            if (selected == UINT32_MAX || (match && !preferred) ||
+                (match == preferred && report.score > kraut.Vulkan.DeviceReports[selected].score)) {
+                selected = i;
+                preferred = match;
             }
         }
 
-        if (kraut.Vulkan.Device.PhysicalDevice == nullptr)
+        if (selected == UINT32_MAX)
+            return VULKAN_NOT_SUPPORTED;
+
+        if (!preference.empty() && !preferred)
+            printf("No supported device matches \"%s\", using the highest ranked one\n", preference.c_str());
+
+        kraut.Vulkan.DeviceReports[selected].selected = 1;
+
+        uint32_t selectedGraphicsQueueFamilyIndex = UINT32_MAX;
+        uint32_t selectedPresentationQueueFamilyIndex = UINT32_MAX;
+
+        if (!kvkCheckDeviceProperties(devices[selected], kraut.Vulkan.Device, selectedGraphicsQueueFamilyIndex,
+                                      selectedPresentationQueueFamilyIndex))
             return VULKAN_NOT_SUPPORTED;
 
+        std::cout << "Selected Device: " << kraut.Vulkan.Device.Properties.deviceName << std::endl;
+
         std::vector<VkDeviceQueueCreateInfo> qCreateInfos;
         std::vector<float> queuePriorities = {1.0f};
 
@@ -252,7 +423,7 @@ namespace KVKBase {
                                            VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,     // VkStructureType              sType
                                            nullptr,                                        // const void                  *pNext
                                            0,                                              // VkDeviceQueueCreateFlags     flags
-                                           selectedGraphicsQueueFamilyIndex,               // uint32_t                     queueFamilyIndex
+                                           selectedPresentationQueueFamilyIndex,           // uint32_t                     queueFamilyIndex
                                            static_cast<uint32_t>(queuePriorities.size()),  // uint32_t                     queueCount
                                            &queuePriorities[0]                             // const float                 *pQueuePriorities
                                    });
@@ -261,9 +432,24 @@ namespace KVKBase {
         std::vector<const char *> extensions;
         kvkGetRequiredDeviceExtensions(extensions);
 
+        //Bindless textures are optional, without descriptor indexing sprites keep a descriptor set per texture
+        VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+        void *deviceCreateNext = nullptr;
+
+        kraut.Bindless.Supported = kvkCheckBindlessSupport(indexingFeatures);
+        if (kraut.Bindless.Supported) {
+            extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+            deviceCreateNext = &indexingFeatures;
+        }
+
+        //Without the driver's budget the tracker falls back on heap sizes and its own accounting
+        kraut.Memory.BudgetSupported = kvkCheckMemoryBudgetSupport();
+        if (kraut.Memory.BudgetSupported)
+            extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
         VkDeviceCreateInfo deviceCreateInfo = {
                 VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,           // VkStructureType                    sType
-                nullptr,                                        // const void                        *pNext
+                deviceCreateNext,                               // const void                        *pNext
                 0,                                              // VkDeviceCreateFlags                flags
                 static_cast<uint32_t>(qCreateInfos.size()),     // uint32_t                           queueCreateInfoCount
                 &qCreateInfos[0],                               // const VkDeviceQueueCreateInfo     *pQueueCreateInfos
@@ -274,83 +460,75 @@ namespace KVKBase {
                 nullptr                                         // const VkPhysicalDeviceFeatures    *pEnabledFeatures
         };
 
-        if (createDevice(kraut.Vulkan.Device.PhysicalDevice, &deviceCreateInfo, nullptr, &kraut.Vulkan.Device.Handle) != SUCCESS)
+        if (vki.createDevice(kraut.Vulkan.Device.PhysicalDevice, &deviceCreateInfo, nullptr, &kraut.Vulkan.Device.Handle) != SUCCESS)
             return VULKAN_DEVICE_CREATION_FAILED;
 
-        getDeviceProcAddr = (PFN_vkGetDeviceProcAddr) glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkGetDeviceProcAddr");
-
-        getDeviceQueue = (PFN_vkGetDeviceQueue)                                         getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkGetDeviceQueue");
-        deviceWaitIdle = (PFN_vkDeviceWaitIdle)                                         getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDeviceWaitIdle");
-        destroyDevice = (PFN_vkDestroyDevice)                                           getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyDevice");
-        createSemaphore = (PFN_vkCreateSemaphore)                                       getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateSemaphore");
-        createSwapchainKHR = (PFN_vkCreateSwapchainKHR)                                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateSwapchainKHR");
-        destroySwapchainKHR = (PFN_vkDestroySwapchainKHR)                               getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroySwapchainKHR");
-        getSwapchainImagesKHR = (PFN_vkGetSwapchainImagesKHR)                           getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkGetSwapchainImagesKHR");
-        acquireNextImageKHR = (PFN_vkAcquireNextImageKHR)                               getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkAcquireNextImageKHR");
-        queuePresentKHR = (PFN_vkQueuePresentKHR)                                       getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkQueuePresentKHR");
-        queueSubmit = (PFN_vkQueueSubmit)                                               getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkQueueSubmit");
-        createCommandPool = (PFN_vkCreateCommandPool)                                   getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateCommandPool");
-        allocateCommandBuffers = (PFN_vkAllocateCommandBuffers)                         getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkAllocateCommandBuffers");
-        freeCommandBuffers = (PFN_vkFreeCommandBuffers)                                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkFreeCommandBuffers");
-        destroyCommandPool = (PFN_vkDestroyCommandPool)                                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyCommandPool");
-        destroySemaphore = (PFN_vkDestroySemaphore)                                     getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroySemaphore");
-        beginCommandBuffer = (PFN_vkBeginCommandBuffer)                                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkBeginCommandBuffer");
-        cmdPipelineBarrier = (PFN_vkCmdPipelineBarrier)                                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdPipelineBarrier");
-        endCommandBuffer = (PFN_vkEndCommandBuffer)                                     getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkEndCommandBuffer");
-        destroyImageView = (PFN_vkDestroyImageView)                                     getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyImageView");
-        createImageView = (PFN_vkCreateImageView)                                       getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateImageView");
-        createRenderPass = (PFN_vkCreateRenderPass)                                     getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateRenderPass");
-        createFramebuffer = (PFN_vkCreateFramebuffer)                                   getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateFramebuffer");
-        createShaderModule = (PFN_vkCreateShaderModule)                                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateShaderModule");
-        destroyShaderModule = (PFN_vkDestroyShaderModule)                               getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyShaderModule");
-        cmdBeginRenderPass = (PFN_vkCmdBeginRenderPass)                                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdBeginRenderPass");
-        cmdBindPipeline = (PFN_vkCmdBindPipeline)                                       getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdBindPipeline");
-        cmdDraw = (PFN_vkCmdDraw)                                                       getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdDraw");
-        cmdEndRenderPass = (PFN_vkCmdEndRenderPass)                                     getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdEndRenderPass");
-        destroyPipeline = (PFN_vkDestroyPipeline)                                       getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyPipeline");
-        destroyRenderPass = (PFN_vkDestroyRenderPass)                                   getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyRenderPass");
-        destroyFramebuffer = (PFN_vkDestroyFramebuffer)                                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyFramebuffer");
-        createGraphicsPipelines = (PFN_vkCreateGraphicsPipelines)                       getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateGraphicsPipelines");
-        createPipelineLayout = (PFN_vkCreatePipelineLayout)                             getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreatePipelineLayout");
-        destroyPipelineLayout = (PFN_vkDestroyPipelineLayout)                           getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyPipelineLayout");
-        createBuffer = (PFN_vkCreateBuffer)                                             getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateBuffer");
-        bindBufferMemory = (PFN_vkBindBufferMemory)                                     getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkBindBufferMemory");
-        mapMemory = (PFN_vkMapMemory)                                                   getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkMapMemory");
-        flushMappedMemoryRanges = (PFN_vkFlushMappedMemoryRanges)                       getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkFlushMappedMemoryRanges");
-        unmapMemory = (PFN_vkUnmapMemory)                                               getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkUnmapMemory");
-        getBufferMemoryRequirements = (PFN_vkGetBufferMemoryRequirements)               getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkGetBufferMemoryRequirements");
-        allocateMemory = (PFN_vkAllocateMemory)                                         getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkAllocateMemory");
-        createFence = (PFN_vkCreateFence)                                               getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateFence");
-        destroyFence = (PFN_vkDestroyFence)                                             getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyFence");
-        destroyBuffer = (PFN_vkDestroyBuffer)                                           getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyBuffer");
-        freeMemory = (PFN_vkFreeMemory)                                                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkFreeMemory");
-        resetFences = (PFN_vkResetFences)                                               getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkResetFences");
-        waitForFences = (PFN_vkWaitForFences)                                           getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkWaitForFences");
-        cmdSetViewport = (PFN_vkCmdSetViewport)                                         getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdSetViewport");
-        cmdSetScissor = (PFN_vkCmdSetScissor)                                           getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdSetScissor");
-        cmdBindVertexBuffers = (PFN_vkCmdBindVertexBuffers)                             getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdBindVertexBuffers");
-        cmdCopyBuffer = (PFN_vkCmdCopyBuffer)                                           getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdCopyBuffer");
-        bindImageMemory = (PFN_vkBindImageMemory)                                       getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkBindImageMemory");
-        createSampler = (PFN_vkCreateSampler)                                           getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateSampler");
-        cmdCopyBufferToImage = (PFN_vkCmdCopyBufferToImage)                             getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdCopyBufferToImage");
-        createImage = (PFN_vkCreateImage)                                               getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateImage");
-        getImageMemoryRequirements = (PFN_vkGetImageMemoryRequirements)                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkGetImageMemoryRequirements");
-        createDescriptorSetLayout = (PFN_vkCreateDescriptorSetLayout)                   getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateDescriptorSetLayout");
-        createDescriptorPool = (PFN_vkCreateDescriptorPool)                             getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCreateDescriptorPool");
-        allocateDescriptorSets = (PFN_vkAllocateDescriptorSets)                         getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkAllocateDescriptorSets");
-        updateDescriptorSets = (PFN_vkUpdateDescriptorSets)                             getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkUpdateDescriptorSets");
-        cmdBindDescriptorSets = (PFN_vkCmdBindDescriptorSets)                           getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkCmdBindDescriptorSets");
-        destroyDescriptorPool = (PFN_vkDestroyDescriptorPool)                           getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyDescriptorPool");
-        destroyDescriptorSetLayout = (PFN_vkDestroyDescriptorSetLayout)                 getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyDescriptorSetLayout");
-        destroySampler = (PFN_vkDestroySampler)                                         getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroySampler");
-        destroyImage = (PFN_vkDestroyImage)                                             getDeviceProcAddr(kraut.Vulkan.Device.Handle, "vkDestroyImage");
+        if (!kraut.Vulkan.Device.Dispatch.load(vki.getDeviceProcAddr, kraut.Vulkan.Device.Handle))
+            return VULKAN_DEVICE_CREATION_FAILED;
 
         //INITIALIZE COMMAND BUFFER
         kraut.GraphicsQueue.FamilyIndex = selectedGraphicsQueueFamilyIndex;
         kraut.PresentQueue.FamilyIndex = selectedPresentationQueueFamilyIndex;
 
-        getDeviceQueue(kraut.Vulkan.Device.Handle, kraut.GraphicsQueue.FamilyIndex, 0, &kraut.GraphicsQueue.Handle);
-        getDeviceQueue(kraut.Vulkan.Device.Handle, kraut.PresentQueue.FamilyIndex, 0, &kraut.PresentQueue.Handle);
+        vkd.getDeviceQueue(kraut.Vulkan.Device.Handle, kraut.GraphicsQueue.FamilyIndex, 0, &kraut.GraphicsQueue.Handle);
+        vkd.getDeviceQueue(kraut.Vulkan.Device.Handle, kraut.PresentQueue.FamilyIndex, 0, &kraut.PresentQueue.Handle);
+
+        //Contexts sharing the device get the queues' locks, the caches and the memory accounting along with it
+        kraut.Vulkan.Device.Shared = std::make_shared<Com::SharedDeviceParameters>();
+        kraut.Vulkan.Device.Shared->GraphicsQueue = kraut.GraphicsQueue.Handle;
+        kraut.Vulkan.Device.Shared->PresentQueue = kraut.PresentQueue.Handle;
+
+        VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,   // VkStructureType                sType
+                nullptr,                                        // const void                    *pNext
+                0,                                              // VkPipelineCacheCreateFlags     flags
+                0,                                              // size_t                         initialDataSize
+                nullptr                                         // const void                    *pInitialData
+        };
+
+        if (vkd.createPipelineCache(kraut.Vulkan.Device.Handle, &pipelineCacheCreateInfo, nullptr, &kraut.Vulkan.Device.Shared->PipelineCache) != VK_SUCCESS)
+            return VULKAN_DEVICE_CREATION_FAILED;
+
+        //Effect timings need timestamps on the graphics queue
+        kraut.Timing.Supported = kraut.Vulkan.Device.Properties.limits.timestampComputeAndGraphics == VK_TRUE;
+        kraut.Timing.TimestampPeriod = kraut.Vulkan.Device.Properties.limits.timestampPeriod;
+
+        return SUCCESS;
+    }
+
+    //Contexts are initialized and terminated on the thread polling their windows, so no other thread changes a device
+    //handle while this looks at it
+    Com::KrautCommon *KrautVK::kvkFindSharedDevice() {
+        std::lock_guard<std::mutex> lock(Com::ContextsMutex);
+        for (auto &context : Com::Contexts) {
+            if (context && context.get() != Com::Current && context->Vulkan.Device.Handle != VK_NULL_HANDLE)
+                return context.get();
+        }
+
+        return nullptr;
+    }
+
+    //The instance, device and queues are shared along with their dispatch tables, the device's caches and memory
+    //accounting. Everything built on top of them stays with the context
+    int KrautVK::kvkShareDevice(const Com::KrautCommon &shared) {
+        kraut.Vulkan.Instance = shared.Vulkan.Instance;
+        kraut.Vulkan.Dispatch = shared.Vulkan.Dispatch;
+        kraut.Vulkan.DeviceReports = shared.Vulkan.DeviceReports;
+        kraut.Vulkan.Device = shared.Vulkan.Device;
+        kraut.GraphicsQueue = shared.GraphicsQueue;
+        kraut.PresentQueue = shared.PresentQueue;
+        kraut.Bindless.Supported = shared.Bindless.Supported;
+        kraut.Memory.BudgetSupported = shared.Memory.BudgetSupported;
+        kraut.Timing.Supported = kraut.Vulkan.Device.Properties.limits.timestampComputeAndGraphics == VK_TRUE;
+        kraut.Timing.TimestampPeriod = kraut.Vulkan.Device.Properties.limits.timestampPeriod;
+
+        if (glfwCreateWindowSurface(kraut.Vulkan.Instance, kraut.GLFW.Window, nullptr, &kraut.Vulkan.ApplicationSurface))
+            return VULKAN_SURFACE_CREATION_FAILED;
+
+        VkBool32 presentSupported = VK_FALSE;
+        if (vki.getPhysicalDeviceSurfaceSupportKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.PresentQueue.FamilyIndex,
+                                               kraut.Vulkan.ApplicationSurface, &presentSupported) != VK_SUCCESS || !presentSupported)
+            return VULKAN_NOT_SUPPORTED;
 
         return SUCCESS;
     }
@@ -358,41 +536,41 @@ namespace KVKBase {
     bool KrautVK::kvkCreateSwapChain() {
 
         if (kraut.Vulkan.Device.Handle != VK_NULL_HANDLE) {
-            deviceWaitIdle(kraut.Vulkan.Device.Handle);
+            kvkDeviceWaitIdle();
         }
 
         for(size_t i = 0; i < kraut.Vulkan.SwapChain.Images.size(); ++i) {
             if(kraut.Vulkan.SwapChain.Images[i].View != VK_NULL_HANDLE) {
-                destroyImageView(kraut.Vulkan.Device.Handle, kraut.Vulkan.SwapChain.Images[i].View, nullptr);
+                vkd.destroyImageView(kraut.Vulkan.Device.Handle, kraut.Vulkan.SwapChain.Images[i].View, nullptr);
                 kraut.Vulkan.SwapChain.Images[i].View = VK_NULL_HANDLE;
             }
         }
         kraut.Vulkan.SwapChain.Images.clear();
 
         VkSurfaceCapabilitiesKHR surfaceCapabilities;
-        if (getPhysicalDeviceSurfaceCapabilitiesKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.ApplicationSurface, &surfaceCapabilities) != VK_SUCCESS) {
+        if (vki.getPhysicalDeviceSurfaceCapabilitiesKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.ApplicationSurface, &surfaceCapabilities) != VK_SUCCESS) {
             return false;
         }
 
         uint32_t formatsCount;
-        if ((getPhysicalDeviceSurfaceFormatsKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.ApplicationSurface, &formatsCount, nullptr) != VK_SUCCESS) ||
+        if ((vki.getPhysicalDeviceSurfaceFormatsKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.ApplicationSurface, &formatsCount, nullptr) != VK_SUCCESS) ||
             (formatsCount == 0)) {
             return false;
         }
 
         std::vector<VkSurfaceFormatKHR> surfaceFormats(formatsCount);
-        if (getPhysicalDeviceSurfaceFormatsKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.ApplicationSurface, &formatsCount, surfaceFormats.data()) != VK_SUCCESS) {
+        if (vki.getPhysicalDeviceSurfaceFormatsKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.ApplicationSurface, &formatsCount, surfaceFormats.data()) != VK_SUCCESS) {
             return false;
         }
 
         uint32_t presentModesCount;
-        if ((getPhysicalDeviceSurfacePresentModesKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.ApplicationSurface, &presentModesCount, nullptr) != VK_SUCCESS) ||
+        if ((vki.getPhysicalDeviceSurfacePresentModesKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.ApplicationSurface, &presentModesCount, nullptr) != VK_SUCCESS) ||
             (presentModesCount == 0)) {
             return false;
         }
 
         std::vector<VkPresentModeKHR> presentModes(presentModesCount);
-        if (getPhysicalDeviceSurfacePresentModesKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.ApplicationSurface,
+        if (vki.getPhysicalDeviceSurfacePresentModesKHR(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.ApplicationSurface,
                                                     &presentModesCount, presentModes.data()) != VK_SUCCESS) {
             return false;
         }
@@ -439,7 +617,7 @@ namespace KVKBase {
                 oldSwapChain                                    // VkSwapchainKHR                 oldSwapchain
         };
 
-        if (createSwapchainKHR(kraut.Vulkan.Device.Handle, &swapChainCreateInfo, nullptr, &kraut.Vulkan.SwapChain.Handle) !=
+        if (vkd.createSwapchainKHR(kraut.Vulkan.Device.Handle, &swapChainCreateInfo, nullptr, &kraut.Vulkan.SwapChain.Handle) !=
             VK_SUCCESS) {
             return false;
         }
@@ -448,11 +626,11 @@ namespace KVKBase {
         kraut.Vulkan.SwapChain.Format = desiredFormat.format;
 
         if (oldSwapChain != VK_NULL_HANDLE) {
-            destroySwapchainKHR(kraut.Vulkan.Device.Handle, oldSwapChain, nullptr);
+            vkd.destroySwapchainKHR(kraut.Vulkan.Device.Handle, oldSwapChain, nullptr);
         }
 
         uint32_t imageCount = 0;
-        if((getSwapchainImagesKHR( kraut.Vulkan.Device.Handle, kraut.Vulkan.SwapChain.Handle, &imageCount, nullptr ) != VK_SUCCESS) ||
+        if((vkd.getSwapchainImagesKHR( kraut.Vulkan.Device.Handle, kraut.Vulkan.SwapChain.Handle, &imageCount, nullptr ) != VK_SUCCESS) ||
             (imageCount == 0) ) {
             std::cout << "Could not get swap chain images!" << std::endl;
             return false;
@@ -460,7 +638,7 @@ namespace KVKBase {
         kraut.Vulkan.SwapChain.Images.resize( imageCount );
 
         std::vector<VkImage> images( imageCount );
-        if(getSwapchainImagesKHR(kraut.Vulkan.Device.Handle, kraut.Vulkan.SwapChain.Handle, &imageCount, images.data() ) != VK_SUCCESS ) {
+        if(vkd.getSwapchainImagesKHR(kraut.Vulkan.Device.Handle, kraut.Vulkan.SwapChain.Handle, &imageCount, images.data() ) != VK_SUCCESS ) {
             std::cout << "Could not get swap chain images!" << std::endl;
             return false;
         }
@@ -608,18 +786,52 @@ namespace KVKBase {
                 kraut.PresentQueue.FamilyIndex                                                              // uint32_t                     queueFamilyIndex
         };
 
-        if (createCommandPool(kraut.Vulkan.Device.Handle, &cmdPoolCreateInfo, nullptr, &kraut.Vulkan.CommandPool) != VK_SUCCESS) {
+        if (vkd.createCommandPool(kraut.Vulkan.Device.Handle, &cmdPoolCreateInfo, nullptr, &kraut.Vulkan.CommandPool) != VK_SUCCESS) {
             return VULKAN_COMMAND_BUFFER_CREATION_FAILED;
         }
 
         return SUCCESS;
     }
 
-    bool KrautVK::kvkRecordCommandBuffers(VkCommandBuffer commandBuffer, const Com::ImageParameters &imageParameters, VkFramebuffer &framebuffer) {
-        if(!kvkCreateFrameBuffers(framebuffer, imageParameters.View)) {
+    //The command pool and everything each rendering resource needs to record and submit a frame
+    int KrautVK::kvkCreateRenderingResources() {
+        int status = kvkCreateCommandPool();
+        if (status != SUCCESS)
+            return status;
+
+        for(size_t i = 0; i < kraut.Vulkan.RenderingResources.size(); i++) {
+
+            status = kvkAllocateCommandBuffer(kraut.Vulkan.CommandPool, 1, &kraut.Vulkan.RenderingResources[i].CommandBuffer);
+            if (status != SUCCESS)
+                return status;
+
+            status = kvkCreateSemaphore(&kraut.Vulkan.RenderingResources[i].ImageAvailableSemaphore);
+            if (status != SUCCESS)
+                return status;
+
+            status = kvkCreateSemaphore(&kraut.Vulkan.RenderingResources[i].FinishedRenderingSemaphore);
+            if (status != SUCCESS)
+                return status;
+
+            status = kvkCreateFence(&kraut.Vulkan.RenderingResources[i].Fence);
+            if (status != SUCCESS)
+                return status;
+
+            if(kraut.Timing.Supported && !kvkCreateTimestampPool(&kraut.Vulkan.RenderingResources[i].TimestampPool))
+                kraut.Timing.Supported = false;
+        }
+
+        return SUCCESS;
+    }
+
+    bool KrautVK::kvkRecordCommandBuffers(Com::RenderingResourcesData &renderingResource, const Com::ImageParameters &imageParameters) {
+        if(!kvkCreateFrameBuffers(renderingResource.Framebuffer, imageParameters.View)) {
             return false;
         }
 
+        VkCommandBuffer commandBuffer = renderingResource.CommandBuffer;
+        VkQueryPool timestampPool = renderingResource.TimestampPool;
+
         VkCommandBufferBeginInfo commandBufferBeginInfo = {
                 VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,        // VkStructureType                        sType
                 nullptr,                                            // const void                            *pNext
@@ -627,7 +839,7 @@ namespace KVKBase {
                 nullptr                                             // const VkCommandBufferInheritanceInfo  *pInheritanceInfo
         };
 
-        beginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+        vkd.beginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
 
         VkImageSubresourceRange imageSubresourceRange = {
                 VK_IMAGE_ASPECT_COLOR_BIT,                          // VkImageAspectFlags                     aspectMask
@@ -637,7 +849,10 @@ namespace KVKBase {
                 1                                                   // uint32_t                               layerCount
         };
 
-        if(kraut.PresentQueue.Handle != kraut.GraphicsQueue.Handle) {
+        //Offscreen targets never go near the present queue
+        const bool transferOwnership = !kraut.Offscreen.Active && kraut.PresentQueue.Handle != kraut.GraphicsQueue.Handle;
+
+        if(transferOwnership) {
             VkImageMemoryBarrier barrierFromPresentToDraw = {
                     VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
                     nullptr,                                          // const void                            *pNext
@@ -650,9 +865,74 @@ namespace KVKBase {
                     imageParameters.Handle,                           // VkImage                                image
                     imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
             };
-            cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierFromPresentToDraw);
+            vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierFromPresentToDraw);
+        }
+
+        if(kraut.Timing.Supported) {
+            vkd.cmdResetQueryPool(commandBuffer, timestampPool, 0, 2);
+            vkd.cmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, 0);
+        }
+
+        if(kraut.Compute.Active)
+            kvkRecordCompute(commandBuffer, imageParameters);
+        else
+            kvkRecordRaster(commandBuffer, renderingResource);
+
+        if(kraut.Timing.Supported)
+            vkd.cmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, 1);
+
+        //The conversion is not part of the effect's time
+        renderingResource.ReadbackWritten = kraut.Offscreen.Active && kraut.Output.Size > 0;
+        if(renderingResource.ReadbackWritten)
+            kvkRecordOutput(commandBuffer, renderingResource);
+
+        if(transferOwnership) {
+            VkImageMemoryBarrier barrierFromDrawToPresent = {
+                    VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                    nullptr,                                          // const void                            *pNext
+                    VK_ACCESS_MEMORY_READ_BIT,                        // VkAccessFlags                          srcAccessMask
+                    VK_ACCESS_MEMORY_READ_BIT,                        // VkAccessFlags                          dstAccessMask
+                    VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,                  // VkImageLayout                          oldLayout
+                    VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,                  // VkImageLayout                          newLayout
+                    kraut.GraphicsQueue.FamilyIndex,                   // uint32_t                               srcQueueFamilyIndex
+                    kraut.PresentQueue.FamilyIndex,                    // uint32_t                               dstQueueFamilyIndex
+                    imageParameters.Handle,                          // VkImage                                image
+                    imageSubresourceRange                           // VkImageSubresourceRange                subresourceRange
+            };
+            vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierFromDrawToPresent);
+        }
+
+        return vkd.endCommandBuffer(commandBuffer) == VK_SUCCESS;
+
+    }
+
+    void KrautVK::kvkRecordRaster(VkCommandBuffer commandBuffer, Com::RenderingResourcesData &renderingResource) {
+        VkPipeline pipeline = kraut.Vulkan.GraphicsPipeline;
+        VkPipelineLayout pipelineLayout = kraut.Vulkan.PipelineLayout;
+        VkDescriptorSet descriptorSet = kraut.Vulkan.Descriptor.Handle;
+
+        //Layers render into their own targets first and are blended over each other in place of the scene quad. With a
+        //render graph instead, the intermediate passes go first and the graph's final pass takes over the main one
+        const bool composited = !kraut.Compositor.Layers.empty();
+
+        if(composited)
+            kvkRecordLayers(commandBuffer, renderingResource);
+        else if(kraut.Graph.Active) {
+            kvkRecordRenderGraph(commandBuffer);
+
+            const Com::RenderGraphPassResources &finalPass = kraut.Graph.Passes.back();
+            pipeline = finalPass.Pipeline;
+            pipelineLayout = finalPass.Layout;
+            descriptorSet = finalPass.Descriptor[kraut.Graph.Parity];
         }
 
+        //With dynamic resolution the scene goes into the scaled target first and is upscaled into the frame after
+        const bool scaled = kraut.Dynamic.Active;
+        const VkExtent2D extent = scaled ? kvkGetScaledExtent() : kvkGetRenderExtent();
+        renderingResource.ResolutionScale = scaled ? kraut.Dynamic.Scale : 1.0f;
+
+        VkRenderPass renderPass = kraut.Offscreen.Active ? kraut.Offscreen.RenderPass : kraut.Vulkan.RenderPass;
+
         VkClearValue clearValue = {
                 KVK_CLEAR_COLOR,                         // VkClearColorValue                      color
         };
@@ -660,28 +940,26 @@ namespace KVKBase {
         VkRenderPassBeginInfo renderPassBeginInfo = {
                 VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,           // VkStructureType                        sType
                 nullptr,                                            // const void                            *pNext
-                kraut.Vulkan.RenderPass,                                  // VkRenderPass                           renderPass
-                framebuffer,                                        // VkFramebuffer                          framebuffer
+                scaled ? kraut.Dynamic.RenderPass : renderPass,     // VkRenderPass                           renderPass
+                scaled ? kraut.Dynamic.Framebuffer : renderingResource.Framebuffer, // VkFramebuffer                          framebuffer
                 {                                                   // VkRect2D                               renderArea
                         {                                                 // VkOffset2D                             offset
                                 0,                                                // int32_t                                x
                                 0                                                 // int32_t                                y
                         },
-                        kraut.Vulkan.SwapChain.Extent,                            // VkExtent2D                             extent;
+                        extent,                                             // VkExtent2D                             extent;
                 },
                 1,                                                  // uint32_t                               clearValueCount
                 &clearValue                                        // const VkClearValue                    *pClearValues
         };
 
-        cmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-        cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, kraut.Vulkan.GraphicsPipeline);
+        vkd.cmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
         VkViewport viewport = {
                 0.0f,                                               // float                                  x
                 0.0f,                                               // float                                  y
-                static_cast<float>(kraut.Vulkan.SwapChain.Extent.width),    // float                                  width
-                static_cast<float>(kraut.Vulkan.SwapChain.Extent.height),   // float                                  height
+                static_cast<float>(extent.width),                   // float                                  width
+                static_cast<float>(extent.height),                  // float                                  height
                 0.0f,                                               // float                                  minDepth
                 1.0f                                                // float                                  maxDepth
         };
@@ -692,47 +970,72 @@ namespace KVKBase {
                         0                                                   // int32_t                                y
                 },
                 {                                                   // VkExtent2D                             extent
-                        kraut.Vulkan.SwapChain.Extent.width,                // uint32_t                               width
-                        kraut.Vulkan.SwapChain.Extent.height                // uint32_t                               height
+                        extent.width,                                       // uint32_t                               width
+                        extent.height                                       // uint32_t                               height
                 }
         };
 
-        cmdSetViewport(commandBuffer, 0, 1, &viewport);
-        cmdSetScissor(commandBuffer, 0, 1, &scissor);
+        vkd.cmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkd.cmdSetScissor(commandBuffer, 0, 1, &scissor);
 
         VkDeviceSize offset = 0;
-        cmdBindVertexBuffers(commandBuffer, 0, 1, &kraut.DemoResources.VertexBuffer.Handle, &offset);
+        vkd.cmdBindVertexBuffers(commandBuffer, 0, 1, &kraut.Resources.Buffers.get(kraut.Resources.DemoVertexBuffer)->Handle, &offset);
 
-        cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, kraut.Vulkan.PipelineLayout, 0, 1, &kraut.Vulkan.Descriptor.Handle, 0, nullptr);
+        if(composited)
+            kvkRecordComposite(commandBuffer);
+        else {
+            vkd.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
-        cmdDraw(commandBuffer, KVK_VERTEX_COUNT, KVK_INSTANCE_COUNT, 0, 0);
+            if(descriptorSet != VK_NULL_HANDLE)
+                vkd.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
 
-        cmdEndRenderPass(commandBuffer);
+            vkd.cmdDraw(commandBuffer, KVK_VERTEX_COUNT, KVK_INSTANCE_COUNT, 0, 0);
+        }
 
-        if(kraut.GraphicsQueue.Handle != kraut.PresentQueue.Handle ) {
-            VkImageMemoryBarrier barrierFromDrawToPresent = {
-                    VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
-                    nullptr,                                          // const void                            *pNext
-                    VK_ACCESS_MEMORY_READ_BIT,                        // VkAccessFlags                          srcAccessMask
-                    VK_ACCESS_MEMORY_READ_BIT,                        // VkAccessFlags                          dstAccessMask
-                    VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,                  // VkImageLayout                          oldLayout
-                    VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,                  // VkImageLayout                          newLayout
-                    kraut.GraphicsQueue.FamilyIndex,                   // uint32_t                               srcQueueFamilyIndex
-                    kraut.PresentQueue.FamilyIndex,                    // uint32_t                               dstQueueFamilyIndex
-                    imageParameters.Handle,                          // VkImage                                image
-                    imageSubresourceRange                           // VkImageSubresourceRange                subresourceRange
-            };
-            cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierFromDrawToPresent);
+        if(scaled) {
+            vkd.cmdEndRenderPass(commandBuffer);
+            kvkRecordUpscale(commandBuffer, renderingResource, extent);
         }
 
-        return endCommandBuffer(commandBuffer) == VK_SUCCESS;
+        //Sprites go over the background, the quad's vertex buffer is still bound
+        kvkRecordSprites(commandBuffer, renderingResource);
 
+        vkd.cmdEndRenderPass(commandBuffer);
     }
 
     bool KrautVK::kvkOnWindowSizeChanged() {
 
-        return kvkCreateSwapChain();
+        if(!kvkCreateSwapChain())
+            return false;
+
+        return kvkCreateExtentResources();
+
+    }
+
+    VkExtent2D KrautVK::kvkGetRenderExtent() {
+        return kraut.Offscreen.Active ? kraut.Offscreen.Extent : kraut.Vulkan.SwapChain.Extent;
+    }
+
+    //Graph images, layer targets, output buffers and the compute target follow the render extent
+    bool KrautVK::kvkCreateExtentResources() {
+        kraut.Idle.Changed = true;
+
+        if(kraut.Graph.Active && !kvkCreateRenderGraphImages())
+            return false;
+
+        if(kraut.Compute.Active && !kvkCreateComputeTarget())
+            return false;
+
+        if(kraut.Dynamic.Active && !kvkCreateDynamicResolutionTarget())
+            return false;
+
+        if(!kraut.Compositor.Layers.empty() && !kvkCreateLayerTargets())
+            return false;
+
+        if(!kraut.Output.Targets.empty() && !kvkCreateOutputResources())
+            return false;
 
+        return true;
     }
 
     int KrautVK::kvkWindowShouldClose() {
@@ -742,21 +1045,31 @@ namespace KVKBase {
 
     bool KrautVK::kvkRenderUpdate() {
 
-        static size_t           resourceIndex = 0;
-        Com::RenderingResourcesData &currentRenderingResource = kraut.Vulkan.RenderingResources[resourceIndex];
+        Com::RenderingResourcesData &currentRenderingResource = kraut.Vulkan.RenderingResources[kraut.Vulkan.ResourceIndex];
         VkSwapchainKHR          swapchain = kraut.Vulkan.SwapChain.Handle;
         uint32_t                imageIndex;
 
-        resourceIndex = (resourceIndex + 1) % Com::VulkanParameters::ResourceCount;
-
-        if(waitForFences(kraut.Vulkan.Device.Handle, 1, &currentRenderingResource.Fence, VK_FALSE, 1000000000) != VK_SUCCESS) {
-            std::cout << "Fence Time Out!" << std::endl;
-            return false;
+        //Nothing to draw that isn't on screen already, so no image is acquired or presented. The last frame isn't
+        //presented again either, that would take an acquire, a copy and a present for an image the presentation engine
+        //keeps showing anyway. A window that lost its contents asks for a refresh, which marks the frame changed.
+        //Offscreen, the last frame stays in its resource's readback buffer and kvkOutputRead keeps returning it
+        if(!kvkFrameChanged()) {
+            kvkCollectCompletedFrames();
+            kraut.Sprites.Pending.clear();
+            kraut.Idle.Skipped = true;
+            ++kraut.Idle.SkippedFrames;
+            return true;
         }
 
-        resetFences(kraut.Vulkan.Device.Handle, 1, &currentRenderingResource.Fence);
+        if(kraut.Offscreen.Active)
+            return kvkRenderOffscreen();
 
-        VkResult result = acquireNextImageKHR(kraut.Vulkan.Device.Handle, swapchain, UINT64_MAX, currentRenderingResource.ImageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+        kraut.Vulkan.ResourceIndex = (kraut.Vulkan.ResourceIndex + 1) % Com::VulkanParameters::ResourceCount;
+
+        if(!kvkWaitRenderingResource(currentRenderingResource))
+            return false;
+
+        VkResult result = vkd.acquireNextImageKHR(kraut.Vulkan.Device.Handle, swapchain, UINT64_MAX, currentRenderingResource.ImageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
         switch(result) {
             case VK_SUCCESS:
             case VK_SUBOPTIMAL_KHR:
@@ -768,11 +1081,22 @@ namespace KVKBase {
                 return false;
         }
 
-        if(!kvkRecordCommandBuffers(currentRenderingResource.CommandBuffer, kraut.Vulkan.SwapChain.Images[imageIndex], currentRenderingResource.Framebuffer)) {
+        auto recordStart = std::chrono::steady_clock::now();
+
+        bool recorded = kvkRecordCommandBuffers(currentRenderingResource, kraut.Vulkan.SwapChain.Images[imageIndex]);
+
+        //Sprites are submitted per frame, whether or not they made it into one. The last ones are kept to compare against
+        kraut.Idle.LastSprites.swap(kraut.Sprites.Pending);
+        kraut.Sprites.Pending.clear();
+
+        if(!recorded) {
             return false;
         }
 
-        VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        currentRenderingResource.TimestampsWritten = kraut.Timing.Supported;
+
+        //The compute path first touches the swap chain image with a transfer instead of the render pass
+        VkPipelineStageFlags waitDstStageMask = kraut.Compute.Active ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
         VkSubmitInfo submitInfo = {
                 VK_STRUCTURE_TYPE_SUBMIT_INFO,                          // VkStructureType              sType
                 nullptr,                                                // const void                  *pNext
@@ -785,10 +1109,18 @@ namespace KVKBase {
                 &currentRenderingResource.FinishedRenderingSemaphore    // const VkSemaphore           *pSignalSemaphores
         };
 
-        if(queueSubmit(kraut.GraphicsQueue.Handle, 1, &submitInfo, currentRenderingResource.Fence) != VK_SUCCESS) {
+        if(kvkQueueSubmit(kraut.GraphicsQueue.Handle, submitInfo, currentRenderingResource.Fence) != VK_SUCCESS) {
             return false;
         }
 
+        currentRenderingResource.SubmittedFrame = ++kraut.Vulkan.Frame;
+        kraut.Timing.RecordMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+
+        //A failed present recreates the swap chain, which marks the next frame changed again
+        kraut.Idle.Changed = false;
+        kraut.Idle.Skipped = false;
+        ++kraut.Idle.RenderedFrames;
+
         VkPresentInfoKHR presentInfo = {
                 VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,                     // VkStructureType              sType
                 nullptr,                                                // const void                  *pNext
@@ -799,7 +1131,7 @@ namespace KVKBase {
                 &imageIndex,                                            // const uint32_t              *pImageIndices
                 nullptr                                                 // VkResult                    *pResults
         };
-        result = queuePresentKHR(kraut.PresentQueue.Handle, &presentInfo);
+        result = kvkQueuePresent(presentInfo);
 
         switch( result ) {
             case VK_SUCCESS:
@@ -816,302 +1148,197 @@ namespace KVKBase {
 
     }
 
-    void KrautVK::kvkPollEvents() {
-        glfwPollEvents();
+    bool KrautVK::kvkFrameChanged() {
+        //Every tick of a capture's clock is a frame of the file, changed or not
+        if(kraut.Idle.Changed || kraut.Idle.Animated || kraut.Capture.Active)
+            return true;
+
+        //Feedback images carry state from frame to frame, so a graph with them changes every frame
+        if(kraut.Graph.Active && !kraut.Compute.Active && kraut.Compositor.Layers.empty() && kraut.Graph.Graph.hasFeedback())
+            return true;
+
+        //Animated layers render again every frame, static ones only when something changed
+        if(!kraut.Compute.Active) {
+            for(const Com::LayerParameters &layer : kraut.Compositor.Layers) {
+                if(layer.Animated)
+                    return true;
+            }
+        }
+
+        //An accumulation that hasn't reached its sample limit keeps refining the frame
+        if(kraut.Compute.Active && kraut.Compute.SamplesPerFrame > 0 && kvkGetFrameSamples() > 0)
+            return true;
+
+        const std::vector<SpriteData> &pending = kraut.Sprites.Pending;
+        const std::vector<SpriteData> &last = kraut.Idle.LastSprites;
+        return pending.size() != last.size() ||
+               (!pending.empty() && std::memcmp(pending.data(), last.data(), pending.size() * sizeof(SpriteData)) != 0);
     }
 
-    int KrautVK::kvkCreateRenderPass() {
-        VkAttachmentDescription attachmentDescription[] = {
-                {
-                        0,                                   // VkAttachmentDescriptionFlags   flags
-                        kraut.Vulkan.SwapChain.Format,              // VkFormat                       format
-                        VK_SAMPLE_COUNT_1_BIT,               // VkSampleCountFlagBits          samples
-                        VK_ATTACHMENT_LOAD_OP_CLEAR,         // VkAttachmentLoadOp             loadOp
-                        VK_ATTACHMENT_STORE_OP_STORE,        // VkAttachmentStoreOp            storeOp
-                        VK_ATTACHMENT_LOAD_OP_DONT_CARE,     // VkAttachmentLoadOp             stencilLoadOp
-                        VK_ATTACHMENT_STORE_OP_DONT_CARE,    // VkAttachmentStoreOp            stencilStoreOp
-                        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,     // VkImageLayout                  initialLayout;
-                        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR      // VkImageLayout                  finalLayout
-                }
-        };
+    //Waits out a rendering resource's last frame and recycles everything that frame was holding on to
+    bool KrautVK::kvkWaitRenderingResource(Com::RenderingResourcesData &renderingResource) {
+        if(vkd.waitForFences(kraut.Vulkan.Device.Handle, 1, &renderingResource.Fence, VK_FALSE, 1000000000) != VK_SUCCESS) {
+            std::cout << "Fence Time Out!" << std::endl;
+            return false;
+        }
 
-        VkAttachmentReference colorAttachmentReferences[] = {
-                {
-                        0,                                          // uint32_t                       attachment
-                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL    // VkImageLayout                  layout
-                }
-        };
+        vkd.resetFences(kraut.Vulkan.Device.Handle, 1, &renderingResource.Fence);
 
-        VkSubpassDescription subpassDescriptions[] = {
-                {
-                        0,                                          // VkSubpassDescriptionFlags      flags
-                        VK_PIPELINE_BIND_POINT_GRAPHICS,            // VkPipelineBindPoint            pipelineBindPoint
-                        0,                                          // uint32_t                       inputAttachmentCount
-                        nullptr,                                    // const VkAttachmentReference   *pInputAttachments
-                        1,                                          // uint32_t                       colorAttachmentCount
-                        colorAttachmentReferences,                  // const VkAttachmentReference   *pColorAttachments
-                        nullptr,                                    // const VkAttachmentReference   *pResolveAttachments
-                        nullptr,                                    // const VkAttachmentReference   *pDepthStencilAttachment
-                        0,                                          // uint32_t                       preserveAttachmentCount
-                        nullptr                                     // const uint32_t*                pPreserveAttachments
-                }
-        };
+        //Fences on one queue signal in submission order, so every frame up to this resource's last one is done
+        kraut.Vulkan.CompletedFrame = std::max(kraut.Vulkan.CompletedFrame, renderingResource.SubmittedFrame);
+        kraut.Vulkan.Deletions.collect(kraut.Vulkan.CompletedFrame);
 
-        std::vector<VkSubpassDependency> dependencies = {
-                {
-                        VK_SUBPASS_EXTERNAL,                            // uint32_t                       srcSubpass
-                        0,                                              // uint32_t                       dstSubpass
-                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,           // VkPipelineStageFlags           srcStageMask
-                        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,  // VkPipelineStageFlags           dstStageMask
-                        VK_ACCESS_MEMORY_READ_BIT,                      // VkAccessFlags                  srcAccessMask
-                        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,           // VkAccessFlags                  dstAccessMask
-                        VK_DEPENDENCY_BY_REGION_BIT                     // VkDependencyFlags              dependencyFlags
-                },
+        kvkEvictResources();
 
-                {
-                        0,                                              // uint32_t                       srcSubpass
-                        VK_SUBPASS_EXTERNAL,                            // uint32_t                       dstSubpass
-                        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,  // VkPipelineStageFlags           srcStageMask
-                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,           // VkPipelineStageFlags           dstStageMask
-                        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,           // VkAccessFlags                  srcAccessMask
-                        VK_ACCESS_MEMORY_READ_BIT,                      // VkAccessFlags                  dstAccessMask
-                        VK_DEPENDENCY_BY_REGION_BIT                     // VkDependencyFlags              dependencyFlags
-                }
-        };
+        //Sets written for this resource's last frame are no longer in use
+        renderingResource.TransientDescriptors.Reset();
 
-        VkRenderPassCreateInfo renderPassCreateInfo = {
-                VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,    // VkStructureType                sType
-                nullptr,                                      // const void                    *pNext
-                0,                                            // VkRenderPassCreateFlags        flags
-                1,                                            // uint32_t                       attachmentCount
-                attachmentDescription,                        // const VkAttachmentDescription *pAttachments
-                1,                                            // uint32_t                       subpassCount
-                subpassDescriptions,                          // const VkSubpassDescription    *pSubpasses
-                static_cast<uint32_t>(dependencies.size()),   // uint32_t                       dependencyCount
-                &dependencies[0]                              // const VkSubpassDependency     *pDependencies
-        };
-
-        if(createRenderPass(kraut.Vulkan.Device.Handle, &renderPassCreateInfo, nullptr, &kraut.Vulkan.RenderPass) == VK_SUCCESS){
-            return SUCCESS;
-        } else{
-            return VULKAN_RENDERPASS_CREATION_FAILED;
-        }
+        //The fence guarantees the timestamps from this resource's last submission are available
+        if(kvkReadTimestamps(renderingResource, kraut.Timing.EffectMilliseconds) && kraut.Dynamic.Active && !kraut.Compute.Active)
+            kvkUpdateResolutionScale(renderingResource.ResolutionScale, kraut.Timing.EffectMilliseconds);
 
+        return true;
+    }
 
+    //Contexts on one device share its queues and may submit from different threads
+    VkResult KrautVK::kvkQueueSubmit(VkQueue queue, const VkSubmitInfo &submitInfo, VkFence fence) {
+        std::lock_guard<std::mutex> lock(kraut.Vulkan.Device.Shared->QueueMutex(queue));
+        return vkd.queueSubmit(queue, 1, &submitInfo, fence);
     }
 
-    bool KrautVK::kvkCreateFrameBuffers(VkFramebuffer &framebuffer, VkImageView imageView) {
+    VkResult KrautVK::kvkQueuePresent(const VkPresentInfoKHR &presentInfo) {
+        std::lock_guard<std::mutex> lock(kraut.Vulkan.Device.Shared->QueueMutex(kraut.PresentQueue.Handle));
+        return vkd.queuePresentKHR(kraut.PresentQueue.Handle, &presentInfo);
+    }
 
-        if(framebuffer != VK_NULL_HANDLE) {
-            destroyFramebuffer(kraut.Vulkan.Device.Handle, framebuffer, nullptr);
-            framebuffer = VK_NULL_HANDLE;
+    //Waiting for the device needs every one of its queues to itself
+    void KrautVK::kvkDeviceWaitIdle() {
+        if (!kraut.Vulkan.Device.Shared) {
+            vkd.deviceWaitIdle(kraut.Vulkan.Device.Handle);
+            return;
         }
 
-        VkFramebufferCreateInfo framebufferCreateInfo = {
-                VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,      // VkStructureType                sType
-                nullptr,                                        // const void                    *pNext
-                0,                                              // VkFramebufferCreateFlags       flags
-                kraut.Vulkan.RenderPass,                              // VkRenderPass                   renderPass
-                1,                                              // uint32_t                       attachmentCount
-                &imageView,                                    // const VkImageView             *pAttachments
-                kraut.Vulkan.SwapChain.Extent.width,                    // uint32_t                       width
-                kraut.Vulkan.SwapChain.Extent.height,                   // uint32_t                       height
-                1                                               // uint32_t                       layers
-        };
+        Com::SharedDeviceParameters &shared = *kraut.Vulkan.Device.Shared;
+        std::lock(shared.GraphicsQueueMutex, shared.PresentQueueMutex);
+        std::lock_guard<std::mutex> graphicsLock(shared.GraphicsQueueMutex, std::adopt_lock);
+        std::lock_guard<std::mutex> presentLock(shared.PresentQueueMutex, std::adopt_lock);
 
-        if(createFramebuffer(kraut.Vulkan.Device.Handle, &framebufferCreateInfo, nullptr, &framebuffer) != VK_SUCCESS ) {
-            std::cout << "Could not create a framebuffer!" << std::endl;
-            return false;
+        vkd.deviceWaitIdle(kraut.Vulkan.Device.Handle);
+    }
+
+    //Skipped frames wait on no rendering resource, so finished ones are polled for instead. Memory freed while idle
+    //is released and eviction still runs
+    void KrautVK::kvkCollectCompletedFrames() {
+        for(const Com::RenderingResourcesData &renderingResource : kraut.Vulkan.RenderingResources) {
+            if(vkd.getFenceStatus(kraut.Vulkan.Device.Handle, renderingResource.Fence) == VK_SUCCESS)
+                kraut.Vulkan.CompletedFrame = std::max(kraut.Vulkan.CompletedFrame, renderingResource.SubmittedFrame);
         }
 
-        return true;
+        kraut.Vulkan.Deletions.collect(kraut.Vulkan.CompletedFrame);
+
+        kvkEvictResources();
     }
 
-    int KrautVK::kvkCreatePipelines(){
-        GarbageCollector<VkShaderModule, PFN_vkDestroyShaderModule> vertexShaderModule = Tools::loadShader(Tools::rootPath + std::string("/data/shadervert.spv"));
-        GarbageCollector<VkShaderModule, PFN_vkDestroyShaderModule> fragmentShaderModule = Tools::loadShader(Tools::rootPath + std::string("/data/shaderfrag.spv"));
+    //Only valid once the resource's last submission has completed
+    bool KrautVK::kvkReadTimestamps(const Com::RenderingResourcesData &renderingResource, double &milliseconds) {
+        if(!renderingResource.TimestampsWritten)
+            return false;
 
-        if( !vertexShaderModule || !fragmentShaderModule ) {
-            return VULKAN_PIPELINES_CREATION_FAILED;
-        }
+        uint64_t timestamps[2];
+        if(vkd.getQueryPoolResults(kraut.Vulkan.Device.Handle, renderingResource.TimestampPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+            return false;
 
-        VkVertexInputBindingDescription vertexBindingDescription = {
-                    0,                                  // uint32_t            binding
-                    sizeof(VertexData),                 // uint32_t            stride
-                    VK_VERTEX_INPUT_RATE_VERTEX         // VkVertexInputRate   inputRate
-        };
+        milliseconds = static_cast<double>(timestamps[1] - timestamps[0]) * kraut.Timing.TimestampPeriod / 1000000.0;
+        return true;
+    }
 
-        VkVertexInputAttributeDescription vertexAttributeDescriptions[] = {
-                {
-                        0,                                          // uint32_t    location
-                        vertexBindingDescription.binding,           // uint32_t    binding
-                        VK_FORMAT_R32G32B32A32_SFLOAT,             // VkFormat    format
-                        0                                          // uint32_t    offset
-                },
-                {
-                        1,                                         // uint32_t    location
-                        vertexBindingDescription.binding,           // uint32_t    binding
-                        VK_FORMAT_R32G32B32A32_SFLOAT,             // VkFormat    format
-                        4 * sizeof(float)                          // uint32_t    offset
-                }
-        };
+    //Same frame as kvkRenderUpdate, drawn into the offscreen target. Nothing is acquired or presented, so the
+    //submission waits on and signals no semaphores
+    bool KrautVK::kvkRenderOffscreen() {
+        Com::RenderingResourcesData &currentRenderingResource = kraut.Vulkan.RenderingResources[kraut.Vulkan.ResourceIndex];
 
-        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {
-                VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,      // VkStructureType                                sType
-                nullptr,                                                        // const void                                    *pNext
-                0,                                                              // VkPipelineVertexInputStateCreateFlags          flags;
-                1,                                                              // uint32_t                                       vertexBindingDescriptionCount
-                &vertexBindingDescription,                                      // const VkVertexInputBindingDescription         *pVertexBindingDescriptions
-                2,                                                              // uint32_t                                       vertexAttributeDescriptionCount
-                vertexAttributeDescriptions                                     // const VkVertexInputAttributeDescription       *pVertexAttributeDescriptions
-        };
+        kraut.Vulkan.ResourceIndex = (kraut.Vulkan.ResourceIndex + 1) % Com::VulkanParameters::ResourceCount;
 
-        //Load Shaders
-        std::vector<VkPipelineShaderStageCreateInfo> shaderStageCreateInfos = {
-                // Vertex shader
-                {
-                        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,        // VkStructureType                                sType
-                        nullptr,                                                    // const void                                    *pNext
-                        0,                                                          // VkPipelineShaderStageCreateFlags               flags
-                        VK_SHADER_STAGE_VERTEX_BIT,                                 // VkShaderStageFlagBits                          stage
-                        vertexShaderModule.get(),                                   // VkShaderModule                                 module
-                        "main",                                                     // const char                                    *pName
-                        nullptr                                                     // const VkSpecializationInfo                    *pSpecializationInfo
-                },
+        if(!kvkWaitRenderingResource(currentRenderingResource))
+            return false;
 
-                // Fragment shader
-                {
-                        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,        // VkStructureType                                sType
-                        nullptr,                                                    // const void                                    *pNext
-                        0,                                                          // VkPipelineShaderStageCreateFlags               flags
-                        VK_SHADER_STAGE_FRAGMENT_BIT,                               // VkShaderStageFlagBits                          stage
-                        fragmentShaderModule.get(),                                 // VkShaderModule                                 module
-                        "main",                                                     // const char                                    *pName
-                        nullptr                                                     // const VkSpecializationInfo                    *pSpecializationInfo
-                }
-        };
+        if(kraut.Capture.Active)
+            kvkCaptureCollect(currentRenderingResource);
 
-        VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = {
-                VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,  // VkStructureType                                sType
-                nullptr,                                                      // const void                                    *pNext
-                0,                                                            // VkPipelineInputAssemblyStateCreateFlags        flags
-                KVK_PRIMITIVE_TOPOLOGY,                                       // VkPrimitiveTopology                            topology
-                VK_FALSE                                                      // VkBool32                                       primitiveRestartEnable
-        };
+        auto recordStart = std::chrono::steady_clock::now();
 
-        VkPipelineViewportStateCreateInfo viewportStateCreateInfo = {
-                VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,        // VkStructureType                                sType
-                nullptr,                                                      // const void                                    *pNext
-                0,                                                            // VkPipelineViewportStateCreateFlags             flags
-                1,                                                            // uint32_t                                       viewportCount
-                nullptr,                                                      // const VkViewport                              *pViewports
-                1,                                                            // uint32_t                                       scissorCount
-                nullptr                                                       // const VkRect2D                                *pScissors
-        };
+        bool recorded = kvkRecordCommandBuffers(currentRenderingResource, kraut.Offscreen.Target);
 
-        VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = {
-                VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,   // VkStructureType                                sType
-                nullptr,                                                      // const void                                    *pNext
-                0,                                                            // VkPipelineRasterizationStateCreateFlags        flags
-                VK_FALSE,                                                     // VkBool32                                       depthClampEnable
-                VK_FALSE,                                                     // VkBool32                                       rasterizerDiscardEnable
-                VK_POLYGON_MODE_FILL,                                         // VkPolygonMode                                  polygonMode
-                KVK_CULL_MODE,                                                // VkCullModeFlags                                cullMode
-                KVK_CULL_FRONT_FACE,                                          // VkFrontFace                                    frontFace
-                VK_FALSE,                                                     // VkBool32                                       depthBiasEnable
-                0.0f,                                                         // float                                          depthBiasConstantFactor
-                0.0f,                                                         // float                                          depthBiasClamp
-                0.0f,                                                         // float                                          depthBiasSlopeFactor
-                1.0f                                                          // float                                          lineWidth
-        };
+        kraut.Idle.LastSprites.swap(kraut.Sprites.Pending);
+        kraut.Sprites.Pending.clear();
 
-        VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = {
-                VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,     // VkStructureType                                sType
-                nullptr,                                                      // const void                                    *pNext
-                0,                                                            // VkPipelineMultisampleStateCreateFlags          flags
-                VK_SAMPLE_COUNT_1_BIT,                                        // VkSampleCountFlagBits                          rasterizationSamples
-                VK_FALSE,                                                     // VkBool32                                       sampleShadingEnable
-                1.0f,                                                         // float                                          minSampleShading
-                nullptr,                                                      // const VkSampleMask                            *pSampleMask
-                VK_FALSE,                                                     // VkBool32                                       alphaToCoverageEnable
-                VK_FALSE                                                      // VkBool32                                       alphaToOneEnable
-        };
+        if(!recorded) {
+            return false;
+        }
 
-        VkPipelineColorBlendAttachmentState colorBlendAttachmentState = {
-                VK_FALSE,                                                     // VkBool32                                       blendEnable
-                VK_BLEND_FACTOR_ONE,                                          // VkBlendFactor                                  srcColorBlendFactor
-                VK_BLEND_FACTOR_ZERO,                                         // VkBlendFactor                                  dstColorBlendFactor
-                VK_BLEND_OP_ADD,                                              // VkBlendOp                                      colorBlendOp
-                VK_BLEND_FACTOR_ONE,                                          // VkBlendFactor                                  srcAlphaBlendFactor
-                VK_BLEND_FACTOR_ZERO,                                         // VkBlendFactor                                  dstAlphaBlendFactor
-                VK_BLEND_OP_ADD,                                              // VkBlendOp                                      alphaBlendOp
-                VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |         // VkColorComponentFlags                          colorWriteMask
-                VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
-        };
+        currentRenderingResource.TimestampsWritten = kraut.Timing.Supported;
 
-        VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = {
-                VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,     // VkStructureType                                sType
-                nullptr,                                                      // const void                                    *pNext
-                0,                                                            // VkPipelineColorBlendStateCreateFlags           flags
-                VK_FALSE,                                                     // VkBool32                                       logicOpEnable
-                VK_LOGIC_OP_COPY,                                             // VkLogicOp                                      logicOp
-                1,                                                            // uint32_t                                       attachmentCount
-                &colorBlendAttachmentState,                                   // const VkPipelineColorBlendAttachmentState     *pAttachments
-                { 0.0f, 0.0f, 0.0f, 0.0f }                                    // float                                          blendConstants[4]
+        VkSubmitInfo submitInfo = {
+                VK_STRUCTURE_TYPE_SUBMIT_INFO,                          // VkStructureType              sType
+                nullptr,                                                // const void                  *pNext
+                0,                                                      // uint32_t                     waitSemaphoreCount
+                nullptr,                                                // const VkSemaphore           *pWaitSemaphores
+                nullptr,                                                // const VkPipelineStageFlags  *pWaitDstStageMask;
+                1,                                                      // uint32_t                     commandBufferCount
+                &currentRenderingResource.CommandBuffer,                // const VkCommandBuffer       *pCommandBuffers
+                0,                                                      // uint32_t                     signalSemaphoreCount
+                nullptr                                                 // const VkSemaphore           *pSignalSemaphores
         };
 
-        if(!kvkCreatePipelineLayout()) {
-            return VULKAN_PIPELINES_CREATION_FAILED;
+        if(kvkQueueSubmit(kraut.GraphicsQueue.Handle, submitInfo, currentRenderingResource.Fence) != VK_SUCCESS) {
+            return false;
         }
 
-        std::vector<VkDynamicState> dynamicStates = {
-                VK_DYNAMIC_STATE_VIEWPORT,
-                VK_DYNAMIC_STATE_SCISSOR,
-        };
+        currentRenderingResource.SubmittedFrame = ++kraut.Vulkan.Frame;
+        kraut.Timing.RecordMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+        kraut.Idle.Changed = false;
+        kraut.Idle.Skipped = false;
+        ++kraut.Idle.RenderedFrames;
 
-        VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo = {
-                VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,         // VkStructureType                                sType
-                nullptr,                                                      // const void                                    *pNext
-                0,                                                            // VkPipelineDynamicStateCreateFlags              flags
-                static_cast<uint32_t>(dynamicStates.size()),                  // uint32_t                                       dynamicStateCount
-                &dynamicStates[0]                                             // const VkDynamicState                          *pDynamicStates
-        };
+        if(kraut.Capture.Active)
+            ++kraut.Capture.Frames;
 
+        return true;
+    }
 
-        VkGraphicsPipelineCreateInfo pipelineCreateInfo = {
-                VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,                // VkStructureType                                sType
-                nullptr,                                                        // const void                                    *pNext
-                0,                                                              // VkPipelineCreateFlags                          flags
-                static_cast<uint32_t>(shaderStageCreateInfos.size()),           // uint32_t                                       stageCount
-                &shaderStageCreateInfos[0],                                     // const VkPipelineShaderStageCreateInfo         *pStages
-                &vertexInputStateCreateInfo,                                    // const VkPipelineVertexInputStateCreateInfo    *pVertexInputState;
-                &inputAssemblyStateCreateInfo,                                  // const VkPipelineInputAssemblyStateCreateInfo  *pInputAssemblyState
-                nullptr,                                                        // const VkPipelineTessellationStateCreateInfo   *pTessellationState
-                &viewportStateCreateInfo,                                       // const VkPipelineViewportStateCreateInfo       *pViewportState
-                &rasterizationStateCreateInfo,                                  // const VkPipelineRasterizationStateCreateInfo  *pRasterizationState
-                &multisampleStateCreateInfo,                                    // const VkPipelineMultisampleStateCreateInfo    *pMultisampleState
-                nullptr,                                                        // const VkPipelineDepthStencilStateCreateInfo   *pDepthStencilState
-                &colorBlendStateCreateInfo,                                     // const VkPipelineColorBlendStateCreateInfo     *pColorBlendState
-                &pipelineDynamicStateCreateInfo,                                // const VkPipelineDynamicStateCreateInfo        *pDynamicState
-                kraut.Vulkan.PipelineLayout,                                    // VkPipelineLayout                               layout
-                kraut.Vulkan.RenderPass,                                        // VkRenderPass                                   renderPass
-                0,                                                              // uint32_t                                       subpass
-                VK_NULL_HANDLE,                                                 // VkPipeline                                     basePipelineHandle
-                -1                                                              // int32_t                                        basePipelineIndex
-        };
+    //Rounded down to KVK_DYNAMIC_RES_ALIGNMENT so small changes of the scale don't change the extent every frame
+    VkExtent2D KrautVK::kvkGetScaledExtent() {
+        const VkExtent2D extent = kvkGetRenderExtent();
+        const uint32_t alignment = KVK_DYNAMIC_RES_ALIGNMENT;
 
+        auto scale = [&](uint32_t size) {
+            uint32_t scaled = static_cast<uint32_t>(size * kraut.Dynamic.Scale) / alignment * alignment;
+            return std::min(std::max(scaled, std::min(alignment, size)), size);
+        };
 
-        if(createGraphicsPipelines(kraut.Vulkan.Device.Handle, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &kraut.Vulkan.GraphicsPipeline) == VK_SUCCESS){
-            return SUCCESS;
+        return {scale(extent.width), scale(extent.height)};
+    }
 
-        } else{
-            return VULKAN_PIPELINES_CREATION_FAILED;
+    //GPU time is taken to grow with the pixels shaded, so a frame's time per unit of area at the scale it was rendered
+    //at gives the scale that would have met the target. The scale moves part of the way there each measured frame
+    void KrautVK::kvkUpdateResolutionScale(float renderedScale, double milliseconds) {
+        if(milliseconds <= 0.0 || renderedScale <= 0.0f)
+            return;
 
-        };
+        const double perArea = milliseconds / (static_cast<double>(renderedScale) * renderedScale);
+        double ideal = std::sqrt(kraut.Dynamic.TargetMilliseconds * KVK_DYNAMIC_RES_HEADROOM / perArea);
+        ideal = std::min(std::max(ideal, static_cast<double>(kraut.Dynamic.MinimumScale)), 1.0);
 
+        kraut.Dynamic.Scale += static_cast<float>((ideal - kraut.Dynamic.Scale) * KVK_DYNAMIC_RES_SMOOTHING);
     }
 
-    bool KrautVK::kvkCreatePipelineLayout(){
+    //Samples the target through the main texture set layout, the push constants say which part of it holds the scene
+    bool KrautVK::kvkCreateUpscalePipeline() {
+        VkPushConstantRange pushConstantRange = {
+                VK_SHADER_STAGE_FRAGMENT_BIT,                   // VkShaderStageFlags             stageFlags
+                0,                                              // uint32_t                       offset
+                7 * sizeof(float)                               // uint32_t                       size
+        };
 
         VkPipelineLayoutCreateInfo layoutCreateInfo = {
                 VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,  // VkStructureType                sType
@@ -1119,232 +1346,3637 @@ namespace KVKBase {
                 0,                                              // VkPipelineLayoutCreateFlags    flags
                 1,                                              // uint32_t                       setLayoutCount
                 &kraut.Vulkan.Descriptor.Layout,                // const VkDescriptorSetLayout   *pSetLayouts
-                0,                                              // uint32_t                       pushConstantRangeCount
-                nullptr                                         // const VkPushConstantRange     *pPushConstantRanges
+                1,                                              // uint32_t                       pushConstantRangeCount
+                &pushConstantRange                              // const VkPushConstantRange     *pPushConstantRanges
         };
 
-        if(createPipelineLayout(kraut.Vulkan.Device.Handle, &layoutCreateInfo, nullptr, &kraut.Vulkan.PipelineLayout) != VK_SUCCESS) {
+        if(vkd.createPipelineLayout(kraut.Vulkan.Device.Handle, &layoutCreateInfo, nullptr, &kraut.Dynamic.Layout) != VK_SUCCESS)
             return false;
-        }
 
-        return true;
+        Com::PipelineVariantKey key;
+        key.VertexShader = KVK_VERTEX_SHADER;
+        key.FragmentShader = KVK_UPSCALE_SHADER;
+        key.RenderPass = kraut.Vulkan.RenderPass;
+        key.Layout = kraut.Dynamic.Layout;
 
+        return kvkCreateGraphicsPipeline(key, kraut.Dynamic.Pipeline) == SUCCESS;
     }
 
-    bool KrautVK::kvkAllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlagBits memoryProperty, VkDeviceMemory *memory) {
-        VkMemoryRequirements bufferMemoryRequirements;
-        getBufferMemoryRequirements(kraut.Vulkan.Device.Handle, buffer, &bufferMemoryRequirements);
-
-        for(uint32_t i = 0; i < kraut.Vulkan.Device.MemoryProperties.memoryTypeCount; ++i) {
-            if((bufferMemoryRequirements.memoryTypeBits & (1 << i)) &&
-                (kraut.Vulkan.Device.MemoryProperties.memoryTypes[i].propertyFlags & memoryProperty)) {
+    //Always the full render extent, so changing the scale never reallocates anything
+    bool KrautVK::kvkCreateDynamicResolutionTarget() {
+        kvkDeviceWaitIdle();
+        kvkDestroyDynamicResolutionTarget();
 
-                VkMemoryAllocateInfo memory_allocate_info = {
-                        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,     // VkStructureType                        sType
-                        nullptr,                                    // const void                            *pNext
-                        bufferMemoryRequirements.size,              // VkDeviceSize                           allocationSize
-                        i                                           // uint32_t                               memoryTypeIndex
-                };
+        if(kraut.Dynamic.RenderPass == VK_NULL_HANDLE &&
+           kvkCreateRenderPass(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, &kraut.Dynamic.RenderPass) != SUCCESS)
+            return false;
 
-                if(allocateMemory(kraut.Vulkan.Device.Handle, &memory_allocate_info, nullptr, memory) == VK_SUCCESS) {
-                    return true;
-                }
-            }
+        const VkExtent2D extent = kvkGetRenderExtent();
+        Com::ImageParameters &target = kraut.Dynamic.Target;
+        if(!kvkCreateImage(extent.width, extent.height, kraut.Vulkan.SwapChain.Format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, &target.Handle) ||
+           !kvkAllocateImageMemory(target.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &target.Memory) ||
+           vkd.bindImageMemory(kraut.Vulkan.Device.Handle, target.Handle, target.Memory, 0) != VK_SUCCESS ||
+           !kvkCreateImageView(target, kraut.Vulkan.SwapChain.Format) ||
+           !kvkAcquireSampler(&target.Sampler) ||
+           !kvkCreateFrameBuffers(kraut.Dynamic.Framebuffer, target.View)) {
+            std::cout << "Could not create the dynamic resolution target!" << std::endl;
+            kvkDestroyDynamicResolutionTarget();
+            return false;
         }
-        return false;
-
-    }
 
-    int KrautVK::kvkAllocateCommandBuffer(VkCommandPool pool, uint32_t count, VkCommandBuffer *commandBuffer) {
+        if(kraut.Dynamic.Descriptor == VK_NULL_HANDLE &&
+           !kraut.Vulkan.PersistentDescriptors.Allocate(kraut.Vulkan.Descriptor.Layout, &kraut.Dynamic.Descriptor))
+            return false;
 
-        VkCommandBufferAllocateInfo cmdBufferAllocateInfo = {
-                VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, // VkStructureType              sType
-                nullptr,                                        // const void*                  pNext
-                pool,                                           // VkCommandPool                commandPool
-                VK_COMMAND_BUFFER_LEVEL_PRIMARY,                // VkCommandBufferLevel         level
-                count                                           // uint32_t                     bufferCount
+        VkDescriptorImageInfo imageInfo = {
+                target.Sampler,                                 // VkSampler                      sampler
+                target.View,                                    // VkImageView                    imageView
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL        // VkImageLayout                  imageLayout
         };
+        kvkUpdateDescriptorTemplate(kraut.Dynamic.Descriptor, kraut.Vulkan.TextureTemplate, &imageInfo);
 
-        if (allocateCommandBuffers(kraut.Vulkan.Device.Handle, &cmdBufferAllocateInfo, commandBuffer) != VK_SUCCESS) {
-            return VULKAN_COMMAND_BUFFER_CREATION_FAILED;
-        }
+        return true;
+    }
 
-        return SUCCESS;
+    void KrautVK::kvkDestroyDynamicResolutionTarget() {
+        kvkDeferDestroy(kraut.Dynamic.Framebuffer, vkd.destroyFramebuffer);
+        kvkDestroyTexture(kraut.Dynamic.Target);
     }
 
-    int KrautVK::kvkCreateSemaphore(VkSemaphore *semaphore) {
+    //Begins the frame's own render pass with the upscaled scene in it. The pass is left open for the sprites
+    void KrautVK::kvkRecordUpscale(VkCommandBuffer commandBuffer, Com::RenderingResourcesData &renderingResource, VkExtent2D sceneExtent) {
+        const VkExtent2D extent = kvkGetRenderExtent();
 
-        VkSemaphoreCreateInfo semaphoreCreateInfo = {
-                VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,      // VkStructureType          sType
-                nullptr,                                      // const void*              pNext
-                0                                             // VkSemaphoreCreateFlags   flags
+        //The render pass already moved the target to SHADER_READ_ONLY_OPTIMAL, its writes still have to be made visible
+        VkImageMemoryBarrier barrierToSample = {
+                VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,             // VkAccessFlags                          srcAccessMask
+                VK_ACCESS_SHADER_READ_BIT,                        // VkAccessFlags                          dstAccessMask
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,         // VkImageLayout                          oldLayout
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,         // VkImageLayout                          newLayout
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                kraut.Dynamic.Target.Handle,                      // VkImage                                image
+                {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}           // VkImageSubresourceRange                subresourceRange
         };
+        vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierToSample);
 
-            if ((createSemaphore(kraut.Vulkan.Device.Handle, &semaphoreCreateInfo, nullptr, semaphore) != VK_SUCCESS)) {
-                return VULKAN_SEMAPHORE_CREATION_FAILED;
-            }
+        VkClearValue clearValue = {
+                KVK_CLEAR_COLOR,                         // VkClearColorValue                      color
+        };
 
-        return SUCCESS;
-    }
+        VkRenderPassBeginInfo renderPassBeginInfo = {
+                VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,           // VkStructureType                        sType
+                nullptr,                                            // const void                            *pNext
+                kraut.Offscreen.Active ? kraut.Offscreen.RenderPass : kraut.Vulkan.RenderPass, // VkRenderPass                           renderPass
+                renderingResource.Framebuffer,                      // VkFramebuffer                          framebuffer
+                {{0, 0}, extent},                                   // VkRect2D                               renderArea
+                1,                                                  // uint32_t                               clearValueCount
+                &clearValue                                         // const VkClearValue                    *pClearValues
+        };
 
-    int KrautVK::kvkCreateFence(VkFence *fence) {
-        VkFenceCreateInfo fenceCreateInfo = {
-                VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,              // VkStructureType                sType
-                nullptr,                                          // const void                    *pNext
-                VK_FENCE_CREATE_SIGNALED_BIT                      // VkFenceCreateFlags             flags
+        vkd.cmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        VkViewport viewport = {
+                0.0f,                                               // float                                  x
+                0.0f,                                               // float                                  y
+                static_cast<float>(extent.width),                   // float                                  width
+                static_cast<float>(extent.height),                  // float                                  height
+                0.0f,                                               // float                                  minDepth
+                1.0f                                                // float                                  maxDepth
         };
 
-        if(createFence(kraut.Vulkan.Device.Handle, &fenceCreateInfo, nullptr, fence) != VK_SUCCESS) {
-            return VULKAN_FENCE_CREATION_FAILED;
-        }
+        VkRect2D scissor = {{0, 0}, extent};
 
-        return SUCCESS;
+        vkd.cmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkd.cmdSetScissor(commandBuffer, 0, 1, &scissor);
 
+        //Matches the Upscale block in upscale.frag
+        const float width = static_cast<float>(extent.width);
+        const float height = static_cast<float>(extent.height);
+        const float upscale[7] = {
+                sceneExtent.width / width, sceneExtent.height / height,
+                (sceneExtent.width - 0.5f) / width, (sceneExtent.height - 0.5f) / height,
+                1.0f / width, 1.0f / height,
+                kraut.Dynamic.Sharpness
+        };
+
+        vkd.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, kraut.Dynamic.Pipeline);
+        vkd.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, kraut.Dynamic.Layout, 0, 1, &kraut.Dynamic.Descriptor, 0, nullptr);
+        vkd.cmdPushConstants(commandBuffer, kraut.Dynamic.Layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(upscale), upscale);
+        vkd.cmdDraw(commandBuffer, KVK_VERTEX_COUNT, KVK_INSTANCE_COUNT, 0, 0);
     }
 
-    bool KrautVK::kvkCreateImage(const uint32_t &width, const uint32_t &height, VkImage *image) {
-        VkImageCreateInfo imageCreateInfo = {
-                VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,  // VkStructureType        sType;
+    //A target frame time of 0 turns it off. The controller runs on GPU timestamps, so it needs them
+    int KrautVK::kvkSetDynamicResolution(double targetMilliseconds, float minimumScale, float sharpness) {
+        if(targetMilliseconds <= 0.0) {
+            if(kraut.Dynamic.Active) {
+                kvkDeviceWaitIdle();
+                kvkDestroyDynamicResolutionTarget();
+                kraut.Dynamic.Active = false;
+                kraut.Dynamic.Scale = 1.0f;
+                kraut.Idle.Changed = true;
+            }
+
+            return SUCCESS;
+        }
+
+        if(!kraut.Timing.Supported) {
+            std::cout << "Dynamic resolution needs GPU timestamps!" << std::endl;
+            return VULKAN_NOT_SUPPORTED;
+        }
+
+        kraut.Dynamic.TargetMilliseconds = targetMilliseconds;
+        kraut.Dynamic.MinimumScale = std::min(std::max(minimumScale, static_cast<float>(KVK_DYNAMIC_RES_MIN_SCALE)), 1.0f);
+        kraut.Dynamic.Sharpness = std::max(sharpness, 0.0f);
+        kraut.Dynamic.Scale = std::max(kraut.Dynamic.Scale, kraut.Dynamic.MinimumScale);
+
+        if(kraut.Dynamic.Active)
+            return SUCCESS;
+
+        if(kraut.Dynamic.Layout == VK_NULL_HANDLE && !kvkCreateUpscalePipeline())
+            return VULKAN_PIPELINES_CREATION_FAILED;
+
+        if(!kvkCreateDynamicResolutionTarget())
+            return VULKAN_TEXTURE_CREATION_FAILED;
+
+        kraut.Dynamic.Active = true;
+        kraut.Dynamic.Scale = 1.0f;
+        kraut.Idle.Changed = true;
+        return SUCCESS;
+    }
+
+    float KrautVK::kvkGetResolutionScale() {
+        return kraut.Dynamic.Active ? kraut.Dynamic.Scale : 1.0f;
+    }
+
+    //The render pass and the composite layout come with the first layer and stay until terminate
+    bool KrautVK::kvkCreateCompositor() {
+        if(kraut.Compositor.RenderPass == VK_NULL_HANDLE &&
+           kvkCreateRenderPass(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, &kraut.Compositor.RenderPass) != SUCCESS)
+            return false;
+
+        if(kraut.Compositor.Layout != VK_NULL_HANDLE)
+            return true;
+
+        VkPushConstantRange pushConstantRange = {
+                VK_SHADER_STAGE_FRAGMENT_BIT,                   // VkShaderStageFlags             stageFlags
+                0,                                              // uint32_t                       offset
+                sizeof(float)                                   // uint32_t                       size
+        };
+
+        VkPipelineLayoutCreateInfo layoutCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,  // VkStructureType                sType
+                nullptr,                                        // const void                    *pNext
+                0,                                              // VkPipelineLayoutCreateFlags    flags
+                1,                                              // uint32_t                       setLayoutCount
+                &kraut.Vulkan.Descriptor.Layout,                // const VkDescriptorSetLayout   *pSetLayouts
+                1,                                              // uint32_t                       pushConstantRangeCount
+                &pushConstantRange                              // const VkPushConstantRange     *pPushConstantRanges
+        };
+
+        return vkd.createPipelineLayout(kraut.Vulkan.Device.Handle, &layoutCreateInfo, nullptr, &kraut.Compositor.Layout) == VK_SUCCESS;
+    }
+
+    //One variant per blend mode, shared by every layer blending the same way
+    int KrautVK::kvkCreateCompositePipeline(uint32_t blend, VkPipeline &pipeline) {
+        Com::PipelineVariantKey key;
+        key.VertexShader = KVK_VERTEX_SHADER;
+        key.FragmentShader = KVK_COMPOSITE_SHADER;
+        key.RenderPass = kraut.Vulkan.RenderPass;
+        key.Layout = kraut.Compositor.Layout;
+        key.Blend = blend;
+
+        return kvkCreateGraphicsPipeline(key, pipeline);
+    }
+
+    //Result sets of removed layers are handed out again before the persistent allocator is asked for more
+    bool KrautVK::kvkAllocateLayerDescriptor(VkDescriptorSet *set) {
+        if(kraut.Compositor.FreeDescriptors.empty())
+            return kraut.Vulkan.PersistentDescriptors.Allocate(kraut.Vulkan.Descriptor.Layout, set);
+
+        *set = kraut.Compositor.FreeDescriptors.back();
+        kraut.Compositor.FreeDescriptors.pop_back();
+        return true;
+    }
+
+    //The full render extent, like the dynamic resolution target. The layer renders again before it's next composited
+    bool KrautVK::kvkCreateLayerTarget(Com::LayerParameters &layer) {
+        kvkDeferDestroy(layer.Framebuffer, vkd.destroyFramebuffer);
+        kvkDestroyTexture(layer.Target);
+
+        const VkExtent2D extent = kvkGetRenderExtent();
+        Com::ImageParameters &target = layer.Target;
+        if(!kvkCreateImage(extent.width, extent.height, kraut.Vulkan.SwapChain.Format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, &target.Handle) ||
+           !kvkAllocateImageMemory(target.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &target.Memory) ||
+           vkd.bindImageMemory(kraut.Vulkan.Device.Handle, target.Handle, target.Memory, 0) != VK_SUCCESS ||
+           !kvkCreateImageView(target, kraut.Vulkan.SwapChain.Format) ||
+           !kvkAcquireSampler(&target.Sampler) ||
+           !kvkCreateFrameBuffers(layer.Framebuffer, target.View)) {
+            std::cout << "Could not create a layer target!" << std::endl;
+            kvkDeferDestroy(layer.Framebuffer, vkd.destroyFramebuffer);
+            kvkDestroyTexture(target);
+            return false;
+        }
+
+        VkDescriptorImageInfo imageInfo = {
+                target.Sampler,                                 // VkSampler                      sampler
+                target.View,                                    // VkImageView                    imageView
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL        // VkImageLayout                  imageLayout
+        };
+        kvkUpdateDescriptorTemplate(layer.Result, kraut.Vulkan.TextureTemplate, &imageInfo);
+
+        layer.Dirty = true;
+        return true;
+    }
+
+    //Result sets are rewritten, so nothing may still be sampling the old targets
+    bool KrautVK::kvkCreateLayerTargets() {
+        kvkDeviceWaitIdle();
+
+        for(Com::LayerParameters &layer : kraut.Compositor.Layers) {
+            if(!kvkCreateLayerTarget(layer))
+                return false;
+        }
+
+        return true;
+    }
+
+    //Pipelines belong to the variant cache, so only the target and the sets go
+    void KrautVK::kvkDestroyLayer(Com::LayerParameters &layer) {
+        kvkDeferDestroy(layer.Framebuffer, vkd.destroyFramebuffer);
+        kvkDestroyTexture(layer.Target);
+
+        if(layer.Result != VK_NULL_HANDLE)
+            kraut.Compositor.FreeDescriptors.push_back(layer.Result);
+
+        layer.Result = VK_NULL_HANDLE;
+    }
+
+    Com::LayerParameters *KrautVK::kvkFindLayer(uint32_t layer) {
+        for(Com::LayerParameters &candidate : kraut.Compositor.Layers) {
+            if(candidate.ID == layer)
+                return &candidate;
+        }
+
+        return nullptr;
+    }
+
+    //Renders the layers that are dirty or animated, the rest keep what they rendered last. The render pass waits for
+    //everything before it, which covers earlier frames still sampling a target, the composite has to wait for the writes.
+    //Source sets are written from the frame's transient allocator, so none outlives the image view it points at
+    void KrautVK::kvkRecordLayers(VkCommandBuffer commandBuffer, Com::RenderingResourcesData &renderingResource) {
+        const VkExtent2D extent = kvkGetRenderExtent();
+        bool rendered = false;
+
+        for(Com::LayerParameters &layer : kraut.Compositor.Layers) {
+            //A layer's image is in use for as long as the layer can render it again. A destroyed or evicted one
+            //is replaced by the demo image
+            const bool sourced = layer.Image != 0 && kraut.Resources.Images.valid(layer.Image);
+            if(sourced)
+                kraut.Resources.ImageLastUsed[layer.Image] = kraut.Vulkan.Frame;
+
+            if(!layer.Dirty && !layer.Animated)
+                continue;
+
+            VkDescriptorSet source = kraut.Vulkan.Descriptor.Handle;
+            if(sourced && renderingResource.TransientDescriptors.Allocate(kraut.Vulkan.Descriptor.Layout, &source)) {
+                const Com::ImageParameters &image = *kraut.Resources.Images.get(layer.Image);
+
+                VkDescriptorImageInfo imageInfo = {
+                        image.Sampler,                                  // VkSampler                      sampler
+                        image.View,                                     // VkImageView                    imageView
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL        // VkImageLayout                  imageLayout
+                };
+                kvkUpdateDescriptorTemplate(source, kraut.Vulkan.TextureTemplate, &imageInfo);
+            }
+
+            if(!rendered) {
+                VkViewport viewport = {
+                        0.0f,                                               // float                                  x
+                        0.0f,                                               // float                                  y
+                        static_cast<float>(extent.width),                   // float                                  width
+                        static_cast<float>(extent.height),                  // float                                  height
+                        0.0f,                                               // float                                  minDepth
+                        1.0f                                                // float                                  maxDepth
+                };
+
+                VkRect2D scissor = {{0, 0}, extent};
+
+                vkd.cmdSetViewport(commandBuffer, 0, 1, &viewport);
+                vkd.cmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+                VkDeviceSize offset = 0;
+                vkd.cmdBindVertexBuffers(commandBuffer, 0, 1, &kraut.Resources.Buffers.get(kraut.Resources.DemoVertexBuffer)->Handle, &offset);
+                rendered = true;
+            }
+
+            //Transparent, so the layers below show through whatever the shader doesn't cover
+            VkClearValue clearValue = {};
+
+            VkRenderPassBeginInfo renderPassBeginInfo = {
+                    VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,           // VkStructureType                        sType
+                    nullptr,                                            // const void                            *pNext
+                    kraut.Compositor.RenderPass,                        // VkRenderPass                           renderPass
+                    layer.Framebuffer,                                  // VkFramebuffer                          framebuffer
+                    {{0, 0}, extent},                                   // VkRect2D                               renderArea
+                    1,                                                  // uint32_t                               clearValueCount
+                    &clearValue                                         // const VkClearValue                    *pClearValues
+            };
+
+            vkd.cmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+            vkd.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layer.Pipeline);
+            vkd.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, kraut.Vulkan.PipelineLayout, 0, 1, &source, 0, nullptr);
+            vkd.cmdDraw(commandBuffer, KVK_VERTEX_COUNT, KVK_INSTANCE_COUNT, 0, 0);
+            vkd.cmdEndRenderPass(commandBuffer);
+
+            layer.Dirty = false;
+        }
+
+        if(!rendered)
+            return;
+
+        VkMemoryBarrier barrierToSample = {
+                VK_STRUCTURE_TYPE_MEMORY_BARRIER,                 // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,             // VkAccessFlags                          srcAccessMask
+                VK_ACCESS_SHADER_READ_BIT                         // VkAccessFlags                          dstAccessMask
+        };
+        vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &barrierToSample, 0, nullptr, 0, nullptr);
+    }
+
+    //Blends every layer's cached target over the open pass, bottom first. Viewport and vertex buffer are the scene's
+    void KrautVK::kvkRecordComposite(VkCommandBuffer commandBuffer) {
+        for(const Com::LayerParameters &layer : kraut.Compositor.Layers) {
+            vkd.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layer.Composite);
+            vkd.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, kraut.Compositor.Layout, 0, 1, &layer.Result, 0, nullptr);
+            vkd.cmdPushConstants(commandBuffer, kraut.Compositor.Layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float), &layer.Opacity);
+            vkd.cmdDraw(commandBuffer, KVK_VERTEX_COUNT, KVK_INSTANCE_COUNT, 0, 0);
+        }
+    }
+
+    //Layers go on top of the ones added before them. Image 0 and a null shader are the demo image and the default
+    //shader, so a plain image layer only needs its image
+    uint32_t KrautVK::kvkLayerAdd(const char *fragmentShader, uint32_t image, uint32_t blend, float opacity) {
+        if(blend < BLEND_NORMAL || blend > BLEND_SCREEN)
+            return 0;
+
+        //Buffer and pipeline handles are valid resources too, but not images
+        if(image != 0 && (HandleAllocator::type(image) != RESOURCE_IMAGE || !kvkResourceValid(image)))
+            return 0;
+
+        if(!kvkCreateCompositor())
+            return 0;
+
+        Com::LayerParameters layer;
+        layer.Shader = fragmentShader != nullptr ? std::string(fragmentShader) : std::string(KVK_FRAGMENT_SHADER);
+        layer.Image = image;
+        layer.Blend = blend;
+        layer.Opacity = std::min(std::max(opacity, 0.0f), 1.0f);
+
+        Com::PipelineVariantKey key;
+        key.VertexShader = KVK_VERTEX_SHADER;
+        key.FragmentShader = layer.Shader;
+        key.RenderPass = kraut.Vulkan.RenderPass;
+        key.Layout = kraut.Vulkan.PipelineLayout;
+
+        if(kvkCreateGraphicsPipeline(key, layer.Pipeline) != SUCCESS ||
+           kvkCreateCompositePipeline(blend, layer.Composite) != SUCCESS)
+            return 0;
+
+        if(!kvkAllocateLayerDescriptor(&layer.Result) || !kvkCreateLayerTarget(layer)) {
+            kvkDestroyLayer(layer);
+            return 0;
+        }
+
+        layer.ID = kraut.Compositor.NextID++;
+        kraut.Compositor.Layers.push_back(layer);
+        kraut.Idle.Changed = true;
+        return layer.ID;
+    }
+
+    //Only the composite changes, the layer's cached result stays
+    int KrautVK::kvkLayerSetBlend(uint32_t layer, uint32_t blend, float opacity) {
+        Com::LayerParameters *parameters = kvkFindLayer(layer);
+        if(parameters == nullptr || blend < BLEND_NORMAL || blend > BLEND_SCREEN)
+            return VULKAN_PIPELINES_CREATION_FAILED;
+
+        VkPipeline composite;
+        int status = kvkCreateCompositePipeline(blend, composite);
+        if(status != SUCCESS)
+            return status;
+
+        parameters->Composite = composite;
+        parameters->Blend = blend;
+        parameters->Opacity = std::min(std::max(opacity, 0.0f), 1.0f);
+        kraut.Idle.Changed = true;
+        return SUCCESS;
+    }
+
+    //For shaders that change over time. Static layers only render again when invalidated or resized
+    bool KrautVK::kvkLayerSetAnimated(uint32_t layer, bool animated) {
+        Com::LayerParameters *parameters = kvkFindLayer(layer);
+        if(parameters == nullptr)
+            return false;
+
+        parameters->Animated = animated;
+        kraut.Idle.Changed = true;
+        return true;
+    }
+
+    //For when something the layer's shader reads changed outside of the engine's knowledge
+    bool KrautVK::kvkLayerInvalidate(uint32_t layer) {
+        Com::LayerParameters *parameters = kvkFindLayer(layer);
+        if(parameters == nullptr)
+            return false;
+
+        parameters->Dirty = true;
+        kraut.Idle.Changed = true;
+        return true;
+    }
+
+    //Waits for the device, the sets go back to the free list and can be rewritten by the next layer added
+    bool KrautVK::kvkLayerRemove(uint32_t layer) {
+        Com::LayerParameters *parameters = kvkFindLayer(layer);
+        if(parameters == nullptr)
+            return false;
+
+        kvkDeviceWaitIdle();
+        kvkDestroyLayer(*parameters);
+
+        kraut.Compositor.Layers.erase(kraut.Compositor.Layers.begin() + (parameters - kraut.Compositor.Layers.data()));
+        kraut.Idle.Changed = true;
+        return true;
+    }
+
+    //The target takes the swap chain's format so the main pipelines and the compute blit work unchanged. It's sampled
+    //by the output conversion
+    bool KrautVK::kvkCreateOffscreenTarget(uint32_t width, uint32_t height) {
+        if(width == 0 || height == 0 || width > kraut.Vulkan.Device.Properties.limits.maxImageDimension2D || height > kraut.Vulkan.Device.Properties.limits.maxImageDimension2D) {
+            std::cout << "Offscreen target size is outside the device limits!" << std::endl;
+            return false;
+        }
+
+        kvkDeviceWaitIdle();
+        kvkDestroyTexture(kraut.Offscreen.Target);
+
+        if(kraut.Offscreen.RenderPass == VK_NULL_HANDLE &&
+           kvkCreateRenderPass(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, &kraut.Offscreen.RenderPass) != SUCCESS)
+            return false;
+
+        Com::ImageParameters &target = kraut.Offscreen.Target;
+        if(!kvkCreateImage(width, height, kraut.Vulkan.SwapChain.Format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, &target.Handle) ||
+           !kvkAllocateImageMemory(target.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &target.Memory) ||
+           vkd.bindImageMemory(kraut.Vulkan.Device.Handle, target.Handle, target.Memory, 0) != VK_SUCCESS ||
+           !kvkCreateImageView(target, kraut.Vulkan.SwapChain.Format) ||
+           !kvkAcquireSampler(&target.Sampler)) {
+            std::cout << "Could not create the offscreen target!" << std::endl;
+            kvkDestroyTexture(target);
+            return false;
+        }
+
+        kraut.Offscreen.Extent = {width, height};
+        kraut.Offscreen.Active = true;
+
+        if(!kvkCreateExtentResources()) {
+            kvkDestroyOffscreenTarget();
+            return false;
+        }
+
+        return true;
+    }
+
+    //Rendering goes back to the swap chain. The render pass is kept for the next target
+    void KrautVK::kvkDestroyOffscreenTarget() {
+        if(!kraut.Offscreen.Active)
+            return;
+
+        kvkDeviceWaitIdle();
+        kvkDestroyTexture(kraut.Offscreen.Target);
+        kraut.Offscreen.Active = false;
+
+        kvkCreateExtentResources();
+    }
+
+    //0 by 0 goes back to the swap chain. Frames keep going through kvkRenderUpdate either way, offscreen ones are
+    //neither acquired nor presented
+    int KrautVK::kvkSetOffscreen(uint32_t width, uint32_t height) {
+        //A capture's frames all have the size it started with
+        if(kraut.Capture.Active)
+            return VULKAN_NOT_SUPPORTED;
+
+        if(width == 0 || height == 0) {
+            kvkDestroyOffscreenTarget();
+            return SUCCESS;
+        }
+
+        for(const Com::OutputTargetParameters &target : kraut.Output.Targets) {
+            if((target.Width == 0 || target.Height == 0) && !kvkCheckOutputExtent(width, height))
+                return VULKAN_NOT_SUPPORTED;
+        }
+
+        return kvkCreateOffscreenTarget(width, height) ? SUCCESS : VULKAN_TEXTURE_CREATION_FAILED;
+    }
+
+    //Every conversion invocation converts an 8x2 block, so a row of its chroma is a whole number of words in any format
+    bool KrautVK::kvkCheckOutputExtent(uint32_t width, uint32_t height) {
+        if(width % 8 == 0 && height % 2 == 0)
+            return true;
+
+        std::cout << "Output frames need a width that is a multiple of 8 and an even height!" << std::endl;
+        return false;
+    }
+
+    //Outputs are only ever filtered down, never up
+    VkExtent2D KrautVK::kvkGetOutputExtent(const Com::OutputTargetParameters &target) {
+        if(target.Width == 0 || target.Height == 0)
+            return kraut.Offscreen.Extent;
+
+        return {target.Width, target.Height};
+    }
+
+    bool KrautVK::kvkOutputFits(const Com::OutputTargetParameters &target) {
+        const VkExtent2D extent = kvkGetOutputExtent(target);
+        if(extent.width > kraut.Offscreen.Extent.width || extent.height > kraut.Offscreen.Extent.height) {
+            std::cout << "Output " << extent.width << "x" << extent.height << " is larger than the frame!" << std::endl;
+            return false;
+        }
+
+        return kvkCheckOutputExtent(extent.width, extent.height);
+    }
+
+    //Conversion sets take an image and a readback buffer, downsample sets an image and a storage image. Neither fits
+    //the persistent pools, which hold no buffers, so every set comes from a pool sized for KVK_OUTPUT_CAPACITY outputs
+    bool KrautVK::kvkCreateOutputLayout() {
+        if(kraut.Output.Layout != VK_NULL_HANDLE)
+            return true;
+
+        VkDescriptorSetLayoutBinding layoutBindings[] = {
+                {
+                        0,                                          // uint32_t             binding
+                        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,  // VkDescriptorType     descriptorType
+                        1,                                          // uint32_t             descriptorCount
+                        VK_SHADER_STAGE_COMPUTE_BIT,                // VkShaderStageFlags   stageFlags
+                        nullptr                                     // const VkSampler     *pImmutableSamplers
+                },
+                {
+                        1,                                          // uint32_t             binding
+                        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,          // VkDescriptorType     descriptorType
+                        1,                                          // uint32_t             descriptorCount
+                        VK_SHADER_STAGE_COMPUTE_BIT,                // VkShaderStageFlags   stageFlags
+                        nullptr                                     // const VkSampler     *pImmutableSamplers
+                }
+        };
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+                VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,  // VkStructureType                      sType
+                nullptr,                                              // const void                          *pNext
+                0,                                                    // VkDescriptorSetLayoutCreateFlags     flags
+                2,                                                    // uint32_t                             bindingCount
+                layoutBindings                                        // const VkDescriptorSetLayoutBinding  *pBindings
+        };
+
+        if(vkd.createDescriptorSetLayout(kraut.Vulkan.Device.Handle, &descriptorSetLayoutCreateInfo, nullptr, &kraut.Output.SetLayout) != VK_SUCCESS)
+            return false;
+
+        layoutBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+
+        if(vkd.createDescriptorSetLayout(kraut.Vulkan.Device.Handle, &descriptorSetLayoutCreateInfo, nullptr, &kraut.Output.DownsampleSetLayout) != VK_SUCCESS)
+            return false;
+
+        const uint32_t resourceCount = static_cast<uint32_t>(Com::VulkanParameters::ResourceCount);
+        const uint32_t capacity = KVK_OUTPUT_CAPACITY;
+
+        VkDescriptorPoolSize poolSizes[] = {
+                {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, capacity * (resourceCount + 1)},
+                {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, capacity * resourceCount},
+                {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, capacity}
+        };
+
+        VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+                VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,  // VkStructureType                sType
+                nullptr,                                        // const void                    *pNext
+                0,                                              // VkDescriptorPoolCreateFlags    flags
+                capacity * (resourceCount + 1),                 // uint32_t                       maxSets
+                3,                                              // uint32_t                       poolSizeCount
+                poolSizes                                       // const VkDescriptorPoolSize    *pPoolSizes
+        };
+
+        if(vkd.createDescriptorPool(kraut.Vulkan.Device.Handle, &descriptorPoolCreateInfo, nullptr, &kraut.Output.Pool) != VK_SUCCESS)
+            return false;
+
+        //Conversion takes the width, height, format, full range and whether the source is decoded sRGB. Downsampling
+        //takes the filter and whether the source is decoded sRGB
+        VkPushConstantRange pushConstantRange = {
+                VK_SHADER_STAGE_COMPUTE_BIT,                    // VkShaderStageFlags             stageFlags
+                0,                                              // uint32_t                       offset
+                5 * sizeof(uint32_t)                            // uint32_t                       size
+        };
+
+        VkPipelineLayoutCreateInfo layoutCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,  // VkStructureType                sType
+                nullptr,                                        // const void                    *pNext
+                0,                                              // VkPipelineLayoutCreateFlags    flags
+                1,                                              // uint32_t                       setLayoutCount
+                &kraut.Output.SetLayout,                        // const VkDescriptorSetLayout   *pSetLayouts
+                1,                                              // uint32_t                       pushConstantRangeCount
+                &pushConstantRange                              // const VkPushConstantRange     *pPushConstantRanges
+        };
+
+        if(vkd.createPipelineLayout(kraut.Vulkan.Device.Handle, &layoutCreateInfo, nullptr, &kraut.Output.Layout) != VK_SUCCESS)
+            return false;
+
+        pushConstantRange.size = 2 * sizeof(uint32_t);
+        layoutCreateInfo.pSetLayouts = &kraut.Output.DownsampleSetLayout;
+
+        return vkd.createPipelineLayout(kraut.Vulkan.Device.Handle, &layoutCreateInfo, nullptr, &kraut.Output.DownsampleLayout) == VK_SUCCESS;
+    }
+
+    int KrautVK::kvkCreateOutputPipelines() {
+        if(!kvkCreateOutputLayout())
+            return VULKAN_COMPUTE_PIPELINE_CREATION_FAILED;
+
+        //Both shaders declare local_size_x_id = 0 and local_size_y_id = 1
+        Com::PipelineVariantKey key;
+        key.FragmentShader = KVK_OUTPUT_SHADER;
+        key.Constants = {{0, KVK_OUTPUT_WORKGROUP}, {1, KVK_OUTPUT_WORKGROUP}};
+        key.Layout = kraut.Output.Layout;
+
+        int status = kvkCreateComputePipeline(key, kraut.Output.Pipeline);
+        if(status != SUCCESS)
+            return status;
+
+        key.FragmentShader = KVK_DOWNSAMPLE_SHADER;
+        key.Layout = kraut.Output.DownsampleLayout;
+
+        return kvkCreateComputePipeline(key, kraut.Output.DownsamplePipeline);
+    }
+
+    void KrautVK::kvkDestroyOutputResources() {
+        //A capture's frames in flight are written before their readback buffers go
+        if(kraut.Capture.Active)
+            kvkCaptureFlush();
+
+        for(Com::RenderingResourcesData &renderingResource : kraut.Vulkan.RenderingResources) {
+            kvkDestroyBuffer(renderingResource.Readback);
+            renderingResource.ReadbackMemory = nullptr;
+            renderingResource.ReadbackWritten = false;
+        }
+
+        for(Com::OutputTargetParameters &target : kraut.Output.Targets) {
+            kvkDestroyTexture(target.Image);
+            target.Downsample = VK_NULL_HANDLE;
+            target.Convert.clear();
+            target.Offset = 0;
+            target.Size = 0;
+        }
+
+        kraut.Output.Size = 0;
+    }
+
+    //Nothing is converted while frames go to the swap chain. Outputs are sorted largest first, each one is made from
+    //the last image of the chain that is at least as wide and as tall, the frame if none is. One of a different size
+    //is downsampled into an image of its own, which joins the chain. All of them share one readback buffer per
+    //rendering resource
+    bool KrautVK::kvkCreateOutputResources() {
+        kvkDeviceWaitIdle();
+        kvkDestroyOutputResources();
+
+        std::vector<Com::OutputTargetParameters> &targets = kraut.Output.Targets;
+        if(targets.empty() || !kraut.Offscreen.Active)
+            return true;
+
+        vkd.resetDescriptorPool(kraut.Vulkan.Device.Handle, kraut.Output.Pool, 0);
+
+        std::stable_sort(targets.begin(), targets.end(), [](const Com::OutputTargetParameters &a, const Com::OutputTargetParameters &b) {
+            const VkExtent2D extentA = kvkGetOutputExtent(a);
+            const VkExtent2D extentB = kvkGetOutputExtent(b);
+            return static_cast<uint64_t>(extentA.width) * extentA.height > static_cast<uint64_t>(extentB.width) * extentB.height;
+        });
+
+        const uint32_t alignment = static_cast<uint32_t>(std::max<VkDeviceSize>(kraut.Vulkan.Device.Properties.limits.minStorageBufferOffsetAlignment, 4));
+        const uint32_t resourceCount = static_cast<uint32_t>(Com::VulkanParameters::ResourceCount);
+
+        //Area order alone would let an output wider or taller than the image before it be scaled up from it
+        std::vector<std::pair<const Com::ImageParameters*, VkExtent2D>> chain = {{&kraut.Offscreen.Target, kraut.Offscreen.Extent}};
+        std::vector<const Com::ImageParameters*> sources(targets.size(), nullptr);
+        uint32_t size = 0;
+
+        for(size_t i = 0; i < targets.size(); ++i) {
+            Com::OutputTargetParameters &target = targets[i];
+            if(!kvkOutputFits(target))
+                continue;
+
+            const VkExtent2D extent = kvkGetOutputExtent(target);
+            const uint32_t pixels = extent.width * extent.height;
+
+            target.Extent = extent;
+            target.Offset = (size + alignment - 1) / alignment * alignment;
+            target.Size = target.Format == OUTPUT_RGBA ? pixels * 4 : pixels / 2 * 3;
+            size = target.Offset + target.Size;
+
+            size_t link = chain.size() - 1;
+            while(chain[link].second.width < extent.width || chain[link].second.height < extent.height)
+                --link;
+
+            const Com::ImageParameters *source = chain[link].first;
+            const VkExtent2D sourceExtent = chain[link].second;
+            target.SourceIsFrame = link == 0;
+
+            if(extent.width != sourceExtent.width || extent.height != sourceExtent.height) {
+                Com::ImageParameters &image = target.Image;
+
+                VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+                        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, // VkStructureType                sType
+                        nullptr,                                        // const void                    *pNext
+                        kraut.Output.Pool,                              // VkDescriptorPool               descriptorPool
+                        1,                                              // uint32_t                       descriptorSetCount
+                        &kraut.Output.DownsampleSetLayout               // const VkDescriptorSetLayout   *pSetLayouts
+                };
+
+                if(!kvkCreateImage(extent.width, extent.height, KVK_OUTPUT_IMAGE_FORMAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, &image.Handle) ||
+                   !kvkAllocateImageMemory(image.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &image.Memory) ||
+                   vkd.bindImageMemory(kraut.Vulkan.Device.Handle, image.Handle, image.Memory, 0) != VK_SUCCESS ||
+                   !kvkCreateImageView(image, KVK_OUTPUT_IMAGE_FORMAT) ||
+                   !kvkAcquireSampler(&image.Sampler) ||
+                   vkd.allocateDescriptorSets(kraut.Vulkan.Device.Handle, &descriptorSetAllocateInfo, &target.Downsample) != VK_SUCCESS) {
+                    std::cout << "Could not create a downsampled output!" << std::endl;
+                    kvkDestroyOutputResources();
+                    return false;
+                }
+
+                VkDescriptorImageInfo imageInfos[] = {
+                        {
+                                source->Sampler,                                         // VkSampler                      sampler
+                                source->View,                                            // VkImageView                    imageView
+                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL                 // VkImageLayout                  imageLayout
+                        },
+                        {
+                                VK_NULL_HANDLE,                                          // VkSampler                      sampler
+                                image.View,                                              // VkImageView                    imageView
+                                VK_IMAGE_LAYOUT_GENERAL                                  // VkImageLayout                  imageLayout
+                        }
+                };
+
+                VkWriteDescriptorSet descriptorWrites[] = {
+                        {
+                                VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,     // VkStructureType                sType
+                                nullptr,                                    // const void                    *pNext
+                                target.Downsample,                          // VkDescriptorSet                dstSet
+                                0,                                          // uint32_t                       dstBinding
+                                0,                                          // uint32_t                       dstArrayElement
+                                1,                                          // uint32_t                       descriptorCount
+                                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,  // VkDescriptorType               descriptorType
+                                &imageInfos[0],                             // const VkDescriptorImageInfo   *pImageInfo
+                                nullptr,                                    // const VkDescriptorBufferInfo  *pBufferInfo
+                                nullptr                                     // const VkBufferView            *pTexelBufferView
+                        },
+                        {
+                                VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,     // VkStructureType                sType
+                                nullptr,                                    // const void                    *pNext
+                                target.Downsample,                          // VkDescriptorSet                dstSet
+                                1,                                          // uint32_t                       dstBinding
+                                0,                                          // uint32_t                       dstArrayElement
+                                1,                                          // uint32_t                       descriptorCount
+                                VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,           // VkDescriptorType               descriptorType
+                                &imageInfos[1],                             // const VkDescriptorImageInfo   *pImageInfo
+                                nullptr,                                    // const VkDescriptorBufferInfo  *pBufferInfo
+                                nullptr                                     // const VkBufferView            *pTexelBufferView
+                        }
+                };
+
+                vkd.updateDescriptorSets(kraut.Vulkan.Device.Handle, 2, descriptorWrites, 0, nullptr);
+
+                source = &image;
+                chain.push_back({&image, extent});
+            }
+
+            sources[i] = source;
+        }
+
+        if(size == 0)
+            return true;
+
+        for(Com::RenderingResourcesData &renderingResource : kraut.Vulkan.RenderingResources) {
+            renderingResource.Readback.Size = size;
+
+            void *readbackPointer;
+            if(!kvkCreateBuffer(renderingResource.Readback, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) ||
+               vkd.mapMemory(kraut.Vulkan.Device.Handle, renderingResource.Readback.Memory, 0, VK_WHOLE_SIZE, 0, &readbackPointer) != VK_SUCCESS) {
+                std::cout << "Could not create the output readback buffers!" << std::endl;
+                kvkDestroyOutputResources();
+                return false;
+            }
+
+            renderingResource.ReadbackMemory = readbackPointer;
+        }
+
+        std::vector<VkDescriptorSetLayout> setLayouts(resourceCount, kraut.Output.SetLayout);
+
+        for(size_t i = 0; i < targets.size(); ++i) {
+            Com::OutputTargetParameters &target = targets[i];
+            if(target.Size == 0)
+                continue;
+
+            target.Convert.resize(resourceCount);
+
+            VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+                    VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, // VkStructureType                sType
+                    nullptr,                                        // const void                    *pNext
+                    kraut.Output.Pool,                              // VkDescriptorPool               descriptorPool
+                    resourceCount,                                  // uint32_t                       descriptorSetCount
+                    setLayouts.data()                               // const VkDescriptorSetLayout   *pSetLayouts
+            };
+
+            if(vkd.allocateDescriptorSets(kraut.Vulkan.Device.Handle, &descriptorSetAllocateInfo, target.Convert.data()) != VK_SUCCESS) {
+                std::cout << "Could not allocate the output descriptor sets!" << std::endl;
+                kvkDestroyOutputResources();
+                return false;
+            }
+
+            VkDescriptorImageInfo imageInfo = {
+                    sources[i]->Sampler,                                     // VkSampler                      sampler
+                    sources[i]->View,                                        // VkImageView                    imageView
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL                 // VkImageLayout                  imageLayout
+            };
+
+            for(uint32_t resource = 0; resource < resourceCount; ++resource) {
+                VkDescriptorBufferInfo bufferInfo = {
+                        kraut.Vulkan.RenderingResources[resource].Readback.Handle, // VkBuffer                       buffer
+                        target.Offset,                                           // VkDeviceSize                   offset
+                        target.Size                                              // VkDeviceSize                   range
+                };
+
+                VkWriteDescriptorSet descriptorWrites[] = {
+                        {
+                                VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,     // VkStructureType                sType
+                                nullptr,                                    // const void                    *pNext
+                                target.Convert[resource],                   // VkDescriptorSet                dstSet
+                                0,                                          // uint32_t                       dstBinding
+                                0,                                          // uint32_t                       dstArrayElement
+                                1,                                          // uint32_t                       descriptorCount
+                                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,  // VkDescriptorType               descriptorType
+                                &imageInfo,                                 // const VkDescriptorImageInfo   *pImageInfo
+                                nullptr,                                    // const VkDescriptorBufferInfo  *pBufferInfo
+                                nullptr                                     // const VkBufferView            *pTexelBufferView
+                        },
+                        {
+                                VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,     // VkStructureType                sType
+                                nullptr,                                    // const void                    *pNext
+                                target.Convert[resource],                   // VkDescriptorSet                dstSet
+                                1,                                          // uint32_t                       dstBinding
+                                0,                                          // uint32_t                       dstArrayElement
+                                1,                                          // uint32_t                       descriptorCount
+                                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,          // VkDescriptorType               descriptorType
+                                nullptr,                                    // const VkDescriptorImageInfo   *pImageInfo
+                                &bufferInfo,                                // const VkDescriptorBufferInfo  *pBufferInfo
+                                nullptr                                     // const VkBufferView            *pTexelBufferView
+                        }
+                };
+
+                vkd.updateDescriptorSets(kraut.Vulkan.Device.Handle, 2, descriptorWrites, 0, nullptr);
+            }
+        }
+
+        kraut.Output.Size = size;
+        return true;
+    }
+
+    //The frame is left in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL by both paths, and goes back there once every output
+    //is converted. Downsampled images only live within the frame, they start out undefined every time
+    void KrautVK::kvkRecordOutput(VkCommandBuffer commandBuffer, Com::RenderingResourcesData &renderingResource) {
+        const size_t resource = &renderingResource - kraut.Vulkan.RenderingResources.data();
+
+        VkImageSubresourceRange imageSubresourceRange = {
+                VK_IMAGE_ASPECT_COLOR_BIT,                          // VkImageAspectFlags                     aspectMask
+                0,                                                  // uint32_t                               baseMipLevel
+                1,                                                  // uint32_t                               levelCount
+                0,                                                  // uint32_t                               baseArrayLayer
+                1                                                   // uint32_t                               layerCount
+        };
+
+        VkImageMemoryBarrier barrierToRead = {
+                VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, // VkAccessFlags                          srcAccessMask
+                VK_ACCESS_SHADER_READ_BIT,                        // VkAccessFlags                          dstAccessMask
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,             // VkImageLayout                          oldLayout
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,         // VkImageLayout                          newLayout
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                kraut.Offscreen.Target.Handle,                    // VkImage                                image
+                imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
+        };
+        vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierToRead);
+
+        //Sampling an sRGB frame decodes it. Downsampled images hold encoded color like a UNORM frame does
+        const VkFormat format = kraut.Vulkan.SwapChain.Format;
+        const bool srgb = format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_B8G8R8A8_SRGB;
+
+        //A source from the chain always comes earlier in the targets, so it is written by the time it's read
+        for(const Com::OutputTargetParameters &target : kraut.Output.Targets) {
+            if(target.Size == 0)
+                continue;
+
+            bool fromFrame = target.SourceIsFrame;
+
+            if(target.Image.Handle != VK_NULL_HANDLE) {
+                VkImageMemoryBarrier barrierToGeneral = {
+                        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                        nullptr,                                          // const void                            *pNext
+                        0,                                                // VkAccessFlags                          srcAccessMask
+                        VK_ACCESS_SHADER_WRITE_BIT,                       // VkAccessFlags                          dstAccessMask
+                        VK_IMAGE_LAYOUT_UNDEFINED,                        // VkImageLayout                          oldLayout
+                        VK_IMAGE_LAYOUT_GENERAL,                          // VkImageLayout                          newLayout
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                        target.Image.Handle,                              // VkImage                                image
+                        imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
+                };
+                vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierToGeneral);
+
+                const uint32_t downsampleConstants[] = {
+                        target.Filter,
+                        fromFrame && srgb ? 1u : 0u
+                };
+
+                vkd.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kraut.Output.DownsamplePipeline);
+                vkd.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kraut.Output.DownsampleLayout, 0, 1, &target.Downsample, 0, nullptr);
+                vkd.cmdPushConstants(commandBuffer, kraut.Output.DownsampleLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(downsampleConstants), downsampleConstants);
+                vkd.cmdDispatch(commandBuffer, (target.Extent.width + KVK_OUTPUT_WORKGROUP - 1) / KVK_OUTPUT_WORKGROUP, (target.Extent.height + KVK_OUTPUT_WORKGROUP - 1) / KVK_OUTPUT_WORKGROUP, 1);
+
+                VkImageMemoryBarrier barrierToSampled = {
+                        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                        nullptr,                                          // const void                            *pNext
+                        VK_ACCESS_SHADER_WRITE_BIT,                       // VkAccessFlags                          srcAccessMask
+                        VK_ACCESS_SHADER_READ_BIT,                        // VkAccessFlags                          dstAccessMask
+                        VK_IMAGE_LAYOUT_GENERAL,                          // VkImageLayout                          oldLayout
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,         // VkImageLayout                          newLayout
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                        target.Image.Handle,                              // VkImage                                image
+                        imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
+                };
+                vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierToSampled);
+
+                fromFrame = false;
+            }
+
+            const uint32_t convertConstants[] = {
+                    target.Extent.width,
+                    target.Extent.height,
+                    target.Format,
+                    target.FullRange ? 1u : 0u,
+                    fromFrame && srgb ? 1u : 0u
+            };
+
+            vkd.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kraut.Output.Pipeline);
+            vkd.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kraut.Output.Layout, 0, 1, &target.Convert[resource], 0, nullptr);
+            vkd.cmdPushConstants(commandBuffer, kraut.Output.Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(convertConstants), convertConstants);
+
+            const uint32_t blocksX = target.Extent.width / 8;
+            const uint32_t blocksY = target.Extent.height / 2;
+            vkd.cmdDispatch(commandBuffer, (blocksX + KVK_OUTPUT_WORKGROUP - 1) / KVK_OUTPUT_WORKGROUP, (blocksY + KVK_OUTPUT_WORKGROUP - 1) / KVK_OUTPUT_WORKGROUP, 1);
+        }
+
+        VkImageMemoryBarrier barrierToTransfer = {
+                VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                0,                                                // VkAccessFlags                          srcAccessMask
+                0,                                                // VkAccessFlags                          dstAccessMask
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,         // VkImageLayout                          oldLayout
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,             // VkImageLayout                          newLayout
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                kraut.Offscreen.Target.Handle,                    // VkImage                                image
+                imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
+        };
+
+        //The host reads the buffer once the resource's fence has signalled
+        VkBufferMemoryBarrier barrierToHost = {
+                VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,          // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                VK_ACCESS_SHADER_WRITE_BIT,                       // VkAccessFlags                          srcAccessMask
+                VK_ACCESS_HOST_READ_BIT,                          // VkAccessFlags                          dstAccessMask
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                renderingResource.Readback.Handle,                // VkBuffer                               buffer
+                0,                                                // VkDeviceSize                           offset
+                VK_WHOLE_SIZE                                     // VkDeviceSize                           size
+        };
+        vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrierToHost, 1, &barrierToTransfer);
+    }
+
+    Com::OutputTargetParameters *KrautVK::kvkFindOutput(uint32_t output) {
+        for(Com::OutputTargetParameters &target : kraut.Output.Targets) {
+            if(target.ID == output)
+                return &target;
+        }
+
+        return nullptr;
+    }
+
+    //A width and height of 0 follow the frame. Returns the output's handle, 0 if it couldn't be added. While frames
+    //render offscreen the output has to fit the frame, otherwise it's skipped until a frame it fits renders
+    uint32_t KrautVK::kvkOutputAdd(uint32_t width, uint32_t height, uint32_t format, uint32_t filter, bool fullRange) {
+        if(format == OUTPUT_NONE || format > OUTPUT_RGBA || filter > FILTER_LANCZOS || kraut.Output.Targets.size() >= KVK_OUTPUT_CAPACITY)
+            return 0;
+
+        Com::OutputTargetParameters target;
+        target.ID = kraut.Output.NextID;
+        target.Width = width;
+        target.Height = height;
+        target.Format = format;
+        target.Filter = filter;
+        target.FullRange = fullRange;
+
+        if(kraut.Offscreen.Active && !kvkOutputFits(target))
+            return 0;
+
+        if(kvkCreateOutputPipelines() != SUCCESS)
+            return 0;
+
+        kraut.Output.Targets.push_back(target);
+        ++kraut.Output.NextID;
+        kraut.Idle.Changed = true;
+
+        if(!kvkCreateOutputResources()) {
+            kvkOutputRemove(target.ID);
+            return 0;
+        }
+
+        return target.ID;
+    }
+
+    //Waits for the device, every output's frames read so far are gone
+    bool KrautVK::kvkOutputRemove(uint32_t output) {
+        Com::OutputTargetParameters *target = kvkFindOutput(output);
+        if(target == nullptr)
+            return false;
+
+        kvkDeviceWaitIdle();
+        kvkDestroyTexture(target->Image);
+        kraut.Output.Targets.erase(kraut.Output.Targets.begin() + (target - kraut.Output.Targets.data()));
+
+        if(kraut.Output.MainID == output)
+            kraut.Output.MainID = 0;
+
+        kvkCreateOutputResources();
+        return true;
+    }
+
+    //0 while the output is not converted
+    uint32_t KrautVK::kvkOutputGetSize(uint32_t output) {
+        const Com::OutputTargetParameters *target = kvkFindOutput(output);
+        return target != nullptr ? target->Size : 0;
+    }
+
+    //Copies the output from the newest frame that has finished on the GPU and returns the frame's number, 0 if there
+    //is none. With wait the last frame submitted is waited for first. Frames converted before the outputs or the
+    //frame size last changed are gone. While frames are skipped it is the last rendered frame, under the same number
+    uint64_t KrautVK::kvkOutputRead(uint32_t output, void *data, uint32_t size, bool wait) {
+        const Com::OutputTargetParameters *target = kvkFindOutput(output);
+        if(target == nullptr || data == nullptr || target->Size == 0 || size < target->Size)
+            return 0;
+
+        std::vector<Com::RenderingResourcesData> &renderingResources = kraut.Vulkan.RenderingResources;
+        const size_t resourceCount = Com::VulkanParameters::ResourceCount;
+
+        //The fence is left signalled, the resource's next frame waits on it as usual
+        const Com::RenderingResourcesData &last = renderingResources[(kraut.Vulkan.ResourceIndex + resourceCount - 1) % resourceCount];
+        if(wait && last.ReadbackWritten && vkd.waitForFences(kraut.Vulkan.Device.Handle, 1, &last.Fence, VK_FALSE, UINT64_MAX) != VK_SUCCESS)
+            return 0;
+
+        const Com::RenderingResourcesData *newest = nullptr;
+        for(const Com::RenderingResourcesData &renderingResource : renderingResources) {
+            if(renderingResource.ReadbackWritten && (newest == nullptr || renderingResource.SubmittedFrame > newest->SubmittedFrame) &&
+               vkd.getFenceStatus(kraut.Vulkan.Device.Handle, renderingResource.Fence) == VK_SUCCESS)
+                newest = &renderingResource;
+        }
+
+        if(newest == nullptr)
+            return 0;
+
+        memcpy(data, kvkInvalidateOutput(*newest, *target), target->Size);
+
+        return newest->SubmittedFrame;
+    }
+
+    //The output's bytes in the resource's readback buffer, only valid once the resource's last frame completed
+    const void *KrautVK::kvkInvalidateOutput(const Com::RenderingResourcesData &renderingResource, const Com::OutputTargetParameters &target) {
+        VkMappedMemoryRange invalidateRange = {
+                VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,            // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                renderingResource.Readback.Memory,                // VkDeviceMemory                         memory
+                0,                                                // VkDeviceSize                           offset
+                VK_WHOLE_SIZE                                     // VkDeviceSize                           size
+        };
+
+        vkd.invalidateMappedMemoryRanges(kraut.Vulkan.Device.Handle, 1, &invalidateRange);
+        return static_cast<const char*>(renderingResource.ReadbackMemory) + target.Offset;
+    }
+
+    //A single output at the frame's size, replacing the one set before. OUTPUT_NONE removes it
+    int KrautVK::kvkSetOutputFormat(uint32_t format, bool fullRange) {
+        if(format > OUTPUT_RGBA)
+            return VULKAN_NOT_SUPPORTED;
+
+        if(kraut.Output.MainID != 0)
+            kvkOutputRemove(kraut.Output.MainID);
+
+        if(format == OUTPUT_NONE)
+            return SUCCESS;
+
+        if(kraut.Offscreen.Active && !kvkCheckOutputExtent(kraut.Offscreen.Extent.width, kraut.Offscreen.Extent.height))
+            return VULKAN_NOT_SUPPORTED;
+
+        kraut.Output.MainID = kvkOutputAdd(0, 0, format, FILTER_BOX, fullRange);
+        return kraut.Output.MainID != 0 ? SUCCESS : VULKAN_COMPUTE_PIPELINE_CREATION_FAILED;
+    }
+
+    uint32_t KrautVK::kvkGetOutputFrameSize() {
+        return kvkOutputGetSize(kraut.Output.MainID);
+    }
+
+    uint64_t KrautVK::kvkReadOutputFrame(void *data, uint32_t size, bool wait) {
+        return kvkOutputRead(kraut.Output.MainID, data, size, wait);
+    }
+
+    //Renders offscreen at width x height from now on, on a clock of fps frames a second that only moves when a
+    //frame renders. The frontend draws each frame for kvkCaptureGetTime and calls kvkRenderUpdate, nothing is
+    //presented so frames come as fast as the device renders them. A path of a PNG capture is the prefix of
+    //every frame's file
+    int KrautVK::kvkCaptureStart(const char *path, uint32_t format, uint32_t width, uint32_t height, uint32_t fps) {
+        if(kraut.Capture.Active)
+            kvkCaptureStop();
+
+        if(path == nullptr || format > CAPTURE_PNG || fps == 0 || !kvkCheckOutputExtent(width, height))
+            return VULKAN_NOT_SUPPORTED;
+
+        Com::CaptureParameters &capture = kraut.Capture;
+        capture.PreviousOffscreen = kraut.Offscreen.Active ? kraut.Offscreen.Extent : VkExtent2D{0, 0};
+
+        if((capture.PreviousOffscreen.width != width || capture.PreviousOffscreen.height != height) && !kvkCreateOffscreenTarget(width, height)) {
+            kvkCaptureRestoreOffscreen();
+            return VULKAN_TEXTURE_CREATION_FAILED;
+        }
+
+        capture.Output = kvkOutputAdd(0, 0, format == CAPTURE_Y4M ? OUTPUT_I420 : OUTPUT_RGBA, FILTER_BOX, false);
+        if(capture.Output == 0) {
+            kvkCaptureRestoreOffscreen();
+            return VULKAN_COMPUTE_PIPELINE_CREATION_FAILED;
+        }
+
+        if(!capture.Writer->open(path, format, width, height, fps, KVK_CAPTURE_THREADS, KVK_CAPTURE_QUEUE)) {
+            std::cout << "Could not open " << path << " for the capture!" << std::endl;
+            kvkOutputRemove(capture.Output);
+            capture.Output = 0;
+            kvkCaptureRestoreOffscreen();
+            return CAPTURE_FAILED;
+        }
+
+        capture.Active = true;
+        capture.FPS = fps;
+        capture.Frames = 0;
+        capture.Written = 0;
+        capture.FirstFrame = kraut.Vulkan.Frame + 1;
+        kraut.Idle.Changed = true;
+
+        return SUCCESS;
+    }
+
+    //Seconds into the capture of the frame the next kvkRenderUpdate renders
+    double KrautVK::kvkCaptureGetTime() {
+        const Com::CaptureParameters &capture = kraut.Capture;
+        return capture.Active ? static_cast<double>(capture.Frames) / capture.FPS : 0.0;
+    }
+
+    //Waits for every frame rendered to be written, then goes back to wherever frames went before. Returns
+    //CAPTURE_FAILED if any frame couldn't be written, or was missing from the sequence
+    int KrautVK::kvkCaptureStop() {
+        Com::CaptureParameters &capture = kraut.Capture;
+        if(!capture.Active)
+            return SUCCESS;
+
+        kvkCaptureFlush();
+        capture.Active = false;
+
+        const bool written = capture.Writer->close();
+
+        kvkOutputRemove(capture.Output);
+        capture.Output = 0;
+        kvkCaptureRestoreOffscreen();
+
+        return written && capture.Written == capture.Frames ? SUCCESS : CAPTURE_FAILED;
+    }
+
+    //Hands the resource's last frame to the writer once it completed. Resources come around in the order their
+    //frames were submitted, so a frame older than the next one the writer expects was already written. A frame
+    //that can't be read leaves a gap, nothing after it is written and kvkCaptureStop returns CAPTURE_FAILED
+    void KrautVK::kvkCaptureCollect(const Com::RenderingResourcesData &renderingResource) {
+        Com::CaptureParameters &capture = kraut.Capture;
+        const Com::OutputTargetParameters *target = kvkFindOutput(capture.Output);
+
+        if(!renderingResource.ReadbackWritten || target == nullptr || target->Size != capture.Writer->frameSize() ||
+           renderingResource.SubmittedFrame != capture.FirstFrame + capture.Written)
+            return;
+
+        capture.Writer->push(kvkInvalidateOutput(renderingResource, *target));
+        ++capture.Written;
+    }
+
+    //Every frame still in flight, oldest first
+    void KrautVK::kvkCaptureFlush() {
+        kvkDeviceWaitIdle();
+
+        std::vector<const Com::RenderingResourcesData*> renderingResources;
+        for(const Com::RenderingResourcesData &renderingResource : kraut.Vulkan.RenderingResources)
+            renderingResources.push_back(&renderingResource);
+
+        std::sort(renderingResources.begin(), renderingResources.end(), [](const Com::RenderingResourcesData *a, const Com::RenderingResourcesData *b) {
+            return a->SubmittedFrame < b->SubmittedFrame;
+        });
+
+        for(const Com::RenderingResourcesData *renderingResource : renderingResources)
+            kvkCaptureCollect(*renderingResource);
+    }
+
+    void KrautVK::kvkCaptureRestoreOffscreen() {
+        const VkExtent2D previous = kraut.Capture.PreviousOffscreen;
+
+        if(previous.width == 0 || previous.height == 0)
+            kvkDestroyOffscreenTarget();
+        else if(previous.width != kraut.Offscreen.Extent.width || previous.height != kraut.Offscreen.Extent.height)
+            kvkCreateOffscreenTarget(previous.width, previous.height);
+    }
+
+    //Warm up frames settle clocks and caches and are not measured. CPU samples are the time between the starts of
+    //consecutive frames, GPU samples the timestamped work of each measured frame, read back as its resource comes up again
+    int KrautVK::kvkBenchmark(const char *fragmentShader, uint32_t width, uint32_t height, uint32_t warmupFrames, uint32_t measuredFrames, const char *reportPath, BenchmarkResult *result) {
+        if(measuredFrames == 0 || kraut.Vulkan.Device.Handle == VK_NULL_HANDLE)
+            return BENCHMARK_FAILED;
+
+        //Its frames would land in the capture and move the capture's clock
+        if(kraut.Capture.Active)
+            return BENCHMARK_FAILED;
+
+        VkPipeline previousPipeline = kraut.Vulkan.GraphicsPipeline;
+        uint32_t pipeline = 0;
+        if(fragmentShader != nullptr) {
+            pipeline = kvkPipelineLoad(fragmentShader);
+            if(pipeline == 0)
+                return VULKAN_PIPELINES_CREATION_FAILED;
+
+            kvkPipelineUse(pipeline);
+        }
+
+        //Frames the frontend sent offscreen go back to its own target afterwards
+        const VkExtent2D previousOffscreen = kraut.Offscreen.Active ? kraut.Offscreen.Extent : VkExtent2D{0, 0};
+
+        //Without a size, or without room for the target, frames go to the swap chain at whatever size it is
+        bool offscreen = width != 0 && height != 0 && kvkCreateOffscreenTarget(width, height);
+        if(!offscreen && width != 0 && height != 0)
+            std::cout << "Benchmarking on the swap chain instead" << std::endl;
+
+        const VkExtent2D extent = kvkGetRenderExtent();
+        const uint64_t firstMeasuredFrame = kraut.Vulkan.Frame + warmupFrames + 1;
+
+        std::vector<double> cpuSamples;
+        std::vector<double> gpuSamples;
+        cpuSamples.reserve(measuredFrames);
+        gpuSamples.reserve(measuredFrames);
+
+        //Every frame has to render to be measured
+        const bool previousAnimated = kraut.Idle.Animated;
+        kraut.Idle.Animated = true;
+
+        bool rendered = true;
+        auto frameStart = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; rendered && i < warmupFrames + measuredFrames; ++i) {
+            const Com::RenderingResourcesData &resource = kraut.Vulkan.RenderingResources[kraut.Vulkan.ResourceIndex];
+            const bool measuredBefore = resource.TimestampsWritten && resource.SubmittedFrame >= firstMeasuredFrame;
+
+            rendered = offscreen ? kvkRenderOffscreen() : kvkRenderUpdate();
+            if(!offscreen)
+                kvkPollEvents();
+
+            if(rendered && measuredBefore)
+                gpuSamples.push_back(kraut.Timing.EffectMilliseconds);
+
+            auto frameEnd = std::chrono::steady_clock::now();
+            if(i >= warmupFrames)
+                cpuSamples.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+
+            frameStart = frameEnd;
+        }
+
+        kraut.Idle.Animated = previousAnimated;
+
+        //The last frame of every resource is still outstanding
+        kvkDeviceWaitIdle();
+        for(const Com::RenderingResourcesData &resource : kraut.Vulkan.RenderingResources) {
+            double milliseconds;
+            if(resource.SubmittedFrame >= firstMeasuredFrame && kvkReadTimestamps(resource, milliseconds))
+                gpuSamples.push_back(milliseconds);
+        }
+
+        kvkDestroyOffscreenTarget();
+        if(previousOffscreen.width != 0)
+            kvkCreateOffscreenTarget(previousOffscreen.width, previousOffscreen.height);
+
+        if(pipeline != 0) {
+            kraut.Vulkan.GraphicsPipeline = previousPipeline;
+            kraut.Idle.Changed = true;
+            kvkResourceDestroy(pipeline);
+        }
+
+        if(!rendered)
+            return BENCHMARK_FAILED;
+
+        BenchmarkResult benchmark = {};
+        benchmark.cpu = Benchmark::summarize(cpuSamples);
+        benchmark.gpu = Benchmark::summarize(gpuSamples);
+        benchmark.width = extent.width;
+        benchmark.height = extent.height;
+        benchmark.offscreen = offscreen ? 1 : 0;
+        //Shading rate of the effect itself, the CPU frame time also counts presentation and vsync
+        if(benchmark.gpu.mean > 0.0)
+            benchmark.megapixelsPerSecond = static_cast<double>(extent.width) * extent.height / (benchmark.gpu.mean / 1000.0) / 1000000.0;
+
+        if(result != nullptr)
+            *result = benchmark;
+
+        if(reportPath != nullptr && !Benchmark::writeReport(reportPath, fragmentShader != nullptr ? fragmentShader : "", kraut.Vulkan.Device.Properties.deviceName, warmupFrames, benchmark))
+            std::cout << "Could not write the benchmark report!" << std::endl;
+
+        return SUCCESS;
+    }
+
+    //Once every initialized context has skipped its frame, nothing changes before the next input or the frontend's
+    //next call, so the loop waits here instead of spinning. The timeout keeps changes made without input from waiting
+    //long. Contexts without a window yet are left out, they have no frame to skip
+    void KrautVK::kvkPollEvents() {
+        bool idle = true;
+        {
+            std::lock_guard<std::mutex> lock(Com::ContextsMutex);
+            for(const auto &context : Com::Contexts)
+                idle = idle && (!context || context->GLFW.Window == nullptr || context->Idle.Skipped);
+        }
+
+        if(idle)
+            glfwWaitEventsTimeout(KVK_IDLE_WAIT);
+        else
+            glfwPollEvents();
+    }
+
+    void KrautVK::kvkSetAnimated(bool animated) {
+        kraut.Idle.Animated = animated;
+    }
+
+    uint64_t KrautVK::kvkGetRenderedFrameCount() {
+        return kraut.Idle.RenderedFrames;
+    }
+
+    uint64_t KrautVK::kvkGetSkippedFrameCount() {
+        return kraut.Idle.SkippedFrames;
+    }
+
+    int KrautVK::kvkCreateRenderPass(VkImageLayout initialLayout, VkImageLayout finalLayout, VkRenderPass *renderPass) {
+        VkAttachmentDescription attachmentDescription[] = {
+                {
+                        0,                                   // VkAttachmentDescriptionFlags   flags
+                        kraut.Vulkan.SwapChain.Format,              // VkFormat                       format
+                        VK_SAMPLE_COUNT_1_BIT,               // VkSampleCountFlagBits          samples
+                        VK_ATTACHMENT_LOAD_OP_CLEAR,         // VkAttachmentLoadOp             loadOp
+                        VK_ATTACHMENT_STORE_OP_STORE,        // VkAttachmentStoreOp            storeOp
+                        VK_ATTACHMENT_LOAD_OP_DONT_CARE,     // VkAttachmentLoadOp             stencilLoadOp
+                        VK_ATTACHMENT_STORE_OP_DONT_CARE,    // VkAttachmentStoreOp            stencilStoreOp
+                        initialLayout,                       // VkImageLayout                  initialLayout;
+                        finalLayout                          // VkImageLayout                  finalLayout
+                }
+        };
+
+        VkAttachmentReference colorAttachmentReferences[] = {
+                {
+                        0,                                          // uint32_t                       attachment
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL    // VkImageLayout                  layout
+                }
+        };
+
+        VkSubpassDescription subpassDescriptions[] = {
+                {
+                        0,                                          // VkSubpassDescriptionFlags      flags
+                        VK_PIPELINE_BIND_POINT_GRAPHICS,            // VkPipelineBindPoint            pipelineBindPoint
+                        0,                                          // uint32_t                       inputAttachmentCount
+                        nullptr,                                    // const VkAttachmentReference   *pInputAttachments
+                        1,                                          // uint32_t                       colorAttachmentCount
+                        colorAttachmentReferences,                  // const VkAttachmentReference   *pColorAttachments
+                        nullptr,                                    // const VkAttachmentReference   *pResolveAttachments
+                        nullptr,                                    // const VkAttachmentReference   *pDepthStencilAttachment
+                        0,                                          // uint32_t                       preserveAttachmentCount
+                        nullptr                                     // const uint32_t*                pPreserveAttachments
+                }
+        };
+
+        std::vector<VkSubpassDependency> dependencies = {
+                {
+                        VK_SUBPASS_EXTERNAL,                            // uint32_t                       srcSubpass
+                        0,                                              // uint32_t                       dstSubpass
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,           // VkPipelineStageFlags           srcStageMask
+                        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,  // VkPipelineStageFlags           dstStageMask
+                        VK_ACCESS_MEMORY_READ_BIT,                      // VkAccessFlags                  srcAccessMask
+                        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,           // VkAccessFlags                  dstAccessMask
+                        VK_DEPENDENCY_BY_REGION_BIT                     // VkDependencyFlags              dependencyFlags
+                },
+
+                {
+                        0,                                              // uint32_t                       srcSubpass
+                        VK_SUBPASS_EXTERNAL,                            // uint32_t                       dstSubpass
+                        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,  // VkPipelineStageFlags           srcStageMask
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,           // VkPipelineStageFlags           dstStageMask
+                        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,           // VkAccessFlags                  srcAccessMask
+                        VK_ACCESS_MEMORY_READ_BIT,                      // VkAccessFlags                  dstAccessMask
+                        VK_DEPENDENCY_BY_REGION_BIT                     // VkDependencyFlags              dependencyFlags
+                }
+        };
+
+        VkRenderPassCreateInfo renderPassCreateInfo = {
+                VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,    // VkStructureType                sType
+                nullptr,                                      // const void                    *pNext
+                0,                                            // VkRenderPassCreateFlags        flags
+                1,                                            // uint32_t                       attachmentCount
+                attachmentDescription,                        // const VkAttachmentDescription *pAttachments
+                1,                                            // uint32_t                       subpassCount
+                subpassDescriptions,                          // const VkSubpassDescription    *pSubpasses
+                static_cast<uint32_t>(dependencies.size()),   // uint32_t                       dependencyCount
+                &dependencies[0]                              // const VkSubpassDependency     *pDependencies
+        };
+
+        if(vkd.createRenderPass(kraut.Vulkan.Device.Handle, &renderPassCreateInfo, nullptr, renderPass) == VK_SUCCESS){
+            return SUCCESS;
+        } else{
+            return VULKAN_RENDERPASS_CREATION_FAILED;
+        }
+
+
+    }
+
+    bool KrautVK::kvkCreateFrameBuffers(VkFramebuffer &framebuffer, VkImageView imageView) {
+
+        kvkDeferDestroy(framebuffer, vkd.destroyFramebuffer);
+
+        VkFramebufferCreateInfo framebufferCreateInfo = {
+                VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,      // VkStructureType                sType
+                nullptr,                                        // const void                    *pNext
+                0,                                              // VkFramebufferCreateFlags       flags
+                kraut.Vulkan.RenderPass,                              // VkRenderPass                   renderPass
+                1,                                              // uint32_t                       attachmentCount
+                &imageView,                                    // const VkImageView             *pAttachments
+                kvkGetRenderExtent().width,                     // uint32_t                       width
+                kvkGetRenderExtent().height,                    // uint32_t                       height
+                1                                               // uint32_t                       layers
+        };
+
+        if(vkd.createFramebuffer(kraut.Vulkan.Device.Handle, &framebufferCreateInfo, nullptr, &framebuffer) != VK_SUCCESS ) {
+            std::cout << "Could not create a framebuffer!" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    //Pipelines are cached by shader, specialization values and render pass, so switching a shader's quality
+    //settings back and forth only compiles each variant once
+    int KrautVK::kvkCreatePipelines(const std::string &fragmentShader, std::vector<Com::SpecializationConstant> constants){
+        std::sort(constants.begin(), constants.end(), [](const Com::SpecializationConstant &a, const Com::SpecializationConstant &b) {
+            return a.ConstantID < b.ConstantID;
+        });
+
+        for (size_t i = 1; i < constants.size(); ++i) {
+            if (constants[i].ConstantID == constants[i - 1].ConstantID)
+                return VULKAN_PIPELINES_CREATION_FAILED;
+        }
+
+        //The layout is shared by every variant
+        if(kraut.Vulkan.PipelineLayout == VK_NULL_HANDLE && !kvkCreatePipelineLayout()) {
+            return VULKAN_PIPELINES_CREATION_FAILED;
+        }
+
+        Com::PipelineVariantKey key;
+        key.VertexShader = KVK_VERTEX_SHADER;
+        key.FragmentShader = fragmentShader;
+        key.Constants = constants;
+        key.RenderPass = kraut.Vulkan.RenderPass;
+        key.Layout = kraut.Vulkan.PipelineLayout;
+
+        VkPipeline pipeline;
+        int status = kvkCreateGraphicsPipeline(key, pipeline);
+        if (status != SUCCESS)
+            return status;
+
+        kraut.Vulkan.GraphicsPipeline = pipeline;
+        kraut.Idle.Changed = true;
+        return SUCCESS;
+    }
+
+    int KrautVK::kvkCreateGraphicsPipeline(const Com::PipelineVariantKey &key, VkPipeline &pipeline) {
+        Com::PipelineVariantCache::iterator cached = kraut.Vulkan.PipelineVariants.find(key);
+        if (cached != kraut.Vulkan.PipelineVariants.end()) {
+            pipeline = cached->second;
+            kraut.Vulkan.PipelineLastUsed[pipeline] = kraut.Vulkan.Frame;
+            return SUCCESS;
+        }
+
+        const std::vector<Com::SpecializationConstant> &constants = key.Constants;
+
+        GarbageCollector<VkShaderModule, PFN_vkDestroyShaderModule> vertexShaderModule = Tools::loadShader(Tools::rootPath + key.VertexShader);
+        GarbageCollector<VkShaderModule, PFN_vkDestroyShaderModule> fragmentShaderModule = Tools::loadShader(Tools::rootPath + key.FragmentShader);
+
+        if( !vertexShaderModule || !fragmentShaderModule ) {
+            return VULKAN_PIPELINES_CREATION_FAILED;
+        }
+
+        //Every constant is a single 32 bit word, packed in ID order
+        std::vector<VkSpecializationMapEntry> specializationMapEntries(constants.size());
+        std::vector<uint32_t> specializationData(constants.size());
+        for (size_t i = 0; i < constants.size(); ++i) {
+            specializationMapEntries[i] = {
+                    constants[i].ConstantID,                                    // uint32_t                                       constantID
+                    static_cast<uint32_t>(i * sizeof(uint32_t)),                // uint32_t                                       offset
+                    sizeof(uint32_t)                                            // size_t                                         size
+            };
+            specializationData[i] = constants[i].Value;
+        }
+
+        VkSpecializationInfo specializationInfo = {
+                static_cast<uint32_t>(specializationMapEntries.size()),         // uint32_t                                       mapEntryCount
+                specializationMapEntries.data(),                                // const VkSpecializationMapEntry                *pMapEntries
+                specializationData.size() * sizeof(uint32_t),                   // size_t                                         dataSize
+                specializationData.data()                                       // const void                                    *pData
+        };
+
+        const VkSpecializationInfo *pSpecializationInfo = constants.empty() ? nullptr : &specializationInfo;
+
+        std::vector<VkVertexInputBindingDescription> vertexBindingDescriptions = {
+                {
+                        0,                                  // uint32_t            binding
+                        sizeof(VertexData),                 // uint32_t            stride
+                        VK_VERTEX_INPUT_RATE_VERTEX         // VkVertexInputRate   inputRate
+                }
+        };
+
+        std::vector<VkVertexInputAttributeDescription> vertexAttributeDescriptions = {
+                {
+                        0,                                         // uint32_t    location
+                        0,                                         // uint32_t    binding
+                        VK_FORMAT_R32G32B32A32_SFLOAT,             // VkFormat    format
+                        offsetof(VertexData, x)                    // uint32_t    offset
+                },
+                {
+                        1,                                         // uint32_t    location
+                        0,                                         // uint32_t    binding
+                        VK_FORMAT_R32G32_SFLOAT,                   // VkFormat    format
+                        offsetof(VertexData, u)                    // uint32_t    offset
+                }
+        };
+
+        //Sprites draw the same quad once per SpriteData in binding 1
+        if(key.Sprite) {
+            vertexBindingDescriptions.push_back({
+                    1,                                  // uint32_t            binding
+                    sizeof(SpriteData),                 // uint32_t            stride
+                    VK_VERTEX_INPUT_RATE_INSTANCE       // VkVertexInputRate   inputRate
+            });
+
+            vertexAttributeDescriptions.push_back({2, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(SpriteData, x)});
+            vertexAttributeDescriptions.push_back({3, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(SpriteData, u0)});
+            vertexAttributeDescriptions.push_back({4, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(SpriteData, r)});
+            vertexAttributeDescriptions.push_back({5, 1, VK_FORMAT_R32_SFLOAT, offsetof(SpriteData, rotation)});
+            vertexAttributeDescriptions.push_back({6, 1, VK_FORMAT_R32_UINT, offsetof(SpriteData, texture)});
+        }
+
+        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,      // VkStructureType                                sType
+                nullptr,                                                        // const void                                    *pNext
+                0,                                                              // VkPipelineVertexInputStateCreateFlags          flags;
+                static_cast<uint32_t>(vertexBindingDescriptions.size()),        // uint32_t                                       vertexBindingDescriptionCount
+                vertexBindingDescriptions.data(),                               // const VkVertexInputBindingDescription         *pVertexBindingDescriptions
+                static_cast<uint32_t>(vertexAttributeDescriptions.size()),      // uint32_t                                       vertexAttributeDescriptionCount
+                vertexAttributeDescriptions.data()                              // const VkVertexInputAttributeDescription       *pVertexAttributeDescriptions
+        };
+
+        //Load Shaders
+        std::vector<VkPipelineShaderStageCreateInfo> shaderStageCreateInfos = {
+                // Vertex shader
+                {
+                        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,        // VkStructureType                                sType
+                        nullptr,                                                    // const void                                    *pNext
+                        0,                                                          // VkPipelineShaderStageCreateFlags               flags
+                        VK_SHADER_STAGE_VERTEX_BIT,                                 // VkShaderStageFlagBits                          stage
+                        vertexShaderModule.get(),                                   // VkShaderModule                                 module
+                        "main",                                                     // const char                                    *pName
+                        pSpecializationInfo                                         // const VkSpecializationInfo                    *pSpecializationInfo
+                },
+
+                // Fragment shader
+                {
+                        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,        // VkStructureType                                sType
+                        nullptr,                                                    // const void                                    *pNext
+                        0,                                                          // VkPipelineShaderStageCreateFlags               flags
+                        VK_SHADER_STAGE_FRAGMENT_BIT,                               // VkShaderStageFlagBits                          stage
+                        fragmentShaderModule.get(),                                 // VkShaderModule                                 module
+                        "main",                                                     // const char                                    *pName
+                        pSpecializationInfo                                         // const VkSpecializationInfo                    *pSpecializationInfo
+                }
+        };
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,  // VkStructureType                                sType
+                nullptr,                                                      // const void                                    *pNext
+                0,                                                            // VkPipelineInputAssemblyStateCreateFlags        flags
+                KVK_PRIMITIVE_TOPOLOGY,                                       // VkPrimitiveTopology                            topology
+                VK_FALSE                                                      // VkBool32                                       primitiveRestartEnable
+        };
+
+        VkPipelineViewportStateCreateInfo viewportStateCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,        // VkStructureType                                sType
+                nullptr,                                                      // const void                                    *pNext
+                0,                                                            // VkPipelineViewportStateCreateFlags             flags
+                1,                                                            // uint32_t                                       viewportCount
+                nullptr,                                                      // const VkViewport                              *pViewports
+                1,                                                            // uint32_t                                       scissorCount
+                nullptr                                                       // const VkRect2D                                *pScissors
+        };
+
+        VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,   // VkStructureType                                sType
+                nullptr,                                                      // const void                                    *pNext
+                0,                                                            // VkPipelineRasterizationStateCreateFlags        flags
+                VK_FALSE,                                                     // VkBool32                                       depthClampEnable
+                VK_FALSE,                                                     // VkBool32                                       rasterizerDiscardEnable
+                VK_POLYGON_MODE_FILL,                                         // VkPolygonMode                                  polygonMode
+                key.Sprite ? VK_CULL_MODE_NONE : KVK_CULL_MODE,               // VkCullModeFlags                                cullMode
+                KVK_CULL_FRONT_FACE,                                          // VkFrontFace                                    frontFace
+                VK_FALSE,                                                     // VkBool32                                       depthBiasEnable
+                0.0f,                                                         // float                                          depthBiasConstantFactor
+                0.0f,                                                         // float                                          depthBiasClamp
+                0.0f,                                                         // float                                          depthBiasSlopeFactor
+                1.0f                                                          // float                                          lineWidth
+        };
+
+        VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,     // VkStructureType                                sType
+                nullptr,                                                      // const void                                    *pNext
+                0,                                                            // VkPipelineMultisampleStateCreateFlags          flags
+                VK_SAMPLE_COUNT_1_BIT,                                        // VkSampleCountFlagBits                          rasterizationSamples
+                VK_FALSE,                                                     // VkBool32                                       sampleShadingEnable
+                1.0f,                                                         // float                                          minSampleShading
+                nullptr,                                                      // const VkSampleMask                            *pSampleMask
+                VK_FALSE,                                                     // VkBool32                                       alphaToCoverageEnable
+                VK_FALSE                                                      // VkBool32                                       alphaToOneEnable
+        };
+
+        VkPipelineColorBlendAttachmentState colorBlendAttachmentState = {
+                VK_FALSE,                                                     // VkBool32                                       blendEnable
+                VK_BLEND_FACTOR_ONE,                                          // VkBlendFactor                                  srcColorBlendFactor
+                VK_BLEND_FACTOR_ZERO,                                         // VkBlendFactor                                  dstColorBlendFactor
+                VK_BLEND_OP_ADD,                                              // VkBlendOp                                      colorBlendOp
+                VK_BLEND_FACTOR_ONE,                                          // VkBlendFactor                                  srcAlphaBlendFactor
+                VK_BLEND_FACTOR_ZERO,                                         // VkBlendFactor                                  dstAlphaBlendFactor
+                VK_BLEND_OP_ADD,                                              // VkBlendOp                                      alphaBlendOp
+                VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |         // VkColorComponentFlags                          colorWriteMask
+                VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+        };
+
+        //The layer modes get premultiplied color, so alpha always covers with ONE_MINUS_SRC_ALPHA
+        const uint32_t blend = key.Sprite ? static_cast<uint32_t>(BLEND_ALPHA) : key.Blend;
+        switch(blend) {
+            case BLEND_ALPHA:
+                colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+                colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                break;
+            case BLEND_NORMAL:
+                colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                break;
+            case BLEND_ADD:
+                colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                break;
+            case BLEND_MULTIPLY:
+                //src * dst + dst * (1 - alpha), so a transparent texel leaves dst as it is
+                colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_DST_COLOR;
+                colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                break;
+            case BLEND_SCREEN:
+                colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR;
+                colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                break;
+            default:
+                break;
+        }
+
+        if(blend != BLEND_OPAQUE) {
+            colorBlendAttachmentState.blendEnable = VK_TRUE;
+            colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        }
+
+        VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,     // VkStructureType                                sType
+                nullptr,                                                      // const void                                    *pNext
+                0,                                                            // VkPipelineColorBlendStateCreateFlags           flags
+                VK_FALSE,                                                     // VkBool32                                       logicOpEnable
+                VK_LOGIC_OP_COPY,                                             // VkLogicOp                                      logicOp
+                1,                                                            // uint32_t                                       attachmentCount
+                &colorBlendAttachmentState,                                   // const VkPipelineColorBlendAttachmentState     *pAttachments
+                { 0.0f, 0.0f, 0.0f, 0.0f }                                    // float                                          blendConstants[4]
+        };
+
+        std::vector<VkDynamicState> dynamicStates = {
+                VK_DYNAMIC_STATE_VIEWPORT,
+                VK_DYNAMIC_STATE_SCISSOR,
+        };
+
+        VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,         // VkStructureType                                sType
+                nullptr,                                                      // const void                                    *pNext
+                0,                                                            // VkPipelineDynamicStateCreateFlags              flags
+                static_cast<uint32_t>(dynamicStates.size()),                  // uint32_t                                       dynamicStateCount
+                &dynamicStates[0]                                             // const VkDynamicState                          *pDynamicStates
+        };
+
+
+        VkGraphicsPipelineCreateInfo pipelineCreateInfo = {
+                VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,                // VkStructureType                                sType
+                nullptr,                                                        // const void                                    *pNext
+                0,                                                              // VkPipelineCreateFlags                          flags
+                static_cast<uint32_t>(shaderStageCreateInfos.size()),           // uint32_t                                       stageCount
+                &shaderStageCreateInfos[0],                                     // const VkPipelineShaderStageCreateInfo         *pStages
+                &vertexInputStateCreateInfo,                                    // const VkPipelineVertexInputStateCreateInfo    *pVertexInputState;
+                &inputAssemblyStateCreateInfo,                                  // const VkPipelineInputAssemblyStateCreateInfo  *pInputAssemblyState
+                nullptr,                                                        // const VkPipelineTessellationStateCreateInfo   *pTessellationState
+                &viewportStateCreateInfo,                                       // const VkPipelineViewportStateCreateInfo       *pViewportState
+                &rasterizationStateCreateInfo,                                  // const VkPipelineRasterizationStateCreateInfo  *pRasterizationState
+                &multisampleStateCreateInfo,                                    // const VkPipelineMultisampleStateCreateInfo    *pMultisampleState
+                nullptr,                                                        // const VkPipelineDepthStencilStateCreateInfo   *pDepthStencilState
+                &colorBlendStateCreateInfo,                                     // const VkPipelineColorBlendStateCreateInfo     *pColorBlendState
+                &pipelineDynamicStateCreateInfo,                                // const VkPipelineDynamicStateCreateInfo        *pDynamicState
+                key.Layout,                                                     // VkPipelineLayout                               layout
+                key.RenderPass,                                                 // VkRenderPass                                   renderPass
+                0,                                                              // uint32_t                                       subpass
+                VK_NULL_HANDLE,                                                 // VkPipeline                                     basePipelineHandle
+                -1                                                              // int32_t                                        basePipelineIndex
+        };
+
+
+        if(vkd.createGraphicsPipelines(kraut.Vulkan.Device.Handle, kraut.Vulkan.Device.Shared->PipelineCache, 1, &pipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS){
+            return VULKAN_PIPELINES_CREATION_FAILED;
+        }
+
+        kraut.Vulkan.PipelineVariants[key] = pipeline;
+        kraut.Vulkan.PipelineLastUsed[pipeline] = kraut.Vulkan.Frame;
+
+        return SUCCESS;
+
+    }
+
+    int KrautVK::kvkSetShaderVariant(const char* fragmentShader, const uint32_t* constantIDs, const uint32_t* values, uint32_t count) {
+        std::vector<Com::SpecializationConstant> constants(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            constants[i].ConstantID = constantIDs[i];
+            constants[i].Value = values[i];
+        }
+
+        return kvkCreatePipelines(fragmentShader != nullptr ? std::string(fragmentShader) : std::string(KVK_FRAGMENT_SHADER), constants);
+    }
+
+    bool KrautVK::kvkCreatePipelineLayout(){
+
+        VkPipelineLayoutCreateInfo layoutCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,  // VkStructureType                sType
+                nullptr,                                        // const void                    *pNext
+                0,                                              // VkPipelineLayoutCreateFlags    flags
+                1,                                              // uint32_t                       setLayoutCount
+                &kraut.Vulkan.Descriptor.Layout,                // const VkDescriptorSetLayout   *pSetLayouts
+                0,                                              // uint32_t                       pushConstantRangeCount
+                nullptr                                         // const VkPushConstantRange     *pPushConstantRanges
+        };
+
+        if(vkd.createPipelineLayout(kraut.Vulkan.Device.Handle, &layoutCreateInfo, nullptr, &kraut.Vulkan.PipelineLayout) != VK_SUCCESS) {
+            return false;
+        }
+
+        return true;
+
+    }
+
+    bool KrautVK::kvkAllocateMemory(const VkMemoryRequirements &requirements, VkMemoryPropertyFlagBits memoryProperty, VkDeviceMemory *memory) {
+        //Find the right memory type that is compatible with our needs and is supported by the hardware
+        for(uint32_t i = 0; i < kraut.Vulkan.Device.MemoryProperties.memoryTypeCount; ++i) {
+            if((requirements.memoryTypeBits & (1 << i)) &&
+                (kraut.Vulkan.Device.MemoryProperties.memoryTypes[i].propertyFlags & memoryProperty)) {
+
+                VkMemoryAllocateInfo memoryAllocateInfo = {
+                        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,     // VkStructureType                        sType
+                        nullptr,                                    // const void                            *pNext
+                        requirements.size,                          // VkDeviceSize                           allocationSize
+                        i                                           // uint32_t                               memoryTypeIndex
+                };
+
+                if(vkd.allocateMemory(kraut.Vulkan.Device.Handle, &memoryAllocateInfo, nullptr, memory) == VK_SUCCESS) {
+                    Com::MemoryParameters::Track(*memory, i, requirements.size);
+                    return true;
+                }
+            }
+        }
+        return false;
+
+    }
+
+    bool KrautVK::kvkAllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlagBits memoryProperty, VkDeviceMemory *memory) {
+        VkMemoryRequirements bufferMemoryRequirements;
+        vkd.getBufferMemoryRequirements(kraut.Vulkan.Device.Handle, buffer, &bufferMemoryRequirements);
+
+        return kvkAllocateMemory(bufferMemoryRequirements, memoryProperty, memory);
+
+    }
+
+    int KrautVK::kvkAllocateCommandBuffer(VkCommandPool pool, uint32_t count, VkCommandBuffer *commandBuffer) {
+
+        VkCommandBufferAllocateInfo cmdBufferAllocateInfo = {
+                VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, // VkStructureType              sType
+                nullptr,                                        // const void*                  pNext
+                pool,                                           // VkCommandPool                commandPool
+                VK_COMMAND_BUFFER_LEVEL_PRIMARY,                // VkCommandBufferLevel         level
+                count                                           // uint32_t                     bufferCount
+        };
+
+        if (vkd.allocateCommandBuffers(kraut.Vulkan.Device.Handle, &cmdBufferAllocateInfo, commandBuffer) != VK_SUCCESS) {
+            return VULKAN_COMMAND_BUFFER_CREATION_FAILED;
+        }
+
+        return SUCCESS;
+    }
+
+    int KrautVK::kvkCreateSemaphore(VkSemaphore *semaphore) {
+
+        VkSemaphoreCreateInfo semaphoreCreateInfo = {
+                VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,      // VkStructureType          sType
+                nullptr,                                      // const void*              pNext
+                0                                             // VkSemaphoreCreateFlags   flags
+        };
+
+            if ((vkd.createSemaphore(kraut.Vulkan.Device.Handle, &semaphoreCreateInfo, nullptr, semaphore) != VK_SUCCESS)) {
+                return VULKAN_SEMAPHORE_CREATION_FAILED;
+            }
+
+        return SUCCESS;
+    }
+
+    int KrautVK::kvkCreateFence(VkFence *fence) {
+        VkFenceCreateInfo fenceCreateInfo = {
+                VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,              // VkStructureType                sType
+                nullptr,                                          // const void                    *pNext
+                VK_FENCE_CREATE_SIGNALED_BIT                      // VkFenceCreateFlags             flags
+        };
+
+        if(vkd.createFence(kraut.Vulkan.Device.Handle, &fenceCreateInfo, nullptr, fence) != VK_SUCCESS) {
+            return VULKAN_FENCE_CREATION_FAILED;
+        }
+
+        return SUCCESS;
+
+    }
+
+    bool KrautVK::kvkCreateImage(const uint32_t &width, const uint32_t &height, VkFormat format, VkImageUsageFlags usage, VkImage *image) {
+        VkImageCreateInfo imageCreateInfo = {
+                VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,  // VkStructureType        sType;
                 nullptr,                              // const void            *pNext
                 0,                                    // VkImageCreateFlags     flags
                 VK_IMAGE_TYPE_2D,                     // VkImageType            imageType
-                VK_FORMAT_R8G8B8A8_UNORM,             // VkFormat               format
+                format,                               // VkFormat               format
                 {                                     // VkExtent3D             extent
 
-                        width,                        // uint32_t               width
-                        height,                       // uint32_t               height
-                        1                             // uint32_t               depth
-                },
-                1,                                    // uint32_t               mipLevels
-                1,                                    // uint32_t               arrayLayers
-                VK_SAMPLE_COUNT_1_BIT,                // VkSampleCountFlagBits  samples
-                VK_IMAGE_TILING_OPTIMAL,              // VkImageTiling          tiling
-                VK_IMAGE_USAGE_TRANSFER_DST_BIT |     // VkImageUsageFlags      usage
-                VK_IMAGE_USAGE_SAMPLED_BIT,
-                VK_SHARING_MODE_EXCLUSIVE,            // VkSharingMode          sharingMode
-                0,                                    // uint32_t               queueFamilyIndexCount
-                nullptr,                              // const uint32_t        *pQueueFamilyIndices
-                VK_IMAGE_LAYOUT_UNDEFINED             // VkImageLayout          initialLayout
+                        width,                        // uint32_t               width
+                        height,                       // uint32_t               height
+                        1                             // uint32_t               depth
+                },
+                1,                                    // uint32_t               mipLevels
+                1,                                    // uint32_t               arrayLayers
+                VK_SAMPLE_COUNT_1_BIT,                // VkSampleCountFlagBits  samples
+                VK_IMAGE_TILING_OPTIMAL,              // VkImageTiling          tiling
+                usage,                                // VkImageUsageFlags      usage
+                VK_SHARING_MODE_EXCLUSIVE,            // VkSharingMode          sharingMode
+                0,                                    // uint32_t               queueFamilyIndexCount
+                nullptr,                              // const uint32_t        *pQueueFamilyIndices
+                VK_IMAGE_LAYOUT_UNDEFINED             // VkImageLayout          initialLayout
+        };
+
+        return vkd.createImage(kraut.Vulkan.Device.Handle, &imageCreateInfo, nullptr, image) == VK_SUCCESS;
+
+    }
+
+    bool KrautVK::kvkAllocateImageMemory(VkImage image, VkMemoryPropertyFlagBits property, VkDeviceMemory *memory) {
+        // Get the memory requirements from the device
+        VkMemoryRequirements imageMemoryRequirements;
+        vkd.getImageMemoryRequirements(kraut.Vulkan.Device.Handle, image, &imageMemoryRequirements);
+
+        return kvkAllocateMemory(imageMemoryRequirements, property, memory);
+
+    }
+
+    int KrautVK::kvkCreateTexture(const std::string relPath, Com::ImageParameters &image) {
+        int width = 0;
+        int height = 0;
+        int dataSize = 0;
+
+        std::vector<char> textureData = Tools::getImageData(Tools::rootPath + relPath, 4, &width, &height, nullptr, &dataSize);
+
+        return kvkCreateTexture(textureData, static_cast<uint32_t>(width), static_cast<uint32_t>(height), image);
+    }
+
+    int KrautVK::kvkCreateTexture(std::vector<char> &textureData, uint32_t width, uint32_t height, Com::ImageParameters &image) {
+        if(textureData.empty())
+            return VULKAN_TEXTURE_CREATION_FAILED;
+
+        if(!kvkCreateImage(width, height, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, &image.Handle))
+            return VULKAN_TEXTURE_CREATION_FAILED;
+
+        if(!kvkAllocateImageMemory(image.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &image.Memory))
+            return VULKAN_TEXTURE_CREATION_FAILED;
+
+        if(vkd.bindImageMemory(kraut.Vulkan.Device.Handle, image.Handle, image.Memory, 0) != VK_SUCCESS)
+            return VULKAN_TEXTURE_CREATION_FAILED;
+
+        if(!kvkCreateImageView(image, VK_FORMAT_R8G8B8A8_UNORM))
+            return VULKAN_TEXTURE_CREATION_FAILED;
+
+        if(!kvkAcquireSampler(&image.Sampler))
+            return VULKAN_TEXTURE_CREATION_FAILED;
+
+        if(!kvkCopyTextureToGPU(image, textureData.data(), static_cast<uint32_t>(textureData.size()), width, height)){
+            return VULKAN_TEXTURE_CREATION_FAILED;
+        }
+
+        return SUCCESS;
+
+    }
+
+    bool KrautVK::kvkCreateImageView(Com::ImageParameters &image, const VkFormat &format) {
+        VkImageViewCreateInfo imageViewCreateInfo = {
+                VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO, // VkStructureType          sType
+                nullptr,                                  // const void              *pNext
+                0,                                        // VkImageViewCreateFlags   flags
+                image.Handle,                             // VkImage                  image
+                VK_IMAGE_VIEW_TYPE_2D,                    // VkImageViewType          viewType
+                format,                                   // VkFormat                 format
+                {                                         // VkComponentMapping       components
+                        VK_COMPONENT_SWIZZLE_IDENTITY,            // VkComponentSwizzle       r
+                        VK_COMPONENT_SWIZZLE_IDENTITY,            // VkComponentSwizzle       g
+                        VK_COMPONENT_SWIZZLE_IDENTITY,            // VkComponentSwizzle       b
+                        VK_COMPONENT_SWIZZLE_IDENTITY             // VkComponentSwizzle       a
+                },
+                {                                                 // VkImageSubresourceRange  subresourceRange
+                        VK_IMAGE_ASPECT_COLOR_BIT,                // VkImageAspectFlags       aspectMask
+                        0,                                        // uint32_t                 baseMipLevel
+                        1,                                        // uint32_t                 levelCount
+                        0,                                        // uint32_t                 baseArrayLayer
+                        1                                         // uint32_t                 layerCount
+                }
+        };
+
+        return vkd.createImageView(kraut.Vulkan.Device.Handle, &imageViewCreateInfo, nullptr, &image.View ) == VK_SUCCESS;
+
+    }
+
+    bool KrautVK::kvkCopyTextureToGPU(Com::ImageParameters &image, char* textureData, uint32_t dataSize, uint32_t width, uint32_t height) {
+        return kvkCopyTextureRegionToGPU(image, textureData, dataSize, {0, 0}, {width, height}, VK_IMAGE_LAYOUT_UNDEFINED);
+    }
+
+    //Uploads into part of an image. Coming from SHADER_READ_ONLY_OPTIMAL keeps the rest of the image intact,
+    //coming from UNDEFINED lets the driver throw it away
+    bool KrautVK::kvkCopyTextureRegionToGPU(Com::ImageParameters &image, char* textureData, uint32_t dataSize, VkOffset2D offset, VkExtent2D extent, VkImageLayout oldLayout) {
+        if(dataSize > kraut.StagingBuffer.Size)
+            return false;
+
+        void *stagingBufferMemoryPointer;
+        if(vkd.mapMemory(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Memory, 0, dataSize, 0, &stagingBufferMemoryPointer) != VK_SUCCESS) {
+            return false;
+        }
+
+        memcpy(stagingBufferMemoryPointer, textureData, dataSize);
+
+        VkMappedMemoryRange flushRange = {
+                VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,              // VkStructureType                        sType
+                nullptr,                                            // const void                            *pNext
+                kraut.StagingBuffer.Memory,                         // VkDeviceMemory                         memory
+                0,                                                  // VkDeviceSize                           offset
+                dataSize                                            // VkDeviceSize                           size
+        };
+        vkd.flushMappedMemoryRanges(kraut.Vulkan.Device.Handle, 1, &flushRange);
+
+        vkd.unmapMemory(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Memory);
+
+        // Prepare command buffer to copy data from staging buffer to a vertex buffer
+        VkCommandBufferBeginInfo commandBufferBeginInfo = {
+                VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,        // VkStructureType                        sType
+                nullptr,                                            // const void                            *pNext
+                VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,        // VkCommandBufferUsageFlags              flags
+                nullptr                                             // const VkCommandBufferInheritanceInfo  *pInheritanceInfo
+        };
+
+        VkCommandBuffer commandBuffer = kraut.Vulkan.RenderingResources[0].CommandBuffer;
+
+        vkd.beginCommandBuffer( commandBuffer, &commandBufferBeginInfo);
+
+        VkImageSubresourceRange imageSubresourceRange = {
+                VK_IMAGE_ASPECT_COLOR_BIT,                          // VkImageAspectFlags                     aspectMask
+                0,                                                  // uint32_t                               baseMipLevel
+                1,                                                  // uint32_t                               levelCount
+                0,                                                  // uint32_t                               baseArrayLayer
+                1                                                   // uint32_t                               layerCount
+        };
+
+        const bool preserve = oldLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VkImageMemoryBarrier imageMemoryBarrierToTransferDst = {
+                VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,             // VkStructureType                        sType
+                nullptr,                                            // const void                            *pNext
+                preserve ? static_cast<VkAccessFlags>(VK_ACCESS_SHADER_READ_BIT) : 0u, // VkAccessFlags                          srcAccessMask
+                VK_ACCESS_TRANSFER_WRITE_BIT,                       // VkAccessFlags                          dstAccessMask
+                oldLayout,                                          // VkImageLayout                          oldLayout
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,               // VkImageLayout                          newLayout
+                VK_QUEUE_FAMILY_IGNORED,                            // uint32_t                               srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                            // uint32_t                               dstQueueFamilyIndex
+                image.Handle,                   // VkImage                                image
+                imageSubresourceRange                               // VkImageSubresourceRange                subresourceRange
+        };
+        vkd.cmdPipelineBarrier(commandBuffer, preserve ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrierToTransferDst);
+
+        VkBufferImageCopy bufferImageCopyInfo = {
+                0,                                                  // VkDeviceSize                           bufferOffset
+                0,                                                  // uint32_t                               bufferRowLength
+                0,                                                  // uint32_t                               bufferImageHeight
+                {                                                   // VkImageSubresourceLayers               imageSubresource
+                        VK_IMAGE_ASPECT_COLOR_BIT,                          // VkImageAspectFlags                     aspectMask
+                        0,                                                  // uint32_t                               mipLevel
+                        0,                                                  // uint32_t                               baseArrayLayer
+                        1                                                   // uint32_t                               layerCount
+                },
+                {                                                   // VkOffset3D                             imageOffset
+                        offset.x,                                           // int32_t                                x
+                        offset.y,                                           // int32_t                                y
+                        0                                                   // int32_t                                z
+                },
+                {                                                   // VkExtent3D                             imageExtent
+                        extent.width,                                       // uint32_t                               width
+                        extent.height,                                      // uint32_t                               height
+                        1                                                   // uint32_t                               depth
+                }
+        };
+        vkd.cmdCopyBufferToImage(commandBuffer, kraut.StagingBuffer.Handle, image.Handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopyInfo);
+
+        VkImageMemoryBarrier imageMemoryBarrierFromTransferToShaderRead = {
+                VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,             // VkStructureType                        sType
+                nullptr,                                            // const void                            *pNext
+                VK_ACCESS_TRANSFER_WRITE_BIT,                       // VkAccessFlags                          srcAccessMask
+                VK_ACCESS_SHADER_READ_BIT,                          // VkAccessFlags                          dstAccessMask
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,               // VkImageLayout                          oldLayout
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,           // VkImageLayout                          newLayout
+                VK_QUEUE_FAMILY_IGNORED,                            // uint32_t                               srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                            // uint32_t                               dstQueueFamilyIndex
+                image.Handle,                   // VkImage                                image
+                imageSubresourceRange                               // VkImageSubresourceRange                subresourceRange
+        };
+        vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrierFromTransferToShaderRead);
+
+        vkd.endCommandBuffer(commandBuffer);
+
+        // Submit command buffer and copy data from staging buffer to a vertex buffer
+        VkSubmitInfo submitInfo = {
+                VK_STRUCTURE_TYPE_SUBMIT_INFO,                      // VkStructureType                        sType
+                nullptr,                                            // const void                            *pNext
+                0,                                                  // uint32_t                               waitSemaphoreCount
+                nullptr,                                            // const VkSemaphore                     *pWaitSemaphores
+                nullptr,                                            // const VkPipelineStageFlags            *pWaitDstStageMask;
+                1,                                                  // uint32_t                               commandBufferCount
+                &commandBuffer,                                     // const VkCommandBuffer                 *pCommandBuffers
+                0,                                                  // uint32_t                               signalSemaphoreCount
+                nullptr                                             // const VkSemaphore                     *pSignalSemaphores
+        };
+
+        if(kvkQueueSubmit(kraut.GraphicsQueue.Handle, submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            return false;
+        }
+
+        kvkDeviceWaitIdle();
+
+        return true;
+    }
+
+    //Destroys object once the frames that might still be using it have finished on the GPU
+    template<class T, class F>
+    void KrautVK::kvkDeferDestroy(T &object, F deleter) {
+        kraut.Vulkan.Deletions.release(object, deleter, kraut.Vulkan.Device.Handle, kraut.Vulkan.Frame);
+        object = VK_NULL_HANDLE;
+    }
+
+    //Linear filtering, clamped to the edge. Every texture in the engine uses this one
+    bool KrautVK::kvkAcquireSampler(VkSampler *sampler) {
+        VkSamplerCreateInfo samplerCreateInfo = {
+                VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,  // VkStructureType        sType
+                nullptr,                                // const void*            pNext
+                0,                                      // VkSamplerCreateFlags   flags
+                VK_FILTER_LINEAR,                       // VkFilter               magFilter
+                VK_FILTER_LINEAR,                       // VkFilter               minFilter
+                VK_SAMPLER_MIPMAP_MODE_NEAREST,         // VkSamplerMipmapMode    mipmapMode
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,  // VkSamplerAddressMode   addressModeU
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,  // VkSamplerAddressMode   addressModeV
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,  // VkSamplerAddressMode   addressModeW
+                0.0f,                                   // float                  mipLodBias
+                VK_FALSE,                               // VkBool32               anisotropyEnable
+                1.0f,                                   // float                  maxAnisotropy
+                VK_FALSE,                               // VkBool32               compareEnable
+                VK_COMPARE_OP_ALWAYS,                   // VkCompareOp            compareOp
+                0.0f,                                   // float                  minLod
+                0.0f,                                   // float                  maxLod
+                VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK,// VkBorderColor          borderColor
+                VK_FALSE                                // VkBool32               unnormalizedCoordinates
+        };
+
+        return kvkAcquireSampler(samplerCreateInfo, sampler);
+    }
+
+    bool KrautVK::kvkAcquireSampler(const VkSamplerCreateInfo &samplerCreateInfo, VkSampler *sampler) {
+        if(samplerCreateInfo.pNext != nullptr)
+            return false;
+
+        //Samplers are device objects, so contexts on the same device share them
+        Com::SharedDeviceParameters &shared = *kraut.Vulkan.Device.Shared;
+        std::lock_guard<std::mutex> lock(shared.SamplerMutex);
+
+        Com::SamplerKey key(samplerCreateInfo);
+        Com::SamplerCache::iterator cached = shared.Samplers.find(key);
+        if(cached != shared.Samplers.end()) {
+            ++cached->second.References;
+            *sampler = cached->second.Handle;
+            return true;
+        }
+
+        if(shared.Samplers.size() >= kraut.Vulkan.Device.Properties.limits.maxSamplerAllocationCount) {
+            std::cout << "Sampler allocation limit reached!" << std::endl;
+            return false;
+        }
+
+        Com::SamplerEntry entry = {VK_NULL_HANDLE, 1};
+        if(vkd.createSampler(kraut.Vulkan.Device.Handle, &samplerCreateInfo, nullptr, &entry.Handle) != VK_SUCCESS)
+            return false;
+
+        shared.Samplers.insert({key, entry});
+        *sampler = entry.Handle;
+        return true;
+    }
+
+    void KrautVK::kvkReleaseSampler(VkSampler &sampler) {
+        if(sampler == VK_NULL_HANDLE)
+            return;
+
+        Com::SharedDeviceParameters &shared = *kraut.Vulkan.Device.Shared;
+        std::lock_guard<std::mutex> lock(shared.SamplerMutex);
+
+        //The last reference goes through this context's deletion queue, its frames may still be sampling with it
+        for(Com::SamplerCache::iterator cached = shared.Samplers.begin(); cached != shared.Samplers.end(); ++cached) {
+            if(cached->second.Handle != sampler)
+                continue;
+
+            if(--cached->second.References == 0) {
+                kvkDeferDestroy(cached->second.Handle, vkd.destroySampler);
+                shared.Samplers.erase(cached);
+            }
+            break;
+        }
+
+        sampler = VK_NULL_HANDLE;
+    }
+
+    bool KrautVK::kvkCreateBuffer(Com::BufferParameters &buffer, VkBufferCreateFlags usage, VkMemoryPropertyFlagBits memoryProperty) {
+
+        VkBufferCreateInfo vkBufferCreateInfo = {
+                VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,             // VkStructureType        sType
+                nullptr,                                          // const void            *pNext
+                0,                                                // VkBufferCreateFlags    flags
+                buffer.Size,                                      // VkDeviceSize           size
+                usage,                                            // VkBufferUsageFlags     usage
+                VK_SHARING_MODE_EXCLUSIVE,                        // VkSharingMode          sharingMode
+                0,                                                // uint32_t               queueFamilyIndexCount
+                nullptr                                           // const uint32_t        *pQueueFamilyIndices
+        };
+
+        if(vkd.createBuffer(kraut.Vulkan.Device.Handle, &vkBufferCreateInfo, nullptr, &buffer.Handle) != VK_SUCCESS ) {
+            return false;
+        }
+        if(!kvkAllocateBufferMemory(buffer.Handle, memoryProperty, &buffer.Memory)) {
+            return false;
+        }
+
+        return !(vkd.bindBufferMemory(kraut.Vulkan.Device.Handle, buffer.Handle, buffer.Memory, 0) != VK_SUCCESS);
+
+    }
+
+    int KrautVK::kvkCreateVertexBuffer() {
+        const std::vector<float> &vertexData = GlobalVertexData;
+
+        Com::BufferParameters vertexBuffer;
+        vertexBuffer.Size = static_cast<uint32_t>(vertexData.size() * sizeof(vertexData[0]));
+        if(!kvkCreateBuffer(vertexBuffer, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+            kvkDestroyBuffer(vertexBuffer);
+            return VULKAN_VERTEX_CREATION_FAILED;
+        }
+
+        kraut.Resources.DemoVertexBuffer = kraut.Resources.Buffers.create(vertexBuffer);
+        if(kraut.Resources.DemoVertexBuffer == 0) {
+            kvkDestroyBuffer(vertexBuffer);
+            return VULKAN_VERTEX_CREATION_FAILED;
+        }
+
+        return SUCCESS;
+
+    }
+
+    int KrautVK::kvkCreateStagingBuffer() {
+        kraut.StagingBuffer.Size = KVK_STAGING_BUFFER_SIZE;
+        if(!kvkCreateBuffer(kraut.StagingBuffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)){
+            return VULKAN_VERTEX_CREATION_FAILED;
+        };
+
+        return SUCCESS;
+
+    }
+
+    int KrautVK::kvkCopyBufferToGPU() {
+        const std::vector<float> &vertexData = GlobalVertexData;
+        const Com::BufferParameters &vertexBuffer = *kraut.Resources.Buffers.get(kraut.Resources.DemoVertexBuffer);
+
+        void *stagingBufferMemoryPointer;
+        if(vkd.mapMemory(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Memory, 0, vertexBuffer.Size, 0, &stagingBufferMemoryPointer) != VK_SUCCESS) {
+            return VULKAN_VERTEX_CREATION_FAILED;
+        }
+
+        memcpy(stagingBufferMemoryPointer, &vertexData[0], vertexBuffer.Size);
+
+        VkMappedMemoryRange flushRange = {
+                VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,            // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                kraut.StagingBuffer.Memory,                       // VkDeviceMemory                         memory
+                0,                                                // VkDeviceSize                           offset
+                vertexBuffer.Size                                 // VkDeviceSize                           size
+        };
+
+        vkd.flushMappedMemoryRanges(kraut.Vulkan.Device.Handle, 1, &flushRange);
+
+        vkd.unmapMemory(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Memory);
+
+        VkCommandBufferBeginInfo commandBufferBeginInfo = {
+                VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,      // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,      // VkCommandBufferUsageFlags              flags
+                nullptr                                           // const VkCommandBufferInheritanceInfo  *pInheritanceInfo
+        };
+
+        VkCommandBuffer commandBuffer = kraut.Vulkan.RenderingResources[0].CommandBuffer;
+
+        vkd.beginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+
+        VkBufferCopy bufferCopyInfo = {
+                0,                                                // VkDeviceSize                           srcOffset
+                0,                                                // VkDeviceSize                           dstOffset
+                vertexBuffer.Size                                 // VkDeviceSize                           size
+        };
+
+        vkd.cmdCopyBuffer(commandBuffer, kraut.StagingBuffer.Handle, vertexBuffer.Handle, 1, &bufferCopyInfo);
+
+        VkBufferMemoryBarrier bufferMemoryBarrier = {
+                VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,          // VkStructureType                        sType;
+                nullptr,                                          // const void                            *pNext
+                VK_ACCESS_MEMORY_WRITE_BIT,                       // VkAccessFlags                          srcAccessMask
+                VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,              // VkAccessFlags                          dstAccessMask
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                vertexBuffer.Handle,                                           // VkBuffer                               buffer
+                0,                                                // VkDeviceSize                           offset
+                VK_WHOLE_SIZE                                     // VkDeviceSize                           size
+        };
+
+        vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr, 1, &bufferMemoryBarrier, 0, nullptr);
+
+        vkd.endCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo = {
+                VK_STRUCTURE_TYPE_SUBMIT_INFO,                    // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                0,                                                // uint32_t                               waitSemaphoreCount
+                nullptr,                                          // const VkSemaphore                     *pWaitSemaphores
+                nullptr,                                          // const VkPipelineStageFlags            *pWaitDstStageMask;
+                1,                                                // uint32_t                               commandBufferCount
+                &commandBuffer,                                   // const VkCommandBuffer                 *pCommandBuffers
+                0,                                                // uint32_t                               signalSemaphoreCount
+                nullptr                                           // const VkSemaphore                     *pSignalSemaphores
+        };
+
+        if(kvkQueueSubmit(kraut.GraphicsQueue.Handle, submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            return VULKAN_VERTEX_CREATION_FAILED;
+        }
+
+        kvkDeviceWaitIdle();
+
+        return SUCCESS;
+
+    }
+
+    uint32_t KrautVK::kvkCreateContext() {
+        return Com::AddContext();
+    }
+
+    //Only switches the calling thread's context
+    bool KrautVK::kvkMakeCurrent(uint32_t context) {
+        Com::KrautCommon *found = Com::FindContext(context);
+        if (found == nullptr)
+            return false;
+
+        Com::Current = found;
+        return true;
+    }
+
+    //The default context is torn down by kvkTerminate and never released. No other thread may still have the
+    //context current
+    bool KrautVK::kvkDestroyContext(uint32_t context) {
+        Com::KrautCommon *found = Com::FindContext(context);
+        if (context <= 1 || found == nullptr)
+            return false;
+
+        Com::KrautCommon *previous = Com::Current;
+        Com::Current = found;
+
+        if (kraut.GLFW.Window != nullptr)
+            kvkTerminate();
+
+        {
+            std::lock_guard<std::mutex> lock(Com::ContextsMutex);
+            Com::Contexts[context - 1].reset();
+        }
+
+        Com::Current = previous == found ? Com::Default : previous;
+
+        return true;
+    }
+
+    //The window is created here, everything after it runs as a graph of tasks on KVK_INIT_THREADS threads. Texture
+    //decoding needs no device and the pipelines need no uploads, so both overlap with the rest of the setup. Tasks
+    //that record on the first frame's command buffer, submit to the graphics queue or allocate memory stay a chain,
+    //those share state that is not thread safe
+    int KrautVK::kvkInit(const int &width, const int &height, const char *title, const int &fullScreen, const char *preferredDevice) {
+        std::cout << "\nKrautVK Alpha v" << krautvk_VERSION_MAJOR << "." << krautvk_VERSION_MINOR << "\n";
+
+        printf("Initializing GLFW...\n");
+        int status = kvkInitGLFW(width, height, title, fullScreen);
+        if (status != SUCCESS)
+            return status;
+
+        TaskGraph init;
+
+        std::vector<char> demoTextureData;
+        int demoWidth = 0;
+        int demoHeight = 0;
+
+        uint32_t decode = init.add("decode textures", [&]() {
+            demoTextureData = Tools::getImageData(Tools::rootPath + "/res/demo.png", 4, &demoWidth, &demoHeight, nullptr, nullptr);
+            return demoTextureData.empty() ? VULKAN_TEXTURE_CREATION_FAILED : SUCCESS;
+        });
+
+        //Contexts after the first render on the device it created
+        uint32_t device;
+        Com::KrautCommon *shared = kvkFindSharedDevice();
+        if (shared != nullptr) {
+            device = init.add("share device", [shared]() { return kvkShareDevice(*shared); });
+        }
+        else {
+            uint32_t instance = init.add("instance", [title]() { return kvkCreateInstance(title); });
+            device = init.add("device", [preferredDevice]() { return kvkCreateDevice(preferredDevice); }, {instance});
+        }
+
+        //Waits for the device to go idle, so it comes before anything that submits
+        uint32_t swapChain = init.add("swap chain", []() { return kvkCreateSwapChain() ? SUCCESS : INT32_MIN; }, {device});
+
+        uint32_t renderPass = init.add("render pass", []() {
+            return kvkCreateRenderPass(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, &kraut.Vulkan.RenderPass);
+        }, {swapChain});
+
+        uint32_t descriptorLayout = init.add("descriptor layout", kvkCreateDescriptorLayout, {device});
+
+        uint32_t pipelines = init.add("pipelines", []() {
+            return kvkCreatePipelines(KVK_FRAGMENT_SHADER, std::vector<Com::SpecializationConstant>());
+        }, {renderPass, descriptorLayout});
+
+        uint32_t renderingResources = init.add("rendering resources", kvkCreateRenderingResources, {swapChain});
+
+        uint32_t staging = init.add("staging buffer", kvkCreateStagingBuffer, {renderingResources});
+
+        uint32_t textures = init.add("upload textures", [&]() {
+            Com::ImageParameters demoImage;
+            int textureStatus = kvkCreateTexture(demoTextureData, static_cast<uint32_t>(demoWidth), static_cast<uint32_t>(demoHeight), demoImage);
+            if (textureStatus == SUCCESS) {
+                kraut.Resources.DemoImage = kraut.Resources.Images.create(demoImage);
+                if (kraut.Resources.DemoImage == 0)
+                    textureStatus = VULKAN_TEXTURE_CREATION_FAILED;
+            }
+
+            if (textureStatus != SUCCESS)
+                kvkDestroyTexture(demoImage);
+
+            return textureStatus;
+        }, {staging, decode});
+
+        uint32_t vertices = init.add("vertex buffer", []() {
+            int vertexStatus = kvkCreateVertexBuffer();
+            return vertexStatus == SUCCESS ? kvkCopyBufferToGPU() : vertexStatus;
+        }, {textures});
+
+        uint32_t descriptors = init.add("descriptor sets", []() {
+            int descriptorStatus = kvkCreateDescriptorSet();
+            if (descriptorStatus == SUCCESS && kraut.Bindless.Supported)
+                descriptorStatus = kvkCreateBindlessTable();
+
+            return descriptorStatus;
+        }, {textures, descriptorLayout});
+
+        init.add("sprites", kvkCreateSpriteResources, {pipelines, descriptors, vertices});
+
+        printf("Setting Up Engine...\n");
+
+        //Pool threads start out on the default context, the tasks set up this one
+        Com::KrautCommon *context = Com::Current;
+        status = init.run(KVK_INIT_THREADS, [context]() { Com::Current = context; });
+
+        kraut.Timing.InitStages.clear();
+        for (const TaskGraph::Timing &timing : init.timings()) {
+            InitStage stage = {};
+            strncpy(stage.name, timing.Name.c_str(), KVK_INIT_STAGE_NAME_SIZE - 1);
+            stage.start = timing.Start;
+            stage.milliseconds = timing.Milliseconds;
+            stage.thread = timing.Thread;
+            kraut.Timing.InitStages.push_back(stage);
+
+            printf("  %-20s thread %u  %8.2f ms at %8.2f ms\n", stage.name, stage.thread, stage.milliseconds, stage.start);
+        }
+
+        if (status != SUCCESS)
+            return status;
+
+        printf("KrautVK Alpha Initialized!\n");
+
+        return SUCCESS;
+    }
+
+    void KrautVK::kvkTerminate() {
+        printf("KrautVK terminating\n");
+
+        if (kraut.Vulkan.Device.Handle != VK_NULL_HANDLE) {
+            kvkDeviceWaitIdle();
+
+            //Finish the capture, its frames in flight are written while the readback buffers are still there
+            if(kraut.Capture.Active) {
+                kvkCaptureFlush();
+                kraut.Capture.Active = false;
+                kraut.Capture.Writer->close();
+            }
+
+            //Destroy Rendering Resource Data
+            for(unsigned int i = 0; i < kraut.Vulkan.RenderingResources.size(); i++)
+                kraut.Vulkan.RenderingResources[i].DestroyResources();
+
+
+            //Destroy Command Pool
+            if(kraut.Vulkan.CommandPool != VK_NULL_HANDLE) {
+                vkd.destroyCommandPool(kraut.Vulkan.Device.Handle, kraut.Vulkan.CommandPool, nullptr);
+                kraut.Vulkan.CommandPool = VK_NULL_HANDLE;
+            }
+
+
+            //Destroy Registered Resources, the demo scene's included
+            for(Com::ImageParameters &image : kraut.Resources.Images.items())
+                kvkDestroyTexture(image);
+
+            for(Com::BufferParameters &buffer : kraut.Resources.Buffers.items())
+                kvkDestroyBuffer(buffer);
+
+            kraut.Resources = Com::ResourceParameters();
+
+            //Destroy Staging Buffer
+            if(kraut.StagingBuffer.Handle != VK_NULL_HANDLE) {
+                vkd.destroyBuffer(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Handle, nullptr);
+                kraut.StagingBuffer.Handle = VK_NULL_HANDLE;
+            }
+
+            if(kraut.StagingBuffer.Memory != VK_NULL_HANDLE) {
+                Com::MemoryParameters::Free(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Memory, nullptr);
+                kraut.StagingBuffer.Memory = VK_NULL_HANDLE;
+            }
+
+
+            //Destroy Sprite Resources, the per frame instance buffers go with the rendering resources and atlas pages
+            //are sprite textures
+            for(size_t i = 1; i < kraut.Sprites.Textures.size(); ++i)
+                kvkDestroyTexture(kraut.Sprites.Textures[i]);
+
+            kraut.Sprites.Textures.clear();
+            kraut.Atlas.Pages.clear();
+            kraut.Atlas.Textures.clear();
+            kraut.Sprites.Descriptors.clear();
+            kraut.Sprites.Pipelines.clear();
+
+            if(kraut.Sprites.Layout != VK_NULL_HANDLE) {
+                vkd.destroyPipelineLayout(kraut.Vulkan.Device.Handle, kraut.Sprites.Layout, nullptr);
+                kraut.Sprites.Layout = VK_NULL_HANDLE;
+            }
+
+            //Destroy Compute Path
+            kvkDestroyComputeTarget();
+
+            kvkDestroyDescriptorTemplate(kraut.Compute.Template);
+
+            if(kraut.Compute.Descriptor.Layout != VK_NULL_HANDLE) {
+                vkd.destroyDescriptorSetLayout(kraut.Vulkan.Device.Handle, kraut.Compute.Descriptor.Layout, nullptr);
+                kraut.Compute.Descriptor.Layout = VK_NULL_HANDLE;
+            }
+
+            if(kraut.Compute.Layout != VK_NULL_HANDLE) {
+                vkd.destroyPipelineLayout(kraut.Vulkan.Device.Handle, kraut.Compute.Layout, nullptr);
+                kraut.Compute.Layout = VK_NULL_HANDLE;
+            }
+
+            //Destroy Render Graph
+            kvkDestroyRenderGraphImages();
+
+            for(auto &renderPass : kraut.Graph.RenderPasses)
+                vkd.destroyRenderPass(kraut.Vulkan.Device.Handle, renderPass.second, nullptr);
+
+            kraut.Graph.RenderPasses.clear();
+
+            kraut.Graph.Descriptors.Destroy();
+
+            for(auto &layout : kraut.Graph.Layouts) {
+                kvkDestroyDescriptorTemplate(layout.second.Template);
+                vkd.destroyPipelineLayout(kraut.Vulkan.Device.Handle, layout.second.PipelineLayout, nullptr);
+                vkd.destroyDescriptorSetLayout(kraut.Vulkan.Device.Handle, layout.second.SetLayout, nullptr);
+            }
+
+            kraut.Graph.Layouts.clear();
+
+            kvkReleaseSampler(kraut.Graph.Sampler);
+
+            //Destroy Compositor, layer pipelines are cached variants and their sets came from the persistent allocator
+            for(Com::LayerParameters &layer : kraut.Compositor.Layers)
+                kvkDestroyLayer(layer);
+
+            kraut.Compositor.Layers.clear();
+            kraut.Compositor.FreeDescriptors.clear();
+
+            if(kraut.Compositor.RenderPass != VK_NULL_HANDLE) {
+                vkd.destroyRenderPass(kraut.Vulkan.Device.Handle, kraut.Compositor.RenderPass, nullptr);
+                kraut.Compositor.RenderPass = VK_NULL_HANDLE;
+            }
+
+            if(kraut.Compositor.Layout != VK_NULL_HANDLE) {
+                vkd.destroyPipelineLayout(kraut.Vulkan.Device.Handle, kraut.Compositor.Layout, nullptr);
+                kraut.Compositor.Layout = VK_NULL_HANDLE;
+            }
+
+            //Destroy Pipelines
+            for(auto &variant : kraut.Vulkan.PipelineVariants)
+                vkd.destroyPipeline(kraut.Vulkan.Device.Handle, variant.second, nullptr);
+
+            kraut.Vulkan.PipelineVariants.clear();
+            kraut.Vulkan.PipelineLastUsed.clear();
+            kraut.Vulkan.GraphicsPipeline = VK_NULL_HANDLE;
+
+            if(kraut.Vulkan.PipelineLayout != VK_NULL_HANDLE ) {
+                vkd.destroyPipelineLayout(kraut.Vulkan.Device.Handle, kraut.Vulkan.PipelineLayout, nullptr);
+                kraut.Vulkan.PipelineLayout = VK_NULL_HANDLE;
+            }
+
+            //Destroy Descriptor Sets, everything but the bindless table came out of the persistent allocator
+            kraut.Vulkan.PersistentDescriptors.Destroy();
+            kraut.Vulkan.Descriptor.Handle = VK_NULL_HANDLE;
+            kraut.Compute.Descriptor.Handle = VK_NULL_HANDLE;
+            kvkDestroyDescriptorTemplate(kraut.Vulkan.TextureTemplate);
+
+            if(kraut.Vulkan.Descriptor.Layout != VK_NULL_HANDLE ) {
+                vkd.destroyDescriptorSetLayout(kraut.Vulkan.Device.Handle, kraut.Vulkan.Descriptor.Layout, nullptr);
+                kraut.Vulkan.Descriptor.Layout = VK_NULL_HANDLE;
+            }
+
+            if(kraut.Bindless.Descriptor.Pool != VK_NULL_HANDLE) {
+                vkd.destroyDescriptorPool(kraut.Vulkan.Device.Handle, kraut.Bindless.Descriptor.Pool, nullptr);
+                kraut.Bindless.Descriptor.Pool = VK_NULL_HANDLE;
+            }
+
+            if(kraut.Bindless.Descriptor.Layout != VK_NULL_HANDLE) {
+                vkd.destroyDescriptorSetLayout(kraut.Vulkan.Device.Handle, kraut.Bindless.Descriptor.Layout, nullptr);
+                kraut.Bindless.Descriptor.Layout = VK_NULL_HANDLE;
+            }
+            kraut.Bindless.Count = 0;
+
+
+
+            //Destroy Dynamic Resolution, its pipeline is a cached variant and its set came from the persistent allocator
+            kvkDestroyDynamicResolutionTarget();
+            kraut.Dynamic.Active = false;
+
+            if(kraut.Dynamic.RenderPass != VK_NULL_HANDLE) {
+                vkd.destroyRenderPass(kraut.Vulkan.Device.Handle, kraut.Dynamic.RenderPass, nullptr);
+                kraut.Dynamic.RenderPass = VK_NULL_HANDLE;
+            }
+
+            if(kraut.Dynamic.Layout != VK_NULL_HANDLE) {
+                vkd.destroyPipelineLayout(kraut.Vulkan.Device.Handle, kraut.Dynamic.Layout, nullptr);
+                kraut.Dynamic.Layout = VK_NULL_HANDLE;
+            }
+
+            //Destroy Outputs, the readback buffers went with the rendering resources and the pipelines are cached variants
+            for(Com::OutputTargetParameters &target : kraut.Output.Targets)
+                kvkDestroyTexture(target.Image);
+
+            kraut.Output.Targets.clear();
+
+            if(kraut.Output.Layout != VK_NULL_HANDLE) {
+                vkd.destroyPipelineLayout(kraut.Vulkan.Device.Handle, kraut.Output.Layout, nullptr);
+                kraut.Output.Layout = VK_NULL_HANDLE;
+            }
+
+            if(kraut.Output.DownsampleLayout != VK_NULL_HANDLE) {
+                vkd.destroyPipelineLayout(kraut.Vulkan.Device.Handle, kraut.Output.DownsampleLayout, nullptr);
+                kraut.Output.DownsampleLayout = VK_NULL_HANDLE;
+            }
+
+            if(kraut.Output.Pool != VK_NULL_HANDLE) {
+                vkd.destroyDescriptorPool(kraut.Vulkan.Device.Handle, kraut.Output.Pool, nullptr);
+                kraut.Output.Pool = VK_NULL_HANDLE;
+            }
+
+            if(kraut.Output.SetLayout != VK_NULL_HANDLE) {
+                vkd.destroyDescriptorSetLayout(kraut.Vulkan.Device.Handle, kraut.Output.SetLayout, nullptr);
+                kraut.Output.SetLayout = VK_NULL_HANDLE;
+            }
+
+            if(kraut.Output.DownsampleSetLayout != VK_NULL_HANDLE) {
+                vkd.destroyDescriptorSetLayout(kraut.Vulkan.Device.Handle, kraut.Output.DownsampleSetLayout, nullptr);
+                kraut.Output.DownsampleSetLayout = VK_NULL_HANDLE;
+            }
+
+            //Destroy Offscreen Target
+            kvkDestroyTexture(kraut.Offscreen.Target);
+            kraut.Offscreen.Active = false;
+
+            if(kraut.Offscreen.RenderPass != VK_NULL_HANDLE) {
+                vkd.destroyRenderPass(kraut.Vulkan.Device.Handle, kraut.Offscreen.RenderPass, nullptr);
+                kraut.Offscreen.RenderPass = VK_NULL_HANDLE;
+            }
+
+            //Destroy Renderpass
+            if(kraut.Vulkan.RenderPass != VK_NULL_HANDLE) {
+                vkd.destroyRenderPass(kraut.Vulkan.Device.Handle, kraut.Vulkan.RenderPass, nullptr);
+                kraut.Vulkan.RenderPass = VK_NULL_HANDLE;
+            }
+
+            //Destroy Swapchain
+            if (kraut.Vulkan.SwapChain.Handle != VK_NULL_HANDLE) {
+                vkd.destroySwapchainKHR(kraut.Vulkan.Device.Handle, kraut.Vulkan.SwapChain.Handle, nullptr);
+            }
+
+            //Everything released above or in earlier frames, the device is idle
+            kraut.Vulkan.Deletions.flush();
+
+            //Destroy Device, unless another context still renders on it. Samplers still cached were never released,
+            //the device is going away either way
+            if (kvkFindSharedDevice() == nullptr) {
+                if (kraut.Vulkan.Device.Shared) {
+                    for(auto &sampler : kraut.Vulkan.Device.Shared->Samplers)
+                        vkd.destroySampler(kraut.Vulkan.Device.Handle, sampler.second.Handle, nullptr);
+
+                    kraut.Vulkan.Device.Shared->Samplers.clear();
+
+                    if (kraut.Vulkan.Device.Shared->PipelineCache != VK_NULL_HANDLE)
+                        vkd.destroyPipelineCache(kraut.Vulkan.Device.Handle, kraut.Vulkan.Device.Shared->PipelineCache, nullptr);
+                }
+
+                vkd.destroyDevice(kraut.Vulkan.Device.Handle, nullptr);
+            }
+        }
+
+        //Destroy Application Surface
+        if (kraut.Vulkan.ApplicationSurface != VK_NULL_HANDLE) {
+            vki.destroySurfaceKHR(kraut.Vulkan.Instance, kraut.Vulkan.ApplicationSurface, nullptr);
+        }
+
+        if (kvkFindSharedDevice() == nullptr) {
+            //Destroy Vulkan Instance
+            if (kraut.Vulkan.Instance != VK_NULL_HANDLE) {
+                vki.destroyInstance(kraut.Vulkan.Instance, nullptr);
+            }
+
+            //Terminate GLFW
+            glfwTerminate();
+        }
+        else if (kraut.GLFW.Window != nullptr) {
+            glfwDestroyWindow(kraut.GLFW.Window);
+        }
+
+        //Leave the context as it was created so it can be initialized again
+        *Com::Current = Com::KrautCommon();
+
+    }
+
+    bool KrautVK::kvkLayoutDescriptorSet() {
+        VkDescriptorSetLayoutBinding layoutBinding = {
+                0,                                          // uint32_t             binding
+                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,  // VkDescriptorType     descriptorType
+                1,                                          // uint32_t             descriptorCount
+                VK_SHADER_STAGE_FRAGMENT_BIT,               // VkShaderStageFlags   stageFlags
+                nullptr                                     // const VkSampler     *pImmutableSamplers
+        };
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+                VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,  // VkStructureType                      sType
+                nullptr,                                              // const void                          *pNext
+                0,                                                    // VkDescriptorSetLayoutCreateFlags     flags
+                1,                                                    // uint32_t                             bindingCount
+                &layoutBinding                                        // const VkDescriptorSetLayoutBinding  *pBindings
+        };
+
+        return !(vkd.createDescriptorSetLayout(kraut.Vulkan.Device.Handle, &descriptorSetLayoutCreateInfo, nullptr, &kraut.Vulkan.Descriptor.Layout ) != VK_SUCCESS);
+
+    }
+
+    bool KrautVK::kvkCreateDescriptorTemplate(VkDescriptorSetLayout layout, Com::DescriptorTemplate &descriptorTemplate) {
+        //Without templates every update falls back on vkUpdateDescriptorSets
+        if(kraut.Vulkan.Device.Properties.apiVersion < VK_API_VERSION_1_1 ||
+           !vkd.resolve(vkd.createDescriptorUpdateTemplate, "vkCreateDescriptorUpdateTemplate") ||
+           !vkd.resolve(vkd.updateDescriptorSetWithTemplate, "vkUpdateDescriptorSetWithTemplate") ||
+           !vkd.resolve(vkd.destroyDescriptorUpdateTemplate, "vkDestroyDescriptorUpdateTemplate"))
+            return true;
+
+        //The data passed to the template is one VkDescriptorImageInfo per binding
+        std::vector<VkDescriptorUpdateTemplateEntry> entries(descriptorTemplate.Bindings.size());
+        for(size_t i = 0; i < entries.size(); ++i) {
+            entries[i] = {
+                    static_cast<uint32_t>(i),                       // uint32_t                       dstBinding
+                    0,                                              // uint32_t                       dstArrayElement
+                    1,                                              // uint32_t                       descriptorCount
+                    descriptorTemplate.Bindings[i],                 // VkDescriptorType               descriptorType
+                    i * sizeof(VkDescriptorImageInfo),              // size_t                         offset
+                    sizeof(VkDescriptorImageInfo)                   // size_t                         stride
+            };
+        }
+
+        VkDescriptorUpdateTemplateCreateInfo templateCreateInfo = {
+                VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,   // VkStructureType                          sType
+                nullptr,                                                    // const void                              *pNext
+                0,                                                          // VkDescriptorUpdateTemplateCreateFlags    flags
+                static_cast<uint32_t>(entries.size()),                      // uint32_t                                 descriptorUpdateEntryCount
+                entries.data(),                                             // const VkDescriptorUpdateTemplateEntry   *pDescriptorUpdateEntries
+                VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,          // VkDescriptorUpdateTemplateType           templateType
+                layout,                                                     // VkDescriptorSetLayout                    descriptorSetLayout
+                VK_PIPELINE_BIND_POINT_GRAPHICS,                            // VkPipelineBindPoint                      pipelineBindPoint
+                VK_NULL_HANDLE,                                             // VkPipelineLayout                         pipelineLayout
+                0                                                           // uint32_t                                 set
+        };
+
+        return vkd.createDescriptorUpdateTemplate(kraut.Vulkan.Device.Handle, &templateCreateInfo, nullptr, &descriptorTemplate.Handle) == VK_SUCCESS;
+    }
+
+    void KrautVK::kvkUpdateDescriptorTemplate(VkDescriptorSet set, const Com::DescriptorTemplate &descriptorTemplate, const VkDescriptorImageInfo *imageInfos) {
+        if(descriptorTemplate.Handle != VK_NULL_HANDLE) {
+            vkd.updateDescriptorSetWithTemplate(kraut.Vulkan.Device.Handle, set, descriptorTemplate.Handle, imageInfos);
+            return;
+        }
+
+        std::vector<VkWriteDescriptorSet> descriptorWrites(descriptorTemplate.Bindings.size());
+        for(size_t i = 0; i < descriptorWrites.size(); ++i) {
+            descriptorWrites[i] = {
+                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,     // VkStructureType                sType
+                    nullptr,                                    // const void                    *pNext
+                    set,                                        // VkDescriptorSet                dstSet
+                    static_cast<uint32_t>(i),                   // uint32_t                       dstBinding
+                    0,                                          // uint32_t                       dstArrayElement
+                    1,                                          // uint32_t                       descriptorCount
+                    descriptorTemplate.Bindings[i],             // VkDescriptorType               descriptorType
+                    &imageInfos[i],                             // const VkDescriptorImageInfo   *pImageInfo
+                    nullptr,                                    // const VkDescriptorBufferInfo  *pBufferInfo
+                    nullptr                                     // const VkBufferView            *pTexelBufferView
+            };
+        }
+
+        vkd.updateDescriptorSets(kraut.Vulkan.Device.Handle, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    }
+
+    void KrautVK::kvkDestroyDescriptorTemplate(Com::DescriptorTemplate &descriptorTemplate) {
+        if(descriptorTemplate.Handle != VK_NULL_HANDLE) {
+            vkd.destroyDescriptorUpdateTemplate(kraut.Vulkan.Device.Handle, descriptorTemplate.Handle, nullptr);
+            descriptorTemplate.Handle = VK_NULL_HANDLE;
+        }
+    }
+
+    bool KrautVK::kvkAllocateDescriptorSet() {
+        return kraut.Vulkan.PersistentDescriptors.Allocate(kraut.Vulkan.Descriptor.Layout, &kraut.Vulkan.Descriptor.Handle);
+    }
+
+    void KrautVK::kvkUpdateDescriptorSet() {
+        const Com::ImageParameters &demoImage = *kraut.Resources.Images.get(kraut.Resources.DemoImage);
+
+        VkDescriptorImageInfo imageInfo = {
+                demoImage.Sampler,                                       // VkSampler                      sampler
+                demoImage.View,                                          // VkImageView                    imageView
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL                 // VkImageLayout                  imageLayout
+        };
+
+        kvkUpdateDescriptorTemplate(kraut.Vulkan.Descriptor.Handle, kraut.Vulkan.TextureTemplate, &imageInfo);
+    }
+
+    //The layout is all the pipelines need, the set itself waits for the demo texture
+    int KrautVK::kvkCreateDescriptorLayout() {
+
+        if(!kvkLayoutDescriptorSet())
+            return VULKAN_DESCRIPTOR_SET_CREATION_FAILED;
+
+        kraut.Vulkan.TextureTemplate.Bindings = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER};
+        if(!kvkCreateDescriptorTemplate(kraut.Vulkan.Descriptor.Layout, kraut.Vulkan.TextureTemplate))
+            return VULKAN_DESCRIPTOR_SET_CREATION_FAILED;
+
+        return SUCCESS;
+    }
+
+    int KrautVK::kvkCreateDescriptorSet() {
+
+        if(!kvkAllocateDescriptorSet())
+            return VULKAN_DESCRIPTOR_SET_CREATION_FAILED;
+
+        kvkUpdateDescriptorSet();
+        return SUCCESS;
+    }
+
+    bool KrautVK::kvkCreateRenderGraphRenderPass(VkFormat format, VkRenderPass *renderPass) {
+        //Graph passes cover the whole image, so old contents are never loaded. Layout transitions are left to the
+        //barriers the graph computes, so the attachment stays in COLOR_ATTACHMENT_OPTIMAL for the whole pass
+        VkAttachmentDescription attachmentDescription = {
+                0,                                          // VkAttachmentDescriptionFlags   flags
+                format,                                     // VkFormat                       format
+                VK_SAMPLE_COUNT_1_BIT,                      // VkSampleCountFlagBits          samples
+                VK_ATTACHMENT_LOAD_OP_DONT_CARE,            // VkAttachmentLoadOp             loadOp
+                VK_ATTACHMENT_STORE_OP_STORE,               // VkAttachmentStoreOp            storeOp
+                VK_ATTACHMENT_LOAD_OP_DONT_CARE,            // VkAttachmentLoadOp             stencilLoadOp
+                VK_ATTACHMENT_STORE_OP_DONT_CARE,           // VkAttachmentStoreOp            stencilStoreOp
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,   // VkImageLayout                  initialLayout;
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL    // VkImageLayout                  finalLayout
+        };
+
+        VkAttachmentReference colorAttachmentReference = {
+                0,                                          // uint32_t                       attachment
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL    // VkImageLayout                  layout
+        };
+
+        VkSubpassDescription subpassDescription = {
+                0,                                          // VkSubpassDescriptionFlags      flags
+                VK_PIPELINE_BIND_POINT_GRAPHICS,            // VkPipelineBindPoint            pipelineBindPoint
+                0,                                          // uint32_t                       inputAttachmentCount
+                nullptr,                                    // const VkAttachmentReference   *pInputAttachments
+                1,                                          // uint32_t                       colorAttachmentCount
+                &colorAttachmentReference,                  // const VkAttachmentReference   *pColorAttachments
+                nullptr,                                    // const VkAttachmentReference   *pResolveAttachments
+                nullptr,                                    // const VkAttachmentReference   *pDepthStencilAttachment
+                0,                                          // uint32_t                       preserveAttachmentCount
+                nullptr                                     // const uint32_t*                pPreserveAttachments
+        };
+
+        VkRenderPassCreateInfo renderPassCreateInfo = {
+                VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,    // VkStructureType                sType
+                nullptr,                                      // const void                    *pNext
+                0,                                            // VkRenderPassCreateFlags        flags
+                1,                                            // uint32_t                       attachmentCount
+                &attachmentDescription,                       // const VkAttachmentDescription *pAttachments
+                1,                                            // uint32_t                       subpassCount
+                &subpassDescription,                          // const VkSubpassDescription    *pSubpasses
+                0,                                            // uint32_t                       dependencyCount
+                nullptr                                       // const VkSubpassDependency     *pDependencies
+        };
+
+        return vkd.createRenderPass(kraut.Vulkan.Device.Handle, &renderPassCreateInfo, nullptr, renderPass) == VK_SUCCESS;
+    }
+
+    bool KrautVK::kvkGetRenderGraphLayout(uint32_t inputCount, Com::RenderGraphLayout &layout) {
+        std::unordered_map<uint32_t, Com::RenderGraphLayout>::iterator cached = kraut.Graph.Layouts.find(inputCount);
+        if(cached != kraut.Graph.Layouts.end()) {
+            layout = cached->second;
+            return true;
+        }
+
+        //Input i of a pass is bound as a combined image sampler at binding i
+        std::vector<VkDescriptorSetLayoutBinding> layoutBindings(inputCount);
+        for(uint32_t i = 0; i < inputCount; ++i) {
+            layoutBindings[i] = {
+                    i,                                          // uint32_t             binding
+                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,  // VkDescriptorType     descriptorType
+                    1,                                          // uint32_t             descriptorCount
+                    VK_SHADER_STAGE_FRAGMENT_BIT,               // VkShaderStageFlags   stageFlags
+                    nullptr                                     // const VkSampler     *pImmutableSamplers
+            };
+        }
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+                VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,  // VkStructureType                      sType
+                nullptr,                                              // const void                          *pNext
+                0,                                                    // VkDescriptorSetLayoutCreateFlags     flags
+                inputCount,                                           // uint32_t                             bindingCount
+                layoutBindings.data()                                 // const VkDescriptorSetLayoutBinding  *pBindings
+        };
+
+        Com::RenderGraphLayout newLayout;
+        if(vkd.createDescriptorSetLayout(kraut.Vulkan.Device.Handle, &descriptorSetLayoutCreateInfo, nullptr, &newLayout.SetLayout) != VK_SUCCESS)
+            return false;
+
+        VkPipelineLayoutCreateInfo layoutCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,  // VkStructureType                sType
+                nullptr,                                        // const void                    *pNext
+                0,                                              // VkPipelineLayoutCreateFlags    flags
+                1,                                              // uint32_t                       setLayoutCount
+                &newLayout.SetLayout,                           // const VkDescriptorSetLayout   *pSetLayouts
+                0,                                              // uint32_t                       pushConstantRangeCount
+                nullptr                                         // const VkPushConstantRange     *pPushConstantRanges
         };
 
-        return createImage(kraut.Vulkan.Device.Handle, &imageCreateInfo, nullptr, image) == VK_SUCCESS;
+        if(vkd.createPipelineLayout(kraut.Vulkan.Device.Handle, &layoutCreateInfo, nullptr, &newLayout.PipelineLayout) != VK_SUCCESS) {
+            vkd.destroyDescriptorSetLayout(kraut.Vulkan.Device.Handle, newLayout.SetLayout, nullptr);
+            return false;
+        }
+
+        newLayout.Template.Bindings.assign(inputCount, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+        if(inputCount > 0 && !kvkCreateDescriptorTemplate(newLayout.SetLayout, newLayout.Template)) {
+            vkd.destroyPipelineLayout(kraut.Vulkan.Device.Handle, newLayout.PipelineLayout, nullptr);
+            vkd.destroyDescriptorSetLayout(kraut.Vulkan.Device.Handle, newLayout.SetLayout, nullptr);
+            return false;
+        }
 
+        kraut.Graph.Layouts[inputCount] = newLayout;
+        layout = newLayout;
+        return true;
     }
 
-    bool KrautVK::kvkAllocateImageMemory(VkImage image, VkMemoryPropertyFlagBits property, VkDeviceMemory *memory) {
-        // Get the memory requirements from the device
-        VkMemoryRequirements imageMemoryRequirements;
-        getImageMemoryRequirements(kraut.Vulkan.Device.Handle, image, &imageMemoryRequirements);
+    void KrautVK::kvkDestroyRenderGraphImages() {
+        for(Com::RenderGraphPassResources &pass : kraut.Graph.Passes) {
+            if(pass.Framebuffer[1] == pass.Framebuffer[0])
+                pass.Framebuffer[1] = VK_NULL_HANDLE;
 
-        //Find the right memory type that is compatible with our needs and is supported by the hardware
-        for(uint32_t i = 0; i < kraut.Vulkan.Device.MemoryProperties.memoryTypeCount; ++i) {
-            if((imageMemoryRequirements.memoryTypeBits & (1 << i)) && (kraut.Vulkan.Device.MemoryProperties.memoryTypes[i].propertyFlags & property)) {
+            kvkDeferDestroy(pass.Framebuffer[0], vkd.destroyFramebuffer);
+            kvkDeferDestroy(pass.Framebuffer[1], vkd.destroyFramebuffer);
+        }
+        kraut.Graph.Passes.clear();
 
-                VkMemoryAllocateInfo memoryAllocateInfo = {
-                        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, // VkStructureType  sType
-                        nullptr,                                // const void      *pNext
-                        imageMemoryRequirements.size,           // VkDeviceSize     allocationSize
-                        i                                       // uint32_t         memoryTypeIndex
-                };
+        //Keeps the pools around for the next build
+        kraut.Graph.Descriptors.Reset();
 
-                if(allocateMemory(kraut.Vulkan.Device.Handle, &memoryAllocateInfo, nullptr, memory) == VK_SUCCESS ) {
-                    return true;
+        for(std::vector<Com::ImageParameters> *images : {&kraut.Graph.Images, &kraut.Graph.History}) {
+            for(Com::ImageParameters &image : *images) {
+                kvkDeferDestroy(image.View, vkd.destroyImageView);
+                kvkDeferDestroy(image.Handle, vkd.destroyImage);
+            }
+            images->clear();
+        }
+
+        for(VkDeviceMemory &memory : kraut.Graph.Memory)
+            kvkDeferDestroy(memory, Com::MemoryParameters::Free);
+
+        kraut.Graph.Memory.clear();
+    }
+
+    //(Re)creates everything in the graph that depends on the swap chain extent. Expects a compiled graph
+    bool KrautVK::kvkCreateRenderGraphImages() {
+        kvkDeviceWaitIdle();
+        kvkDestroyRenderGraphImages();
+
+        const RenderGraph &graph = kraut.Graph.Graph;
+        const std::vector<RenderGraph::Resource> &resources = graph.resources();
+        const std::vector<uint32_t> &order = graph.order();
+        const VkExtent2D extent = kvkGetRenderExtent();
+
+        kraut.Graph.Images.resize(resources.size());
+        kraut.Graph.History.resize(resources.size());
+
+        //Images in the same alias slot share one allocation, sized for the largest of them. An image whose memory
+        //types don't agree with the rest of its slot gets an allocation of its own
+        std::vector<VkMemoryRequirements> allocations(graph.aliasSlotCount(), {0, 0, UINT32_MAX});
+        std::vector<uint32_t> allocationIndex(resources.size(), RenderGraph::Unused);
+        std::vector<bool> slotHasExclusive(graph.aliasSlotCount(), false);
+
+        for(uint32_t i = 0; i < resources.size(); ++i) {
+            if(i == RenderGraph::Backbuffer || resources[i].FirstUse == RenderGraph::Unused || resources[i].Feedback)
+                continue;
+
+            if(!kvkCreateImage(extent.width, extent.height, resources[i].Format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, &kraut.Graph.Images[i].Handle))
+                return false;
+
+            VkMemoryRequirements requirements;
+            vkd.getImageMemoryRequirements(kraut.Vulkan.Device.Handle, kraut.Graph.Images[i].Handle, &requirements);
+
+            VkMemoryRequirements &slot = allocations[resources[i].AliasSlot];
+            if((slot.memoryTypeBits & requirements.memoryTypeBits) != 0) {
+                slot.size = std::max(slot.size, requirements.size);
+                slot.alignment = std::max(slot.alignment, requirements.alignment);
+                slot.memoryTypeBits &= requirements.memoryTypeBits;
+                allocationIndex[i] = resources[i].AliasSlot;
+            } else {
+                allocationIndex[i] = static_cast<uint32_t>(allocations.size());
+                allocations.push_back(requirements);
+            }
+        }
+
+        kraut.Graph.Memory.resize(allocations.size(), VK_NULL_HANDLE);
+        for(size_t i = 0; i < allocations.size(); ++i) {
+            if(!kvkAllocateMemory(allocations[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &kraut.Graph.Memory[i]))
+                return false;
+        }
+
+        for(uint32_t i = 0; i < resources.size(); ++i) {
+            if(allocationIndex[i] == RenderGraph::Unused)
+                continue;
+
+            if(vkd.bindImageMemory(kraut.Vulkan.Device.Handle, kraut.Graph.Images[i].Handle, kraut.Graph.Memory[allocationIndex[i]], 0) != VK_SUCCESS)
+                return false;
+
+            if(!kvkCreateImageView(kraut.Graph.Images[i], resources[i].Format))
+                return false;
+        }
+
+        //Feedback images outlive the frame, so both of their images get memory of their own
+        for(uint32_t i = 0; i < resources.size(); ++i) {
+            if(!resources[i].Feedback || resources[i].FirstUse == RenderGraph::Unused)
+                continue;
+
+            if(!kvkCheckFormatFeatures(kraut.Vulkan.Device.PhysicalDevice, resources[i].Format, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+                std::cout << "Render graph feedback image " << resources[i].Name << " has a format the device can't render to and sample" << std::endl;
+                return false;
+            }
+
+            for(Com::ImageParameters *image : {&kraut.Graph.Images[i], &kraut.Graph.History[i]}) {
+                if(!kvkCreateImage(extent.width, extent.height, resources[i].Format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, &image->Handle))
+                    return false;
+
+                VkMemoryRequirements requirements;
+                vkd.getImageMemoryRequirements(kraut.Vulkan.Device.Handle, image->Handle, &requirements);
+
+                kraut.Graph.Memory.push_back(VK_NULL_HANDLE);
+                if(!kvkAllocateMemory(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &kraut.Graph.Memory.back()))
+                    return false;
+
+                if(vkd.bindImageMemory(kraut.Vulkan.Device.Handle, image->Handle, kraut.Graph.Memory.back(), 0) != VK_SUCCESS)
+                    return false;
+
+                if(!kvkCreateImageView(*image, resources[i].Format))
+                    return false;
+            }
+        }
+
+        if(kraut.Graph.Sampler == VK_NULL_HANDLE && !kvkAcquireSampler(&kraut.Graph.Sampler))
+            return false;
+
+        kraut.Graph.Passes.resize(order.size());
+        for(size_t i = 0; i < order.size(); ++i) {
+            const RenderGraph::Pass &pass = graph.passes()[order[i]];
+            Com::RenderGraphPassResources &passResources = kraut.Graph.Passes[i];
+            uint32_t inputCount = static_cast<uint32_t>(pass.Inputs.size());
+
+            Com::RenderGraphLayout layout;
+            if(!kvkGetRenderGraphLayout(inputCount, layout))
+                return false;
+
+            passResources.Layout = layout.PipelineLayout;
+
+            if(pass.Output == RenderGraph::Backbuffer) {
+                passResources.RenderPass = kraut.Vulkan.RenderPass;
+            } else {
+                VkFormat format = resources[pass.Output].Format;
+                std::unordered_map<uint32_t, VkRenderPass>::iterator renderPass = kraut.Graph.RenderPasses.find(static_cast<uint32_t>(format));
+
+                if(renderPass != kraut.Graph.RenderPasses.end()) {
+                    passResources.RenderPass = renderPass->second;
+                } else {
+                    if(!kvkCreateRenderGraphRenderPass(format, &passResources.RenderPass))
+                        return false;
+
+                    kraut.Graph.RenderPasses[static_cast<uint32_t>(format)] = passResources.RenderPass;
                 }
+
+                const bool feedbackOutput = resources[pass.Output].Feedback;
+                for(uint32_t parity = 0; parity < (feedbackOutput ? 2u : 1u); ++parity) {
+                    VkFramebufferCreateInfo framebufferCreateInfo = {
+                            VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,      // VkStructureType                sType
+                            nullptr,                                        // const void                    *pNext
+                            0,                                              // VkFramebufferCreateFlags       flags
+                            passResources.RenderPass,                       // VkRenderPass                   renderPass
+                            1,                                              // uint32_t                       attachmentCount
+                            &kvkGetRenderGraphImage(pass.Output, parity).View, // const VkImageView             *pAttachments
+                            extent.width,                                   // uint32_t                       width
+                            extent.height,                                  // uint32_t                       height
+                            1                                               // uint32_t                       layers
+                    };
+
+                    if(vkd.createFramebuffer(kraut.Vulkan.Device.Handle, &framebufferCreateInfo, nullptr, &passResources.Framebuffer[parity]) != VK_SUCCESS)
+                        return false;
+                }
+
+                if(!feedbackOutput)
+                    passResources.Framebuffer[1] = passResources.Framebuffer[0];
+            }
+
+            Com::PipelineVariantKey key;
+            key.VertexShader = KVK_VERTEX_SHADER;
+            key.FragmentShader = pass.FragmentShader;
+            key.RenderPass = passResources.RenderPass;
+            key.Layout = passResources.Layout;
+
+            if(kvkCreateGraphicsPipeline(key, passResources.Pipeline) != SUCCESS)
+                return false;
+
+            if(inputCount == 0)
+                continue;
+
+            //A pass reading its own output samples the other image of the pair
+            const bool feedbackInput = std::any_of(pass.Inputs.begin(), pass.Inputs.end(), [&resources](uint32_t input) { return resources[input].Feedback; });
+            std::vector<VkDescriptorImageInfo> imageInfos(inputCount);
+            for(uint32_t parity = 0; parity < (feedbackInput ? 2u : 1u); ++parity) {
+                if(!kraut.Graph.Descriptors.Allocate(layout.SetLayout, &passResources.Descriptor[parity]))
+                    return false;
+
+                for(uint32_t j = 0; j < inputCount; ++j) {
+                    const uint32_t input = pass.Inputs[j];
+                    imageInfos[j] = {
+                            kraut.Graph.Sampler,                            // VkSampler                      sampler
+                            kvkGetRenderGraphImage(input, input == pass.Output ? parity ^ 1u : parity).View, // VkImageView                    imageView
+                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL        // VkImageLayout                  imageLayout
+                    };
+                }
+
+                kvkUpdateDescriptorTemplate(passResources.Descriptor[parity], layout.Template, imageInfos.data());
             }
+
+            if(!feedbackInput)
+                passResources.Descriptor[1] = passResources.Descriptor[0];
         }
-        return false;
 
+        //New feedback images hold garbage, the first frame clears them
+        kraut.Graph.Parity = 0;
+        kraut.Graph.ClearFeedback = graph.hasFeedback();
 
+        return true;
     }
 
-    int KrautVK::kvkCreateTexture(const std::string relPath, Com::ImageParameters &image) {
-        int width = 0;
-        int height = 0;
-        int dataSize = 0;
+    //The image a resource is written to in frames of the given parity. Only feedback images alternate
+    Com::ImageParameters &KrautVK::kvkGetRenderGraphImage(uint32_t resource, uint32_t parity) {
+        return parity != 0 && kraut.Graph.Graph.resources()[resource].Feedback ? kraut.Graph.History[resource] : kraut.Graph.Images[resource];
+    }
 
-        std::vector<char> textureData = Tools::getImageData(Tools::rootPath + relPath, 4, &width, &height, nullptr, &dataSize);
+    //Both images of every feedback resource go to zero and are left the way the end of a frame leaves them
+    void KrautVK::kvkClearRenderGraphFeedback(VkCommandBuffer commandBuffer) {
+        const std::vector<RenderGraph::Resource> &resources = kraut.Graph.Graph.resources();
 
-        if(!kvkCreateImage(static_cast<const uint32_t &>(width), static_cast<const uint32_t &>(height), &image.Handle))
-            return VULKAN_TEXTURE_CREATION_FAILED;
+        VkImageSubresourceRange imageSubresourceRange = {
+                VK_IMAGE_ASPECT_COLOR_BIT,                          // VkImageAspectFlags                     aspectMask
+                0,                                                  // uint32_t                               baseMipLevel
+                1,                                                  // uint32_t                               levelCount
+                0,                                                  // uint32_t                               baseArrayLayer
+                1                                                   // uint32_t                               layerCount
+        };
 
-        if(!kvkAllocateImageMemory(image.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &image.Memory))
-            return VULKAN_TEXTURE_CREATION_FAILED;
+        std::vector<VkImageMemoryBarrier> barriersToTransfer;
+        std::vector<VkImageMemoryBarrier> barriersFromTransfer;
+        for(uint32_t i = 0; i < resources.size(); ++i) {
+            if(!resources[i].Feedback || resources[i].FirstUse == RenderGraph::Unused)
+                continue;
+
+            for(uint32_t parity = 0; parity < 2; ++parity) {
+                VkImage image = kvkGetRenderGraphImage(i, parity).Handle;
+
+                barriersToTransfer.push_back({
+                        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                        nullptr,                                          // const void                            *pNext
+                        0,                                                // VkAccessFlags                          srcAccessMask
+                        VK_ACCESS_TRANSFER_WRITE_BIT,                     // VkAccessFlags                          dstAccessMask
+                        VK_IMAGE_LAYOUT_UNDEFINED,                        // VkImageLayout                          oldLayout
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,             // VkImageLayout                          newLayout
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                        image,                                            // VkImage                                image
+                        imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
+                });
+
+                barriersFromTransfer.push_back({
+                        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                        nullptr,                                          // const void                            *pNext
+                        VK_ACCESS_TRANSFER_WRITE_BIT,                     // VkAccessFlags                          srcAccessMask
+                        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, // VkAccessFlags                          dstAccessMask
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,             // VkImageLayout                          oldLayout
+                        resources[i].FinalLayout,                         // VkImageLayout                          newLayout
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                        image,                                            // VkImage                                image
+                        imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
+                });
+            }
+        }
 
-        if(bindImageMemory(kraut.Vulkan.Device.Handle, image.Handle, image.Memory, 0) != VK_SUCCESS)
-            return VULKAN_TEXTURE_CREATION_FAILED;
+        kraut.Graph.ClearFeedback = false;
+        if(barriersToTransfer.empty())
+            return;
 
-        if(!kvkCreateImageView(image, VK_FORMAT_R8G8B8A8_UNORM))
-            return VULKAN_TEXTURE_CREATION_FAILED;
+        //Earlier frames may still be reading or writing them
+        vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                               0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriersToTransfer.size()), barriersToTransfer.data());
 
-        if(!kvkCreateSampler(&image.Sampler))
-            return VULKAN_TEXTURE_CREATION_FAILED;
+        VkClearColorValue clearColor = {};
+        for(const VkImageMemoryBarrier &barrier : barriersToTransfer)
+            vkd.cmdClearColorImage(commandBuffer, barrier.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1, &imageSubresourceRange);
 
-        if(!kvkCopyTextureToGPU(image, textureData.data(), static_cast<uint32_t>(dataSize), static_cast<uint32_t>(width), static_cast<uint32_t>(height))){
-            return VULKAN_TEXTURE_CREATION_FAILED;
+        vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                               0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriersFromTransfer.size()), barriersFromTransfer.data());
+    }
+
+    void KrautVK::kvkRecordRenderGraph(VkCommandBuffer commandBuffer) {
+        const RenderGraph &graph = kraut.Graph.Graph;
+        const std::vector<uint32_t> &order = graph.order();
+        const VkExtent2D extent = kvkGetRenderExtent();
+
+        VkImageSubresourceRange imageSubresourceRange = {
+                VK_IMAGE_ASPECT_COLOR_BIT,                          // VkImageAspectFlags                     aspectMask
+                0,                                                  // uint32_t                               baseMipLevel
+                1,                                                  // uint32_t                               levelCount
+                0,                                                  // uint32_t                               baseArrayLayer
+                1                                                   // uint32_t                               layerCount
+        };
+
+        VkViewport viewport = {
+                0.0f,                                               // float                                  x
+                0.0f,                                               // float                                  y
+                static_cast<float>(extent.width),                   // float                                  width
+                static_cast<float>(extent.height),                  // float                                  height
+                0.0f,                                               // float                                  minDepth
+                1.0f                                                // float                                  maxDepth
+        };
+
+        VkRect2D renderArea = {
+                {0, 0},                                             // VkOffset2D                             offset
+                extent                                              // VkExtent2D                             extent
+        };
+
+        //Last frame's writes become this frame's previous images
+        if(graph.hasFeedback())
+            kraut.Graph.Parity ^= 1;
+
+        if(kraut.Graph.ClearFeedback)
+            kvkClearRenderGraphFeedback(commandBuffer);
+
+        const uint32_t parity = kraut.Graph.Parity;
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+
+        for(size_t i = 0; i < order.size(); ++i) {
+            const RenderGraph::BarrierBatch &batch = graph.barriers()[i];
+
+            if(!batch.Barriers.empty()) {
+                imageBarriers.clear();
+
+                for(const RenderGraph::Barrier &barrier : batch.Barriers) {
+                    imageBarriers.push_back({
+                            VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                            nullptr,                                          // const void                            *pNext
+                            barrier.SrcAccess,                                // VkAccessFlags                          srcAccessMask
+                            barrier.DstAccess,                                // VkAccessFlags                          dstAccessMask
+                            barrier.OldLayout,                                // VkImageLayout                          oldLayout
+                            barrier.NewLayout,                                // VkImageLayout                          newLayout
+                            VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                            VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                            kvkGetRenderGraphImage(barrier.Resource, barrier.Previous ? parity ^ 1u : parity).Handle, // VkImage                                image
+                            imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
+                    });
+                }
+
+                vkd.cmdPipelineBarrier(commandBuffer, batch.SrcStages, batch.DstStages, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+            }
+
+            //The final pass is drawn by the main render pass
+            if(graph.passes()[order[i]].Output == RenderGraph::Backbuffer)
+                break;
+
+            const Com::RenderGraphPassResources &pass = kraut.Graph.Passes[i];
+
+            VkRenderPassBeginInfo renderPassBeginInfo = {
+                    VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,           // VkStructureType                        sType
+                    nullptr,                                            // const void                            *pNext
+                    pass.RenderPass,                                    // VkRenderPass                           renderPass
+                    pass.Framebuffer[parity],                           // VkFramebuffer                          framebuffer
+                    renderArea,                                         // VkRect2D                               renderArea
+                    0,                                                  // uint32_t                               clearValueCount
+                    nullptr                                             // const VkClearValue                    *pClearValues
+            };
+
+            vkd.cmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+            vkd.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pass.Pipeline);
+            vkd.cmdSetViewport(commandBuffer, 0, 1, &viewport);
+            vkd.cmdSetScissor(commandBuffer, 0, 1, &renderArea);
+
+            VkDeviceSize offset = 0;
+            vkd.cmdBindVertexBuffers(commandBuffer, 0, 1, &kraut.Resources.Buffers.get(kraut.Resources.DemoVertexBuffer)->Handle, &offset);
+
+            if(pass.Descriptor[parity] != VK_NULL_HANDLE)
+                vkd.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pass.Layout, 0, 1, &pass.Descriptor[parity], 0, nullptr);
+
+            vkd.cmdDraw(commandBuffer, KVK_VERTEX_COUNT, KVK_INSTANCE_COUNT, 0, 0);
+            vkd.cmdEndRenderPass(commandBuffer);
+        }
+    }
+
+    void KrautVK::kvkRenderGraphReset() {
+        if(kraut.Vulkan.Device.Handle != VK_NULL_HANDLE) {
+            kvkDeviceWaitIdle();
+            kvkDestroyRenderGraphImages();
+        }
+
+        kraut.Graph.Active = false;
+        kraut.Graph.Graph.clear();
+        kraut.Idle.Changed = true;
+    }
+
+    uint32_t KrautVK::kvkRenderGraphAddImage(const char *name, VkFormat format) {
+        return kraut.Graph.Graph.addImage(name != nullptr ? name : "", format);
+    }
+
+    //Float formats like VK_FORMAT_R16G16B16A16_SFLOAT keep simulation state from quantizing between frames
+    uint32_t KrautVK::kvkRenderGraphAddFeedbackImage(const char *name, VkFormat format) {
+        return kraut.Graph.Graph.addFeedbackImage(name != nullptr ? name : "", format);
+    }
+
+    //Feedback images start from zero again with the next frame
+    void KrautVK::kvkRenderGraphResetFeedback() {
+        kraut.Graph.ClearFeedback = kraut.Graph.Active && kraut.Graph.Graph.hasFeedback();
+        kraut.Idle.Changed = true;
+    }
+
+    uint32_t KrautVK::kvkRenderGraphAddPass(const char *name, const char *fragmentShader, const uint32_t *inputs, uint32_t inputCount, uint32_t output) {
+        std::vector<uint32_t> passInputs(inputs, inputs + inputCount);
+        return kraut.Graph.Graph.addPass(name != nullptr ? name : "", fragmentShader != nullptr ? fragmentShader : KVK_FRAGMENT_SHADER, passInputs, output);
+    }
+
+    int KrautVK::kvkRenderGraphBuild() {
+        kraut.Graph.Active = false;
+
+        if(!kraut.Graph.Graph.compile())
+            return VULKAN_RENDER_GRAPH_CREATION_FAILED;
+
+        if(!kvkCreateRenderGraphImages()) {
+            kvkDestroyRenderGraphImages();
+            return VULKAN_RENDER_GRAPH_CREATION_FAILED;
         }
 
+        kraut.Graph.Active = true;
+        kraut.Idle.Changed = true;
         return SUCCESS;
+    }
+
+    bool KrautVK::kvkCreateTimestampPool(VkQueryPool *queryPool) {
+        VkQueryPoolCreateInfo queryPoolCreateInfo = {
+                VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,       // VkStructureType                sType
+                nullptr,                                        // const void                    *pNext
+                0,                                              // VkQueryPoolCreateFlags         flags
+                VK_QUERY_TYPE_TIMESTAMP,                        // VkQueryType                    queryType
+                2,                                              // uint32_t                       queryCount
+                0                                               // VkQueryPipelineStatisticFlags  pipelineStatistics
+        };
 
+        return vkd.createQueryPool(kraut.Vulkan.Device.Handle, &queryPoolCreateInfo, nullptr, queryPool) == VK_SUCCESS;
     }
 
-    bool KrautVK::kvkCreateImageView(Com::ImageParameters &image, const VkFormat &format) {
-        VkImageViewCreateInfo imageViewCreateInfo = {
-                VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO, // VkStructureType          sType
-                nullptr,                                  // const void              *pNext
-                0,                                        // VkImageViewCreateFlags   flags
-                image.Handle,                             // VkImage                  image
-                VK_IMAGE_VIEW_TYPE_2D,                    // VkImageViewType          viewType
-                format,                                   // VkFormat                 format
-                {                                         // VkComponentMapping       components
-                        VK_COMPONENT_SWIZZLE_IDENTITY,            // VkComponentSwizzle       r
-                        VK_COMPONENT_SWIZZLE_IDENTITY,            // VkComponentSwizzle       g
-                        VK_COMPONENT_SWIZZLE_IDENTITY,            // VkComponentSwizzle       b
-                        VK_COMPONENT_SWIZZLE_IDENTITY             // VkComponentSwizzle       a
+    int KrautVK::kvkCreateComputePipeline(const Com::PipelineVariantKey &key, VkPipeline &pipeline) {
+        //Compute pipelines share the variant cache with graphics ones, keyed with an empty vertex shader
+        Com::PipelineVariantCache::iterator cached = kraut.Vulkan.PipelineVariants.find(key);
+        if (cached != kraut.Vulkan.PipelineVariants.end()) {
+            pipeline = cached->second;
+            kraut.Vulkan.PipelineLastUsed[pipeline] = kraut.Vulkan.Frame;
+            return SUCCESS;
+        }
+
+        const std::vector<Com::SpecializationConstant> &constants = key.Constants;
+
+        GarbageCollector<VkShaderModule, PFN_vkDestroyShaderModule> computeShaderModule = Tools::loadShader(Tools::rootPath + key.FragmentShader);
+        if( !computeShaderModule ) {
+            return VULKAN_COMPUTE_PIPELINE_CREATION_FAILED;
+        }
+
+        std::vector<VkSpecializationMapEntry> specializationMapEntries(constants.size());
+        std::vector<uint32_t> specializationData(constants.size());
+        for (size_t i = 0; i < constants.size(); ++i) {
+            specializationMapEntries[i] = {
+                    constants[i].ConstantID,                                    // uint32_t                                       constantID
+                    static_cast<uint32_t>(i * sizeof(uint32_t)),                // uint32_t                                       offset
+                    sizeof(uint32_t)                                            // size_t                                         size
+            };
+            specializationData[i] = constants[i].Value;
+        }
+
+        VkSpecializationInfo specializationInfo = {
+                static_cast<uint32_t>(specializationMapEntries.size()),         // uint32_t                                       mapEntryCount
+                specializationMapEntries.data(),                                // const VkSpecializationMapEntry                *pMapEntries
+                specializationData.size() * sizeof(uint32_t),                   // size_t                                         dataSize
+                specializationData.data()                                       // const void                                    *pData
+        };
+
+        VkComputePipelineCreateInfo pipelineCreateInfo = {
+                VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,                 // VkStructureType                                sType
+                nullptr,                                                        // const void                                    *pNext
+                0,                                                              // VkPipelineCreateFlags                          flags
+                {                                                               // VkPipelineShaderStageCreateInfo                stage
+                        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,            // VkStructureType                                sType
+                        nullptr,                                                        // const void                                    *pNext
+                        0,                                                              // VkPipelineShaderStageCreateFlags               flags
+                        VK_SHADER_STAGE_COMPUTE_BIT,                                    // VkShaderStageFlagBits                          stage
+                        computeShaderModule.get(),                                      // VkShaderModule                                 module
+                        "main",                                                         // const char                                    *pName
+                        constants.empty() ? nullptr : &specializationInfo               // const VkSpecializationInfo                    *pSpecializationInfo
                 },
-                {                                                 // VkImageSubresourceRange  subresourceRange
-                        VK_IMAGE_ASPECT_COLOR_BIT,                // VkImageAspectFlags       aspectMask
-                        0,                                        // uint32_t                 baseMipLevel
-                        1,                                        // uint32_t                 levelCount
-                        0,                                        // uint32_t                 baseArrayLayer
-                        1                                         // uint32_t                 layerCount
+                key.Layout,                                                     // VkPipelineLayout                               layout
+                VK_NULL_HANDLE,                                                 // VkPipeline                                     basePipelineHandle
+                -1                                                              // int32_t                                        basePipelineIndex
+        };
+
+        if(vkd.createComputePipelines(kraut.Vulkan.Device.Handle, kraut.Vulkan.Device.Shared->PipelineCache, 1, &pipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            return VULKAN_COMPUTE_PIPELINE_CREATION_FAILED;
+        }
+
+        kraut.Vulkan.PipelineVariants[key] = pipeline;
+        kraut.Vulkan.PipelineLastUsed[pipeline] = kraut.Vulkan.Frame;
+
+        return SUCCESS;
+    }
+
+    //Binding 0 matches the fragment shader's texture so effects port over unchanged, binding 1 is the output and
+    //binding 2 the accumulation image of progressive mode. The push constant is the index of the sample being added
+    bool KrautVK::kvkCreateComputeLayout() {
+        if(kraut.Compute.Layout != VK_NULL_HANDLE)
+            return true;
+
+        VkDescriptorSetLayoutBinding layoutBindings[] = {
+                {
+                        0,                                          // uint32_t             binding
+                        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,  // VkDescriptorType     descriptorType
+                        1,                                          // uint32_t             descriptorCount
+                        VK_SHADER_STAGE_COMPUTE_BIT,                // VkShaderStageFlags   stageFlags
+                        nullptr                                     // const VkSampler     *pImmutableSamplers
+                },
+                {
+                        1,                                          // uint32_t             binding
+                        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,           // VkDescriptorType     descriptorType
+                        1,                                          // uint32_t             descriptorCount
+                        VK_SHADER_STAGE_COMPUTE_BIT,                // VkShaderStageFlags   stageFlags
+                        nullptr                                     // const VkSampler     *pImmutableSamplers
+                },
+                {
+                        2,                                          // uint32_t             binding
+                        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,           // VkDescriptorType     descriptorType
+                        1,                                          // uint32_t             descriptorCount
+                        VK_SHADER_STAGE_COMPUTE_BIT,                // VkShaderStageFlags   stageFlags
+                        nullptr                                     // const VkSampler     *pImmutableSamplers
                 }
         };
 
-        return createImageView(kraut.Vulkan.Device.Handle, &imageViewCreateInfo, nullptr, &image.View ) == VK_SUCCESS;
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+                VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,  // VkStructureType                      sType
+                nullptr,                                              // const void                          *pNext
+                0,                                                    // VkDescriptorSetLayoutCreateFlags     flags
+                3,                                                    // uint32_t                             bindingCount
+                layoutBindings                                        // const VkDescriptorSetLayoutBinding  *pBindings
+        };
+
+        if(vkd.createDescriptorSetLayout(kraut.Vulkan.Device.Handle, &descriptorSetLayoutCreateInfo, nullptr, &kraut.Compute.Descriptor.Layout) != VK_SUCCESS)
+            return false;
+
+        kraut.Compute.Template.Bindings = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE};
+        if(!kvkCreateDescriptorTemplate(kraut.Compute.Descriptor.Layout, kraut.Compute.Template))
+            return false;
+
+        if(!kraut.Vulkan.PersistentDescriptors.Allocate(kraut.Compute.Descriptor.Layout, &kraut.Compute.Descriptor.Handle))
+            return false;
+
+        VkPushConstantRange pushConstantRange = {
+                VK_SHADER_STAGE_COMPUTE_BIT,                    // VkShaderStageFlags             stageFlags
+                0,                                              // uint32_t                       offset
+                sizeof(uint32_t)                                // uint32_t                       size
+        };
+
+        VkPipelineLayoutCreateInfo layoutCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,  // VkStructureType                sType
+                nullptr,                                        // const void                    *pNext
+                0,                                              // VkPipelineLayoutCreateFlags    flags
+                1,                                              // uint32_t                       setLayoutCount
+                &kraut.Compute.Descriptor.Layout,               // const VkDescriptorSetLayout   *pSetLayouts
+                1,                                              // uint32_t                       pushConstantRangeCount
+                &pushConstantRange                              // const VkPushConstantRange     *pPushConstantRanges
+        };
+
+        return vkd.createPipelineLayout(kraut.Vulkan.Device.Handle, &layoutCreateInfo, nullptr, &kraut.Compute.Layout) == VK_SUCCESS;
+    }
 
+    void KrautVK::kvkDestroyComputeTarget() {
+        kvkDeferDestroy(kraut.Compute.Target.View, vkd.destroyImageView);
+        kvkDeferDestroy(kraut.Compute.Target.Handle, vkd.destroyImage);
+        kvkDeferDestroy(kraut.Compute.Target.Memory, Com::MemoryParameters::Free);
+        kvkDeferDestroy(kraut.Compute.Accumulation.View, vkd.destroyImageView);
+        kvkDeferDestroy(kraut.Compute.Accumulation.Handle, vkd.destroyImage);
+        kvkDeferDestroy(kraut.Compute.Accumulation.Memory, Com::MemoryParameters::Free);
     }
 
-    bool KrautVK::kvkCopyTextureToGPU(Com::ImageParameters &image, char* textureData, uint32_t dataSize, uint32_t width, uint32_t height) {
+    bool KrautVK::kvkCreateComputeTarget() {
+        kvkDeviceWaitIdle();
+        kvkDestroyComputeTarget();
+
+        //Blitting converts to whatever format the swap chain picked. Without blit support the formats have to match
+        VkFormatProperties targetProperties;
+        VkFormatProperties swapChainProperties;
+        vki.getPhysicalDeviceFormatProperties(kraut.Vulkan.Device.PhysicalDevice, KVK_COMPUTE_TARGET_FORMAT, &targetProperties);
+        vki.getPhysicalDeviceFormatProperties(kraut.Vulkan.Device.PhysicalDevice, kraut.Vulkan.SwapChain.Format, &swapChainProperties);
+
+        if(!(targetProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) {
+            std::cout << "Compute target format does not support storage images!" << std::endl;
+            return false;
+        }
+
+        kraut.Compute.Blit = (targetProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT) &&
+                             (swapChainProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT);
+
+        if(!kraut.Compute.Blit && kraut.Vulkan.SwapChain.Format != KVK_COMPUTE_TARGET_FORMAT) {
+            std::cout << "Compute target can be neither blitted nor copied to the swap chain!" << std::endl;
+            return false;
+        }
+
+        const VkExtent2D extent = kvkGetRenderExtent();
+
+        if(!kvkCreateImage(extent.width, extent.height, KVK_COMPUTE_TARGET_FORMAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, &kraut.Compute.Target.Handle))
+            return false;
+
+        if(!kvkAllocateImageMemory(kraut.Compute.Target.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &kraut.Compute.Target.Memory))
+            return false;
+
+        if(vkd.bindImageMemory(kraut.Vulkan.Device.Handle, kraut.Compute.Target.Handle, kraut.Compute.Target.Memory, 0) != VK_SUCCESS)
+            return false;
+
+        if(!kvkCreateImageView(kraut.Compute.Target, KVK_COMPUTE_TARGET_FORMAT))
+            return false;
 
-        void *stagingBufferMemoryPointer;
-        if(mapMemory(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Memory, 0, dataSize, 0, &stagingBufferMemoryPointer) != VK_SUCCESS) {
+        //A new accumulation image holds nothing yet
+        kraut.Compute.Samples = 0;
+        Com::ImageParameters &accumulation = kraut.Compute.Accumulation;
+        if(kraut.Compute.SamplesPerFrame > 0 &&
+           (!kvkCreateImage(extent.width, extent.height, KVK_ACCUMULATION_FORMAT, VK_IMAGE_USAGE_STORAGE_BIT, &accumulation.Handle) ||
+            !kvkAllocateImageMemory(accumulation.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &accumulation.Memory) ||
+            vkd.bindImageMemory(kraut.Vulkan.Device.Handle, accumulation.Handle, accumulation.Memory, 0) != VK_SUCCESS ||
+            !kvkCreateImageView(accumulation, KVK_ACCUMULATION_FORMAT))) {
+            std::cout << "Could not create the accumulation image!" << std::endl;
             return false;
         }
 
-        memcpy(stagingBufferMemoryPointer, textureData, dataSize);
+        const Com::ImageParameters &demoImage = *kraut.Resources.Images.get(kraut.Resources.DemoImage);
 
-        VkMappedMemoryRange flushRange = {
-                VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,              // VkStructureType                        sType
-                nullptr,                                            // const void                            *pNext
-                kraut.StagingBuffer.Memory,                         // VkDeviceMemory                         memory
-                0,                                                  // VkDeviceSize                           offset
-                dataSize                                            // VkDeviceSize                           size
+        VkDescriptorImageInfo imageInfos[] = {
+                {
+                        demoImage.Sampler,                                       // VkSampler                      sampler
+                        demoImage.View,                                          // VkImageView                    imageView
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL                 // VkImageLayout                  imageLayout
+                },
+                {
+                        VK_NULL_HANDLE,                                          // VkSampler                      sampler
+                        kraut.Compute.Target.View,                               // VkImageView                    imageView
+                        VK_IMAGE_LAYOUT_GENERAL                                  // VkImageLayout                  imageLayout
+                },
+                {
+                        //Outside progressive mode the target stands in, shaders that don't accumulate never touch it
+                        VK_NULL_HANDLE,                                          // VkSampler                      sampler
+                        accumulation.View != VK_NULL_HANDLE ? accumulation.View : kraut.Compute.Target.View, // VkImageView                    imageView
+                        VK_IMAGE_LAYOUT_GENERAL                                  // VkImageLayout                  imageLayout
+                }
         };
-        flushMappedMemoryRanges(kraut.Vulkan.Device.Handle, 1, &flushRange);
-
-        unmapMemory(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Memory);
 
-        // Prepare command buffer to copy data from staging buffer to a vertex buffer
-        VkCommandBufferBeginInfo commandBufferBeginInfo = {
-                VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,        // VkStructureType                        sType
-                nullptr,                                            // const void                            *pNext
-                VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,        // VkCommandBufferUsageFlags              flags
-                nullptr                                             // const VkCommandBufferInheritanceInfo  *pInheritanceInfo
-        };
+        kvkUpdateDescriptorTemplate(kraut.Compute.Descriptor.Handle, kraut.Compute.Template, imageInfos);
 
-        VkCommandBuffer commandBuffer = kraut.Vulkan.RenderingResources[0].CommandBuffer;
+        return true;
+    }
 
-        beginCommandBuffer( commandBuffer, &commandBufferBeginInfo);
+    void KrautVK::kvkRecordCompute(VkCommandBuffer commandBuffer, const Com::ImageParameters &imageParameters) {
+        const VkExtent2D extent = kvkGetRenderExtent();
 
         VkImageSubresourceRange imageSubresourceRange = {
                 VK_IMAGE_ASPECT_COLOR_BIT,                          // VkImageAspectFlags                     aspectMask
@@ -1354,494 +4986,669 @@ namespace KVKBase {
                 1                                                   // uint32_t                               layerCount
         };
 
-        VkImageMemoryBarrier imageMemoryBarrierFromUndefinedToTransferDst = {
-                VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,             // VkStructureType                        sType
-                nullptr,                                            // const void                            *pNext
-                0,                                                  // VkAccessFlags                          srcAccessMask
-                VK_ACCESS_TRANSFER_WRITE_BIT,                       // VkAccessFlags                          dstAccessMask
-                VK_IMAGE_LAYOUT_UNDEFINED,                          // VkImageLayout                          oldLayout
-                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,               // VkImageLayout                          newLayout
-                VK_QUEUE_FAMILY_IGNORED,                            // uint32_t                               srcQueueFamilyIndex
-                VK_QUEUE_FAMILY_IGNORED,                            // uint32_t                               dstQueueFamilyIndex
-                image.Handle,                   // VkImage                                image
-                imageSubresourceRange                               // VkImageSubresourceRange                subresourceRange
-        };
-        cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrierFromUndefinedToTransferDst);
+        //Whatever changed the frame makes the accumulated samples stale
+        const bool progressive = kraut.Compute.SamplesPerFrame > 0;
+        if(progressive && kraut.Idle.Changed)
+            kraut.Compute.Samples = 0;
+
+        //A converged accumulation dispatches nothing, the target still holds the average from the last frame
+        const uint32_t frameSamples = kvkGetFrameSamples();
+
+        if(frameSamples > 0) {
+            //The previous frame's transfer may still be reading the target, its contents are not needed. The
+            //accumulation is carried over from the previous frame's dispatches unless it starts again
+            VkImageMemoryBarrier barriersToGeneral[] = {
+                    {
+                            VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                            nullptr,                                          // const void                            *pNext
+                            VK_ACCESS_TRANSFER_READ_BIT,                      // VkAccessFlags                          srcAccessMask
+                            VK_ACCESS_SHADER_WRITE_BIT,                       // VkAccessFlags                          dstAccessMask
+                            VK_IMAGE_LAYOUT_UNDEFINED,                        // VkImageLayout                          oldLayout
+                            VK_IMAGE_LAYOUT_GENERAL,                          // VkImageLayout                          newLayout
+                            VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                            VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                            kraut.Compute.Target.Handle,                      // VkImage                                image
+                            imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
+                    },
+                    {
+                            VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                            nullptr,                                          // const void                            *pNext
+                            VK_ACCESS_SHADER_WRITE_BIT,                       // VkAccessFlags                          srcAccessMask
+                            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, // VkAccessFlags                          dstAccessMask
+                            kraut.Compute.Samples == 0 ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_GENERAL, // VkImageLayout                          oldLayout
+                            VK_IMAGE_LAYOUT_GENERAL,                          // VkImageLayout                          newLayout
+                            VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                            VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                            kraut.Compute.Accumulation.Handle,                // VkImage                                image
+                            imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
+                    }
+            };
+            vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, progressive ? 2 : 1, barriersToGeneral);
 
-        VkBufferImageCopy bufferImageCopyInfo = {
-                0,                                                  // VkDeviceSize                           bufferOffset
-                0,                                                  // uint32_t                               bufferRowLength
-                0,                                                  // uint32_t                               bufferImageHeight
-                {                                                   // VkImageSubresourceLayers               imageSubresource
-                        VK_IMAGE_ASPECT_COLOR_BIT,                          // VkImageAspectFlags                     aspectMask
-                        0,                                                  // uint32_t                               mipLevel
-                        0,                                                  // uint32_t                               baseArrayLayer
-                        1                                                   // uint32_t                               layerCount
-                },
-                {                                                   // VkOffset3D                             imageOffset
-                        0,                                                  // int32_t                                x
-                        0,                                                  // int32_t                                y
-                        0                                                   // int32_t                                z
+            vkd.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kraut.Compute.Pipeline);
+            vkd.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kraut.Compute.Layout, 0, 1, &kraut.Compute.Descriptor.Handle, 0, nullptr);
+
+            //Every sample reads the sum the one before it wrote
+            VkMemoryBarrier barrierBetweenSamples = {
+                    VK_STRUCTURE_TYPE_MEMORY_BARRIER,                 // VkStructureType                        sType
+                    nullptr,                                          // const void                            *pNext
+                    VK_ACCESS_SHADER_WRITE_BIT,                       // VkAccessFlags                          srcAccessMask
+                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT // VkAccessFlags                          dstAccessMask
+            };
+
+            for(uint32_t i = 0; i < frameSamples; ++i) {
+                if(i > 0)
+                    vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrierBetweenSamples, 0, nullptr, 0, nullptr);
+
+                const uint32_t sample = progressive ? kraut.Compute.Samples + i : 0;
+                vkd.cmdPushConstants(commandBuffer, kraut.Compute.Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(sample), &sample);
+                vkd.cmdDispatch(commandBuffer, (extent.width + kraut.Compute.WorkgroupX - 1) / kraut.Compute.WorkgroupX, (extent.height + kraut.Compute.WorkgroupY - 1) / kraut.Compute.WorkgroupY, 1);
+            }
+
+            if(progressive)
+                kraut.Compute.Samples += frameSamples;
+        }
+
+        VkImageMemoryBarrier barriersToTransfer[] = {
+                {
+                        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                        nullptr,                                          // const void                            *pNext
+                        frameSamples > 0 ? static_cast<VkAccessFlags>(VK_ACCESS_SHADER_WRITE_BIT) : 0u, // VkAccessFlags                          srcAccessMask
+                        VK_ACCESS_TRANSFER_READ_BIT,                      // VkAccessFlags                          dstAccessMask
+                        frameSamples > 0 ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // VkImageLayout                          oldLayout
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,             // VkImageLayout                          newLayout
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                        kraut.Compute.Target.Handle,                      // VkImage                                image
+                        imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
                 },
-                {                                                   // VkExtent3D                             imageExtent
-                        width,                                              // uint32_t                               width
-                        height,                                             // uint32_t                               height
-                        1                                                   // uint32_t                               depth
+                {
+                        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                        nullptr,                                          // const void                            *pNext
+                        0,                                                // VkAccessFlags                          srcAccessMask
+                        VK_ACCESS_TRANSFER_WRITE_BIT,                     // VkAccessFlags                          dstAccessMask
+                        VK_IMAGE_LAYOUT_UNDEFINED,                        // VkImageLayout                          oldLayout
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,             // VkImageLayout                          newLayout
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                        VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                        imageParameters.Handle,                           // VkImage                                image
+                        imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
                 }
         };
-        cmdCopyBufferToImage(commandBuffer, kraut.StagingBuffer.Handle, image.Handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopyInfo);
+        vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriersToTransfer);
 
-        VkImageMemoryBarrier imageMemoryBarrierFromTransferToShaderRead = {
-                VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,             // VkStructureType                        sType
-                nullptr,                                            // const void                            *pNext
-                VK_ACCESS_TRANSFER_WRITE_BIT,                       // VkAccessFlags                          srcAccessMask
-                VK_ACCESS_SHADER_READ_BIT,                          // VkAccessFlags                          dstAccessMask
-                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,               // VkImageLayout                          oldLayout
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,           // VkImageLayout                          newLayout
-                VK_QUEUE_FAMILY_IGNORED,                            // uint32_t                               srcQueueFamilyIndex
-                VK_QUEUE_FAMILY_IGNORED,                            // uint32_t                               dstQueueFamilyIndex
-                image.Handle,                   // VkImage                                image
-                imageSubresourceRange                               // VkImageSubresourceRange                subresourceRange
+        VkImageSubresourceLayers imageSubresourceLayers = {
+                VK_IMAGE_ASPECT_COLOR_BIT,                          // VkImageAspectFlags                     aspectMask
+                0,                                                  // uint32_t                               mipLevel
+                0,                                                  // uint32_t                               baseArrayLayer
+                1                                                   // uint32_t                               layerCount
         };
-        cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrierFromTransferToShaderRead);
 
-        endCommandBuffer(commandBuffer);
+        if(kraut.Compute.Blit) {
+            VkImageBlit imageBlit = {
+                    imageSubresourceLayers,                                                                 // VkImageSubresourceLayers               srcSubresource
+                    {{0, 0, 0}, {static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1}}, // VkOffset3D                             srcOffsets[2]
+                    imageSubresourceLayers,                                                                 // VkImageSubresourceLayers               dstSubresource
+                    {{0, 0, 0}, {static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1}}  // VkOffset3D                             dstOffsets[2]
+            };
+            vkd.cmdBlitImage(commandBuffer, kraut.Compute.Target.Handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, imageParameters.Handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_NEAREST);
+        } else {
+            VkImageCopy imageCopy = {
+                    imageSubresourceLayers,                             // VkImageSubresourceLayers               srcSubresource
+                    {0, 0, 0},                                          // VkOffset3D                             srcOffset
+                    imageSubresourceLayers,                             // VkImageSubresourceLayers               dstSubresource
+                    {0, 0, 0},                                          // VkOffset3D                             dstOffset
+                    {extent.width, extent.height, 1}                    // VkExtent3D                             extent
+            };
+            vkd.cmdCopyImage(commandBuffer, kraut.Compute.Target.Handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, imageParameters.Handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageCopy);
+        }
 
-        // Submit command buffer and copy data from staging buffer to a vertex buffer
-        VkSubmitInfo submitInfo = {
-                VK_STRUCTURE_TYPE_SUBMIT_INFO,                      // VkStructureType                        sType
-                nullptr,                                            // const void                            *pNext
-                0,                                                  // uint32_t                               waitSemaphoreCount
-                nullptr,                                            // const VkSemaphore                     *pWaitSemaphores
-                nullptr,                                            // const VkPipelineStageFlags            *pWaitDstStageMask;
-                1,                                                  // uint32_t                               commandBufferCount
-                &commandBuffer,                                     // const VkCommandBuffer                 *pCommandBuffers
-                0,                                                  // uint32_t                               signalSemaphoreCount
-                nullptr                                             // const VkSemaphore                     *pSignalSemaphores
+        VkImageMemoryBarrier barrierToPresent = {
+                VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,           // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                VK_ACCESS_TRANSFER_WRITE_BIT,                     // VkAccessFlags                          srcAccessMask
+                VK_ACCESS_MEMORY_READ_BIT,                        // VkAccessFlags                          dstAccessMask
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,             // VkImageLayout                          oldLayout
+                kraut.Offscreen.Active ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, // VkImageLayout                          newLayout
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
+                imageParameters.Handle,                           // VkImage                                image
+                imageSubresourceRange                             // VkImageSubresourceRange                subresourceRange
         };
+        vkd.cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierToPresent);
+    }
 
-        if(queueSubmit(kraut.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
-            return false;
+    int KrautVK::kvkSetComputeEffect(const char *computeShader, uint32_t workgroupX, uint32_t workgroupY) {
+        //No shader switches back to the raster path
+        if(computeShader == nullptr) {
+            kvkDeviceWaitIdle();
+            kraut.Compute.Active = false;
+            kraut.Idle.Changed = true;
+            kvkDestroyComputeTarget();
+            return SUCCESS;
         }
 
-        deviceWaitIdle(kraut.Vulkan.Device.Handle);
-
-        return true;
-    }
+        workgroupX = workgroupX == 0 ? KVK_COMPUTE_WORKGROUP_X : workgroupX;
+        workgroupY = workgroupY == 0 ? KVK_COMPUTE_WORKGROUP_Y : workgroupY;
 
-    bool KrautVK::kvkCreateSampler(VkSampler *sampler) {
-        VkSamplerCreateInfo samplerCreateInfo = {
-                VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,  // VkStructureType        sType
-                nullptr,                                // const void*            pNext
-                0,                                      // VkSamplerCreateFlags   flags
-                VK_FILTER_LINEAR,                       // VkFilter               magFilter
-                VK_FILTER_LINEAR,                       // VkFilter               minFilter
-                VK_SAMPLER_MIPMAP_MODE_NEAREST,         // VkSamplerMipmapMode    mipmapMode
-                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,  // VkSamplerAddressMode   addressModeU
-                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,  // VkSamplerAddressMode   addressModeV
-                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,  // VkSamplerAddressMode   addressModeW
-                0.0f,                                   // float                  mipLodBias
-                VK_FALSE,                               // VkBool32               anisotropyEnable
-                1.0f,                                   // float                  maxAnisotropy
-                VK_FALSE,                               // VkBool32               compareEnable
-                VK_COMPARE_OP_ALWAYS,                   // VkCompareOp            compareOp
-                0.0f,                                   // float                  minLod
-                0.0f,                                   // float                  maxLod
-                VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK,// VkBorderColor          borderColor
-                VK_FALSE                                // VkBool32               unnormalizedCoordinates
-        };
+        const VkPhysicalDeviceLimits &limits = kraut.Vulkan.Device.Properties.limits;
+        if(workgroupX > limits.maxComputeWorkGroupSize[0] || workgroupY > limits.maxComputeWorkGroupSize[1] ||
+           workgroupX * workgroupY > limits.maxComputeWorkGroupInvocations) {
+            std::cout << "Compute workgroup size " << workgroupX << "x" << workgroupY << " exceeds the device limits" << std::endl;
+            return VULKAN_COMPUTE_PIPELINE_CREATION_FAILED;
+        }
 
-        return createSampler(kraut.Vulkan.Device.Handle, &samplerCreateInfo, nullptr, sampler) == VK_SUCCESS;
-    }
+        if(!kvkCreateComputeLayout())
+            return VULKAN_COMPUTE_PIPELINE_CREATION_FAILED;
 
-    bool KrautVK::kvkCreateBuffer(Com::BufferParameters &buffer, VkBufferCreateFlags usage, VkMemoryPropertyFlagBits memoryProperty) {
+        //The shader declares local_size_x_id = 0 and local_size_y_id = 1
+        Com::PipelineVariantKey key;
+        key.FragmentShader = computeShader;
+        key.Constants = {{0, workgroupX}, {1, workgroupY}};
+        key.Layout = kraut.Compute.Layout;
 
-        VkBufferCreateInfo vkBufferCreateInfo = {
-                VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,             // VkStructureType        sType
-                nullptr,                                          // const void            *pNext
-                0,                                                // VkBufferCreateFlags    flags
-                buffer.Size,                                      // VkDeviceSize           size
-                usage,                                            // VkBufferUsageFlags     usage
-                VK_SHARING_MODE_EXCLUSIVE,                        // VkSharingMode          sharingMode
-                0,                                                // uint32_t               queueFamilyIndexCount
-                nullptr                                           // const uint32_t        *pQueueFamilyIndices
-        };
+        VkPipeline pipeline;
+        int status = kvkCreateComputePipeline(key, pipeline);
+        if(status != SUCCESS)
+            return status;
 
-        if(createBuffer(kraut.Vulkan.Device.Handle, &vkBufferCreateInfo, nullptr, &buffer.Handle) != VK_SUCCESS ) {
-            return false;
-        }
-        if(!kvkAllocateBufferMemory(buffer.Handle, memoryProperty, &buffer.Memory)) {
-            return false;
-        }
+        if(kraut.Compute.Target.Handle == VK_NULL_HANDLE && !kvkCreateComputeTarget())
+            return VULKAN_COMPUTE_PIPELINE_CREATION_FAILED;
 
-        return !(bindBufferMemory(kraut.Vulkan.Device.Handle, buffer.Handle, buffer.Memory, 0) != VK_SUCCESS);
+        kraut.Compute.Shader = computeShader;
+        kraut.Compute.WorkgroupX = workgroupX;
+        kraut.Compute.WorkgroupY = workgroupY;
+        kraut.Compute.Pipeline = pipeline;
+        kraut.Compute.Active = true;
+        kraut.Idle.Changed = true;
 
+        return SUCCESS;
     }
 
-    int KrautVK::kvkCreateVertexBuffer() {
-        const std::vector<float> &vertexData = GlobalVertexData;
+    //Samples the next compute frame adds, always 1 outside progressive mode
+    uint32_t KrautVK::kvkGetFrameSamples() {
+        const Com::ComputeParameters &compute = kraut.Compute;
+        if(compute.SamplesPerFrame == 0)
+            return 1;
 
-        kraut.DemoResources.VertexBuffer.Size = static_cast<uint32_t>(vertexData.size() * sizeof(vertexData[0]));
-        if(!kvkCreateBuffer(kraut.DemoResources.VertexBuffer, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
-            return VULKAN_VERTEX_CREATION_FAILED;
+        if(compute.MaxSamples == 0)
+            return compute.SamplesPerFrame;
+
+        return compute.Samples >= compute.MaxSamples ? 0 : std::min(compute.SamplesPerFrame, compute.MaxSamples - compute.Samples);
+    }
+
+    //Applies to the compute effect, set before or after it. 0 samples per frame turns it off and frees the accumulation image
+    int KrautVK::kvkSetProgressive(uint32_t samplesPerFrame, uint32_t maxSamples) {
+        const bool recreate = (samplesPerFrame > 0) != (kraut.Compute.SamplesPerFrame > 0);
+
+        kraut.Compute.SamplesPerFrame = samplesPerFrame;
+        kraut.Compute.MaxSamples = maxSamples;
+        kraut.Idle.Changed = true;
+
+        //The target is created with or without the accumulation image
+        if(recreate && kraut.Compute.Target.Handle != VK_NULL_HANDLE && !kvkCreateComputeTarget()) {
+            kvkDeviceWaitIdle();
+            kraut.Compute.Active = false;
+            kraut.Compute.SamplesPerFrame = 0;
+            kvkDestroyComputeTarget();
+            return VULKAN_COMPUTE_PIPELINE_CREATION_FAILED;
         }
 
         return SUCCESS;
+    }
 
+    //For changes the renderer can't see, e.g. to data the shader reads from outside
+    void KrautVK::kvkResetAccumulation() {
+        kraut.Compute.Samples = 0;
+        kraut.Idle.Changed = true;
     }
 
-    int KrautVK::kvkCreateStagingBuffer() {
-        kraut.StagingBuffer.Size = KVK_STAGING_BUFFER_SIZE;
-        if(!kvkCreateBuffer(kraut.StagingBuffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)){
-            return VULKAN_VERTEX_CREATION_FAILED;
-        };
+    uint32_t KrautVK::kvkGetAccumulatedSamples() {
+        return kraut.Compute.Samples;
+    }
 
-        return SUCCESS;
+    double KrautVK::kvkGetEffectTime() {
+        return kraut.Timing.Supported ? kraut.Timing.EffectMilliseconds : -1.0;
+    }
 
+    uint32_t KrautVK::kvkGetDeviceCount() {
+        return static_cast<uint32_t>(kraut.Vulkan.DeviceReports.size());
     }
 
-    int KrautVK::kvkCopyBufferToGPU() {
-        const std::vector<float> &vertexData = GlobalVertexData;
+    bool KrautVK::kvkGetDeviceReport(uint32_t index, DeviceReport *report) {
+        if (index >= kraut.Vulkan.DeviceReports.size())
+            return false;
 
-        void *stagingBufferMemoryPointer;
-        if(mapMemory(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Memory, 0, kraut.DemoResources.VertexBuffer.Size, 0, &stagingBufferMemoryPointer) != VK_SUCCESS) {
-            return VULKAN_VERTEX_CREATION_FAILED;
-        }
+        *report = kraut.Vulkan.DeviceReports[index];
+        return true;
+    }
 
-        memcpy(stagingBufferMemoryPointer, &vertexData[0], kraut.DemoResources.VertexBuffer.Size);
+    double KrautVK::kvkGetRecordTime() {
+        return kraut.Timing.RecordMilliseconds;
+    }
 
-        VkMappedMemoryRange flushRange = {
-                VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,            // VkStructureType                        sType
-                nullptr,                                          // const void                            *pNext
-                kraut.StagingBuffer.Memory,                       // VkDeviceMemory                         memory
-                0,                                                // VkDeviceSize                           offset
-                kraut.DemoResources.VertexBuffer.Size             // VkDeviceSize                           size
-        };
+    uint32_t KrautVK::kvkGetInitStageCount() {
+        return static_cast<uint32_t>(kraut.Timing.InitStages.size());
+    }
 
-        flushMappedMemoryRanges(kraut.Vulkan.Device.Handle, 1, &flushRange);
+    bool KrautVK::kvkGetInitStage(uint32_t index, InitStage *stage) {
+        if (index >= kraut.Timing.InitStages.size())
+            return false;
 
-        unmapMemory(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Memory);
+        *stage = kraut.Timing.InitStages[index];
+        return true;
+    }
 
-        VkCommandBufferBeginInfo commandBufferBeginInfo = {
-                VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,      // VkStructureType                        sType
-                nullptr,                                          // const void                            *pNext
-                VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,      // VkCommandBufferUsageFlags              flags
-                nullptr                                           // const VkCommandBufferInheritanceInfo  *pInheritanceInfo
+    int KrautVK::kvkCreateSpriteResources() {
+        VkPushConstantRange pushConstantRange = {
+                VK_SHADER_STAGE_VERTEX_BIT,                     // VkShaderStageFlags             stageFlags
+                0,                                              // uint32_t                       offset
+                2 * sizeof(float)                               // uint32_t                       size
         };
 
-        VkCommandBuffer commandBuffer = kraut.Vulkan.RenderingResources[0].CommandBuffer;
-
-        beginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+        //Sprites either index the bindless table or sample their texture exactly like the demo quad, sharing its set layout
+        const VkDescriptorSetLayout *setLayout = kraut.Bindless.Supported ? &kraut.Bindless.Descriptor.Layout : &kraut.Vulkan.Descriptor.Layout;
 
-        VkBufferCopy bufferCopyInfo = {
-                0,                                                // VkDeviceSize                           srcOffset
-                0,                                                // VkDeviceSize                           dstOffset
-                kraut.DemoResources.VertexBuffer.Size             // VkDeviceSize                           size
+        VkPipelineLayoutCreateInfo layoutCreateInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,  // VkStructureType                sType
+                nullptr,                                        // const void                    *pNext
+                0,                                              // VkPipelineLayoutCreateFlags    flags
+                1,                                              // uint32_t                       setLayoutCount
+                setLayout,                                      // const VkDescriptorSetLayout   *pSetLayouts
+                1,                                              // uint32_t                       pushConstantRangeCount
+                &pushConstantRange                              // const VkPushConstantRange     *pPushConstantRanges
         };
 
-        cmdCopyBuffer(commandBuffer, kraut.StagingBuffer.Handle, kraut.DemoResources.VertexBuffer.Handle, 1, &bufferCopyInfo);
+        if(vkd.createPipelineLayout(kraut.Vulkan.Device.Handle, &layoutCreateInfo, nullptr, &kraut.Sprites.Layout) != VK_SUCCESS)
+            return VULKAN_PIPELINES_CREATION_FAILED;
 
-        VkBufferMemoryBarrier bufferMemoryBarrier = {
-                VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,          // VkStructureType                        sType;
-                nullptr,                                          // const void                            *pNext
-                VK_ACCESS_MEMORY_WRITE_BIT,                       // VkAccessFlags                          srcAccessMask
-                VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,              // VkAccessFlags                          dstAccessMask
-                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               srcQueueFamilyIndex
-                VK_QUEUE_FAMILY_IGNORED,                          // uint32_t                               dstQueueFamilyIndex
-                kraut.DemoResources.VertexBuffer.Handle,                       // VkBuffer                               buffer
-                0,                                                // VkDeviceSize                           offset
-                VK_WHOLE_SIZE                                     // VkDeviceSize                           size
-        };
+        //Texture 0 is the demo texture, which is also bindless slot 0
+        kraut.Sprites.Textures.push_back(Com::ImageParameters());
 
-        cmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr, 1, &bufferMemoryBarrier, 0, nullptr);
+        //Without bindless textures every sprite texture gets a set of its own from the persistent allocator
+        if(!kraut.Bindless.Supported)
+            kraut.Sprites.Descriptors.push_back(kraut.Vulkan.Descriptor.Handle);
 
-        endCommandBuffer(commandBuffer);
+        if(kvkSpriteAddPipeline(kraut.Bindless.Supported ? KVK_SPRITE_BINDLESS_SHADER : KVK_SPRITE_FRAGMENT_SHADER) == UINT32_MAX)
+            return VULKAN_PIPELINES_CREATION_FAILED;
 
-        VkSubmitInfo submitInfo = {
-                VK_STRUCTURE_TYPE_SUBMIT_INFO,                    // VkStructureType                        sType
-                nullptr,                                          // const void                            *pNext
-                0,                                                // uint32_t                               waitSemaphoreCount
-                nullptr,                                          // const VkSemaphore                     *pWaitSemaphores
-                nullptr,                                          // const VkPipelineStageFlags            *pWaitDstStageMask;
-                1,                                                // uint32_t                               commandBufferCount
-                &commandBuffer,                                   // const VkCommandBuffer                 *pCommandBuffers
-                0,                                                // uint32_t                               signalSemaphoreCount
-                nullptr                                           // const VkSemaphore                     *pSignalSemaphores
-        };
+        //One instance buffer per frame in flight, mapped for the lifetime of the engine
+        for(Com::RenderingResourcesData &renderingResource : kraut.Vulkan.RenderingResources) {
+            renderingResource.SpriteBuffer.Size = KVK_SPRITE_CAPACITY * sizeof(SpriteData);
+            if(!kvkCreateBuffer(renderingResource.SpriteBuffer, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+                return VULKAN_VERTEX_CREATION_FAILED;
 
-        if(queueSubmit(kraut.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE ) != VK_SUCCESS) {
-            return VULKAN_VERTEX_CREATION_FAILED;
+            void *spriteMemoryPointer;
+            if(vkd.mapMemory(kraut.Vulkan.Device.Handle, renderingResource.SpriteBuffer.Memory, 0, VK_WHOLE_SIZE, 0, &spriteMemoryPointer) != VK_SUCCESS)
+                return VULKAN_VERTEX_CREATION_FAILED;
+
+            renderingResource.SpriteMemory = static_cast<SpriteData*>(spriteMemoryPointer);
         }
 
-        deviceWaitIdle(kraut.Vulkan.Device.Handle);
+        kraut.Sprites.Pending.reserve(KVK_SPRITE_CAPACITY);
+        kraut.Idle.LastSprites.reserve(KVK_SPRITE_CAPACITY);
+        kraut.Sprites.Keys.reserve(KVK_SPRITE_CAPACITY);
 
         return SUCCESS;
-
     }
 
-    int KrautVK::kvkInit(const int &width, const int &height, const char *title, const int &fullScreen) {
-        std::cout << "\nKrautVK Alpha v" << krautvk_VERSION_MAJOR << "." << krautvk_VERSION_MINOR << "\n";
+    //Counting sort on (layer, pipeline, texture), scattering each sprite straight into the mapped instance buffer,
+    //then one instanced draw per run of sprites sharing a pipeline and texture. With bindless textures the shader
+    //picks the texture from the instance data, so runs only break on pipeline changes
+    void KrautVK::kvkRecordSprites(VkCommandBuffer commandBuffer, Com::RenderingResourcesData &renderingResource) {
+        const std::vector<SpriteData> &sprites = kraut.Sprites.Pending;
+        if(sprites.empty() || renderingResource.SpriteMemory == nullptr)
+            return;
+
+        const uint32_t textureCount = static_cast<uint32_t>(kraut.Sprites.Textures.size());
+        const uint32_t pipelineCount = static_cast<uint32_t>(kraut.Sprites.Pipelines.size());
+        const uint32_t textureKeys = kraut.Bindless.Supported ? 1 : textureCount;
+        const uint32_t keyCount = KVK_SPRITE_LAYER_COUNT * pipelineCount * textureKeys;
+        const float width = static_cast<float>(kvkGetRenderExtent().width);
+        const float height = static_cast<float>(kvkGetRenderExtent().height);
+
+        std::vector<uint32_t> &keys = kraut.Sprites.Keys;
+        std::vector<uint32_t> &offsets = kraut.Sprites.Offsets;
+        keys.resize(sprites.size());
+        offsets.assign(keyCount + 1, 0);
+
+        for(size_t i = 0; i < sprites.size(); ++i) {
+            const SpriteData &sprite = sprites[i];
+
+            //Bounding circle against the window
+            float radius = 0.5f * (std::fabs(sprite.width) + std::fabs(sprite.height));
+            if(sprite.layer >= KVK_SPRITE_LAYER_COUNT || sprite.pipeline >= pipelineCount || sprite.texture >= textureCount ||
+               sprite.x + radius < 0.0f || sprite.x - radius > width || sprite.y + radius < 0.0f || sprite.y - radius > height) {
+                keys[i] = UINT32_MAX;
+                continue;
+            }
 
-        printf("Initializing GLFW...\n");
-        int status = kvkInitGLFW(width, height, title, fullScreen);
-        if (status != SUCCESS)
-            return status;
+            keys[i] = (sprite.layer * pipelineCount + sprite.pipeline) * textureKeys + sprite.texture % textureKeys;
+            ++offsets[keys[i] + 1];
+        }
 
-        printf("Initializing Vulkan...\n");
-        status = kvkCreateInstance(title);
-        if (status != SUCCESS)
-            return status;
+        for(uint32_t key = 0; key < keyCount; ++key)
+            offsets[key + 1] += offsets[key];
 
-        printf("Setting Up Hardware...\n");
-        status = kvkCreateDevice();
-        if (status != SUCCESS)
-            return status;
+        const uint32_t visible = std::min<uint32_t>(offsets[keyCount], KVK_SPRITE_CAPACITY);
+        if(visible == 0)
+            return;
 
-        printf("Loading Rendering Resources...\n");
-        if(!kvkCreateSwapChain())
-            return INT32_MIN;
+        if(offsets[keyCount] > KVK_SPRITE_CAPACITY)
+            std::cout << "Sprite capacity exceeded, " << offsets[keyCount] - KVK_SPRITE_CAPACITY << " sprites dropped" << std::endl;
 
-        status = kvkCreateCommandPool();
-        if (status != SUCCESS)
-            return status;
+        //offsets[key] walks forward as sprites are placed, ending where key + 1 starts
+        SpriteData *instances = renderingResource.SpriteMemory;
+        for(size_t i = 0; i < sprites.size(); ++i) {
+            if(keys[i] == UINT32_MAX)
+                continue;
 
-        for(size_t i = 0; i < kraut.Vulkan.RenderingResources.size(); i++) {
+            uint32_t slot = offsets[keys[i]]++;
+            if(slot < KVK_SPRITE_CAPACITY)
+                memcpy(&instances[slot], &sprites[i], sizeof(SpriteData));
+        }
 
-            status = kvkAllocateCommandBuffer(kraut.Vulkan.CommandPool, 1, &kraut.Vulkan.RenderingResources[i].CommandBuffer);
-            if (status != SUCCESS)
-                return status;
+        VkMappedMemoryRange flushRange = {
+                VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,            // VkStructureType                        sType
+                nullptr,                                          // const void                            *pNext
+                renderingResource.SpriteBuffer.Memory,            // VkDeviceMemory                         memory
+                0,                                                // VkDeviceSize                           offset
+                VK_WHOLE_SIZE                                     // VkDeviceSize                           size
+        };
 
-            status = kvkCreateSemaphore(&kraut.Vulkan.RenderingResources[i].ImageAvailableSemaphore);
-            if (status != SUCCESS)
-                return status;
+        vkd.flushMappedMemoryRanges(kraut.Vulkan.Device.Handle, 1, &flushRange);
+
+        VkDeviceSize offset = 0;
+        vkd.cmdBindVertexBuffers(commandBuffer, 1, 1, &renderingResource.SpriteBuffer.Handle, &offset);
+
+        float inverseSize[2] = {1.0f / width, 1.0f / height};
+        vkd.cmdPushConstants(commandBuffer, kraut.Sprites.Layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(inverseSize), inverseSize);
+
+        uint32_t boundPipeline = UINT32_MAX;
+        uint32_t boundTexture = UINT32_MAX;
+        uint32_t first = 0;
+
+        if(kraut.Bindless.Supported)
+            vkd.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, kraut.Sprites.Layout, 0, 1, &kraut.Bindless.Descriptor.Handle, 0, nullptr);
+
+        //After the scatter, offsets[key] is the end of key's run
+        for(uint32_t key = 0; key < keyCount && first < visible; ++key) {
+            uint32_t last = std::min(offsets[key], visible);
+            if(last == first)
+                continue;
+
+            uint32_t pipeline = (key / textureKeys) % pipelineCount;
+            uint32_t texture = key % textureKeys;
+
+            //Runs in different layers with the same state are adjacent and get merged
+            uint32_t end = last;
+            for(uint32_t next = key + 1; next < keyCount; ++next) {
+                uint32_t nextEnd = std::min(offsets[next], visible);
+                if(nextEnd == end)
+                    continue;
+
+                if((next / textureKeys) % pipelineCount != pipeline || next % textureKeys != texture)
+                    break;
+
+                end = nextEnd;
+                key = next;
+            }
+
+            if(pipeline != boundPipeline) {
+                vkd.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, kraut.Sprites.Pipelines[pipeline]);
+                boundPipeline = pipeline;
+            }
 
-            status = kvkCreateSemaphore(&kraut.Vulkan.RenderingResources[i].FinishedRenderingSemaphore);
-            if (status != SUCCESS)
-                return status;
+            if(!kraut.Bindless.Supported && texture != boundTexture) {
+                vkd.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, kraut.Sprites.Layout, 0, 1, &kraut.Sprites.Descriptors[texture], 0, nullptr);
+                boundTexture = texture;
+            }
 
-            status = kvkCreateFence(&kraut.Vulkan.RenderingResources[i].Fence);
-            if (status != SUCCESS)
-                return status;
+            vkd.cmdDraw(commandBuffer, KVK_VERTEX_COUNT, end - first, 0, first);
+            first = end;
         }
+    }
 
-        status = kvkCreateStagingBuffer();
-        if (status != SUCCESS)
-            return status;
+    uint32_t KrautVK::kvkSpriteLoadTexture(const char *path) {
+        if(path == nullptr)
+            return UINT32_MAX;
 
-        printf("Staging Test Environment...\n");
+        int width = 0;
+        int height = 0;
+        std::vector<char> textureData = Tools::getImageData(Tools::rootPath + path, 4, &width, &height, nullptr, nullptr);
 
-        status = kvkCreateTexture("/res/demo.png", kraut.DemoResources.Image);
-        if (status != SUCCESS)
-            return status;
+        return kvkSpriteCreateTexture(textureData, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    }
 
-        printf("Setting Up Engine...\n");
-        status = kvkCreateDescriptorSet();
-        if (status != SUCCESS)
-            return status;
+    uint32_t KrautVK::kvkSpriteCreateTexture(std::vector<char> &textureData, uint32_t width, uint32_t height) {
+        //Texture uploads go through the staging buffer and the first rendering resource's command buffer
+        kvkDeviceWaitIdle();
 
-        status = kvkCreateRenderPass();
-        if (status != SUCCESS)
-            return status;
+        Com::ImageParameters texture;
+        if(kvkCreateTexture(textureData, width, height, texture) != SUCCESS) {
+            kvkDestroyTexture(texture);
+            return UINT32_MAX;
+        }
 
-        status = kvkCreatePipelines();
-        if (status != SUCCESS)
-            return status;
+        uint32_t index = kvkSpriteAddTexture(texture);
+        if(index == UINT32_MAX)
+            kvkDestroyTexture(texture);
 
-        status = kvkCreateVertexBuffer();
-        if (status != SUCCESS)
-            return status;
+        return index;
+    }
 
-        status = kvkCopyBufferToGPU();
-        if (status != SUCCESS)
-            return status;
+    //Takes ownership of the texture on success, it is destroyed with the other sprite textures
+    uint32_t KrautVK::kvkSpriteAddTexture(const Com::ImageParameters &texture) {
+        const size_t maxTextures = kraut.Bindless.Supported ? kraut.Bindless.Capacity : KVK_SPRITE_MAX_TEXTURES;
+        if(kraut.Sprites.Textures.size() >= maxTextures)
+            return UINT32_MAX;
 
-        printf("KrautVK Alpha Initialized!\n");
+        //Sprite textures are the only bindless slots after the demo texture, so the slot is also the sprite texture index
+        if(kraut.Bindless.Supported) {
+            if(kvkBindlessRegister(texture) == UINT32_MAX)
+                return UINT32_MAX;
 
-        return SUCCESS;
-    }
+            kraut.Sprites.Textures.push_back(texture);
+            return static_cast<uint32_t>(kraut.Sprites.Textures.size() - 1);
+        }
 
-    void KrautVK::kvkTerminate() {
-        printf("KrautVK terminating\n");
+        VkDescriptorSet descriptor;
+        if(!kraut.Vulkan.PersistentDescriptors.Allocate(kraut.Vulkan.Descriptor.Layout, &descriptor))
+            return UINT32_MAX;
 
-        if (kraut.Vulkan.Device.Handle != VK_NULL_HANDLE) {
-            deviceWaitIdle(kraut.Vulkan.Device.Handle);
+        VkDescriptorImageInfo imageInfo = {
+                texture.Sampler,                                         // VkSampler                      sampler
+                texture.View,                                            // VkImageView                    imageView
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL                 // VkImageLayout                  imageLayout
+        };
 
-            //Destroy Rendering Resource Data
-            for(unsigned int i = 0; i < kraut.Vulkan.RenderingResources.size(); i++)
-                kraut.Vulkan.RenderingResources[i].DestroyResources();
+        kvkUpdateDescriptorTemplate(descriptor, kraut.Vulkan.TextureTemplate, &imageInfo);
 
+        kraut.Sprites.Textures.push_back(texture);
+        kraut.Sprites.Descriptors.push_back(descriptor);
 
-            //Destroy Command Pool
-            if(kraut.Vulkan.CommandPool != VK_NULL_HANDLE) {
-                destroyCommandPool(kraut.Vulkan.Device.Handle, kraut.Vulkan.CommandPool, nullptr);
-                kraut.Vulkan.CommandPool = VK_NULL_HANDLE;
-            }
+        return static_cast<uint32_t>(kraut.Sprites.Textures.size() - 1);
+    }
 
+    uint32_t KrautVK::kvkSpriteAddPipeline(const char *fragmentShader) {
+        if(fragmentShader == nullptr || kraut.Sprites.Pipelines.size() >= KVK_SPRITE_MAX_PIPELINES)
+            return UINT32_MAX;
 
-            //Destroy Vertex Buffer
-            if(kraut.DemoResources.VertexBuffer.Handle != VK_NULL_HANDLE) {
-                destroyBuffer(kraut.Vulkan.Device.Handle, kraut.DemoResources.VertexBuffer.Handle, nullptr);
-                kraut.DemoResources.VertexBuffer.Handle = VK_NULL_HANDLE;
-            }
+        Com::PipelineVariantKey key;
+        key.VertexShader = KVK_SPRITE_VERTEX_SHADER;
+        key.FragmentShader = fragmentShader;
+        key.RenderPass = kraut.Vulkan.RenderPass;
+        key.Layout = kraut.Sprites.Layout;
+        key.Sprite = true;
 
-            if(kraut.DemoResources.VertexBuffer.Memory != VK_NULL_HANDLE) {
-                freeMemory(kraut.Vulkan.Device.Handle, kraut.DemoResources.VertexBuffer.Memory, nullptr);
-                kraut.DemoResources.VertexBuffer.Memory = VK_NULL_HANDLE;
-            }
+        VkPipeline pipeline;
+        if(kvkCreateGraphicsPipeline(key, pipeline) != SUCCESS)
+            return UINT32_MAX;
 
-            //Destroy Staging Buffer
-            if(kraut.StagingBuffer.Handle != VK_NULL_HANDLE) {
-                destroyBuffer(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Handle, nullptr);
-                kraut.StagingBuffer.Handle = VK_NULL_HANDLE;
-            }
+        kraut.Sprites.Pipelines.push_back(pipeline);
 
-            if(kraut.StagingBuffer.Memory != VK_NULL_HANDLE) {
-                freeMemory(kraut.Vulkan.Device.Handle, kraut.StagingBuffer.Memory, nullptr);
-                kraut.StagingBuffer.Memory = VK_NULL_HANDLE;
-            }
+        return static_cast<uint32_t>(kraut.Sprites.Pipelines.size() - 1);
+    }
 
+    void KrautVK::kvkSpriteSubmit(const SpriteData *sprites, uint32_t count) {
+        kraut.Sprites.Pending.insert(kraut.Sprites.Pending.end(), sprites, sprites + count);
+    }
 
-            //Destroy Pipeline
-            if(kraut.Vulkan.GraphicsPipeline != VK_NULL_HANDLE) {
-                destroyPipeline(kraut.Vulkan.Device.Handle, kraut.Vulkan.GraphicsPipeline, nullptr);
-                kraut.Vulkan.GraphicsPipeline = VK_NULL_HANDLE;
-            }
+    bool KrautVK::kvkCheckBindlessSupport(VkPhysicalDeviceDescriptorIndexingFeatures &enabledFeatures) {
+        VkPhysicalDevice physicalDevice = kraut.Vulkan.Device.PhysicalDevice;
 
-            if(kraut.Vulkan.PipelineLayout != VK_NULL_HANDLE ) {
-                destroyPipelineLayout(kraut.Vulkan.Device.Handle, kraut.Vulkan.PipelineLayout, nullptr);
-                kraut.Vulkan.PipelineLayout = VK_NULL_HANDLE;
-            }
+        //Feature and property chains need a 1.1 device
+        if (vki.getPhysicalDeviceFeatures2 == nullptr || vki.getPhysicalDeviceProperties2 == nullptr ||
+            kraut.Vulkan.Device.Properties.apiVersion < VK_API_VERSION_1_1)
+            return false;
 
-            //Destroy Descriptor Sets
-            if(kraut.Vulkan.Descriptor.Pool != VK_NULL_HANDLE ) {
-                destroyDescriptorPool(kraut.Vulkan.Device.Handle, kraut.Vulkan.Descriptor.Pool, nullptr);
-                kraut.Vulkan.Descriptor.Pool = VK_NULL_HANDLE;
-            }
+        uint32_t extensionsCount = 0;
+        if (vki.enumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionsCount, nullptr) != VK_SUCCESS || extensionsCount == 0)
+            return false;
 
-            if(kraut.Vulkan.Descriptor.Layout != VK_NULL_HANDLE ) {
-                destroyDescriptorSetLayout(kraut.Vulkan.Device.Handle, kraut.Vulkan.Descriptor.Layout, nullptr);
-                kraut.Vulkan.Descriptor.Layout = VK_NULL_HANDLE;
-            }
+        std::vector<VkExtensionProperties> availableExtensions(extensionsCount);
+        if (vki.enumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionsCount, &availableExtensions[0]) != VK_SUCCESS)
+            return false;
 
-            //Destroy Demo Image
-            if(kraut.DemoResources.Image.Sampler != VK_NULL_HANDLE ) {
-                destroySampler(kraut.Vulkan.Device.Handle, kraut.DemoResources.Image.Sampler, nullptr);
-                kraut.DemoResources.Image.Sampler = VK_NULL_HANDLE;
-            }
+        if (!kvkCheckExtensionAvailability(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, availableExtensions))
+            return false;
 
-            if(kraut.DemoResources.Image.View != VK_NULL_HANDLE ) {
-                destroyImageView(kraut.Vulkan.Device.Handle, kraut.DemoResources.Image.View, nullptr);
-                kraut.DemoResources.Image.View = VK_NULL_HANDLE;
-            }
+        VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
 
-            if(kraut.DemoResources.Image.Handle != VK_NULL_HANDLE ) {
-                destroyImage(kraut.Vulkan.Device.Handle, kraut.DemoResources.Image.Handle, nullptr);
-                kraut.DemoResources.Image.Handle = VK_NULL_HANDLE;
-            }
+        VkPhysicalDeviceFeatures2 features = {
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,   // VkStructureType                sType
+                &indexingFeatures,                              // void                          *pNext
+                {}                                              // VkPhysicalDeviceFeatures       features
+        };
 
-            if(kraut.DemoResources.Image.Memory != VK_NULL_HANDLE ) {
-                freeMemory(kraut.Vulkan.Device.Handle, kraut.DemoResources.Image.Memory, nullptr);
-                kraut.DemoResources.Image.Memory = VK_NULL_HANDLE;
-            }
+        vki.getPhysicalDeviceFeatures2(physicalDevice, &features);
 
+        if (!indexingFeatures.runtimeDescriptorArray ||
+            !indexingFeatures.shaderSampledImageArrayNonUniformIndexing ||
+            !indexingFeatures.descriptorBindingPartiallyBound ||
+            !indexingFeatures.descriptorBindingSampledImageUpdateAfterBind ||
+            !indexingFeatures.descriptorBindingUpdateUnusedWhilePending)
+            return false;
 
-            //Destroy Renderpass
-            if(kraut.Vulkan.RenderPass != VK_NULL_HANDLE) {
-                destroyRenderPass(kraut.Vulkan.Device.Handle, kraut.Vulkan.RenderPass, nullptr);
-                kraut.Vulkan.RenderPass = VK_NULL_HANDLE;
-            }
+        VkPhysicalDeviceDescriptorIndexingProperties indexingProperties = {};
+        indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
 
-            //Destroy Swapchain
-            if (kraut.Vulkan.SwapChain.Handle != VK_NULL_HANDLE) {
-                destroySwapchainKHR(kraut.Vulkan.Device.Handle, kraut.Vulkan.SwapChain.Handle, nullptr);
-            }
+        VkPhysicalDeviceProperties2 properties = {
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, // VkStructureType                sType
+                &indexingProperties,                            // void                          *pNext
+                {}                                              // VkPhysicalDeviceProperties     properties
+        };
 
-            //Destroy Device
-            destroyDevice(kraut.Vulkan.Device.Handle, nullptr);
-        }
+        vki.getPhysicalDeviceProperties2(physicalDevice, &properties);
 
-        //Destroy Application Surface
-        if (kraut.Vulkan.ApplicationSurface != VK_NULL_HANDLE) {
-            destroySurfaceKHR(kraut.Vulkan.Instance, kraut.Vulkan.ApplicationSurface, nullptr);
-        }
+        //A combined image sampler counts against both the sampler and the sampled image limits
+        kraut.Bindless.Capacity = std::min<uint32_t>({
+                KVK_BINDLESS_CAPACITY,
+                indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages
+        });
 
-        //Destroy Vulkan Instance
-        if (kraut.Vulkan.Instance != VK_NULL_HANDLE) {
-            destroyInstance(kraut.Vulkan.Instance, nullptr);
-        }
+        if (kraut.Bindless.Capacity == 0)
+            return false;
 
-        //Terminate GLFW
-        glfwTerminate();
+        //Only turn on what the bindless table uses
+        enabledFeatures = {};
+        enabledFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+        enabledFeatures.runtimeDescriptorArray = VK_TRUE;
+        enabledFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        enabledFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        enabledFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        enabledFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
 
+        return true;
     }
 
-    bool KrautVK::kvkLayoutDescriptorSet() {
+    int KrautVK::kvkCreateBindlessTable() {
+        //Slots are written while frames using other slots are still in flight, and most of the array is never written
+        VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                                VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                                VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo = {
+                VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,  // VkStructureType                      sType
+                nullptr,                                                            // const void                          *pNext
+                1,                                                                  // uint32_t                             bindingCount
+                &bindingFlags                                                       // const VkDescriptorBindingFlags      *pBindingFlags
+        };
+
         VkDescriptorSetLayoutBinding layoutBinding = {
                 0,                                          // uint32_t             binding
                 VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,  // VkDescriptorType     descriptorType
-                1,                                          // uint32_t             descriptorCount
+                kraut.Bindless.Capacity,                    // uint32_t             descriptorCount
                 VK_SHADER_STAGE_FRAGMENT_BIT,               // VkShaderStageFlags   stageFlags
                 nullptr                                     // const VkSampler     *pImmutableSamplers
         };
 
         VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
-                VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,  // VkStructureType                      sType
-                nullptr,                                              // const void                          *pNext
-                0,                                                    // VkDescriptorSetLayoutCreateFlags     flags
-                1,                                                    // uint32_t                             bindingCount
-                &layoutBinding                                        // const VkDescriptorSetLayoutBinding  *pBindings
+                VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,        // VkStructureType                      sType
+                &bindingFlagsCreateInfo,                                    // const void                          *pNext
+                VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, // VkDescriptorSetLayoutCreateFlags     flags
+                1,                                                          // uint32_t                             bindingCount
+                &layoutBinding                                              // const VkDescriptorSetLayoutBinding  *pBindings
         };
 
-        return !(createDescriptorSetLayout(kraut.Vulkan.Device.Handle, &descriptorSetLayoutCreateInfo, nullptr, &kraut.Vulkan.Descriptor.Layout ) != VK_SUCCESS);
-
-    }
+        if(vkd.createDescriptorSetLayout(kraut.Vulkan.Device.Handle, &descriptorSetLayoutCreateInfo, nullptr, &kraut.Bindless.Descriptor.Layout) != VK_SUCCESS)
+            return VULKAN_DESCRIPTOR_SET_CREATION_FAILED;
 
-    bool KrautVK::kvkCreateDescriptorPool() {
         VkDescriptorPoolSize poolSize = {
                 VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,      // VkDescriptorType               type
-                1                                               // uint32_t                       descriptorCount
+                kraut.Bindless.Capacity                         // uint32_t                       descriptorCount
         };
 
         VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
                 VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,  // VkStructureType                sType
                 nullptr,                                        // const void                    *pNext
-                0,                                              // VkDescriptorPoolCreateFlags    flags
+                VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,// VkDescriptorPoolCreateFlags    flags
                 1,                                              // uint32_t                       maxSets
                 1,                                              // uint32_t                       poolSizeCount
                 &poolSize                                       // const VkDescriptorPoolSize    *pPoolSizes
         };
 
-        return createDescriptorPool(kraut.Vulkan.Device.Handle, &descriptorPoolCreateInfo, nullptr, &kraut.Vulkan.Descriptor.Pool) == VK_SUCCESS;
-
-    }
+        if(vkd.createDescriptorPool(kraut.Vulkan.Device.Handle, &descriptorPoolCreateInfo, nullptr, &kraut.Bindless.Descriptor.Pool) != VK_SUCCESS)
+            return VULKAN_DESCRIPTOR_SET_CREATION_FAILED;
 
-    bool KrautVK::kvkAllocateDescriptorSet() {
         VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
                 VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, // VkStructureType                sType
                 nullptr,                                        // const void                    *pNext
-                kraut.Vulkan.Descriptor.Pool,                   // VkDescriptorPool               descriptorPool
+                kraut.Bindless.Descriptor.Pool,                 // VkDescriptorPool               descriptorPool
                 1,                                              // uint32_t                       descriptorSetCount
-                &kraut.Vulkan.Descriptor.Layout                 // const VkDescriptorSetLayout   *pSetLayouts
+                &kraut.Bindless.Descriptor.Layout               // const VkDescriptorSetLayout   *pSetLayouts
         };
 
-        return !(allocateDescriptorSets(kraut.Vulkan.Device.Handle, &descriptorSetAllocateInfo, &kraut.Vulkan.Descriptor.Handle ) != VK_SUCCESS);
+        if(vkd.allocateDescriptorSets(kraut.Vulkan.Device.Handle, &descriptorSetAllocateInfo, &kraut.Bindless.Descriptor.Handle) != VK_SUCCESS)
+            return VULKAN_DESCRIPTOR_SET_CREATION_FAILED;
 
+        if(kvkBindlessRegister(*kraut.Resources.Images.get(kraut.Resources.DemoImage)) != 0)
+            return VULKAN_DESCRIPTOR_SET_CREATION_FAILED;
 
+        return SUCCESS;
     }
 
-    void KrautVK::kvkUpdateDescriptorSet() {
+    //Each slot is written once, when its texture is loaded, and never touched from the frame loop
+    uint32_t KrautVK::kvkBindlessRegister(const Com::ImageParameters &image) {
+        if(!kraut.Bindless.Supported || kraut.Bindless.Count >= kraut.Bindless.Capacity)
+            return UINT32_MAX;
+
         VkDescriptorImageInfo imageInfo = {
-                kraut.DemoResources.Image.Sampler,                       // VkSampler                      sampler
-                kraut.DemoResources.Image.View,                          // VkImageView                    imageView
+                image.Sampler,                                           // VkSampler                      sampler
+                image.View,                                              // VkImageView                    imageView
                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL                 // VkImageLayout                  imageLayout
         };
 
         VkWriteDescriptorSet descriptorWrites = {
                 VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,     // VkStructureType                sType
                 nullptr,                                    // const void                    *pNext
-                kraut.Vulkan.Descriptor.Handle,             // VkDescriptorSet                dstSet
+                kraut.Bindless.Descriptor.Handle,           // VkDescriptorSet                dstSet
                 0,                                          // uint32_t                       dstBinding
-                0,                                          // uint32_t                       dstArrayElement
+                kraut.Bindless.Count,                       // uint32_t                       dstArrayElement
                 1,                                          // uint32_t                       descriptorCount
                 VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,  // VkDescriptorType               descriptorType
                 &imageInfo,                                 // const VkDescriptorImageInfo   *pImageInfo
@@ -1849,23 +5656,400 @@ namespace KVKBase {
                 nullptr                                     // const VkBufferView            *pTexelBufferView
         };
 
-        updateDescriptorSets(kraut.Vulkan.Device.Handle, 1, &descriptorWrites, 0, nullptr);
+        vkd.updateDescriptorSets(kraut.Vulkan.Device.Handle, 1, &descriptorWrites, 0, nullptr);
+
+        return kraut.Bindless.Count++;
+    }
 
+    void KrautVK::kvkDestroyTexture(Com::ImageParameters &image) {
+        kvkReleaseSampler(image.Sampler);
+        kvkDeferDestroy(image.View, vkd.destroyImageView);
+        kvkDeferDestroy(image.Handle, vkd.destroyImage);
+        kvkDeferDestroy(image.Memory, Com::MemoryParameters::Free);
 
+        image = Com::ImageParameters();
     }
 
-    int KrautVK::kvkCreateDescriptorSet() {
+    void KrautVK::kvkDestroyBuffer(Com::BufferParameters &buffer) {
+        kvkDeferDestroy(buffer.Handle, vkd.destroyBuffer);
+        kvkDeferDestroy(buffer.Memory, Com::MemoryParameters::Free);
 
-        if(!kvkLayoutDescriptorSet())
-            return VULKAN_DESCRIPTOR_SET_CREATION_FAILED;
+        buffer = Com::BufferParameters();
+    }
 
-        if(!kvkCreateDescriptorPool())
-            return VULKAN_DESCRIPTOR_SET_CREATION_FAILED;
+    //Pages start out undefined, the first image packed into a page is uploaded from VK_IMAGE_LAYOUT_UNDEFINED
+    uint32_t KrautVK::kvkCreateAtlasPage() {
+        Com::ImageParameters page;
+
+        if(!kvkCreateImage(KVK_ATLAS_PAGE_SIZE, KVK_ATLAS_PAGE_SIZE, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, &page.Handle) ||
+           !kvkAllocateImageMemory(page.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &page.Memory) ||
+           vkd.bindImageMemory(kraut.Vulkan.Device.Handle, page.Handle, page.Memory, 0) != VK_SUCCESS ||
+           !kvkCreateImageView(page, VK_FORMAT_R8G8B8A8_UNORM) ||
+           !kvkAcquireSampler(&page.Sampler)) {
+            kvkDestroyTexture(page);
+            return UINT32_MAX;
+        }
 
-        if(!kvkAllocateDescriptorSet())
-            return VULKAN_DESCRIPTOR_SET_CREATION_FAILED;
+        uint32_t texture = kvkSpriteAddTexture(page);
+        if(texture == UINT32_MAX) {
+            kvkDestroyTexture(page);
+            return UINT32_MAX;
+        }
 
-        kvkUpdateDescriptorSet();
+        kraut.Atlas.Pages.push_back(AtlasPage(KVK_ATLAS_PAGE_SIZE, KVK_ATLAS_PAGE_SIZE));
+        kraut.Atlas.Textures.push_back(texture);
+
+        return static_cast<uint32_t>(kraut.Atlas.Pages.size() - 1);
+    }
+
+    int KrautVK::kvkAtlasLoadImage(const char *path, AtlasRegion *region) {
+        if(path == nullptr || region == nullptr)
+            return VULKAN_TEXTURE_CREATION_FAILED;
+
+        int width = 0;
+        int height = 0;
+        std::vector<char> textureData = Tools::getImageData(Tools::rootPath + path, 4, &width, &height, nullptr, nullptr);
+        if(textureData.empty())
+            return VULKAN_TEXTURE_CREATION_FAILED;
+
+        //Large images gain little from sharing a page and would fill it quickly
+        if(width > KVK_ATLAS_MAX_IMAGE_SIZE || height > KVK_ATLAS_MAX_IMAGE_SIZE) {
+            uint32_t texture = kvkSpriteCreateTexture(textureData, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+            if(texture == UINT32_MAX)
+                return VULKAN_TEXTURE_CREATION_FAILED;
+
+            *region = {texture, UINT32_MAX, 0.0f, 0.0f, 1.0f, 1.0f};
+            return SUCCESS;
+        }
+
+        const uint32_t gutter = KVK_ATLAS_GUTTER;
+        const uint32_t extrudedWidth = static_cast<uint32_t>(width) + 2 * gutter;
+        const uint32_t extrudedHeight = static_cast<uint32_t>(height) + 2 * gutter;
+        std::vector<char> extruded = AtlasPage::extrude(textureData.data(), static_cast<uint32_t>(width), static_cast<uint32_t>(height), gutter);
+
+        //First page with room wins, padding goes on the right and bottom of every rect
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t page = 0;
+        while(page < kraut.Atlas.Pages.size() &&
+              !kraut.Atlas.Pages[page].insert(extrudedWidth + KVK_ATLAS_PADDING, extrudedHeight + KVK_ATLAS_PADDING, x, y))
+            ++page;
+
+        VkImageLayout oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        if(page == kraut.Atlas.Pages.size()) {
+            page = kvkCreateAtlasPage();
+            if(page == UINT32_MAX ||
+               !kraut.Atlas.Pages[page].insert(extrudedWidth + KVK_ATLAS_PADDING, extrudedHeight + KVK_ATLAS_PADDING, x, y))
+                return VULKAN_TEXTURE_CREATION_FAILED;
+
+            oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+
+        //Only the new rect is uploaded, images already on the page stay where they are
+        kvkDeviceWaitIdle();
+
+        uint32_t texture = kraut.Atlas.Textures[page];
+        if(!kvkCopyTextureRegionToGPU(kraut.Sprites.Textures[texture], extruded.data(), static_cast<uint32_t>(extruded.size()),
+                                      {static_cast<int32_t>(x), static_cast<int32_t>(y)}, {extrudedWidth, extrudedHeight}, oldLayout))
+            return VULKAN_TEXTURE_CREATION_FAILED;
+
+        //Sprites already drawing from the page sample the new image's gutter at their edges
+        kraut.Idle.Changed = true;
+
+        const float inverseSize = 1.0f / KVK_ATLAS_PAGE_SIZE;
+        *region = {
+                texture,
+                page,
+                (x + gutter) * inverseSize,
+                (y + gutter) * inverseSize,
+                (x + gutter + width) * inverseSize,
+                (y + gutter + height) * inverseSize
+        };
+
+        return SUCCESS;
+    }
+
+    uint32_t KrautVK::kvkAtlasGetPageCount() {
+        return static_cast<uint32_t>(kraut.Atlas.Pages.size());
+    }
+
+    float KrautVK::kvkAtlasGetOccupancy(uint32_t page) {
+        if(page >= kraut.Atlas.Pages.size())
+            return -1.0f;
+
+        return kraut.Atlas.Pages[page].occupancy();
+    }
+
+    uint32_t KrautVK::kvkImageLoad(const char *path) {
+        if(path == nullptr)
+            return 0;
+
+        //Texture uploads go through the staging buffer and the first rendering resource's command buffer
+        kvkDeviceWaitIdle();
+
+        Com::ImageParameters image;
+        if(kvkCreateTexture(path, image) != SUCCESS) {
+            kvkDestroyTexture(image);
+            return 0;
+        }
+
+        uint32_t handle = kraut.Resources.Images.create(image);
+        if(handle == 0)
+            kvkDestroyTexture(image);
+        else
+            kraut.Resources.ImageLastUsed[handle] = kraut.Vulkan.Frame;
+
+        return handle;
+    }
+
+    //Builds the main pass pipeline for a fragment shader. Loading the same shader twice gives two handles to one pipeline
+    uint32_t KrautVK::kvkPipelineLoad(const char *fragmentShader) {
+        if(fragmentShader == nullptr)
+            return 0;
+
+        Com::PipelineVariantKey key;
+        key.VertexShader = KVK_VERTEX_SHADER;
+        key.FragmentShader = fragmentShader;
+        key.RenderPass = kraut.Vulkan.RenderPass;
+        key.Layout = kraut.Vulkan.PipelineLayout;
+
+        VkPipeline pipeline;
+        if(kvkCreateGraphicsPipeline(key, pipeline) != SUCCESS)
+            return 0;
+
+        return kraut.Resources.Pipelines.create(pipeline);
+    }
+
+    int KrautVK::kvkPipelineUse(uint32_t handle) {
+        VkPipeline *pipeline = kraut.Resources.Pipelines.get(handle);
+        if(pipeline == nullptr)
+            return VULKAN_PIPELINES_CREATION_FAILED;
+
+        kraut.Vulkan.GraphicsPipeline = *pipeline;
+        kraut.Idle.Changed = true;
         return SUCCESS;
     }
+
+    bool KrautVK::kvkResourceValid(uint32_t handle) {
+        switch(HandleAllocator::type(handle)) {
+            case RESOURCE_IMAGE:
+                if(!kraut.Resources.Images.valid(handle))
+                    return false;
+
+                kraut.Resources.ImageLastUsed[handle] = kraut.Vulkan.Frame;
+                return true;
+            case RESOURCE_BUFFER:
+                return kraut.Resources.Buffers.valid(handle);
+            case RESOURCE_PIPELINE:
+                return kraut.Resources.Pipelines.valid(handle);
+            default:
+                return false;
+        }
+    }
+
+    //Stale handles are ignored. The demo scene's resources live until terminate
+    bool KrautVK::kvkResourceDestroy(uint32_t handle) {
+        if(handle == kraut.Resources.DemoImage || handle == kraut.Resources.DemoVertexBuffer)
+            return false;
+
+        switch(HandleAllocator::type(handle)) {
+            case RESOURCE_IMAGE: {
+                Com::ImageParameters image;
+                if(!kraut.Resources.Images.destroy(handle, image))
+                    return false;
+
+                kraut.Resources.ImageLastUsed.erase(handle);
+                kraut.Resources.Evictable.erase(handle);
+                kvkDestroyTexture(image);
+                return true;
+            }
+            case RESOURCE_BUFFER: {
+                Com::BufferParameters buffer;
+                if(!kraut.Resources.Buffers.destroy(handle, buffer))
+                    return false;
+
+                kvkDestroyBuffer(buffer);
+                return true;
+            }
+            case RESOURCE_PIPELINE: {
+                VkPipeline pipeline;
+                return kraut.Resources.Pipelines.destroy(handle, pipeline);
+            }
+            default:
+                return false;
+        }
+    }
+
+    //Only images can be evicted, and only once the frontend has said it can load them again. The demo image stays
+    bool KrautVK::kvkResourceSetEvictable(uint32_t handle, bool evictable) {
+        if(handle == kraut.Resources.DemoImage || !kraut.Resources.Images.valid(handle))
+            return false;
+
+        if(evictable)
+            kraut.Resources.Evictable.insert(handle);
+        else
+            kraut.Resources.Evictable.erase(handle);
+
+        return true;
+    }
+
+    bool KrautVK::kvkCheckMemoryBudgetSupport() {
+        if (vki.getPhysicalDeviceMemoryProperties2 == nullptr || kraut.Vulkan.Device.Properties.apiVersion < VK_API_VERSION_1_1)
+            return false;
+
+        uint32_t extensionsCount = 0;
+        if (vki.enumerateDeviceExtensionProperties(kraut.Vulkan.Device.PhysicalDevice, nullptr, &extensionsCount, nullptr) != VK_SUCCESS || extensionsCount == 0)
+            return false;
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionsCount);
+        if (vki.enumerateDeviceExtensionProperties(kraut.Vulkan.Device.PhysicalDevice, nullptr, &extensionsCount, &availableExtensions[0]) != VK_SUCCESS)
+            return false;
+
+        return kvkCheckExtensionAvailability(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, availableExtensions) != 0;
+    }
+
+    //Usage and budget summed over the device local heaps
+    void KrautVK::kvkGetMemoryBudget(VkDeviceSize &usage, VkDeviceSize &budget) {
+        const VkPhysicalDeviceMemoryProperties &memoryProperties = kraut.Vulkan.Device.MemoryProperties;
+
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+        budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        if (kraut.Memory.BudgetSupported) {
+            VkPhysicalDeviceMemoryProperties2 memoryProperties2 = {
+                    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,  // VkStructureType                    sType
+                    &budgetProperties,                                      // void                              *pNext
+                    {}                                                      // VkPhysicalDeviceMemoryProperties   memoryProperties
+            };
+
+            vki.getPhysicalDeviceMemoryProperties2(kraut.Vulkan.Device.PhysicalDevice, &memoryProperties2);
+        }
+
+        usage = 0;
+        VkDeviceSize available = 0;
+        for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i) {
+            if (!(memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+                continue;
+
+            if (kraut.Memory.BudgetSupported) {
+                usage += budgetProperties.heapUsage[i];
+                available += budgetProperties.heapBudget[i];
+            } else {
+                std::lock_guard<std::mutex> lock(kraut.Vulkan.Device.Shared->MemoryMutex);
+                usage += kraut.Vulkan.Device.Shared->HeapUsage[i];
+                available += memoryProperties.memoryHeaps[i].size;
+            }
+        }
+
+        budget = kraut.Memory.Budget != 0 ? kraut.Memory.Budget : static_cast<VkDeviceSize>(available * KVK_MEMORY_BUDGET_FRACTION);
+    }
+
+    //Drops least recently used evictable images, then pipeline variants nothing refers to, while usage is over budget.
+    //Only resources idle for KVK_EVICTION_MIN_AGE frames are candidates, freed memory comes back through the deletion
+    //queue. Images the frontend hasn't marked evictable are its own to destroy
+    void KrautVK::kvkEvictResources() {
+        if (kraut.Vulkan.CompletedFrame < kraut.Memory.EvictionFrame)
+            return;
+
+        VkDeviceSize usage, budget;
+        kvkGetMemoryBudget(usage, budget);
+
+        if (usage <= budget)
+            return;
+
+        const uint64_t frame = kraut.Vulkan.Frame;
+        kraut.Memory.EvictionFrame = frame;
+
+        std::vector<std::pair<uint64_t, uint32_t>> images;
+        for (uint32_t handle : kraut.Resources.Evictable) {
+            uint64_t lastUsed = kraut.Resources.ImageLastUsed[handle];
+
+            if (lastUsed + KVK_EVICTION_MIN_AGE <= frame)
+                images.push_back({lastUsed, handle});
+        }
+
+        std::sort(images.begin(), images.end());
+
+        for (const std::pair<uint64_t, uint32_t> &image : images) {
+            if (usage <= budget)
+                break;
+
+            {
+                Com::SharedDeviceParameters &shared = *kraut.Vulkan.Device.Shared;
+                std::lock_guard<std::mutex> lock(shared.MemoryMutex);
+
+                std::unordered_map<VkDeviceMemory, Com::MemoryAllocation>::iterator allocation =
+                        shared.Allocations.find(kraut.Resources.Images.get(image.second)->Memory);
+                if (allocation != shared.Allocations.end())
+                    usage -= std::min(usage, allocation->second.Size);
+            }
+
+            kvkResourceDestroy(image.second);
+            ++kraut.Memory.EvictedImages;
+        }
+
+        if (usage <= budget)
+            return;
+
+        std::unordered_set<VkPipeline> referenced = {kraut.Vulkan.GraphicsPipeline, kraut.Compute.Pipeline, kraut.Dynamic.Pipeline,
+                                                     kraut.Output.Pipeline, kraut.Output.DownsamplePipeline};
+
+        for (const Com::RenderGraphPassResources &pass : kraut.Graph.Passes)
+            referenced.insert(pass.Pipeline);
+
+        for (const Com::LayerParameters &layer : kraut.Compositor.Layers) {
+            referenced.insert(layer.Pipeline);
+            referenced.insert(layer.Composite);
+        }
+
+        referenced.insert(kraut.Sprites.Pipelines.begin(), kraut.Sprites.Pipelines.end());
+        referenced.insert(kraut.Resources.Pipelines.items().begin(), kraut.Resources.Pipelines.items().end());
+
+        for (Com::PipelineVariantCache::iterator variant = kraut.Vulkan.PipelineVariants.begin(); variant != kraut.Vulkan.PipelineVariants.end();) {
+            VkPipeline pipeline = variant->second;
+            if (referenced.count(pipeline) || kraut.Vulkan.PipelineLastUsed[pipeline] + KVK_EVICTION_MIN_AGE > frame) {
+                ++variant;
+                continue;
+            }
+
+            kraut.Vulkan.PipelineLastUsed.erase(pipeline);
+            kvkDeferDestroy(pipeline, vkd.destroyPipeline);
+            variant = kraut.Vulkan.PipelineVariants.erase(variant);
+            ++kraut.Memory.EvictedPipelines;
+        }
+    }
+
+    void KrautVK::kvkGetMemoryStats(MemoryStats *stats) {
+        if (stats == nullptr)
+            return;
+
+        VkDeviceSize usage, budget;
+        kvkGetMemoryBudget(usage, budget);
+
+        VkDeviceSize allocated = 0;
+        {
+            std::lock_guard<std::mutex> lock(kraut.Vulkan.Device.Shared->MemoryMutex);
+            for (VkDeviceSize heapUsage : kraut.Vulkan.Device.Shared->HeapUsage)
+                allocated += heapUsage;
+        }
+
+        stats->usage = usage;
+        stats->budget = budget;
+        stats->allocated = allocated;
+        stats->evictedImages = kraut.Memory.EvictedImages;
+        stats->evictedPipelines = kraut.Memory.EvictedPipelines;
+        stats->driverBudget = kraut.Memory.BudgetSupported ? 1 : 0;
+    }
+
+    void KrautVK::kvkSetMemoryBudget(uint64_t bytes) {
+        kraut.Memory.Budget = bytes;
+    }
+
+    uint64_t KrautVK::kvkGetHeapUsage(uint32_t heap) {
+        if (heap >= kraut.Vulkan.Device.MemoryProperties.memoryHeapCount)
+            return 0;
+
+        std::lock_guard<std::mutex> lock(kraut.Vulkan.Device.Shared->MemoryMutex);
+        return kraut.Vulkan.Device.Shared->HeapUsage[heap];
+    }
 }
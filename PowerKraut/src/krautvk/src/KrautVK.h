@@ -19,12 +19,22 @@ limitations under the License.
 
 #include "KrautVKConfig.h"
 #include "KrautVKCommon.cpp"
+#include "KrautVKRenderGraph.cpp"
+#include "KrautVKAtlas.cpp"
+#include "KrautVKRegistry.cpp"
+#include "KrautVKDispatch.cpp"
+#include "KrautVKBenchmark.cpp"
+#include "KrautVKTaskGraph.cpp"
+#include "KrautVKFrameWriter.cpp"
 
 //FUNCTION HEADERS
 namespace KVKBase {
 
     class KrautVK {
 
+        //The microbenchmarks time private stages like kvkCreateInstance on their own
+        friend class MicroBenchmark;
+
     private:
 
         static int kvkInitGLFW(const int &width, const int &height, const char* title,const int &fullScreen);
@@ -33,11 +43,21 @@ namespace KVKBase {
 
         static void kvkGetRequiredDeviceExtensions(std::vector<const char*> &deviceExtensions);
 
-        static int kvkCheckDeviceProperties(VkPhysicalDevice physicalDevice, uint32_t &selectedFamilyIndex, uint32_t &selectedPresentationCommandBuffer);
+        static int kvkCheckDeviceProperties(VkPhysicalDevice physicalDevice, Com::DeviceParameters &device, uint32_t &selectedFamilyIndex, uint32_t &selectedPresentationCommandBuffer);
+
+        static bool kvkCheckFormatFeatures(VkPhysicalDevice physicalDevice, VkFormat format, VkFormatFeatureFlags features);
+
+        static int64_t kvkScoreDevice(VkPhysicalDevice physicalDevice, DeviceReport &report);
+
+        static bool kvkMatchDevice(const DeviceReport &report, const std::string &preferredDevice);
 
         static int kvkCreateInstance(const char *title);
 
-        static int kvkCreateDevice();
+        static int kvkCreateDevice(const char *preferredDevice);
+
+        static Com::KrautCommon *kvkFindSharedDevice();
+
+        static int kvkShareDevice(const Com::KrautCommon &shared);
 
         static bool kvkCreateSwapChain();
 
@@ -55,15 +75,101 @@ namespace KVKBase {
 
         static int kvkCreateCommandPool();
 
-        static int kvkCreateRenderPass();
+        static int kvkCreateRenderingResources();
+
+        static int kvkCreateRenderPass(VkImageLayout initialLayout, VkImageLayout finalLayout, VkRenderPass *renderPass);
 
         static bool kvkCreateFrameBuffers(VkFramebuffer &framebuffer, VkImageView imageView);
 
         static bool kvkOnWindowSizeChanged();
 
-        static bool kvkRecordCommandBuffers(VkCommandBuffer commandBuffer, const Com::ImageParameters &imageParameters, VkFramebuffer &framebuffer);
+        static VkExtent2D kvkGetRenderExtent();
+
+        static bool kvkCreateExtentResources();
+
+        static bool kvkCreateOffscreenTarget(uint32_t width, uint32_t height);
+
+        static void kvkDestroyOffscreenTarget();
+
+        static bool kvkWaitRenderingResource(Com::RenderingResourcesData &renderingResource);
+
+        static void kvkCollectCompletedFrames();
+
+        static VkResult kvkQueueSubmit(VkQueue queue, const VkSubmitInfo &submitInfo, VkFence fence);
+
+        static VkResult kvkQueuePresent(const VkPresentInfoKHR &presentInfo);
+
+        static void kvkDeviceWaitIdle();
+
+        static bool kvkReadTimestamps(const Com::RenderingResourcesData &renderingResource, double &milliseconds);
+
+        static bool kvkRenderOffscreen();
+
+        static bool kvkCheckOutputExtent(uint32_t width, uint32_t height);
+
+        static VkExtent2D kvkGetOutputExtent(const Com::OutputTargetParameters &target);
+
+        static bool kvkOutputFits(const Com::OutputTargetParameters &target);
+
+        static bool kvkCreateOutputLayout();
+
+        static int kvkCreateOutputPipelines();
+
+        static bool kvkCreateOutputResources();
+
+        static void kvkDestroyOutputResources();
+
+        static Com::OutputTargetParameters *kvkFindOutput(uint32_t output);
+
+        static const void *kvkInvalidateOutput(const Com::RenderingResourcesData &renderingResource, const Com::OutputTargetParameters &target);
+
+        static void kvkCaptureCollect(const Com::RenderingResourcesData &renderingResource);
+
+        static void kvkCaptureFlush();
+
+        static void kvkCaptureRestoreOffscreen();
+
+        static void kvkRecordOutput(VkCommandBuffer commandBuffer, Com::RenderingResourcesData &renderingResource);
+
+        static bool kvkFrameChanged();
+
+        static VkExtent2D kvkGetScaledExtent();
+
+        static void kvkUpdateResolutionScale(float renderedScale, double milliseconds);
+
+        static bool kvkCreateUpscalePipeline();
+
+        static bool kvkCreateDynamicResolutionTarget();
+
+        static void kvkDestroyDynamicResolutionTarget();
 
-        static int kvkCreatePipelines();
+        static void kvkRecordUpscale(VkCommandBuffer commandBuffer, Com::RenderingResourcesData &renderingResource, VkExtent2D sceneExtent);
+
+        static bool kvkCreateCompositor();
+
+        static int kvkCreateCompositePipeline(uint32_t blend, VkPipeline &pipeline);
+
+        static bool kvkAllocateLayerDescriptor(VkDescriptorSet *set);
+
+        static bool kvkCreateLayerTarget(Com::LayerParameters &layer);
+
+        static bool kvkCreateLayerTargets();
+
+        static void kvkDestroyLayer(Com::LayerParameters &layer);
+
+        static Com::LayerParameters *kvkFindLayer(uint32_t layer);
+
+        static void kvkRecordLayers(VkCommandBuffer commandBuffer, Com::RenderingResourcesData &renderingResource);
+
+        static void kvkRecordComposite(VkCommandBuffer commandBuffer);
+
+        static bool kvkRecordCommandBuffers(Com::RenderingResourcesData &renderingResource, const Com::ImageParameters &imageParameters);
+
+        static void kvkRecordRaster(VkCommandBuffer commandBuffer, Com::RenderingResourcesData &renderingResource);
+
+        static int kvkCreatePipelines(const std::string &fragmentShader, std::vector<Com::SpecializationConstant> constants);
+
+        static int kvkCreateGraphicsPipeline(const Com::PipelineVariantKey &key, VkPipeline &pipeline);
 
         static bool kvkCreatePipelineLayout();
 
@@ -75,6 +181,8 @@ namespace KVKBase {
 
         static int kvkCopyBufferToGPU();
 
+        static bool kvkAllocateMemory(const VkMemoryRequirements &requirements, VkMemoryPropertyFlagBits memoryProperty, VkDeviceMemory *memory);
+
         static bool kvkAllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlagBits memoryProperty, VkDeviceMemory *memory);
 
         static int kvkAllocateCommandBuffer(VkCommandPool pool, uint32_t count, VkCommandBuffer *commandBuffer);
@@ -83,36 +191,221 @@ namespace KVKBase {
 
         static int kvkCreateFence(VkFence *fence);
 
-        static bool kvkCreateImage(const uint32_t &width, const uint32_t &height, VkImage *image);
+        static bool kvkCreateImage(const uint32_t &width, const uint32_t &height, VkFormat format, VkImageUsageFlags usage, VkImage *image);
 
         static bool kvkAllocateImageMemory(VkImage image, VkMemoryPropertyFlagBits property, VkDeviceMemory *memory);
 
         static int kvkCreateTexture(std::string relPath, Com::ImageParameters &image);
 
+        static int kvkCreateTexture(std::vector<char> &textureData, uint32_t width, uint32_t height, Com::ImageParameters &image);
+
+        static void kvkDestroyTexture(Com::ImageParameters &image);
+
+        static void kvkDestroyBuffer(Com::BufferParameters &buffer);
+
         static bool kvkCreateImageView(Com::ImageParameters &image, const VkFormat &format);
 
         static bool kvkCopyTextureToGPU(Com::ImageParameters &image, char* textureData, uint32_t dataSize, uint32_t width, uint32_t height);
 
-        static bool kvkCreateSampler(VkSampler *sampler);
+        static bool kvkCopyTextureRegionToGPU(Com::ImageParameters &image, char* textureData, uint32_t dataSize, VkOffset2D offset, VkExtent2D extent, VkImageLayout oldLayout);
+
+        static bool kvkAcquireSampler(VkSampler *sampler);
+
+        static bool kvkAcquireSampler(const VkSamplerCreateInfo &samplerCreateInfo, VkSampler *sampler);
+
+        static void kvkReleaseSampler(VkSampler &sampler);
+
+        template<class T, class F>
+        static void kvkDeferDestroy(T &object, F deleter);
 
         static int kvkCreateDescriptorSet();
 
+        static int kvkCreateDescriptorLayout();
+
         static bool kvkLayoutDescriptorSet();
 
-        static bool kvkCreateDescriptorPool();
+        static bool kvkCreateDescriptorTemplate(VkDescriptorSetLayout layout, Com::DescriptorTemplate &descriptorTemplate);
+
+        static void kvkUpdateDescriptorTemplate(VkDescriptorSet set, const Com::DescriptorTemplate &descriptorTemplate, const VkDescriptorImageInfo *imageInfos);
+
+        static void kvkDestroyDescriptorTemplate(Com::DescriptorTemplate &descriptorTemplate);
 
         static bool kvkAllocateDescriptorSet();
 
         static void kvkUpdateDescriptorSet();
 
+        static bool kvkCreateRenderGraphRenderPass(VkFormat format, VkRenderPass *renderPass);
+
+        static bool kvkGetRenderGraphLayout(uint32_t inputCount, Com::RenderGraphLayout &layout);
+
+        static bool kvkCreateRenderGraphImages();
+
+        static void kvkDestroyRenderGraphImages();
+
+        static Com::ImageParameters &kvkGetRenderGraphImage(uint32_t resource, uint32_t parity);
+
+        static void kvkClearRenderGraphFeedback(VkCommandBuffer commandBuffer);
+
+        static void kvkRecordRenderGraph(VkCommandBuffer commandBuffer);
+
+        static bool kvkCreateTimestampPool(VkQueryPool *queryPool);
+
+        static int kvkCreateComputePipeline(const Com::PipelineVariantKey &key, VkPipeline &pipeline);
+
+        static bool kvkCreateComputeLayout();
+
+        static bool kvkCreateComputeTarget();
+
+        static void kvkDestroyComputeTarget();
+
+        static void kvkRecordCompute(VkCommandBuffer commandBuffer, const Com::ImageParameters &imageParameters);
+
+        static uint32_t kvkGetFrameSamples();
+
+        static int kvkCreateSpriteResources();
+
+        static void kvkRecordSprites(VkCommandBuffer commandBuffer, Com::RenderingResourcesData &renderingResource);
+
+        static bool kvkCheckBindlessSupport(VkPhysicalDeviceDescriptorIndexingFeatures &enabledFeatures);
+
+        static int kvkCreateBindlessTable();
+
+        static uint32_t kvkBindlessRegister(const Com::ImageParameters &image);
+
+        static uint32_t kvkSpriteAddTexture(const Com::ImageParameters &texture);
+
+        static uint32_t kvkSpriteCreateTexture(std::vector<char> &textureData, uint32_t width, uint32_t height);
+
+        static uint32_t kvkCreateAtlasPage();
+
+        static bool kvkCheckMemoryBudgetSupport();
+
+        static void kvkGetMemoryBudget(VkDeviceSize &usage, VkDeviceSize &budget);
+
+        static void kvkEvictResources();
+
     public:
 
-        static int kvkInit(const int &w, const int &h, const char* title, const int &f);
+        static uint32_t kvkCreateContext();
+
+        static bool kvkMakeCurrent(uint32_t context);
+
+        static bool kvkDestroyContext(uint32_t context);
+
+        static int kvkInit(const int &w, const int &h, const char* title, const int &f, const char* preferredDevice);
 
         static int kvkWindowShouldClose();
 
         static bool kvkRenderUpdate();
 
+        static int kvkSetOffscreen(uint32_t width, uint32_t height);
+
+        static int kvkSetOutputFormat(uint32_t format, bool fullRange);
+
+        static uint32_t kvkGetOutputFrameSize();
+
+        static uint64_t kvkReadOutputFrame(void* data, uint32_t size, bool wait);
+
+        static uint32_t kvkOutputAdd(uint32_t width, uint32_t height, uint32_t format, uint32_t filter, bool fullRange);
+
+        static bool kvkOutputRemove(uint32_t output);
+
+        static uint32_t kvkOutputGetSize(uint32_t output);
+
+        static uint64_t kvkOutputRead(uint32_t output, void* data, uint32_t size, bool wait);
+
+        static int kvkCaptureStart(const char* path, uint32_t format, uint32_t width, uint32_t height, uint32_t fps);
+
+        static double kvkCaptureGetTime();
+
+        static int kvkCaptureStop();
+
+        static int kvkBenchmark(const char* fragmentShader, uint32_t width, uint32_t height, uint32_t warmupFrames, uint32_t measuredFrames, const char* reportPath, BenchmarkResult* result);
+
+        static int kvkSetShaderVariant(const char* fragmentShader, const uint32_t* constantIDs, const uint32_t* values, uint32_t count);
+
+        static void kvkRenderGraphReset();
+
+        static uint32_t kvkRenderGraphAddImage(const char* name, VkFormat format);
+
+        static uint32_t kvkRenderGraphAddFeedbackImage(const char* name, VkFormat format);
+
+        static void kvkRenderGraphResetFeedback();
+
+        static uint32_t kvkRenderGraphAddPass(const char* name, const char* fragmentShader, const uint32_t* inputs, uint32_t inputCount, uint32_t output);
+
+        static int kvkRenderGraphBuild();
+
+        static int kvkSetDynamicResolution(double targetMilliseconds, float minimumScale, float sharpness);
+
+        static float kvkGetResolutionScale();
+
+        static uint32_t kvkLayerAdd(const char* fragmentShader, uint32_t image, uint32_t blend, float opacity);
+
+        static int kvkLayerSetBlend(uint32_t layer, uint32_t blend, float opacity);
+
+        static bool kvkLayerSetAnimated(uint32_t layer, bool animated);
+
+        static bool kvkLayerInvalidate(uint32_t layer);
+
+        static bool kvkLayerRemove(uint32_t layer);
+
+        static void kvkSetAnimated(bool animated);
+
+        static uint64_t kvkGetRenderedFrameCount();
+
+        static uint64_t kvkGetSkippedFrameCount();
+
+        static int kvkSetComputeEffect(const char* computeShader, uint32_t workgroupX, uint32_t workgroupY);
+
+        static int kvkSetProgressive(uint32_t samplesPerFrame, uint32_t maxSamples);
+
+        static void kvkResetAccumulation();
+
+        static uint32_t kvkGetAccumulatedSamples();
+
+        static double kvkGetEffectTime();
+
+        static double kvkGetRecordTime();
+
+        static uint32_t kvkGetInitStageCount();
+
+        static bool kvkGetInitStage(uint32_t index, InitStage* stage);
+
+        static uint32_t kvkGetDeviceCount();
+
+        static bool kvkGetDeviceReport(uint32_t index, DeviceReport* report);
+
+        static uint32_t kvkSpriteLoadTexture(const char* path);
+
+        static uint32_t kvkSpriteAddPipeline(const char* fragmentShader);
+
+        static void kvkSpriteSubmit(const SpriteData* sprites, uint32_t count);
+
+        static int kvkAtlasLoadImage(const char* path, AtlasRegion* region);
+
+        static uint32_t kvkAtlasGetPageCount();
+
+        static float kvkAtlasGetOccupancy(uint32_t page);
+
+        static uint32_t kvkImageLoad(const char* path);
+
+        static uint32_t kvkPipelineLoad(const char* fragmentShader);
+
+        static int kvkPipelineUse(uint32_t handle);
+
+        static bool kvkResourceValid(uint32_t handle);
+
+        static bool kvkResourceDestroy(uint32_t handle);
+
+        static bool kvkResourceSetEvictable(uint32_t handle, bool evictable);
+
+        static void kvkGetMemoryStats(MemoryStats* stats);
+
+        static void kvkSetMemoryBudget(uint64_t bytes);
+
+        static uint64_t kvkGetHeapUsage(uint32_t heap);
+
         static void kvkPollEvents();
 
         static void kvkTerminate();
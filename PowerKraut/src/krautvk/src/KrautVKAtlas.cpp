@@ -0,0 +1,140 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "KrautVKAtlas.h"
+
+namespace KVKBase {
+
+    AtlasPage::AtlasPage(uint32_t width, uint32_t height) :
+            Skyline(),
+            Width(width),
+            Height(height),
+            UsedArea(0) {
+        Skyline.push_back({0, 0, width});
+    }
+
+    uint32_t AtlasPage::width() const {
+        return Width;
+    }
+
+    uint32_t AtlasPage::height() const {
+        return Height;
+    }
+
+    float AtlasPage::occupancy() const {
+        return static_cast<float>(static_cast<double>(UsedArea) / (static_cast<double>(Width) * Height));
+    }
+
+    //A rect starting at a node rests on the highest skyline segment it spans
+    bool AtlasPage::fit(size_t node, uint32_t width, uint32_t height, uint32_t &y) const {
+        if (Skyline[node].X + width > Width)
+            return false;
+
+        y = 0;
+        uint32_t remaining = width;
+        for (size_t i = node; remaining > 0 && i < Skyline.size(); ++i) {
+            y = std::max(y, Skyline[i].Y);
+            if (y + height > Height)
+                return false;
+
+            remaining -= std::min(remaining, Skyline[i].Width);
+        }
+
+        return true;
+    }
+
+    //Bottom left rule: the position whose top edge ends up lowest, ties go to the narrowest segment
+    bool AtlasPage::insert(uint32_t width, uint32_t height, uint32_t &x, uint32_t &y) {
+        if (width == 0 || height == 0)
+            return false;
+
+        size_t best = Skyline.size();
+        uint32_t bestTop = UINT32_MAX;
+        uint32_t bestWidth = UINT32_MAX;
+        uint32_t bestY = 0;
+
+        for (size_t i = 0; i < Skyline.size(); ++i) {
+            uint32_t nodeY;
+            if (!fit(i, width, height, nodeY))
+                continue;
+
+            if (nodeY + height < bestTop || (nodeY + height == bestTop && Skyline[i].Width < bestWidth)) {
+                best = i;
+                bestTop = nodeY + height;
+                bestWidth = Skyline[i].Width;
+                bestY = nodeY;
+            }
+        }
+
+        if (best == Skyline.size())
+            return false;
+
+        x = Skyline[best].X;
+        y = bestY;
+
+        Skyline.insert(Skyline.begin() + best, {x, y + height, width});
+
+        //Trim the segments the new one now covers
+        for (size_t i = best + 1; i < Skyline.size(); ++i) {
+            uint32_t covered = Skyline[i - 1].X + Skyline[i - 1].Width;
+            if (Skyline[i].X >= covered)
+                break;
+
+            uint32_t shrink = covered - Skyline[i].X;
+            if (Skyline[i].Width > shrink) {
+                Skyline[i].X += shrink;
+                Skyline[i].Width -= shrink;
+                break;
+            }
+
+            Skyline.erase(Skyline.begin() + i);
+            --i;
+        }
+
+        for (size_t i = 0; i + 1 < Skyline.size(); ++i) {
+            if (Skyline[i].Y == Skyline[i + 1].Y) {
+                Skyline[i].Width += Skyline[i + 1].Width;
+                Skyline.erase(Skyline.begin() + i + 1);
+                --i;
+            }
+        }
+
+        UsedArea += static_cast<uint64_t>(width) * height;
+
+        return true;
+    }
+
+    std::vector<char> AtlasPage::extrude(const char *pixels, uint32_t width, uint32_t height, uint32_t gutter) {
+        const uint32_t outWidth = width + 2 * gutter;
+        const uint32_t outHeight = height + 2 * gutter;
+        std::vector<char> output(static_cast<size_t>(outWidth) * outHeight * 4);
+
+        for (uint32_t row = 0; row < outHeight; ++row) {
+            uint32_t sourceRow = std::min(std::max(row, gutter) - gutter, height - 1);
+            const char *source = pixels + static_cast<size_t>(sourceRow) * width * 4;
+            char *destination = &output[static_cast<size_t>(row) * outWidth * 4];
+
+            for (uint32_t column = 0; column < gutter; ++column) {
+                memcpy(destination + column * 4, source, 4);
+                memcpy(destination + (gutter + width + column) * 4, source + (width - 1) * 4, 4);
+            }
+
+            memcpy(destination + gutter * 4, source, static_cast<size_t>(width) * 4);
+        }
+
+        return output;
+    }
+}
@@ -0,0 +1,66 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef KRAUTVKATLAS_H_
+#define KRAUTVKATLAS_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace KVKBase {
+
+    //Skyline packer for one atlas page. Only tracks which rects are taken, the pixels are uploaded by the caller,
+    //so inserting never moves what is already on the page
+    class AtlasPage {
+
+    public:
+
+        AtlasPage(uint32_t width, uint32_t height);
+
+        //Claims a width x height rect, x and y are its top left corner
+        bool insert(uint32_t width, uint32_t height, uint32_t &x, uint32_t &y);
+
+        //Fraction of the page claimed so far
+        float occupancy() const;
+
+        uint32_t width() const;
+
+        uint32_t height() const;
+
+        //Copies an RGBA8 image into a buffer gutter texels larger on every side, repeating the edge texels
+        //outwards so filtering at the image's border never picks up its neighbours
+        static std::vector<char> extrude(const char *pixels, uint32_t width, uint32_t height, uint32_t gutter);
+
+    private:
+
+        struct Node {
+            uint32_t X;
+            uint32_t Y;                 //Height of the skyline over [X, X + Width)
+            uint32_t Width;
+        };
+
+        bool fit(size_t node, uint32_t width, uint32_t height, uint32_t &y) const;
+
+        std::vector<Node> Skyline;
+        uint32_t Width;
+        uint32_t Height;
+        uint64_t UsedArea;
+    };
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+//Standalone shader benchmark, built as krautvk_bench from the same single translation unit as the library:
+//
+//  krautvk_bench [shader] [--width w] [--height h] [--warmup n] [--frames n] [--device name] [--root dir] [--out report.json]
+//
+//The shader is a SPIR-V fragment shader relative to the root, which defaults to the executable's directory,
+//the same layout the library gets from the frontend. Without one the default fragment shader is measured
+
+#include "KrautVK.cpp"
+
+static void kvkBenchUsage() {
+    printf("usage: krautvk_bench [shader] [--width w] [--height h] [--warmup n] [--frames n] [--device name] [--root dir] [--out report.json]\n");
+}
+
+static void kvkBenchPrint(const char *label, const KVKBase::BenchmarkStats &stats) {
+    printf("%s %u samples, mean %.3f ms, median %.3f ms, p95 %.3f ms, p99 %.3f ms, stddev %.3f ms\n",
+           label, stats.samples, stats.mean, stats.median, stats.p95, stats.p99, stats.stddev);
+}
+
+int main(int argc, char **argv) {
+    std::string shader = KVK_FRAGMENT_SHADER;
+    std::string root = argv[0];
+    std::string device;
+    std::string report = "benchmark.json";
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t warmupFrames = 60;
+    uint32_t measuredFrames = 600;
+
+    KVKBase::Tools::findAndReplace(root, std::string("\\"), std::string("/"));
+    root = root.substr(0, root.find_last_of('/') == std::string::npos ? 0 : root.find_last_of('/'));
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--width" && hasValue)
+            width = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--height" && hasValue)
+            height = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--warmup" && hasValue)
+            warmupFrames = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--frames" && hasValue)
+            measuredFrames = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--device" && hasValue)
+            device = argv[++i];
+        else if (argument == "--root" && hasValue)
+            root = argv[++i];
+        else if (argument == "--out" && hasValue)
+            report = argv[++i];
+        else if (argument.compare(0, 2, "--") != 0)
+            shader = argument;
+        else {
+            kvkBenchUsage();
+            return 1;
+        }
+    }
+
+    KVKBase::Tools::rootPath = root;
+
+    //The window only has to exist for the swap chain format, frames go to the offscreen target
+    int status = KVKBase::KrautVK::kvkInit(640, 360, "KrautVK Benchmark", 0, device.empty() ? nullptr : device.c_str());
+    if (status == SUCCESS) {
+        KVKBase::BenchmarkResult result;
+        status = KVKBase::KrautVK::kvkBenchmark(shader.c_str(), width, height, warmupFrames, measuredFrames, report.c_str(), &result);
+
+        if (status == SUCCESS) {
+            printf("%ux%u%s, %.2f MPix/s\n", result.width, result.height, result.offscreen ? " offscreen" : "", result.megapixelsPerSecond);
+            kvkBenchPrint("cpu", result.cpu);
+            kvkBenchPrint("gpu", result.gpu);
+            printf("Report written to %s\n", report.c_str());
+        }
+    }
+
+    KVKBase::KrautVK::kvkTerminate();
+
+    if (status != SUCCESS)
+        printf("Benchmark failed with status %d\n", status);
+
+    return status == SUCCESS ? 0 : 1;
+}
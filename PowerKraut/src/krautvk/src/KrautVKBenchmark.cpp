@@ -0,0 +1,127 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "KrautVKBenchmark.h"
+
+namespace KVKBase {
+
+    double Benchmark::percentile(const std::vector<double> &sorted, double fraction) {
+        size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+    }
+
+    //Paths and device names are written as they are apart from the characters JSON needs escaped
+    std::string Benchmark::escape(const std::string &text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    BenchmarkStats Benchmark::summarize(std::vector<double> samples) {
+        BenchmarkStats stats = {};
+        stats.samples = static_cast<uint32_t>(samples.size());
+        if (samples.empty())
+            return stats;
+
+        std::sort(samples.begin(), samples.end());
+
+        double sum = 0.0;
+        for (double sample : samples)
+            sum += sample;
+
+        stats.mean = sum / samples.size();
+
+        double squares = 0.0;
+        for (double sample : samples)
+            squares += (sample - stats.mean) * (sample - stats.mean);
+
+        size_t middle = samples.size() / 2;
+        stats.median = samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2.0;
+        stats.p95 = percentile(samples, 0.95);
+        stats.p99 = percentile(samples, 0.99);
+        stats.stddev = samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0.0;
+        stats.min = samples.front();
+        stats.max = samples.back();
+
+        return stats;
+    }
+
+    std::string Benchmark::toJson(const BenchmarkStats &stats) {
+        char json[512];
+        snprintf(json, sizeof(json),
+                 "{\"samples\": %u, \"mean\": %.4f, \"median\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"stddev\": %.4f, \"min\": %.4f, \"max\": %.4f}",
+                 stats.samples, stats.mean, stats.median, stats.p95, stats.p99, stats.stddev, stats.min, stats.max);
+
+        return json;
+    }
+
+    bool Benchmark::writeReport(const char *path, const std::string &shader, const std::string &device, uint32_t warmupFrames, const BenchmarkResult &result) {
+        FILE *file = fopen(path, "w");
+        if (file == nullptr)
+            return false;
+
+        fprintf(file, "{\n");
+        fprintf(file, "  \"shader\": \"%s\",\n", escape(shader).c_str());
+        fprintf(file, "  \"device\": \"%s\",\n", escape(device).c_str());
+        fprintf(file, "  \"width\": %u,\n", result.width);
+        fprintf(file, "  \"height\": %u,\n", result.height);
+        fprintf(file, "  \"offscreen\": %s,\n", result.offscreen ? "true" : "false");
+        fprintf(file, "  \"warmupFrames\": %u,\n", warmupFrames);
+        fprintf(file, "  \"cpuFrameMilliseconds\": %s,\n", toJson(result.cpu).c_str());
+        fprintf(file, "  \"gpuFrameMilliseconds\": %s,\n", toJson(result.gpu).c_str());
+        fprintf(file, "  \"megapixelsPerSecond\": %.2f\n", result.megapixelsPerSecond);
+        fprintf(file, "}\n");
+
+        return fclose(file) == 0;
+    }
+
+    bool Benchmark::writeSuite(const char *path, const std::string &device, const std::vector<std::pair<std::string, BenchmarkStats>> &results) {
+        FILE *file = fopen(path, "w");
+        if (file == nullptr)
+            return false;
+
+        fprintf(file, "{\n");
+        fprintf(file, "  \"device\": \"%s\",\n", escape(device).c_str());
+        fprintf(file, "  \"benchmarks\": {\n");
+        for (size_t i = 0; i < results.size(); ++i)
+            fprintf(file, "    \"%s\": %s%s\n", escape(results[i].first).c_str(), toJson(results[i].second).c_str(), i + 1 < results.size() ? "," : "");
+        fprintf(file, "  }\n");
+        fprintf(file, "}\n");
+
+        return fclose(file) == 0;
+    }
+
+    //Only understands the layout writeSuite produces, a flat object of stats per name
+    bool Benchmark::readSuiteMeans(const char *path, std::unordered_map<std::string, double> &means) {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+
+        std::stringstream contents;
+        contents << file.rdbuf();
+        const std::string json = contents.str();
+
+        static const std::regex entry("\"([^\"]+)\": \\{[^{}]*\"mean\": ([-+0-9.eE]+)");
+        for (std::sregex_iterator match(json.begin(), json.end(), entry), end; match != end; ++match)
+            means[(*match)[1].str()] = std::stod((*match)[2].str());
+
+        return !means.empty();
+    }
+}
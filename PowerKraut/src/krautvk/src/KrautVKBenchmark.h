@@ -0,0 +1,81 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef KRAUTVKBENCHMARK_H_
+#define KRAUTVKBENCHMARK_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <regex>
+#include <unordered_map>
+
+namespace KVKBase {
+
+    //Summary of a series of samples, in whatever unit they were taken
+    struct BenchmarkStats {
+        double mean;
+        double median;
+        double p95;
+        double p99;
+        double stddev;
+        double min;
+        double max;
+        uint32_t samples;
+    };
+
+    //Result of rendering one shader for a fixed number of frames
+    struct BenchmarkResult {
+        BenchmarkStats cpu;             //Milliseconds between the starts of consecutive frames
+        BenchmarkStats gpu;             //Milliseconds of GPU work per frame, no samples without timestamp support
+        double megapixelsPerSecond;     //Pixels shaded per second at the mean GPU time, 0 without timestamp support
+        uint32_t width;
+        uint32_t height;
+        uint32_t offscreen;             //1 if frames went to an offscreen target rather than the swap chain
+    };
+
+    class Benchmark {
+
+    public:
+
+        //Nearest rank percentiles, sample standard deviation
+        static BenchmarkStats summarize(std::vector<double> samples);
+
+        //A stats object as a JSON object, for reports
+        static std::string toJson(const BenchmarkStats &stats);
+
+        static bool writeReport(const char *path, const std::string &shader, const std::string &device, uint32_t warmupFrames, const BenchmarkResult &result);
+
+        //A named series of stats, one JSON object per name under "benchmarks"
+        static bool writeSuite(const char *path, const std::string &device, const std::vector<std::pair<std::string, BenchmarkStats>> &results);
+
+        //Reads back each benchmark's mean from a file writeSuite wrote, for comparing a run against a baseline
+        static bool readSuiteMeans(const char *path, std::unordered_map<std::string, double> &means);
+
+    private:
+
+        static double percentile(const std::vector<double> &sorted, double fraction);
+
+        static std::string escape(const std::string &text);
+    };
+}
+
+#endif
@@ -18,7 +18,31 @@ limitations under the License.
 
 namespace KVKBase {
 
-    Com::KrautCommon Com::kraut;
+    std::vector<std::unique_ptr<Com::KrautCommon>> Com::Contexts;
+
+    std::mutex Com::ContextsMutex;
+
+    Com::KrautCommon *const Com::Default = Com::FindContext(Com::AddContext());
+
+    thread_local Com::KrautCommon *Com::Current = Com::Default;
+
+    uint32_t Com::AddContext() {
+        std::lock_guard<std::mutex> lock(ContextsMutex);
+        Contexts.emplace_back(new KrautCommon());
+        return static_cast<uint32_t>(Contexts.size());
+    }
+
+    Com::KrautCommon *Com::FindContext(uint32_t context) {
+        std::lock_guard<std::mutex> lock(ContextsMutex);
+        if (context == 0 || context > Contexts.size())
+            return nullptr;
+
+        return Contexts[context - 1].get();
+    }
+
+    std::mutex &Com::SharedDeviceParameters::QueueMutex(VkQueue queue) {
+        return queue == PresentQueue && queue != GraphicsQueue ? PresentQueueMutex : GraphicsQueueMutex;
+    }
 
     std::string Tools::rootPath = std::string("");
 
@@ -160,32 +184,196 @@ namespace KVKBase {
         };
 
         VkShaderModule shaderModule;
-        if(createShaderModule(Com::kraut.Vulkan.Device.Handle, &shaderModuleCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        if(vkd.createShaderModule(Com::Current->Vulkan.Device.Handle, &shaderModuleCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
             return GarbageCollector<VkShaderModule, PFN_vkDestroyShaderModule>();
         }
 
-        return GarbageCollector<VkShaderModule, PFN_vkDestroyShaderModule>(shaderModule, destroyShaderModule, Com::kraut.Vulkan.Device.Handle);
+        return GarbageCollector<VkShaderModule, PFN_vkDestroyShaderModule>(shaderModule, vkd.destroyShaderModule, Com::Current->Vulkan.Device.Handle);
+
+    }
+
+    void DeletionQueue::collect(uint64_t completedFrame) {
+        while (!Pending.empty() && Pending.front().Frame <= completedFrame) {
+            Pending.front().Destroy();
+            Pending.pop_front();
+        }
+    }
+
+    void DeletionQueue::flush() {
+        for (Entry &entry : Pending)
+            entry.Destroy();
+
+        Pending.clear();
+    }
+
+    size_t DeletionQueue::size() const {
+        return Pending.size();
+    }
+
+    size_t Com::PipelineVariantKeyHash::operator()(const Com::PipelineVariantKey &key) const {
+        //boost style hash_combine
+        size_t seed = std::hash<std::string>()(key.VertexShader);
+        seed ^= std::hash<std::string>()(key.FragmentShader) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<VkRenderPass>()(key.RenderPass) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<VkPipelineLayout>()(key.Layout) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<bool>()(key.Sprite) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(key.Blend) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+
+        for (const SpecializationConstant &constant : key.Constants) {
+            seed ^= std::hash<uint32_t>()(constant.ConstantID) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= std::hash<uint32_t>()(constant.Value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+
+        return seed;
+    }
 
+    size_t Com::SamplerKeyHash::operator()(const Com::SamplerKey &key) const {
+        const VkSamplerCreateInfo &info = key.Info;
+
+        size_t seed = std::hash<uint32_t>()(info.flags);
+        seed ^= std::hash<uint32_t>()(info.magFilter) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(info.minFilter) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(info.mipmapMode) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(info.addressModeU) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(info.addressModeV) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(info.addressModeW) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<float>()(info.mipLodBias) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(info.anisotropyEnable) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<float>()(info.maxAnisotropy) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(info.compareEnable) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(info.compareOp) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<float>()(info.minLod) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<float>()(info.maxLod) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(info.borderColor) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>()(info.unnormalizedCoordinates) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+
+        return seed;
+    }
+
+    void Com::MemoryParameters::Track(VkDeviceMemory memory, uint32_t memoryType, VkDeviceSize size) {
+        uint32_t heap = Com::Current->Vulkan.Device.MemoryProperties.memoryTypes[memoryType].heapIndex;
+        Com::SharedDeviceParameters &shared = *Com::Current->Vulkan.Device.Shared;
+
+        std::lock_guard<std::mutex> lock(shared.MemoryMutex);
+        shared.Allocations[memory] = {heap, size};
+        shared.HeapUsage[heap] += size;
+    }
+
+    void Com::MemoryParameters::Free(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks *allocator) {
+        Com::SharedDeviceParameters &shared = *Com::Current->Vulkan.Device.Shared;
+
+        {
+            std::lock_guard<std::mutex> lock(shared.MemoryMutex);
+            std::unordered_map<VkDeviceMemory, MemoryAllocation>::iterator allocation = shared.Allocations.find(memory);
+            if (allocation != shared.Allocations.end()) {
+                shared.HeapUsage[allocation->second.Heap] -= allocation->second.Size;
+                shared.Allocations.erase(allocation);
+            }
+        }
+
+        vkd.freeMemory(device, memory, allocator);
     }
 
     void Com::RenderingResourcesData::DestroyResources() {
         //Destroy Framebuffer
         if (Framebuffer != VK_NULL_HANDLE)
-            destroyFramebuffer(Com::kraut.Vulkan.Device.Handle, Framebuffer, nullptr);
+            vkd.destroyFramebuffer(Com::Current->Vulkan.Device.Handle, Framebuffer, nullptr);
 
         //Destroy Command Buffer
         if (CommandBuffer != VK_NULL_HANDLE)
-            freeCommandBuffers(Com::kraut.Vulkan.Device.Handle, Com::kraut.Vulkan.CommandPool, 1, &CommandBuffer);
+            vkd.freeCommandBuffers(Com::Current->Vulkan.Device.Handle, Com::Current->Vulkan.CommandPool, 1, &CommandBuffer);
 
         //Destroy Semaphores
         if (ImageAvailableSemaphore != VK_NULL_HANDLE)
-            destroySemaphore(Com::kraut.Vulkan.Device.Handle, ImageAvailableSemaphore, nullptr);
+            vkd.destroySemaphore(Com::Current->Vulkan.Device.Handle, ImageAvailableSemaphore, nullptr);
 
         if (FinishedRenderingSemaphore != VK_NULL_HANDLE)
-            destroySemaphore(Com::kraut.Vulkan.Device.Handle, FinishedRenderingSemaphore, nullptr);
+            vkd.destroySemaphore(Com::Current->Vulkan.Device.Handle, FinishedRenderingSemaphore, nullptr);
 
         if (Fence != VK_NULL_HANDLE)
-            destroyFence(Com::kraut.Vulkan.Device.Handle, Fence, nullptr);
+            vkd.destroyFence(Com::Current->Vulkan.Device.Handle, Fence, nullptr);
+
+        if (TimestampPool != VK_NULL_HANDLE)
+            vkd.destroyQueryPool(Com::Current->Vulkan.Device.Handle, TimestampPool, nullptr);
+
+        //Freeing the memory unmaps it
+        if (SpriteBuffer.Handle != VK_NULL_HANDLE)
+            vkd.destroyBuffer(Com::Current->Vulkan.Device.Handle, SpriteBuffer.Handle, nullptr);
+
+        if (SpriteBuffer.Memory != VK_NULL_HANDLE)
+            Com::MemoryParameters::Free(Com::Current->Vulkan.Device.Handle, SpriteBuffer.Memory, nullptr);
+
+        if (Readback.Handle != VK_NULL_HANDLE)
+            vkd.destroyBuffer(Com::Current->Vulkan.Device.Handle, Readback.Handle, nullptr);
+
+        if (Readback.Memory != VK_NULL_HANDLE)
+            Com::MemoryParameters::Free(Com::Current->Vulkan.Device.Handle, Readback.Memory, nullptr);
+
+        TransientDescriptors.Destroy();
+    }
+
+    bool Com::DescriptorAllocator::Allocate(VkDescriptorSetLayout layout, VkDescriptorSet *set) {
+        while (true) {
+            bool fresh = false;
+
+            if (Current == Pools.size()) {
+                VkDescriptorPoolSize poolSizes[] = {
+                        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, SetsPerPool * KVK_DESCRIPTOR_SAMPLERS_PER_SET},
+                        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, SetsPerPool * KVK_DESCRIPTOR_STORAGE_PER_SET}
+                };
+
+                VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+                        VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,  // VkStructureType                sType
+                        nullptr,                                        // const void                    *pNext
+                        0,                                              // VkDescriptorPoolCreateFlags    flags
+                        SetsPerPool,                                    // uint32_t                       maxSets
+                        2,                                              // uint32_t                       poolSizeCount
+                        poolSizes                                       // const VkDescriptorPoolSize    *pPoolSizes
+                };
+
+                VkDescriptorPool pool;
+                if (vkd.createDescriptorPool(Com::Current->Vulkan.Device.Handle, &descriptorPoolCreateInfo, nullptr, &pool) != VK_SUCCESS)
+                    return false;
+
+                Pools.push_back(pool);
+                SetsPerPool = std::min<uint32_t>(SetsPerPool * 2, KVK_DESCRIPTOR_POOL_MAX_SETS);
+                fresh = true;
+            }
+
+            VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+                    VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, // VkStructureType                sType
+                    nullptr,                                        // const void                    *pNext
+                    Pools[Current],                                 // VkDescriptorPool               descriptorPool
+                    1,                                              // uint32_t                       descriptorSetCount
+                    &layout                                         // const VkDescriptorSetLayout   *pSetLayouts
+            };
+
+            VkResult result = vkd.allocateDescriptorSets(Com::Current->Vulkan.Device.Handle, &descriptorSetAllocateInfo, set);
+            if (result == VK_SUCCESS)
+                return true;
+
+            //A set that doesn't fit in an empty pool never will
+            if (fresh || (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL))
+                return false;
+
+            ++Current;
+        }
+    }
+
+    void Com::DescriptorAllocator::Reset() {
+        for (VkDescriptorPool pool : Pools)
+            vkd.resetDescriptorPool(Com::Current->Vulkan.Device.Handle, pool, 0);
+
+        Current = 0;
+    }
+
+    void Com::DescriptorAllocator::Destroy() {
+        for (VkDescriptorPool pool : Pools)
+            vkd.destroyDescriptorPool(Com::Current->Vulkan.Device.Handle, pool, nullptr);
+
+        Pools.clear();
+        Current = 0;
+        SetsPerPool = KVK_DESCRIPTOR_POOL_SETS;
     }
 }
 
@@ -19,11 +19,22 @@ limitations under the License.
 
 #include <cmath>
 #include <cstdio>
+#include <cstddef>
 #include <vector>
 #include <iostream>
 #include <fstream>
 #include <cstring>
 #include <array>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <mutex>
+#include <atomic>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
@@ -31,6 +42,14 @@ limitations under the License.
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#include "KrautVKRenderGraph.h"
+#include "KrautVKAtlas.h"
+#include "KrautVKRegistry.h"
+#include "KrautVKDispatch.h"
+#include "KrautVKBenchmark.h"
+#include "KrautVKTaskGraph.h"
+#include "KrautVKFrameWriter.h"
+
 //MACROS
 #define SUCCESS (0)
 #define GLFW_INIT_FAILED (-1)
@@ -47,6 +66,10 @@ limitations under the License.
 #define VULKAN_FENCE_CREATION_FAILED (-12)
 #define VULKAN_COMMAND_BUFFER_CREATION_FAILED (-13)
 #define VULKAN_DESCRIPTOR_SET_CREATION_FAILED (-14)
+#define VULKAN_RENDER_GRAPH_CREATION_FAILED (-15)
+#define VULKAN_COMPUTE_PIPELINE_CREATION_FAILED (-16)
+#define BENCHMARK_FAILED (-17)
+#define CAPTURE_FAILED (-18)
 
 //SETTINGS
 //__SHADERS & RASTER
@@ -56,6 +79,82 @@ limitations under the License.
 #define KVK_INSTANCE_COUNT          (1)
 #define KVK_CULL_MODE               VK_CULL_MODE_BACK_BIT
 #define KVK_CULL_FRONT_FACE         VK_FRONT_FACE_COUNTER_CLOCKWISE
+#define KVK_VERTEX_SHADER           "/data/shadervert.spv"
+#define KVK_FRAGMENT_SHADER         "/data/shaderfrag.spv"
+
+//__COMPUTE
+#define KVK_COMPUTE_SHADER          "/data/shadercomp.spv"
+#define KVK_COMPUTE_WORKGROUP_X     (16)
+#define KVK_COMPUTE_WORKGROUP_Y     (16)
+#define KVK_COMPUTE_TARGET_FORMAT   VK_FORMAT_R8G8B8A8_UNORM
+#define KVK_ACCUMULATION_FORMAT     VK_FORMAT_R32G32B32A32_SFLOAT  //Storage support is required for it, so no format query
+
+//__SPRITES
+#define KVK_SPRITE_VERTEX_SHADER    "/data/spritevert.spv"
+#define KVK_SPRITE_FRAGMENT_SHADER  "/data/spritefrag.spv"
+#define KVK_SPRITE_CAPACITY         (131072)
+#define KVK_SPRITE_MAX_TEXTURES     (256)
+#define KVK_SPRITE_MAX_PIPELINES    (16)
+#define KVK_SPRITE_LAYER_COUNT      (16)
+#define KVK_SPRITE_BINDLESS_SHADER  "/data/spritebindlessfrag.spv"
+
+//__BINDLESS TEXTURES
+#define KVK_BINDLESS_CAPACITY       (4096)
+
+//__ATLAS
+#define KVK_ATLAS_PAGE_SIZE         (2048)
+#define KVK_ATLAS_MAX_IMAGE_SIZE    (256)      //Larger images get a texture of their own
+#define KVK_ATLAS_GUTTER            (2)        //Edge texels repeated around every image
+#define KVK_ATLAS_PADDING           (1)        //Empty texels between neighbouring gutters
+
+//__DESCRIPTORS
+#define KVK_DESCRIPTOR_POOL_SETS            (32)       //Sets in the first pool of an allocator, each new pool doubles it
+#define KVK_DESCRIPTOR_POOL_MAX_SETS        (1024)
+#define KVK_DESCRIPTOR_SAMPLERS_PER_SET     (4)        //Average descriptors per set a pool is sized for
+#define KVK_DESCRIPTOR_STORAGE_PER_SET      (1)
+
+//__MEMORY BUDGET
+#define KVK_MEMORY_BUDGET               (0)        //Bytes of device local memory before eviction starts, 0 derives it
+#define KVK_MEMORY_BUDGET_FRACTION      (0.9)      //Of the driver's budget, or of the heap sizes without VK_EXT_memory_budget
+#define KVK_EVICTION_MIN_AGE            (120)      //Frames a resource has to go unused before it can be evicted
+
+//__DEVICE SELECTION
+#define KVK_SCORE_DISCRETE_GPU      (1000)
+#define KVK_SCORE_INTEGRATED_GPU    (400)
+#define KVK_SCORE_VIRTUAL_GPU       (200)
+#define KVK_SCORE_PER_GIB           (50)       //Per GiB of device local memory
+#define KVK_SCORE_MAX_GIB           (16)       //Memory beyond this doesn't make a device faster for us
+#define KVK_SCORE_QUEUE_FAMILY      (60)       //Per dedicated compute or transfer family
+#define KVK_SCORE_SHARED_PRESENT    (40)       //Graphics and presentation on one family
+#define KVK_SCORE_FEATURE           (30)       //Per optional format or feature the engine can use
+
+//__DYNAMIC RESOLUTION
+#define KVK_UPSCALE_SHADER          "/data/upscalefrag.spv"
+#define KVK_DYNAMIC_RES_HEADROOM    (0.9)      //Fraction of the target frame time the controller aims for
+#define KVK_DYNAMIC_RES_SMOOTHING   (0.1)      //How far toward the ideal scale each measured frame moves
+#define KVK_DYNAMIC_RES_ALIGNMENT   (8)        //Scaled extents are multiples of this many pixels
+#define KVK_DYNAMIC_RES_MIN_SCALE   (0.25)     //Lowest minimum scale the frontend can ask for
+
+//__LAYERS
+#define KVK_COMPOSITE_SHADER        "/data/compositefrag.spv"
+
+//__OUTPUT
+#define KVK_OUTPUT_SHADER           "/data/yuvcomp.spv"
+#define KVK_DOWNSAMPLE_SHADER       "/data/downsamplecomp.spv"
+#define KVK_OUTPUT_WORKGROUP        (8)        //Square workgroups, every conversion invocation converts an 8x2 block of pixels
+#define KVK_OUTPUT_CAPACITY         (8)        //Outputs converted from a single frame
+#define KVK_OUTPUT_IMAGE_FORMAT     VK_FORMAT_R8G8B8A8_UNORM   //Of downsampled outputs, holds sRGB encoded color
+
+//__CAPTURE
+#define KVK_CAPTURE_THREADS         (0)        //Threads PNG frames encode on, 0 uses one per hardware thread
+#define KVK_CAPTURE_QUEUE           (16)       //Frames waiting to be written before rendering waits on the disk
+
+//__IDLE FRAMES
+#define KVK_IDLE_WAIT               (0.016)    //Seconds kvkPollEvents waits for input once every context skipped its frame
+
+//__INITIALIZATION
+#define KVK_INIT_THREADS            (0)        //Threads the startup tasks run on, 0 uses one per hardware thread
+#define KVK_INIT_STAGE_NAME_SIZE    (32)
 
 //__RENDERING RESOURCES
 #define KVK_RESOURCE_COUNT          (3)
@@ -66,89 +165,6 @@ namespace KVKBase {
     //KRAUTVK VERSION
     uint32_t version = VK_MAKE_VERSION(krautvk_VERSION_MAJOR, krautvk_VERSION_MINOR, 0);
 
-    //VULKAN FUNCTION POINTERS
-    PFN_vkCreateInstance createInstance;
-
-    PFN_vkCreateDevice createDevice;
-    PFN_vkEnumeratePhysicalDevices enumeratePhysicalDevices;
-    PFN_vkGetPhysicalDeviceProperties getPhysicalDeviceProperties;
-    PFN_vkGetPhysicalDeviceFeatures getPhysicalDeviceFeatures;
-    PFN_vkGetPhysicalDeviceQueueFamilyProperties getPhysicalDeviceQueueFamilyProperties;
-    PFN_vkDestroyInstance destroyInstance;
-    PFN_vkEnumerateDeviceExtensionProperties enumerateDeviceExtensionProperties;
-    PFN_vkDestroySurfaceKHR destroySurfaceKHR;
-    PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR getPhysicalDeviceSurfaceCapabilitiesKHR;
-    PFN_vkGetPhysicalDeviceSurfaceFormatsKHR getPhysicalDeviceSurfaceFormatsKHR;
-    PFN_vkGetPhysicalDeviceSurfacePresentModesKHR getPhysicalDeviceSurfacePresentModesKHR;
-
-    PFN_vkGetDeviceProcAddr getDeviceProcAddr;
-    PFN_vkGetDeviceQueue getDeviceQueue;
-    PFN_vkDeviceWaitIdle deviceWaitIdle;
-    PFN_vkDestroyDevice destroyDevice;
-    PFN_vkDestroyImageView destroyImageView;
-    PFN_vkCreateSemaphore createSemaphore;
-    PFN_vkCreateSwapchainKHR createSwapchainKHR;
-    PFN_vkCreateImageView createImageView;
-    PFN_vkCreateRenderPass createRenderPass;
-    PFN_vkCreateFramebuffer createFramebuffer;
-    PFN_vkCreateShaderModule createShaderModule;
-    PFN_vkDestroySwapchainKHR destroySwapchainKHR;
-    PFN_vkDestroyShaderModule destroyShaderModule;
-    PFN_vkGetSwapchainImagesKHR getSwapchainImagesKHR;
-    PFN_vkAcquireNextImageKHR acquireNextImageKHR;
-    PFN_vkQueuePresentKHR queuePresentKHR;
-    PFN_vkQueueSubmit queueSubmit;
-    PFN_vkCreateCommandPool createCommandPool;
-    PFN_vkAllocateCommandBuffers allocateCommandBuffers;
-    PFN_vkFreeCommandBuffers freeCommandBuffers;
-    PFN_vkDestroyCommandPool destroyCommandPool;
-    PFN_vkDestroySemaphore destroySemaphore;
-    PFN_vkBeginCommandBuffer beginCommandBuffer;
-    PFN_vkCmdPipelineBarrier cmdPipelineBarrier;
-    PFN_vkEndCommandBuffer endCommandBuffer;
-    PFN_vkCmdBeginRenderPass cmdBeginRenderPass;
-    PFN_vkCmdBindPipeline cmdBindPipeline;
-    PFN_vkCmdDraw cmdDraw;
-    PFN_vkCmdEndRenderPass cmdEndRenderPass;
-    PFN_vkDestroyPipeline destroyPipeline;
-    PFN_vkDestroyRenderPass destroyRenderPass;
-    PFN_vkDestroyFramebuffer destroyFramebuffer;
-    PFN_vkCreateGraphicsPipelines createGraphicsPipelines;
-    PFN_vkCreatePipelineLayout createPipelineLayout;
-    PFN_vkDestroyPipelineLayout destroyPipelineLayout;
-    PFN_vkCreateBuffer createBuffer;
-    PFN_vkBindBufferMemory bindBufferMemory;
-    PFN_vkMapMemory mapMemory;
-    PFN_vkFlushMappedMemoryRanges flushMappedMemoryRanges;
-    PFN_vkUnmapMemory unmapMemory;
-    PFN_vkGetBufferMemoryRequirements getBufferMemoryRequirements;
-    PFN_vkGetPhysicalDeviceMemoryProperties getPhysicalDeviceMemoryProperties;
-    PFN_vkAllocateMemory allocateMemory;
-    PFN_vkCreateFence createFence;
-    PFN_vkDestroyFence destroyFence;
-    PFN_vkDestroyBuffer destroyBuffer;
-    PFN_vkFreeMemory freeMemory;
-    PFN_vkResetFences resetFences;
-    PFN_vkWaitForFences waitForFences;
-    PFN_vkCmdSetViewport cmdSetViewport;
-    PFN_vkCmdSetScissor cmdSetScissor;
-    PFN_vkCmdBindVertexBuffers cmdBindVertexBuffers;
-    PFN_vkCmdCopyBuffer cmdCopyBuffer;
-    PFN_vkBindImageMemory bindImageMemory;
-    PFN_vkCreateSampler createSampler;
-    PFN_vkCmdCopyBufferToImage cmdCopyBufferToImage;
-    PFN_vkCreateImage createImage;
-    PFN_vkGetImageMemoryRequirements getImageMemoryRequirements;
-    PFN_vkCreateDescriptorSetLayout createDescriptorSetLayout;
-    PFN_vkCreateDescriptorPool createDescriptorPool;
-    PFN_vkAllocateDescriptorSets allocateDescriptorSets;
-    PFN_vkUpdateDescriptorSets updateDescriptorSets;
-    PFN_vkCmdBindDescriptorSets cmdBindDescriptorSets;
-    PFN_vkDestroyDescriptorPool destroyDescriptorPool;
-    PFN_vkDestroyDescriptorSetLayout destroyDescriptorSetLayout;
-    PFN_vkDestroySampler destroySampler;
-    PFN_vkDestroyImage destroyImage;
-
     template<class T, class F>
     class GarbageCollector {
     public:
@@ -201,6 +217,35 @@ namespace KVKBase {
         VkDevice  Device{};
     };
 
+    //Deferred counterpart of GarbageCollector. A released object is tagged with the last frame submitted before the
+    //release, and destroyed by collect once the GPU has finished that frame
+    class DeletionQueue {
+    public:
+        template<class T, class F>
+        void release(T object, F deleter, VkDevice device, uint64_t frame) {
+            if((object == VK_NULL_HANDLE) || (deleter == nullptr) || (device == VK_NULL_HANDLE))
+                return;
+
+            Pending.push_back({frame, [object, deleter, device]() { deleter(device, object, nullptr); }});
+        }
+
+        //Destroys everything released up to and including completedFrame
+        void collect(uint64_t completedFrame);
+
+        //Destroys everything. Only safe once the device is idle
+        void flush();
+
+        size_t size() const;
+
+    private:
+        struct Entry {
+            uint64_t Frame;
+            std::function<void()> Destroy;
+        };
+
+        std::deque<Entry> Pending;          //Frames never decrease, so the oldest entries are at the front
+    };
+
     class Tools{
     public :
         static std::string rootPath;
@@ -224,24 +269,241 @@ namespace KVKBase {
         float   u, v;                   //Coord
     };
 
+    //One sprite, copied as is into the per-instance vertex buffer. Layer, texture and pipeline are only sort keys
+    struct SpriteData {
+        float   x, y, width, height;    //Center and size, in pixels
+        float   u0, v0, u1, v1;         //UV rect
+        float   r, g, b, a;             //Color
+        float   rotation;               //Radians
+        uint32_t layer, texture, pipeline;
+    };
+
+    //Where a loaded image ended up, in the same terms a SpriteData references it
+    struct AtlasRegion {
+        uint32_t texture;               //Sprite texture index
+        uint32_t page;                  //UINT32_MAX if the image was too large to pack
+        float   u0, v0, u1, v1;         //UV rect
+    };
+
+    //Device local memory as seen by the budget tracker
+    struct MemoryStats {
+        uint64_t usage;                 //Bytes in device local heaps, the driver's count when it reports one
+        uint64_t budget;                //Eviction starts above this
+        uint64_t allocated;             //Bytes every context on the device has allocated, across all heaps
+        uint32_t evictedImages;
+        uint32_t evictedPipelines;
+        uint32_t driverBudget;          //1 if usage and budget come from VK_EXT_memory_budget
+    };
+
+    //What device selection found out about a physical device
+    struct DeviceReport {
+        char name[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE];
+        uint8_t uuid[VK_UUID_SIZE];
+        uint64_t deviceLocalMemory;     //Bytes over every device local heap
+        uint64_t sharedMemory;          //Bytes over the remaining heaps
+        int64_t score;                  //-1 if the device can't run the engine
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t deviceType;            //VkPhysicalDeviceType
+        uint32_t apiVersion;
+        uint32_t driverVersion;
+        uint32_t graphicsFamily;
+        uint32_t presentFamily;
+        uint32_t computeFamily;         //Compute without graphics, UINT32_MAX if there is none
+        uint32_t transferFamily;        //Transfer only, UINT32_MAX if there is none
+        uint32_t maxImageDimension2D;
+        uint32_t floatTargets;          //1 if R16G16B16A16_SFLOAT can be rendered to and filtered
+        uint32_t storageTarget;         //1 if the compute target format can be written and blitted
+        uint32_t bindless;              //1 if VK_EXT_descriptor_indexing is available
+        uint32_t memoryBudget;          //1 if VK_EXT_memory_budget is available
+        uint32_t timestamps;            //1 if the graphics queue can write timestamps
+        uint32_t selected;
+    };
+
+    //One task of the last kvkInit, times in milliseconds since the task graph started
+    struct InitStage {
+        char name[KVK_INIT_STAGE_NAME_SIZE];
+        double start;
+        double milliseconds;
+        uint32_t thread;                //0 is the thread kvkInit was called on
+    };
+
+    //Fixed function blending of a pipeline onto its target. Sprites blend straight alpha, the layer modes take color
+    //the composite shader premultiplied with the layer's alpha and opacity
+    enum BlendMode : uint32_t {
+        BLEND_OPAQUE = 0,
+        BLEND_ALPHA = 1,
+        BLEND_NORMAL = 2,
+        BLEND_ADD = 3,
+        BLEND_MULTIPLY = 4,
+        BLEND_SCREEN = 5
+    };
+
+    //What an offscreen frame is converted to for readback. The YUV formats are planar 4:2:0 BT.709 in either range,
+    //NV12 is the Y plane then interleaved UV, I420 the Y, U and V planes one after the other. RGBA is 8 bits a channel
+    enum OutputFormat : uint32_t {
+        OUTPUT_NONE = 0,
+        OUTPUT_NV12 = 1,
+        OUTPUT_I420 = 2,
+        OUTPUT_RGBA = 3
+    };
+
+    //How an output smaller than the one it's made from is filtered down. Box averages the covered area, bilinear
+    //takes one filtered sample, Lanczos is a three lobe windowed sinc
+    enum DownsampleFilter : uint32_t {
+        FILTER_BOX = 0,
+        FILTER_BILINEAR = 1,
+        FILTER_LANCZOS = 2
+    };
+
     //Important structures to keep Engine Data
     class Com {
 
     public:
 
+        //A single specialization constant. Values are stored as raw 32 bit words, so ints, floats and bools all fit
+        struct SpecializationConstant {
+            uint32_t ConstantID;
+            uint32_t Value;
+
+            bool operator==(const SpecializationConstant &other) const {
+                return ConstantID == other.ConstantID && Value == other.Value;
+            }
+        };
+
+        //Everything that makes one compiled pipeline different from another
+        struct PipelineVariantKey {
+            std::string VertexShader;
+            std::string FragmentShader;
+            std::vector<SpecializationConstant> Constants;
+            VkRenderPass RenderPass;
+            VkPipelineLayout Layout;
+            bool Sprite;            //Instanced SpriteData input with alpha blending
+            uint32_t Blend;         //BlendMode, sprites always blend BLEND_ALPHA
+
+            PipelineVariantKey() :
+                    VertexShader(),
+                    FragmentShader(),
+                    Constants(),
+                    RenderPass(VK_NULL_HANDLE),
+                    Layout(VK_NULL_HANDLE),
+                    Sprite(false),
+                    Blend(BLEND_OPAQUE) {
+            }
+
+            bool operator==(const PipelineVariantKey &other) const {
+                return RenderPass == other.RenderPass &&
+                       Layout == other.Layout &&
+                       Sprite == other.Sprite &&
+                       Blend == other.Blend &&
+                       Constants == other.Constants &&
+                       FragmentShader == other.FragmentShader &&
+                       VertexShader == other.VertexShader;
+            }
+        };
+
+        struct PipelineVariantKeyHash {
+            size_t operator()(const PipelineVariantKey &key) const;
+        };
+
+        typedef std::unordered_map<PipelineVariantKey, VkPipeline, PipelineVariantKeyHash> PipelineVariantCache;
+
+        //The full sampler state. pNext chains are not part of the key, so they aren't allowed
+        struct SamplerKey {
+            VkSamplerCreateInfo Info;
+
+            explicit SamplerKey(const VkSamplerCreateInfo &info) :
+                    Info(info) {
+            }
+
+            bool operator==(const SamplerKey &other) const {
+                return Info.flags == other.Info.flags &&
+                       Info.magFilter == other.Info.magFilter &&
+                       Info.minFilter == other.Info.minFilter &&
+                       Info.mipmapMode == other.Info.mipmapMode &&
+                       Info.addressModeU == other.Info.addressModeU &&
+                       Info.addressModeV == other.Info.addressModeV &&
+                       Info.addressModeW == other.Info.addressModeW &&
+                       Info.mipLodBias == other.Info.mipLodBias &&
+                       Info.anisotropyEnable == other.Info.anisotropyEnable &&
+                       Info.maxAnisotropy == other.Info.maxAnisotropy &&
+                       Info.compareEnable == other.Info.compareEnable &&
+                       Info.compareOp == other.Info.compareOp &&
+                       Info.minLod == other.Info.minLod &&
+                       Info.maxLod == other.Info.maxLod &&
+                       Info.borderColor == other.Info.borderColor &&
+                       Info.unnormalizedCoordinates == other.Info.unnormalizedCoordinates;
+            }
+        };
+
+        struct SamplerKeyHash {
+            size_t operator()(const SamplerKey &key) const;
+        };
+
+        //Samplers are shared by everything created with the same state and destroyed with their last reference
+        struct SamplerEntry {
+            VkSampler Handle;
+            uint32_t References;
+        };
+
+        typedef std::unordered_map<SamplerKey, SamplerEntry, SamplerKeyHash> SamplerCache;
+
+        struct MemoryAllocation {
+            uint32_t Heap;
+            VkDeviceSize Size;
+        };
+
+        //What every context on a device has in common. The context creating the device creates it, contexts sharing
+        //the device hold on to it, and it is destroyed with the device. Contexts may render on different threads, so
+        //each part is only touched under its own mutex
+        struct SharedDeviceParameters {
+            VkQueue GraphicsQueue;
+            VkQueue PresentQueue;
+            std::mutex GraphicsQueueMutex;      //Also guards presents when the present queue is the graphics queue
+            std::mutex PresentQueueMutex;
+
+            VkPipelineCache PipelineCache;      //Internally synchronized, every context builds its pipelines through it
+
+            std::mutex SamplerMutex;
+            SamplerCache Samplers;
+
+            std::mutex MemoryMutex;
+            std::unordered_map<VkDeviceMemory, MemoryAllocation> Allocations;
+            std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> HeapUsage;
+
+            std::mutex &QueueMutex(VkQueue queue);
+
+            SharedDeviceParameters() :
+                    GraphicsQueue(VK_NULL_HANDLE),
+                    PresentQueue(VK_NULL_HANDLE),
+                    GraphicsQueueMutex(),
+                    PresentQueueMutex(),
+                    PipelineCache(VK_NULL_HANDLE),
+                    SamplerMutex(),
+                    Samplers(),
+                    MemoryMutex(),
+                    Allocations(),
+                    HeapUsage() {
+            }
+        };
+
         struct DeviceParameters {
             VkDevice Handle;
             VkPhysicalDevice PhysicalDevice;
             VkPhysicalDeviceMemoryProperties MemoryProperties;
             VkPhysicalDeviceProperties Properties;
             VkPhysicalDeviceFeatures Features;
+            DeviceDispatch Dispatch;
+            std::shared_ptr<SharedDeviceParameters> Shared;
 
             DeviceParameters() :
             Handle(VK_NULL_HANDLE),
             PhysicalDevice(VK_NULL_HANDLE),
             MemoryProperties(),
             Properties(),
-            Features() {
+            Features(),
+            Dispatch(),
+            Shared() {
 
             }
         };
@@ -259,7 +521,7 @@ namespace KVKBase {
         struct ImageParameters {
             VkImage Handle;
             VkImageView View;
-            VkSampler Sampler;
+            VkSampler Sampler;          //Borrowed from the sampler cache, released rather than destroyed
             VkDeviceMemory Memory;
 
             ImageParameters() :
@@ -294,6 +556,38 @@ namespace KVKBase {
             }
         };
 
+        //Hands out sets from a chain of pools, adding a larger pool whenever the current one runs out. Sets are
+        //never freed one at a time, Reset recycles every pool at once
+        struct DescriptorAllocator {
+            std::vector<VkDescriptorPool> Pools;    //Pools before Current are full
+            size_t Current;
+            uint32_t SetsPerPool;                   //Size of the next pool created
+
+            bool Allocate(VkDescriptorSetLayout layout, VkDescriptorSet *set);
+
+            void Reset();
+
+            void Destroy();
+
+            DescriptorAllocator() :
+                    Pools(),
+                    Current(0),
+                    SetsPerPool(KVK_DESCRIPTOR_POOL_SETS) {
+            }
+        };
+
+        //Writes one image descriptor per binding in a single call. Handle stays null on 1.0 devices, which fall back
+        //to vkUpdateDescriptorSets
+        struct DescriptorTemplate {
+            std::vector<VkDescriptorType> Bindings;
+            VkDescriptorUpdateTemplate Handle;
+
+            DescriptorTemplate() :
+                    Bindings(),
+                    Handle(VK_NULL_HANDLE) {
+            }
+        };
+
         struct SwapChainParameters {
             VkSwapchainKHR Handle;
             VkFormat Format;
@@ -314,7 +608,16 @@ namespace KVKBase {
             VkSemaphore ImageAvailableSemaphore;
             VkSemaphore FinishedRenderingSemaphore;
             VkFence Fence;
-
+            VkQueryPool TimestampPool;      //Brackets the effect work recorded in CommandBuffer
+            bool TimestampsWritten;
+            BufferParameters SpriteBuffer;  //Persistently mapped to SpriteMemory
+            SpriteData *SpriteMemory;
+            DescriptorAllocator TransientDescriptors;   //Sets written for one frame, reset once this resource's fence has signalled
+            uint64_t SubmittedFrame;                    //Frame of this resource's last submission, 0 if none
+            float ResolutionScale;                      //Dynamic resolution scale of the last submission
+            BufferParameters Readback;                  //Every output's converted frame, persistently mapped to ReadbackMemory
+            void *ReadbackMemory;
+            bool ReadbackWritten;                       //The last submission converted its frame into Readback
 
             void DestroyResources();
 
@@ -323,7 +626,17 @@ namespace KVKBase {
                     CommandBuffer(VK_NULL_HANDLE),
                     ImageAvailableSemaphore(VK_NULL_HANDLE),
                     FinishedRenderingSemaphore(VK_NULL_HANDLE),
-                    Fence(VK_NULL_HANDLE) {
+                    Fence(VK_NULL_HANDLE),
+                    TimestampPool(VK_NULL_HANDLE),
+                    TimestampsWritten(false),
+                    SpriteBuffer(),
+                    SpriteMemory(nullptr),
+                    TransientDescriptors(),
+                    SubmittedFrame(0),
+                    ResolutionScale(1.0f),
+                    Readback(),
+                    ReadbackMemory(nullptr),
+                    ReadbackWritten(false) {
             }
         };
 
@@ -334,41 +647,490 @@ namespace KVKBase {
 
         struct VulkanParameters {
             VkInstance Instance;
+            InstanceDispatch Dispatch;
             DeviceParameters Device;
             VkSurfaceKHR ApplicationSurface;
             VkRenderPass RenderPass;
             VkPipeline GraphicsPipeline;
             VkPipelineLayout PipelineLayout;
+            PipelineVariantCache PipelineVariants;     //Keyed on this context's render passes and layouts, so it stays with the context
+            std::unordered_map<VkPipeline, uint64_t> PipelineLastUsed;     //Frame of each variant's last cache lookup
             SwapChainParameters SwapChain;
             std::vector<RenderingResourcesData> RenderingResources;
             VkCommandPool CommandPool;
             DescriptorSetParameters Descriptor;
+            DescriptorAllocator PersistentDescriptors;
+            DescriptorTemplate TextureTemplate;     //Binding 0 of Descriptor.Layout
+            DeletionQueue Deletions;
+            std::vector<DeviceReport> DeviceReports;    //Every physical device, as ranked when the device was picked
+            uint64_t Frame;                         //Frames submitted so far
+            uint64_t CompletedFrame;                //Every frame up to this one has finished on the GPU
+            size_t ResourceIndex;                   //Rendering resource the next frame records into
 
             static const size_t ResourceCount = KVK_RESOURCE_COUNT;
 
             VulkanParameters() :
                     Instance(VK_NULL_HANDLE),
+                    Dispatch(),
                     Device(),
                     ApplicationSurface(VK_NULL_HANDLE),
                     RenderPass(VK_NULL_HANDLE),
                     GraphicsPipeline(VK_NULL_HANDLE),
                     PipelineLayout(),
+                    PipelineVariants(),
+                    PipelineLastUsed(),
                     SwapChain(),
                     RenderingResources(ResourceCount),
                     CommandPool(),
-                    Descriptor(){
+                    Descriptor(),
+                    PersistentDescriptors(),
+                    TextureTemplate(),
+                    Deletions(),
+                    DeviceReports(),
+                    Frame(0),
+                    CompletedFrame(0),
+                    ResourceIndex(0){
+            }
+        };
+
+        struct RenderGraphLayout {
+            VkDescriptorSetLayout SetLayout;
+            VkPipelineLayout PipelineLayout;
+            DescriptorTemplate Template;
+
+            RenderGraphLayout() :
+                    SetLayout(VK_NULL_HANDLE),
+                    PipelineLayout(VK_NULL_HANDLE),
+                    Template() {
+            }
+        };
+
+        //Framebuffers and sets are by feedback parity. A pass not touching feedback images has the same one twice
+        struct RenderGraphPassResources {
+            VkRenderPass RenderPass;
+            VkFramebuffer Framebuffer[2];
+            VkPipelineLayout Layout;
+            VkPipeline Pipeline;
+            VkDescriptorSet Descriptor[2];
+
+            RenderGraphPassResources() :
+                    RenderPass(VK_NULL_HANDLE),
+                    Framebuffer{VK_NULL_HANDLE, VK_NULL_HANDLE},
+                    Layout(VK_NULL_HANDLE),
+                    Pipeline(VK_NULL_HANDLE),
+                    Descriptor{VK_NULL_HANDLE, VK_NULL_HANDLE} {
+            }
+        };
+
+        struct RenderGraphParameters {
+            RenderGraph Graph;
+            bool Active;
+
+            //Indexed by graph resource. Aliased images don't own their memory, it lives in Memory. Feedback images
+            //have their second image in History, Parity says which of the two is written this frame
+            std::vector<ImageParameters> Images;
+            std::vector<ImageParameters> History;
+            std::vector<VkDeviceMemory> Memory;
+            uint32_t Parity;
+            bool ClearFeedback;             //Feedback images are cleared before the next frame reads them
+
+            //Indexed by position in the graph's execution order
+            std::vector<RenderGraphPassResources> Passes;
+
+            //Kept across rebuilds so cached pipelines built against them stay valid
+            std::unordered_map<uint32_t, VkRenderPass> RenderPasses;        //By VkFormat
+            std::unordered_map<uint32_t, RenderGraphLayout> Layouts;        //By input count
+
+            DescriptorAllocator Descriptors;        //Reset whenever the images are recreated
+            VkSampler Sampler;
+
+            RenderGraphParameters() :
+                    Graph(),
+                    Active(false),
+                    Images(),
+                    History(),
+                    Memory(),
+                    Parity(0),
+                    ClearFeedback(false),
+                    Passes(),
+                    RenderPasses(),
+                    Layouts(),
+                    Descriptors(),
+                    Sampler(VK_NULL_HANDLE) {
+            }
+        };
+
+        struct ComputeParameters {
+            bool Active;
+            std::string Shader;
+            uint32_t WorkgroupX;
+            uint32_t WorkgroupY;
+
+            //Storage image the size of the render extent, blitted (or copied, if blitting is unsupported) to the frame's image every frame
+            ImageParameters Target;
+            bool Blit;
+
+            //Progressive mode dispatches the shader SamplesPerFrame times a frame, each adding a sample to the
+            //Accumulation image at binding 2 and writing the running average to the target. 0 samples is off
+            ImageParameters Accumulation;
+            uint32_t SamplesPerFrame;
+            uint32_t MaxSamples;            //Accumulation stops here and frames stop rendering, 0 never stops
+            uint32_t Samples;               //Accumulated so far, the next sample's index
+
+            DescriptorSetParameters Descriptor;
+            DescriptorTemplate Template;
+            VkPipelineLayout Layout;
+            VkPipeline Pipeline;
+
+            ComputeParameters() :
+                    Active(false),
+                    Shader(),
+                    WorkgroupX(KVK_COMPUTE_WORKGROUP_X),
+                    WorkgroupY(KVK_COMPUTE_WORKGROUP_Y),
+                    Target(),
+                    Blit(true),
+                    Accumulation(),
+                    SamplesPerFrame(0),
+                    MaxSamples(0),
+                    Samples(0),
+                    Descriptor(),
+                    Template(),
+                    Layout(VK_NULL_HANDLE),
+                    Pipeline(VK_NULL_HANDLE) {
+            }
+        };
+
+        struct SpriteParameters {
+            VkPipelineLayout Layout;
+            std::vector<VkPipeline> Pipelines;
+
+            //Texture 0 is the demo texture and uses the main descriptor set, the rest are owned here.
+            //With bindless textures the index is the texture's slot and Descriptors stays empty
+            std::vector<ImageParameters> Textures;
+            std::vector<VkDescriptorSet> Descriptors;
+
+            //Sprites submitted since the last frame, and scratch space for sorting them
+            std::vector<SpriteData> Pending;
+            std::vector<uint32_t> Keys;
+            std::vector<uint32_t> Offsets;
+
+            SpriteParameters() :
+                    Layout(VK_NULL_HANDLE),
+                    Pipelines(),
+                    Textures(),
+                    Descriptors(),
+                    Pending(),
+                    Keys(),
+                    Offsets() {
+            }
+        };
+
+        //One update-after-bind array of every texture, indexed from shaders instead of rebinding a set per texture
+        struct BindlessParameters {
+            bool Supported;
+            uint32_t Capacity;              //KVK_BINDLESS_CAPACITY clamped to the device limits
+            uint32_t Count;                 //Slots below Count are written, the rest are left unbound
+            DescriptorSetParameters Descriptor;
+
+            BindlessParameters() :
+                    Supported(false),
+                    Capacity(0),
+                    Count(0),
+                    Descriptor() {
+            }
+        };
+
+        //Pages are sprite textures, so atlas images are drawn by pointing a sprite at the page and the image's UV rect
+        struct AtlasParameters {
+            std::vector<AtlasPage> Pages;
+            std::vector<uint32_t> Textures;     //Sprite texture index of each page
+
+            AtlasParameters() :
+                    Pages(),
+                    Textures() {
+            }
+        };
+
+        //Fixed size color target frames render into instead of the swap chain, for benchmarks. Its render pass is
+        //compatible with the main one, so every pipeline works with either
+        struct OffscreenParameters {
+            bool Active;
+            ImageParameters Target;
+            VkRenderPass RenderPass;        //Leaves the target in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+            VkExtent2D Extent;
+
+            OffscreenParameters() :
+                    Active(false),
+                    Target(),
+                    RenderPass(VK_NULL_HANDLE),
+                    Extent({0, 0}) {
+            }
+        };
+
+        //The raster scene renders into the top left of a target the size of the frame and is upscaled over the whole
+        //frame, the rendered part shrinking while the GPU misses the target frame time. Sprites go on after the upscale
+        //at full resolution. Compute effects are not scaled
+        struct DynamicResolutionParameters {
+            bool Active;
+            double TargetMilliseconds;
+            float MinimumScale;
+            float Sharpness;                //Unsharp mask strength of the upscale, 0 is plain bilinear
+            float Scale;                    //Of each dimension, for the next frame
+
+            ImageParameters Target;
+            VkRenderPass RenderPass;        //Leaves the target in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+            VkFramebuffer Framebuffer;
+            VkDescriptorSet Descriptor;     //The target, in the main texture set layout
+            VkPipelineLayout Layout;
+            VkPipeline Pipeline;
+
+            DynamicResolutionParameters() :
+                    Active(false),
+                    TargetMilliseconds(0.0),
+                    MinimumScale(1.0f),
+                    Sharpness(0.0f),
+                    Scale(1.0f),
+                    Target(),
+                    RenderPass(VK_NULL_HANDLE),
+                    Framebuffer(VK_NULL_HANDLE),
+                    Descriptor(VK_NULL_HANDLE),
+                    Layout(VK_NULL_HANDLE),
+                    Pipeline(VK_NULL_HANDLE) {
+            }
+        };
+
+        //One layer of the compositor. Its shader renders the layer's image into Target, which is kept and only
+        //rendered again once the layer is dirty, or every frame for animated layers
+        struct LayerParameters {
+            uint32_t ID;
+            std::string Shader;
+            uint32_t Image;                 //Resource handle of the image the shader samples, 0 is the demo image
+            uint32_t Blend;                 //BLEND_NORMAL to BLEND_SCREEN
+            float Opacity;
+            bool Animated;
+            bool Dirty;
+
+            ImageParameters Target;
+            VkFramebuffer Framebuffer;
+            VkDescriptorSet Result;         //The target, sampled by the composite
+            VkPipeline Pipeline;
+            VkPipeline Composite;
+
+            LayerParameters() :
+                    ID(0),
+                    Shader(),
+                    Image(0),
+                    Blend(BLEND_NORMAL),
+                    Opacity(1.0f),
+                    Animated(false),
+                    Dirty(true),
+                    Target(),
+                    Framebuffer(VK_NULL_HANDLE),
+                    Result(VK_NULL_HANDLE),
+                    Pipeline(VK_NULL_HANDLE),
+                    Composite(VK_NULL_HANDLE) {
             }
         };
 
-        struct TestDemoResources {
+        //With any layers, the raster scene is the layers blended bottom to top over the clear color instead of the
+        //main pipeline's quad, and the render graph is not run. Layer targets have the full render extent
+        struct CompositorParameters {
+            std::vector<LayerParameters> Layers;        //Bottom first
+            uint32_t NextID;
+            VkRenderPass RenderPass;                    //Leaves targets in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+            VkPipelineLayout Layout;                    //Main texture set layout and the opacity
+            std::vector<VkDescriptorSet> FreeDescriptors;   //Of removed layers, persistent sets can't be freed
+
+            CompositorParameters() :
+                    Layers(),
+                    NextID(1),
+                    RenderPass(VK_NULL_HANDLE),
+                    Layout(VK_NULL_HANDLE),
+                    FreeDescriptors() {
+            }
+        };
 
-            BufferParameters VertexBuffer;
-            ImageParameters Image;
+        //A size and format an offscreen frame is converted to. Everything but the settings is recreated with the
+        //frame, an output that doesn't fit the frame is skipped until it does
+        struct OutputTargetParameters {
+            uint32_t ID;
+            uint32_t Width;                 //0 by 0 follows the frame
+            uint32_t Height;
+            uint32_t Format;                //OutputFormat
+            uint32_t Filter;                //DownsampleFilter
+            bool FullRange;                 //0-255 instead of 16-235 luma and 16-240 chroma
 
-            TestDemoResources() :
-                VertexBuffer(),
-                Image(){
+            VkExtent2D Extent;
+            uint32_t Offset;                //Into every rendering resource's readback buffer
+            uint32_t Size;                  //Bytes of a converted frame, 0 while the output is skipped
+            bool SourceIsFrame;             //Made from the frame rather than another output's image
+            ImageParameters Image;          //Downsampled frame, none when the output is as large as its source
+            VkDescriptorSet Downsample;     //Source in, Image out
+            std::vector<VkDescriptorSet> Convert;   //Per rendering resource, Image or the source in, readback out
+
+            OutputTargetParameters() :
+                    ID(0),
+                    Width(0),
+                    Height(0),
+                    Format(OUTPUT_NONE),
+                    Filter(FILTER_BOX),
+                    FullRange(false),
+                    Extent({0, 0}),
+                    Offset(0),
+                    Size(0),
+                    SourceIsFrame(true),
+                    Image(),
+                    Downsample(VK_NULL_HANDLE),
+                    Convert() {
+            }
+        };
 
+        //Conversion of offscreen frames for encoders and other sinks, the frame renders once however many outputs
+        //there are. Each output is downsampled from a smaller image at least as wide and as tall as it, never scaled
+        //up, and every rendering resource converts into a readback buffer of its own, so outputs are read
+        //independently while the next frames render
+        struct OutputParameters {
+            std::vector<OutputTargetParameters> Targets;    //Largest area first
+            uint32_t NextID;
+            uint32_t MainID;                //The output kvkSetOutputFormat manages, 0 if none
+            uint32_t Size;                  //Bytes of every output's frame together, 0 while nothing is converted
+            VkDescriptorPool Pool;          //Reset whenever the outputs are recreated, the persistent pools hold no buffers
+            VkDescriptorSetLayout SetLayout;
+            VkDescriptorSetLayout DownsampleSetLayout;
+            VkPipelineLayout Layout;
+            VkPipelineLayout DownsampleLayout;
+            VkPipeline Pipeline;
+            VkPipeline DownsamplePipeline;
+
+            OutputParameters() :
+                    Targets(),
+                    NextID(1),
+                    MainID(0),
+                    Size(0),
+                    Pool(VK_NULL_HANDLE),
+                    SetLayout(VK_NULL_HANDLE),
+                    DownsampleSetLayout(VK_NULL_HANDLE),
+                    Layout(VK_NULL_HANDLE),
+                    DownsampleLayout(VK_NULL_HANDLE),
+                    Pipeline(VK_NULL_HANDLE),
+                    DownsamplePipeline(VK_NULL_HANDLE) {
+            }
+        };
+
+        //Offline rendering on a fixed clock, frame N is at N / FPS whatever the wall clock says. Frames render
+        //offscreen back to back and go to the writer once their rendering resource comes around again, so the
+        //GPU only ever waits on the disk when the writer's queue is full
+        struct CaptureParameters {
+            bool Active;
+            uint32_t FPS;
+            uint32_t Output;                //The output frames are read from
+            uint64_t Frames;                //Frames rendered, the next one is at Frames / FPS
+            uint64_t FirstFrame;            //Number of the capture's first frame
+            uint64_t Written;               //Frames handed to the writer
+            VkExtent2D PreviousOffscreen;   //Restored when the capture stops, 0 by 0 was the swap chain
+            std::unique_ptr<FrameWriter> Writer;    //Behind a pointer since it holds threads and locks, contexts are reset by moving
+
+            CaptureParameters() :
+                    Active(false),
+                    FPS(0),
+                    Output(0),
+                    Frames(0),
+                    FirstFrame(0),
+                    Written(0),
+                    PreviousOffscreen({0, 0}),
+                    Writer(new FrameWriter()) {
+            }
+        };
+
+        //A frame is only rendered when something it depends on changed since the last one. Otherwise the last
+        //presented image stays on screen, and the offscreen target keeps the last frame for reading back
+        struct IdleParameters {
+            bool Changed;                   //Set by everything that changes what a frame looks like
+            bool Animated;                  //Declared by the frontend for shaders that change over time, every frame renders
+            std::atomic<bool> Skipped;      //The last kvkRenderUpdate skipped its frame, kvkPollEvents reads it from any thread
+            uint64_t RenderedFrames;
+            uint64_t SkippedFrames;
+            std::vector<SpriteData> LastSprites;    //Sprites of the last rendered frame, resubmitting the same ones is no change
+
+            IdleParameters() :
+                    Changed(true),
+                    Animated(false),
+                    Skipped(false),
+                    RenderedFrames(0),
+                    SkippedFrames(0),
+                    LastSprites() {
+            }
+
+            //Contexts are reset by assignment, which the atomic doesn't have
+            IdleParameters &operator=(const IdleParameters &other) {
+                Changed = other.Changed;
+                Animated = other.Animated;
+                Skipped = other.Skipped.load();
+                RenderedFrames = other.RenderedFrames;
+                SkippedFrames = other.SkippedFrames;
+                LastSprites = other.LastSprites;
+                return *this;
+            }
+        };
+
+        struct TimingParameters {
+            bool Supported;
+            float TimestampPeriod;          //Nanoseconds per tick
+            double EffectMilliseconds;      //GPU time of the last completed frame's effect work
+            double RecordMilliseconds;      //CPU time of the last frame's command recording and submission
+            std::vector<InitStage> InitStages;
+
+            TimingParameters() :
+                    Supported(false),
+                    TimestampPeriod(0.0f),
+                    EffectMilliseconds(0.0),
+                    RecordMilliseconds(0.0),
+                    InitStages() {
+            }
+        };
+
+        //Every allocation made through kvkAllocateMemory, by heap. Memory has to be freed through Free to be accounted
+        //Allocations are counted on the device, which every context sharing it allocates from
+        struct MemoryParameters {
+            bool BudgetSupported;           //VK_EXT_memory_budget is enabled
+            VkDeviceSize Budget;            //Set by the frontend, 0 derives it from the heaps
+            uint32_t EvictedImages;
+            uint32_t EvictedPipelines;
+            uint64_t EvictionFrame;         //Frame of the last eviction, its memory is only back once that frame completes
+
+            static void Track(VkDeviceMemory memory, uint32_t memoryType, VkDeviceSize size);
+
+            //Same signature as vkFreeMemory, so it can go through the deletion queue
+            static void Free(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks *allocator);
+
+            MemoryParameters() :
+                    BudgetSupported(false),
+                    Budget(KVK_MEMORY_BUDGET),
+                    EvictedImages(0),
+                    EvictedPipelines(0),
+                    EvictionFrame(0) {
+            }
+        };
+
+        //Every image, buffer and pipeline the engine hands out by handle, including the demo scene's own
+        struct ResourceParameters {
+            ResourcePool<ImageParameters> Images;
+            ResourcePool<BufferParameters> Buffers;
+            ResourcePool<VkPipeline> Pipelines;     //Owned by the pipeline variant cache, only the handle is released
+            std::unordered_map<uint32_t, uint64_t> ImageLastUsed;     //Frame each image handle was last looked up
+            std::unordered_set<uint32_t> Evictable;                   //Image handles the frontend gave up to eviction
+
+            uint32_t DemoImage;
+            uint32_t DemoVertexBuffer;
+
+            ResourceParameters() :
+                    Images(RESOURCE_IMAGE),
+                    Buffers(RESOURCE_BUFFER),
+                    Pipelines(RESOURCE_PIPELINE),
+                    ImageLastUsed(),
+                    Evictable(),
+                    DemoImage(0),
+                    DemoVertexBuffer(0) {
             }
         };
 
@@ -378,23 +1140,69 @@ namespace KVKBase {
             QueueParameters GraphicsQueue;
             QueueParameters PresentQueue;
             BufferParameters StagingBuffer;
-
-            TestDemoResources DemoResources;
+            RenderGraphParameters Graph;
+            ComputeParameters Compute;
+            SpriteParameters Sprites;
+            BindlessParameters Bindless;
+            AtlasParameters Atlas;
+            OffscreenParameters Offscreen;
+            DynamicResolutionParameters Dynamic;
+            CompositorParameters Compositor;
+            OutputParameters Output;
+            CaptureParameters Capture;
+            IdleParameters Idle;
+            TimingParameters Timing;
+
+            ResourceParameters Resources;
+            MemoryParameters Memory;
 
             KrautCommon() :
                 GLFW(),
                 Vulkan(),
                 GraphicsQueue(),
                 PresentQueue(),
-                StagingBuffer(){
+                StagingBuffer(),
+                Graph(),
+                Compute(),
+                Sprites(),
+                Bindless(),
+                Atlas(),
+                Offscreen(),
+                Dynamic(),
+                Compositor(),
+                Output(),
+                Capture(),
+                Idle(),
+                Timing(),
+                Resources(),
+                Memory(){
 
             }
 
         };
 
-        static KrautCommon kraut;
+        //Every renderer context, a context's handle is its slot plus one. Destroyed contexts leave their slot empty
+        //so handles stay stable, the first slot is the default context the single window API has always used
+        static std::vector<std::unique_ptr<KrautCommon>> Contexts;
+        static std::mutex ContextsMutex;
+
+        static KrautCommon *const Default;
+
+        //The context kvk calls work on. Every thread has its own and starts on the default context, so threads
+        //driving different contexts don't switch each other's
+        static thread_local KrautCommon *Current;
+
+        //Returns the new context's handle
+        static uint32_t AddContext();
+
+        //Null for handles that were never given out or whose context is destroyed
+        static KrautCommon *FindContext(uint32_t context);
 
     };
 }
 
+//The current context's instance and device entry points
+#define vki (KVKBase::Com::Current->Vulkan.Dispatch)
+#define vkd (KVKBase::Com::Current->Vulkan.Device.Dispatch)
+
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "KrautVKDispatch.h"
+
+#define KVK_DISPATCH_NULL(type, name) name = nullptr;
+
+namespace KVKBase {
+
+    InstanceDispatch::InstanceDispatch() :
+            createInstance(nullptr) {
+        KVK_INSTANCE_FUNCTIONS(KVK_DISPATCH_NULL)
+        KVK_INSTANCE_OPTIONAL_FUNCTIONS(KVK_DISPATCH_NULL)
+    }
+
+    bool InstanceDispatch::load(PFN_vkGetInstanceProcAddr getInstanceProcAddr, VkInstance instance) {
+        bool complete = true;
+
+#define KVK_DISPATCH_LOAD(type, name) \
+        name = reinterpret_cast<PFN_vk##type>(getInstanceProcAddr(instance, "vk" #type)); \
+        complete &= name != nullptr;
+
+        KVK_INSTANCE_FUNCTIONS(KVK_DISPATCH_LOAD)
+
+#undef KVK_DISPATCH_LOAD
+
+#define KVK_DISPATCH_LOAD_OPTIONAL(type, name) \
+        name = reinterpret_cast<PFN_vk##type>(getInstanceProcAddr(instance, "vk" #type));
+
+        KVK_INSTANCE_OPTIONAL_FUNCTIONS(KVK_DISPATCH_LOAD_OPTIONAL)
+
+#undef KVK_DISPATCH_LOAD_OPTIONAL
+
+        return complete;
+    }
+
+    DeviceDispatch::DeviceDispatch() :
+            Device(VK_NULL_HANDLE),
+            GetDeviceProcAddr(nullptr) {
+        KVK_DEVICE_FUNCTIONS(KVK_DISPATCH_NULL)
+        KVK_DEVICE_OPTIONAL_FUNCTIONS(KVK_DISPATCH_NULL)
+    }
+
+    bool DeviceDispatch::load(PFN_vkGetDeviceProcAddr getDeviceProcAddr, VkDevice device) {
+        Device = device;
+        GetDeviceProcAddr = getDeviceProcAddr;
+
+        KVK_DEVICE_OPTIONAL_FUNCTIONS(KVK_DISPATCH_NULL)
+
+        bool complete = true;
+
+#define KVK_DISPATCH_LOAD(type, name) \
+        name = reinterpret_cast<PFN_vk##type>(getDeviceProcAddr(device, "vk" #type)); \
+        complete &= name != nullptr;
+
+        KVK_DEVICE_FUNCTIONS(KVK_DISPATCH_LOAD)
+
+#undef KVK_DISPATCH_LOAD
+
+        return complete;
+    }
+}
+
+#undef KVK_DISPATCH_NULL
@@ -0,0 +1,181 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef KRAUTVKDISPATCH_H_
+#define KRAUTVKDISPATCH_H_
+
+#include <vulkan/vulkan.h>
+
+//Every entry point the renderer calls, as X(PFN_vk suffix, member). Adding a line declares the member and loads it
+
+#define KVK_INSTANCE_FUNCTIONS(X) \
+        X(CreateDevice,                            createDevice) \
+        X(EnumeratePhysicalDevices,                enumeratePhysicalDevices) \
+        X(GetPhysicalDeviceProperties,             getPhysicalDeviceProperties) \
+        X(GetPhysicalDeviceFeatures,               getPhysicalDeviceFeatures) \
+        X(GetPhysicalDeviceQueueFamilyProperties,  getPhysicalDeviceQueueFamilyProperties) \
+        X(DestroyInstance,                         destroyInstance) \
+        X(DestroySurfaceKHR,                       destroySurfaceKHR) \
+        X(GetPhysicalDeviceSurfaceSupportKHR,      getPhysicalDeviceSurfaceSupportKHR) \
+        X(EnumerateDeviceExtensionProperties,      enumerateDeviceExtensionProperties) \
+        X(GetPhysicalDeviceSurfaceCapabilitiesKHR, getPhysicalDeviceSurfaceCapabilitiesKHR) \
+        X(GetPhysicalDeviceSurfaceFormatsKHR,      getPhysicalDeviceSurfaceFormatsKHR) \
+        X(GetPhysicalDeviceSurfacePresentModesKHR, getPhysicalDeviceSurfacePresentModesKHR) \
+        X(GetPhysicalDeviceMemoryProperties,       getPhysicalDeviceMemoryProperties) \
+        X(GetPhysicalDeviceFormatProperties,       getPhysicalDeviceFormatProperties) \
+        X(GetDeviceProcAddr,                       getDeviceProcAddr)
+
+#define KVK_DEVICE_FUNCTIONS(X) \
+        X(GetDeviceQueue,              getDeviceQueue) \
+        X(DeviceWaitIdle,              deviceWaitIdle) \
+        X(DestroyDevice,               destroyDevice) \
+        X(CreateSemaphore,             createSemaphore) \
+        X(CreateSwapchainKHR,          createSwapchainKHR) \
+        X(DestroySwapchainKHR,         destroySwapchainKHR) \
+        X(GetSwapchainImagesKHR,       getSwapchainImagesKHR) \
+        X(AcquireNextImageKHR,         acquireNextImageKHR) \
+        X(QueuePresentKHR,             queuePresentKHR) \
+        X(QueueSubmit,                 queueSubmit) \
+        X(CreateCommandPool,           createCommandPool) \
+        X(AllocateCommandBuffers,      allocateCommandBuffers) \
+        X(FreeCommandBuffers,          freeCommandBuffers) \
+        X(DestroyCommandPool,          destroyCommandPool) \
+        X(DestroySemaphore,            destroySemaphore) \
+        X(BeginCommandBuffer,          beginCommandBuffer) \
+        X(CmdPipelineBarrier,          cmdPipelineBarrier) \
+        X(EndCommandBuffer,            endCommandBuffer) \
+        X(DestroyImageView,            destroyImageView) \
+        X(CreateImageView,             createImageView) \
+        X(CreateRenderPass,            createRenderPass) \
+        X(CreateFramebuffer,           createFramebuffer) \
+        X(CreateShaderModule,          createShaderModule) \
+        X(DestroyShaderModule,         destroyShaderModule) \
+        X(CmdBeginRenderPass,          cmdBeginRenderPass) \
+        X(CmdBindPipeline,             cmdBindPipeline) \
+        X(CmdDraw,                     cmdDraw) \
+        X(CmdEndRenderPass,            cmdEndRenderPass) \
+        X(DestroyPipeline,             destroyPipeline) \
+        X(DestroyRenderPass,           destroyRenderPass) \
+        X(DestroyFramebuffer,          destroyFramebuffer) \
+        X(CreateGraphicsPipelines,     createGraphicsPipelines) \
+        X(CreatePipelineLayout,        createPipelineLayout) \
+        X(DestroyPipelineLayout,       destroyPipelineLayout) \
+        X(CreateBuffer,                createBuffer) \
+        X(BindBufferMemory,            bindBufferMemory) \
+        X(MapMemory,                   mapMemory) \
+        X(FlushMappedMemoryRanges,     flushMappedMemoryRanges) \
+        X(InvalidateMappedMemoryRanges, invalidateMappedMemoryRanges) \
+        X(UnmapMemory,                 unmapMemory) \
+        X(GetBufferMemoryRequirements, getBufferMemoryRequirements) \
+        X(AllocateMemory,              allocateMemory) \
+        X(CreateFence,                 createFence) \
+        X(DestroyFence,                destroyFence) \
+        X(DestroyBuffer,               destroyBuffer) \
+        X(FreeMemory,                  freeMemory) \
+        X(ResetFences,                 resetFences) \
+        X(WaitForFences,               waitForFences) \
+        X(GetFenceStatus,              getFenceStatus) \
+        X(CmdSetViewport,              cmdSetViewport) \
+        X(CmdSetScissor,               cmdSetScissor) \
+        X(CmdBindVertexBuffers,        cmdBindVertexBuffers) \
+        X(CmdCopyBuffer,               cmdCopyBuffer) \
+        X(BindImageMemory,             bindImageMemory) \
+        X(CreateSampler,               createSampler) \
+        X(CmdCopyBufferToImage,        cmdCopyBufferToImage) \
+        X(CreateImage,                 createImage) \
+        X(GetImageMemoryRequirements,  getImageMemoryRequirements) \
+        X(CreateDescriptorSetLayout,   createDescriptorSetLayout) \
+        X(CreateDescriptorPool,        createDescriptorPool) \
+        X(AllocateDescriptorSets,      allocateDescriptorSets) \
+        X(UpdateDescriptorSets,        updateDescriptorSets) \
+        X(ResetDescriptorPool,         resetDescriptorPool) \
+        X(CmdBindDescriptorSets,       cmdBindDescriptorSets) \
+        X(DestroyDescriptorPool,       destroyDescriptorPool) \
+        X(DestroyDescriptorSetLayout,  destroyDescriptorSetLayout) \
+        X(DestroySampler,              destroySampler) \
+        X(DestroyImage,                destroyImage) \
+        X(CreateComputePipelines,      createComputePipelines) \
+        X(CreatePipelineCache,         createPipelineCache) \
+        X(DestroyPipelineCache,        destroyPipelineCache) \
+        X(CmdDispatch,                 cmdDispatch) \
+        X(CmdPushConstants,            cmdPushConstants) \
+        X(CmdBlitImage,                cmdBlitImage) \
+        X(CmdCopyImage,                cmdCopyImage) \
+        X(CreateQueryPool,             createQueryPool) \
+        X(DestroyQueryPool,            destroyQueryPool) \
+        X(CmdResetQueryPool,           cmdResetQueryPool) \
+        X(CmdWriteTimestamp,           cmdWriteTimestamp) \
+        X(GetQueryPoolResults,         getQueryPoolResults) \
+        X(CmdClearColorImage,          cmdClearColorImage)
+
+//Core in 1.1, left null on older instances
+#define KVK_INSTANCE_OPTIONAL_FUNCTIONS(X) \
+        X(GetPhysicalDeviceFeatures2,              getPhysicalDeviceFeatures2) \
+        X(GetPhysicalDeviceProperties2,            getPhysicalDeviceProperties2) \
+        X(GetPhysicalDeviceMemoryProperties2,      getPhysicalDeviceMemoryProperties2)
+
+//Core in 1.1, resolved the first time they are used and left null on older devices
+#define KVK_DEVICE_OPTIONAL_FUNCTIONS(X) \
+        X(CreateDescriptorUpdateTemplate,  createDescriptorUpdateTemplate) \
+        X(DestroyDescriptorUpdateTemplate, destroyDescriptorUpdateTemplate) \
+        X(UpdateDescriptorSetWithTemplate, updateDescriptorSetWithTemplate)
+
+#define KVK_DISPATCH_MEMBER(type, name) PFN_vk##type name;
+
+namespace KVKBase {
+
+    //Instance level entry points, createInstance is the only one that exists before the instance does
+    struct InstanceDispatch {
+        PFN_vkCreateInstance createInstance;
+        KVK_INSTANCE_FUNCTIONS(KVK_DISPATCH_MEMBER)
+        KVK_INSTANCE_OPTIONAL_FUNCTIONS(KVK_DISPATCH_MEMBER)
+
+        InstanceDispatch();
+
+        //False if a required entry point is missing
+        bool load(PFN_vkGetInstanceProcAddr getInstanceProcAddr, VkInstance instance);
+    };
+
+    //Device level entry points, resolved by the driver through vkGetDeviceProcAddr so calls skip the loader's
+    //trampoline. One table per device, contexts sharing a device copy it
+    struct DeviceDispatch {
+        KVK_DEVICE_FUNCTIONS(KVK_DISPATCH_MEMBER)
+        KVK_DEVICE_OPTIONAL_FUNCTIONS(KVK_DISPATCH_MEMBER)
+
+        DeviceDispatch();
+
+        //False if a required entry point is missing, the optional ones are cleared for resolve
+        bool load(PFN_vkGetDeviceProcAddr getDeviceProcAddr, VkDevice device);
+
+        //Loads an optional or extension entry point on first use, false if the device doesn't expose it
+        template<class T>
+        bool resolve(T &function, const char *name) {
+            if (function == nullptr && Device != VK_NULL_HANDLE)
+                function = reinterpret_cast<T>(GetDeviceProcAddr(Device, name));
+
+            return function != nullptr;
+        }
+
+    private:
+
+        VkDevice Device;
+        PFN_vkGetDeviceProcAddr GetDeviceProcAddr;
+    };
+}
+
+#undef KVK_DISPATCH_MEMBER
+
+#endif
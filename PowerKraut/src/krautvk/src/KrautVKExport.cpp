@@ -4,7 +4,7 @@
 
 #include "KrautVKExport.h"
 
-extern __declspec(dllexport) int KrautInit(int width, int height, char *title, int fullScreen, char *dllPath) {
+extern __declspec(dllexport) int KrautInit(int width, int height, char *title, int fullScreen, char *dllPath, char *device) {
     //dllPath exists so as to let the calling .NET Core decide where the root of the dll is
     //as finding it within execution of the framework in this dll is possible but "janky"
 
@@ -12,7 +12,8 @@ extern __declspec(dllexport) int KrautInit(int width, int height, char *title, i
     KVKBase::Tools::findAndReplace(rootPath, std::string("\\"), std::string("/"));
 
     KVKBase::Tools::rootPath = rootPath;
-    return KVKBase::KrautVK::kvkInit(width, height, title, fullScreen);
+    //device picks a GPU by name or UUID, null or empty leaves it to the ranking
+    return KVKBase::KrautVK::kvkInit(width, height, title, fullScreen, device);
 }
 
 extern __declspec(dllexport) int KrautWindowShouldClose() {
@@ -29,4 +30,236 @@ extern __declspec(dllexport) void KrautTerminate() {
 
 extern __declspec(dllexport) void KrautDraw() {
     KVKBase::KrautVK::kvkRenderUpdate();
-}
\ No newline at end of file
+}
+
+extern __declspec(dllexport) int KrautSetShaderVariant(char* shaderPath, unsigned int* constantIDs, unsigned int* values, int count) {
+    return KVKBase::KrautVK::kvkSetShaderVariant(shaderPath, constantIDs, values, static_cast<uint32_t>(count));
+}
+
+extern __declspec(dllexport) void KrautRenderGraphReset() {
+    KVKBase::KrautVK::kvkRenderGraphReset();
+}
+
+extern __declspec(dllexport) int KrautRenderGraphAddImage(char* name, int format) {
+    return static_cast<int>(KVKBase::KrautVK::kvkRenderGraphAddImage(name, static_cast<VkFormat>(format)));
+}
+
+extern __declspec(dllexport) int KrautRenderGraphAddFeedbackImage(char* name, int format) {
+    return static_cast<int>(KVKBase::KrautVK::kvkRenderGraphAddFeedbackImage(name, static_cast<VkFormat>(format)));
+}
+
+extern __declspec(dllexport) void KrautRenderGraphResetFeedback() {
+    KVKBase::KrautVK::kvkRenderGraphResetFeedback();
+}
+
+extern __declspec(dllexport) int KrautRenderGraphAddPass(char* name, char* shaderPath, unsigned int* inputs, int inputCount, int output) {
+    return static_cast<int>(KVKBase::KrautVK::kvkRenderGraphAddPass(name, shaderPath, inputs, static_cast<uint32_t>(inputCount), static_cast<uint32_t>(output)));
+}
+
+extern __declspec(dllexport) int KrautRenderGraphBuild() {
+    return KVKBase::KrautVK::kvkRenderGraphBuild();
+}
+
+extern __declspec(dllexport) int KrautSetComputeEffect(char* shaderPath, int workgroupX, int workgroupY) {
+    return KVKBase::KrautVK::kvkSetComputeEffect(shaderPath, static_cast<uint32_t>(workgroupX), static_cast<uint32_t>(workgroupY));
+}
+
+extern __declspec(dllexport) int KrautSetDynamicResolution(double targetMilliseconds, float minimumScale, float sharpness) {
+    return KVKBase::KrautVK::kvkSetDynamicResolution(targetMilliseconds, minimumScale, sharpness);
+}
+
+extern __declspec(dllexport) float KrautGetResolutionScale() {
+    return KVKBase::KrautVK::kvkGetResolutionScale();
+}
+
+extern __declspec(dllexport) unsigned int KrautLayerAdd(char* shaderPath, unsigned int image, int blend, float opacity) {
+    return KVKBase::KrautVK::kvkLayerAdd(shaderPath, image, static_cast<uint32_t>(blend), opacity);
+}
+
+extern __declspec(dllexport) int KrautLayerSetBlend(unsigned int layer, int blend, float opacity) {
+    return KVKBase::KrautVK::kvkLayerSetBlend(layer, static_cast<uint32_t>(blend), opacity);
+}
+
+extern __declspec(dllexport) int KrautLayerSetAnimated(unsigned int layer, int animated) {
+    return KVKBase::KrautVK::kvkLayerSetAnimated(layer, animated != 0) ? 1 : 0;
+}
+
+extern __declspec(dllexport) int KrautLayerInvalidate(unsigned int layer) {
+    return KVKBase::KrautVK::kvkLayerInvalidate(layer) ? 1 : 0;
+}
+
+extern __declspec(dllexport) int KrautLayerRemove(unsigned int layer) {
+    return KVKBase::KrautVK::kvkLayerRemove(layer) ? 1 : 0;
+}
+
+extern __declspec(dllexport) void KrautSetAnimated(int animated) {
+    KVKBase::KrautVK::kvkSetAnimated(animated != 0);
+}
+
+extern __declspec(dllexport) unsigned long long KrautGetRenderedFrameCount() {
+    return KVKBase::KrautVK::kvkGetRenderedFrameCount();
+}
+
+extern __declspec(dllexport) unsigned long long KrautGetSkippedFrameCount() {
+    return KVKBase::KrautVK::kvkGetSkippedFrameCount();
+}
+
+extern __declspec(dllexport) int KrautSetProgressive(int samplesPerFrame, int maxSamples) {
+    return KVKBase::KrautVK::kvkSetProgressive(static_cast<uint32_t>(samplesPerFrame), static_cast<uint32_t>(maxSamples));
+}
+
+extern __declspec(dllexport) void KrautResetAccumulation() {
+    KVKBase::KrautVK::kvkResetAccumulation();
+}
+
+extern __declspec(dllexport) int KrautGetAccumulatedSamples() {
+    return static_cast<int>(KVKBase::KrautVK::kvkGetAccumulatedSamples());
+}
+
+extern __declspec(dllexport) double KrautGetEffectTime() {
+    return KVKBase::KrautVK::kvkGetEffectTime();
+}
+
+extern __declspec(dllexport) double KrautGetRecordTime() {
+    return KVKBase::KrautVK::kvkGetRecordTime();
+}
+
+extern __declspec(dllexport) int KrautGetDeviceCount() {
+    return static_cast<int>(KVKBase::KrautVK::kvkGetDeviceCount());
+}
+
+extern __declspec(dllexport) int KrautGetDeviceReport(int index, void* report) {
+    return KVKBase::KrautVK::kvkGetDeviceReport(static_cast<uint32_t>(index), static_cast<KVKBase::DeviceReport*>(report)) ? 1 : 0;
+}
+
+extern __declspec(dllexport) int KrautGetInitStageCount() {
+    return static_cast<int>(KVKBase::KrautVK::kvkGetInitStageCount());
+}
+
+extern __declspec(dllexport) int KrautGetInitStage(int index, void* stage) {
+    return KVKBase::KrautVK::kvkGetInitStage(static_cast<uint32_t>(index), static_cast<KVKBase::InitStage*>(stage)) ? 1 : 0;
+}
+
+//0 by 0 goes back to the swap chain
+extern __declspec(dllexport) int KrautSetOffscreen(int width, int height) {
+    return KVKBase::KrautVK::kvkSetOffscreen(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+}
+
+extern __declspec(dllexport) int KrautSetOutputFormat(int format, int fullRange) {
+    return KVKBase::KrautVK::kvkSetOutputFormat(static_cast<uint32_t>(format), fullRange != 0);
+}
+
+extern __declspec(dllexport) unsigned int KrautGetOutputFrameSize() {
+    return KVKBase::KrautVK::kvkGetOutputFrameSize();
+}
+
+extern __declspec(dllexport) unsigned long long KrautReadOutputFrame(void* data, unsigned int size, int wait) {
+    return KVKBase::KrautVK::kvkReadOutputFrame(data, size, wait != 0);
+}
+
+extern __declspec(dllexport) unsigned int KrautOutputAdd(int width, int height, int format, int filter, int fullRange) {
+    return KVKBase::KrautVK::kvkOutputAdd(static_cast<uint32_t>(width), static_cast<uint32_t>(height), static_cast<uint32_t>(format),
+                                          static_cast<uint32_t>(filter), fullRange != 0);
+}
+
+extern __declspec(dllexport) int KrautOutputRemove(unsigned int output) {
+    return KVKBase::KrautVK::kvkOutputRemove(output);
+}
+
+extern __declspec(dllexport) unsigned int KrautOutputGetSize(unsigned int output) {
+    return KVKBase::KrautVK::kvkOutputGetSize(output);
+}
+
+extern __declspec(dllexport) unsigned long long KrautOutputRead(unsigned int output, void* data, unsigned int size, int wait) {
+    return KVKBase::KrautVK::kvkOutputRead(output, data, size, wait != 0);
+}
+
+extern __declspec(dllexport) int KrautCaptureStart(char* path, int format, int width, int height, int fps) {
+    return KVKBase::KrautVK::kvkCaptureStart(path, static_cast<uint32_t>(format), static_cast<uint32_t>(width), static_cast<uint32_t>(height), static_cast<uint32_t>(fps));
+}
+
+extern __declspec(dllexport) double KrautCaptureGetTime() {
+    return KVKBase::KrautVK::kvkCaptureGetTime();
+}
+
+extern __declspec(dllexport) int KrautCaptureStop() {
+    return KVKBase::KrautVK::kvkCaptureStop();
+}
+
+//A width or height of 0 benchmarks on the swap chain, reportPath may be null to skip the JSON report
+extern __declspec(dllexport) int KrautBenchmark(char* shaderPath, int width, int height, int warmupFrames, int measuredFrames, char* reportPath, void* result) {
+    return KVKBase::KrautVK::kvkBenchmark(shaderPath, static_cast<uint32_t>(width), static_cast<uint32_t>(height), static_cast<uint32_t>(warmupFrames),
+                                          static_cast<uint32_t>(measuredFrames), reportPath, static_cast<KVKBase::BenchmarkResult*>(result));
+}
+
+extern __declspec(dllexport) int KrautSpriteLoadTexture(char* path) {
+    return static_cast<int>(KVKBase::KrautVK::kvkSpriteLoadTexture(path));
+}
+
+extern __declspec(dllexport) int KrautSpriteAddPipeline(char* shaderPath) {
+    return static_cast<int>(KVKBase::KrautVK::kvkSpriteAddPipeline(shaderPath));
+}
+
+extern __declspec(dllexport) void KrautSpriteSubmit(void* sprites, int count) {
+    KVKBase::KrautVK::kvkSpriteSubmit(static_cast<const KVKBase::SpriteData*>(sprites), static_cast<uint32_t>(count));
+}
+
+extern __declspec(dllexport) int KrautAtlasLoadImage(char* path, void* region) {
+    return KVKBase::KrautVK::kvkAtlasLoadImage(path, static_cast<KVKBase::AtlasRegion*>(region));
+}
+
+extern __declspec(dllexport) int KrautAtlasGetPageCount() {
+    return static_cast<int>(KVKBase::KrautVK::kvkAtlasGetPageCount());
+}
+
+extern __declspec(dllexport) float KrautAtlasGetOccupancy(int page) {
+    return KVKBase::KrautVK::kvkAtlasGetOccupancy(static_cast<uint32_t>(page));
+}
+
+extern __declspec(dllexport) unsigned int KrautImageLoad(char* path) {
+    return KVKBase::KrautVK::kvkImageLoad(path);
+}
+
+extern __declspec(dllexport) unsigned int KrautPipelineLoad(char* shaderPath) {
+    return KVKBase::KrautVK::kvkPipelineLoad(shaderPath);
+}
+
+extern __declspec(dllexport) int KrautPipelineUse(unsigned int handle) {
+    return KVKBase::KrautVK::kvkPipelineUse(handle);
+}
+
+extern __declspec(dllexport) int KrautResourceValid(unsigned int handle) {
+    return KVKBase::KrautVK::kvkResourceValid(handle) ? 1 : 0;
+}
+
+extern __declspec(dllexport) int KrautResourceDestroy(unsigned int handle) {
+    return KVKBase::KrautVK::kvkResourceDestroy(handle) ? 1 : 0;
+}
+
+extern __declspec(dllexport) int KrautResourceSetEvictable(unsigned int handle, int evictable) {
+    return KVKBase::KrautVK::kvkResourceSetEvictable(handle, evictable != 0) ? 1 : 0;
+}
+
+extern __declspec(dllexport) void KrautGetMemoryStats(void* stats) {
+    KVKBase::KrautVK::kvkGetMemoryStats(static_cast<KVKBase::MemoryStats*>(stats));
+}
+
+extern __declspec(dllexport) void KrautSetMemoryBudget(unsigned long long bytes) {
+    KVKBase::KrautVK::kvkSetMemoryBudget(bytes);
+}
+
+extern __declspec(dllexport) unsigned long long KrautGetHeapUsage(int heap) {
+    return KVKBase::KrautVK::kvkGetHeapUsage(static_cast<uint32_t>(heap));
+}
+
+extern __declspec(dllexport) unsigned int KrautCreateContext() {
+    return KVKBase::KrautVK::kvkCreateContext();
+}
+
+extern __declspec(dllexport) int KrautMakeCurrent(unsigned int context) {
+    return KVKBase::KrautVK::kvkMakeCurrent(context) ? 1 : 0;
+}
+
+extern __declspec(dllexport) int KrautDestroyContext(unsigned int context) {
+    return KVKBase::KrautVK::kvkDestroyContext(context) ? 1 : 0;
+}
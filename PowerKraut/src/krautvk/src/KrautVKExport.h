@@ -9,7 +9,7 @@
 
 extern "C"{
 
-__declspec(dllexport) int KrautInit(int w, int h, char* title, int f, char* dllPath);
+__declspec(dllexport) int KrautInit(int w, int h, char* title, int f, char* dllPath, char* device);
 
 __declspec(dllexport) int KrautWindowShouldClose();
 
@@ -18,6 +18,120 @@ __declspec(dllexport) void KrautPollEvents();
 __declspec(dllexport) void KrautTerminate();
 
 __declspec(dllexport) void KrautDraw();
+
+__declspec(dllexport) int KrautSetShaderVariant(char* shaderPath, unsigned int* constantIDs, unsigned int* values, int count);
+
+__declspec(dllexport) void KrautRenderGraphReset();
+
+__declspec(dllexport) int KrautRenderGraphAddImage(char* name, int format);
+
+__declspec(dllexport) int KrautRenderGraphAddFeedbackImage(char* name, int format);
+
+__declspec(dllexport) void KrautRenderGraphResetFeedback();
+
+__declspec(dllexport) int KrautRenderGraphAddPass(char* name, char* shaderPath, unsigned int* inputs, int inputCount, int output);
+
+__declspec(dllexport) int KrautRenderGraphBuild();
+
+__declspec(dllexport) int KrautSetComputeEffect(char* shaderPath, int workgroupX, int workgroupY);
+
+__declspec(dllexport) int KrautSetDynamicResolution(double targetMilliseconds, float minimumScale, float sharpness);
+
+__declspec(dllexport) float KrautGetResolutionScale();
+
+__declspec(dllexport) unsigned int KrautLayerAdd(char* shaderPath, unsigned int image, int blend, float opacity);
+
+__declspec(dllexport) int KrautLayerSetBlend(unsigned int layer, int blend, float opacity);
+
+__declspec(dllexport) int KrautLayerSetAnimated(unsigned int layer, int animated);
+
+__declspec(dllexport) int KrautLayerInvalidate(unsigned int layer);
+
+__declspec(dllexport) int KrautLayerRemove(unsigned int layer);
+
+__declspec(dllexport) void KrautSetAnimated(int animated);
+
+__declspec(dllexport) unsigned long long KrautGetRenderedFrameCount();
+
+__declspec(dllexport) unsigned long long KrautGetSkippedFrameCount();
+
+__declspec(dllexport) int KrautSetProgressive(int samplesPerFrame, int maxSamples);
+
+__declspec(dllexport) void KrautResetAccumulation();
+
+__declspec(dllexport) int KrautGetAccumulatedSamples();
+
+__declspec(dllexport) double KrautGetEffectTime();
+
+__declspec(dllexport) double KrautGetRecordTime();
+
+__declspec(dllexport) int KrautGetDeviceCount();
+
+__declspec(dllexport) int KrautGetDeviceReport(int index, void* report);
+
+__declspec(dllexport) int KrautGetInitStageCount();
+
+__declspec(dllexport) int KrautGetInitStage(int index, void* stage);
+
+__declspec(dllexport) int KrautSetOffscreen(int width, int height);
+
+__declspec(dllexport) int KrautSetOutputFormat(int format, int fullRange);
+
+__declspec(dllexport) unsigned int KrautGetOutputFrameSize();
+
+__declspec(dllexport) unsigned long long KrautReadOutputFrame(void* data, unsigned int size, int wait);
+
+__declspec(dllexport) unsigned int KrautOutputAdd(int width, int height, int format, int filter, int fullRange);
+
+__declspec(dllexport) int KrautOutputRemove(unsigned int output);
+
+__declspec(dllexport) unsigned int KrautOutputGetSize(unsigned int output);
+
+__declspec(dllexport) unsigned long long KrautOutputRead(unsigned int output, void* data, unsigned int size, int wait);
+
+__declspec(dllexport) int KrautCaptureStart(char* path, int format, int width, int height, int fps);
+
+__declspec(dllexport) double KrautCaptureGetTime();
+
+__declspec(dllexport) int KrautCaptureStop();
+
+__declspec(dllexport) int KrautBenchmark(char* shaderPath, int width, int height, int warmupFrames, int measuredFrames, char* reportPath, void* result);
+
+__declspec(dllexport) int KrautSpriteLoadTexture(char* path);
+
+__declspec(dllexport) int KrautSpriteAddPipeline(char* shaderPath);
+
+__declspec(dllexport) void KrautSpriteSubmit(void* sprites, int count);
+
+__declspec(dllexport) int KrautAtlasLoadImage(char* path, void* region);
+
+__declspec(dllexport) int KrautAtlasGetPageCount();
+
+__declspec(dllexport) float KrautAtlasGetOccupancy(int page);
+
+__declspec(dllexport) unsigned int KrautImageLoad(char* path);
+
+__declspec(dllexport) unsigned int KrautPipelineLoad(char* shaderPath);
+
+__declspec(dllexport) int KrautPipelineUse(unsigned int handle);
+
+__declspec(dllexport) int KrautResourceValid(unsigned int handle);
+
+__declspec(dllexport) int KrautResourceDestroy(unsigned int handle);
+
+__declspec(dllexport) int KrautResourceSetEvictable(unsigned int handle, int evictable);
+
+__declspec(dllexport) void KrautGetMemoryStats(void* stats);
+
+__declspec(dllexport) void KrautSetMemoryBudget(unsigned long long bytes);
+
+__declspec(dllexport) unsigned long long KrautGetHeapUsage(int heap);
+
+__declspec(dllexport) unsigned int KrautCreateContext();
+
+__declspec(dllexport) int KrautMakeCurrent(unsigned int context);
+
+__declspec(dllexport) int KrautDestroyContext(unsigned int context);
 }
 
 #endif //KRAUTVK_KRAUTVKEXPORT_H
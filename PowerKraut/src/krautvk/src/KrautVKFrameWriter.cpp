@@ -0,0 +1,188 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "KrautVKFrameWriter.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+namespace KVKBase {
+
+    FrameWriter::FrameWriter() :
+            Path(),
+            Format(CAPTURE_Y4M),
+            Width(0),
+            Height(0),
+            Size(0),
+            File(nullptr),
+            Queue(),
+            Free(),
+            Threads(),
+            Lock(),
+            Wake(),
+            Space(),
+            Capacity(1),
+            Pending(0),
+            Pushed(0),
+            Closing(false),
+            Failed(false) {
+    }
+
+    FrameWriter::~FrameWriter() {
+        close();
+    }
+
+    bool FrameWriter::open(const std::string &path, uint32_t format, uint32_t width, uint32_t height, uint32_t fps, uint32_t threads, uint32_t queue) {
+        close();
+
+        if(format > CAPTURE_PNG || width == 0 || height == 0 || fps == 0)
+            return false;
+
+        Path = path;
+        Format = format;
+        Width = width;
+        Height = height;
+        Size = format == CAPTURE_Y4M ? static_cast<size_t>(width) * height / 2 * 3 : static_cast<size_t>(width) * height * 4;
+        Capacity = std::max(queue, 1u);
+        Pending = 0;
+        Pushed = 0;
+        Closing = false;
+        Failed = false;
+
+        if(format != CAPTURE_PNG) {
+            File = std::fopen(path.c_str(), "wb");
+            if(File == nullptr)
+                return false;
+
+            //Chroma of the conversion is the average of each 2x2 quad, which is centered like JPEG's
+            if(format == CAPTURE_Y4M && std::fprintf(File, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", width, height, fps) < 0) {
+                std::fclose(File);
+                File = nullptr;
+                return false;
+            }
+
+            threads = 1;
+        }
+        else if(threads == 0)
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+        for(uint32_t i = 0; i < threads; ++i)
+            Threads.emplace_back(&FrameWriter::work, this);
+
+        return true;
+    }
+
+    bool FrameWriter::push(const void *data) {
+        if(Threads.empty())
+            return false;
+
+        std::unique_lock<std::mutex> lock(Lock);
+        Space.wait(lock, [this]() { return Pending < Capacity; });
+
+        if(Failed)
+            return false;
+
+        Job job = {Pushed++, std::vector<char>()};
+        if(!Free.empty()) {
+            job.Data.swap(Free.back());
+            Free.pop_back();
+        }
+
+        ++Pending;
+        lock.unlock();
+
+        //The copy happens outside the lock, the workers only ever touch jobs that are queued
+        job.Data.resize(Size);
+        std::memcpy(job.Data.data(), data, Size);
+
+        lock.lock();
+        Queue.push_back(std::move(job));
+        Wake.notify_one();
+
+        return true;
+    }
+
+    bool FrameWriter::close() {
+        if(Threads.empty())
+            return !Failed;
+
+        {
+            std::lock_guard<std::mutex> lock(Lock);
+            Closing = true;
+            Wake.notify_all();
+        }
+
+        for(std::thread &thread : Threads)
+            thread.join();
+
+        Threads.clear();
+        Free.clear();
+
+        if(File != nullptr && std::fclose(File) != 0)
+            Failed = true;
+
+        File = nullptr;
+        return !Failed;
+    }
+
+    bool FrameWriter::isOpen() const {
+        return !Threads.empty();
+    }
+
+    size_t FrameWriter::frameSize() const {
+        return Size;
+    }
+
+    //Closing only ends a worker once the queue is empty, so every frame pushed gets written
+    void FrameWriter::work() {
+        std::unique_lock<std::mutex> lock(Lock);
+
+        while(true) {
+            Wake.wait(lock, [this]() { return !Queue.empty() || Closing; });
+            if(Queue.empty())
+                return;
+
+            Job job = std::move(Queue.front());
+            Queue.pop_front();
+
+            //Nothing more is written after a frame failed
+            const bool failed = Failed;
+            lock.unlock();
+
+            bool written = !failed && write(job);
+
+            lock.lock();
+            Failed = Failed || !written;
+            Free.push_back(std::move(job.Data));
+            --Pending;
+            Space.notify_one();
+        }
+    }
+
+    bool FrameWriter::write(const Job &job) {
+        if(Format == CAPTURE_PNG) {
+            char number[24];
+            std::snprintf(number, sizeof(number), "%06llu.png", static_cast<unsigned long long>(job.Index));
+
+            return stbi_write_png((Path + number).c_str(), static_cast<int>(Width), static_cast<int>(Height), 4, job.Data.data(), static_cast<int>(Width * 4)) != 0;
+        }
+
+        if(Format == CAPTURE_Y4M && std::fputs("FRAME\n", File) < 0)
+            return false;
+
+        return std::fwrite(job.Data.data(), 1, job.Data.size(), File) == job.Data.size();
+    }
+}
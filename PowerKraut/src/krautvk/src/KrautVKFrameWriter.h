@@ -0,0 +1,99 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef KRAUTVKFRAMEWRITER_H_
+#define KRAUTVKFRAMEWRITER_H_
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+namespace KVKBase {
+
+    //What a capture is written as. Y4M is I420 limited range in a YUV4MPEG2 stream, RGBA a headerless stream of
+    //8 bit RGBA frames, PNG one RGBA image per frame
+    enum CaptureFormat : uint32_t {
+        CAPTURE_Y4M = 0,
+        CAPTURE_RGBA = 1,
+        CAPTURE_PNG = 2
+    };
+
+    //Encodes and writes frames on a pool of threads, so whoever renders them only waits on the disk once the queue
+    //is full. Stream formats go through a single thread since their frames have to land in order, PNG frames are
+    //independent files and encode on as many threads as there are
+    class FrameWriter {
+
+    public:
+
+        FrameWriter();
+
+        ~FrameWriter();
+
+        //path is the file of a stream, and the prefix of every PNG's, which ends in the frame's number. threads
+        //is for PNG, 0 uses one per hardware thread. queue is how many frames wait before push blocks
+        bool open(const std::string &path, uint32_t format, uint32_t width, uint32_t height, uint32_t fps, uint32_t threads, uint32_t queue);
+
+        //Copies the frame, frameSize bytes, into the queue
+        bool push(const void *data);
+
+        //Waits for every frame pushed to be written. Returns false if any of them failed
+        bool close();
+
+        bool isOpen() const;
+
+        //Bytes of a frame in the format opened
+        size_t frameSize() const;
+
+    private:
+
+        struct Job {
+            uint64_t Index;
+            std::vector<char> Data;
+        };
+
+        void work();
+
+        bool write(const Job &job);
+
+        std::string Path;
+        uint32_t Format;
+        uint32_t Width;
+        uint32_t Height;
+        size_t Size;
+        std::FILE *File;
+
+        std::deque<Job> Queue;
+        std::vector<std::vector<char>> Free;    //Buffers of written frames, reused so frames don't allocate
+        std::vector<std::thread> Threads;
+        std::mutex Lock;
+        std::condition_variable Wake;
+        std::condition_variable Space;
+        uint32_t Capacity;
+        uint32_t Pending;                       //Frames pushed and not written yet
+        uint64_t Pushed;
+        bool Closing;
+        bool Failed;
+    };
+}
+
+#endif
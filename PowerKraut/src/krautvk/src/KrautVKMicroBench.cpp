@@ -0,0 +1,381 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+//CPU side overhead of the renderer, built as krautvk_microbench from the same single translation unit as the library:
+//
+//  krautvk_microbench [--iterations n] [--frames n] [--texture path] [--device name] [--root dir] [--out results.json]
+//                     [--baseline results.json] [--threshold percent]
+//
+//Everything is measured on the CPU, so it runs the same on a software ICD, e.g. with VK_ICD_FILENAMES pointing at
+//lavapipe's or SwiftShader's manifest and --device picking it. With a baseline, every benchmark whose mean got worse
+//by more than the threshold is reported and the exit code is 2. The cmd_call and fence_call pairs time the same entry
+//points through the loader's trampoline and through the device dispatch table, the per call overhead the table saves
+//Before anything is timed, handles of the wrong resource type are checked to be refused where an image is expected
+
+#include "KrautVK.cpp"
+
+namespace KVKBase {
+
+    //Times the startup stages on their own, which is why KrautVK names it a friend
+    class MicroBenchmark {
+
+    public:
+
+        static bool startup(uint32_t iterations, const char *device, std::vector<double> &instance, std::vector<double> &deviceSamples);
+
+        static bool pipelines(uint32_t iterations, std::vector<double> &samples);
+
+        static bool textures(uint32_t iterations, const std::string &path, std::vector<double> &decode, std::vector<double> &upload,
+                             std::vector<double> &decodeThroughput, std::vector<double> &uploadThroughput);
+
+        static bool frames(uint32_t frames, std::vector<double> &samples);
+
+        static bool resize(uint32_t iterations, std::vector<double> &samples);
+
+        static bool dispatch(uint32_t iterations, std::vector<double> &loaderRecord, std::vector<double> &deviceRecord,
+                             std::vector<double> &loaderQuery, std::vector<double> &deviceQuery);
+
+        static bool handles();
+
+    private:
+
+        static const uint32_t DispatchCalls = 1000;
+
+        template<class F>
+        static double time(F function) {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        static double megabytesPerSecond(size_t bytes, double milliseconds) {
+            return milliseconds > 0.0 ? static_cast<double>(bytes) / (milliseconds / 1000.0) / 1000000.0 : 0.0;
+        }
+    };
+
+    //Each iteration starts from nothing, so the window and instance are created and torn down every time
+    bool MicroBenchmark::startup(uint32_t iterations, const char *device, std::vector<double> &instance, std::vector<double> &deviceSamples) {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            int status = KrautVK::kvkInitGLFW(640, 360, "KrautVK MicroBenchmark", 0);
+
+            if (status == SUCCESS)
+                instance.push_back(time([&]() { status = KrautVK::kvkCreateInstance("KrautVK MicroBenchmark"); }));
+
+            if (status == SUCCESS)
+                deviceSamples.push_back(time([&]() { status = KrautVK::kvkCreateDevice(device); }));
+
+            KrautVK::kvkTerminate();
+
+            if (status != SUCCESS)
+                return false;
+        }
+
+        return true;
+    }
+
+    //The default pipeline is dropped from the variant cache first, otherwise every iteration after the first is a lookup
+    bool MicroBenchmark::pipelines(uint32_t iterations, std::vector<double> &samples) {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            KrautVK::kvkDeviceWaitIdle();
+
+            for (auto variant = kraut.Vulkan.PipelineVariants.begin(); variant != kraut.Vulkan.PipelineVariants.end(); ++variant) {
+                if (variant->second == kraut.Vulkan.GraphicsPipeline) {
+                    vkd.destroyPipeline(kraut.Vulkan.Device.Handle, variant->second, nullptr);
+                    kraut.Vulkan.PipelineLastUsed.erase(variant->second);
+                    kraut.Vulkan.PipelineVariants.erase(variant);
+                    break;
+                }
+            }
+
+            int status = SUCCESS;
+            samples.push_back(time([&]() { status = KrautVK::kvkCreatePipelines(KVK_FRAGMENT_SHADER, std::vector<Com::SpecializationConstant>()); }));
+
+            if (status != SUCCESS)
+                return false;
+        }
+
+        return true;
+    }
+
+    //Decode is the image file to RGBA8, upload everything from there to a sampled image on the device
+    bool MicroBenchmark::textures(uint32_t iterations, const std::string &path, std::vector<double> &decode, std::vector<double> &upload,
+                                  std::vector<double> &decodeThroughput, std::vector<double> &uploadThroughput) {
+        std::ifstream file(Tools::rootPath + path, std::ios::binary | std::ios::ate);
+        const size_t fileSize = file ? static_cast<size_t>(file.tellg()) : 0;
+
+        for (uint32_t i = 0; i < iterations; ++i) {
+            int width = 0;
+            int height = 0;
+            std::vector<char> textureData;
+
+            decode.push_back(time([&]() { textureData = Tools::getImageData(Tools::rootPath + path, 4, &width, &height, nullptr, nullptr); }));
+            decodeThroughput.push_back(megabytesPerSecond(fileSize, decode.back()));
+
+            if (textureData.empty())
+                return false;
+
+            Com::ImageParameters image;
+            int status = SUCCESS;
+            upload.push_back(time([&]() { status = KrautVK::kvkCreateTexture(textureData, static_cast<uint32_t>(width), static_cast<uint32_t>(height), image); }));
+            uploadThroughput.push_back(megabytesPerSecond(textureData.size(), upload.back()));
+
+            KrautVK::kvkDestroyTexture(image);
+
+            //No frames run here, so nothing else would ever collect the released textures
+            KrautVK::kvkDeviceWaitIdle();
+            kraut.Vulkan.Deletions.collect(kraut.Vulkan.Frame);
+
+            if (status != SUCCESS)
+                return false;
+        }
+
+        return true;
+    }
+
+    //Command recording and submission of the default scene, the same span kvkGetRecordTime reports. The scene never
+    //changes, so it is declared animated or every frame after the first would be skipped
+    bool MicroBenchmark::frames(uint32_t frames, std::vector<double> &samples) {
+        KrautVK::kvkSetAnimated(true);
+
+        for (uint32_t i = 0; i < frames; ++i) {
+            if (!KrautVK::kvkRenderUpdate())
+                return false;
+
+            KrautVK::kvkPollEvents();
+            samples.push_back(kraut.Timing.RecordMilliseconds);
+        }
+
+        return true;
+    }
+
+    //Recreates the swap chain at the same size, along with everything that follows its extent
+    bool MicroBenchmark::resize(uint32_t iterations, std::vector<double> &samples) {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            bool resized = false;
+            samples.push_back(time([&]() { resized = KrautVK::kvkOnWindowSizeChanged(); }));
+
+            if (!resized)
+                return false;
+        }
+
+        return true;
+    }
+
+    //Per call cost of one record and one submit path entry point, called through the loader's trampoline as every call
+    //was before the device dispatch table, and through the table. Nanoseconds per call, from batches of DispatchCalls
+    bool MicroBenchmark::dispatch(uint32_t iterations, std::vector<double> &loaderRecord, std::vector<double> &deviceRecord,
+                                  std::vector<double> &loaderQuery, std::vector<double> &deviceQuery) {
+        auto loaderSetViewport = reinterpret_cast<PFN_vkCmdSetViewport>(glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkCmdSetViewport"));
+        auto loaderGetFenceStatus = reinterpret_cast<PFN_vkGetFenceStatus>(glfwGetInstanceProcAddress(kraut.Vulkan.Instance, "vkGetFenceStatus"));
+
+        if (loaderSetViewport == nullptr || loaderGetFenceStatus == nullptr || kraut.Vulkan.RenderingResources.empty())
+            return false;
+
+        VkCommandBufferAllocateInfo allocateInfo = {
+                VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,     // VkStructureType          sType
+                nullptr,                                            // const void*              pNext
+                kraut.Vulkan.CommandPool,                           // VkCommandPool            commandPool
+                VK_COMMAND_BUFFER_LEVEL_PRIMARY,                    // VkCommandBufferLevel     level
+                1                                                   // uint32_t                 commandBufferCount
+        };
+
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        if (vkd.allocateCommandBuffers(kraut.Vulkan.Device.Handle, &allocateInfo, &commandBuffer) != VK_SUCCESS)
+            return false;
+
+        VkCommandBufferBeginInfo beginInfo = {
+                VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,        // VkStructureType                          sType
+                nullptr,                                            // const void*                              pNext
+                VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,        // VkCommandBufferUsageFlags                flags
+                nullptr                                             // const VkCommandBufferInheritanceInfo*    pInheritanceInfo
+        };
+
+        const VkViewport viewport = {0.0f, 0.0f, 640.0f, 360.0f, 0.0f, 1.0f};
+        const VkDevice device = kraut.Vulkan.Device.Handle;
+        const VkFence fence = kraut.Vulkan.RenderingResources[0].Fence;
+        const double nanosecondsPerCall = 1000000.0 / DispatchCalls;
+        bool passed = true;
+
+        for (uint32_t i = 0; i < iterations && passed; ++i) {
+            passed = vkd.beginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS;
+
+            loaderRecord.push_back(time([&]() {
+                for (uint32_t call = 0; call < DispatchCalls; ++call)
+                    loaderSetViewport(commandBuffer, 0, 1, &viewport);
+            }) * nanosecondsPerCall);
+
+            deviceRecord.push_back(time([&]() {
+                for (uint32_t call = 0; call < DispatchCalls; ++call)
+                    vkd.cmdSetViewport(commandBuffer, 0, 1, &viewport);
+            }) * nanosecondsPerCall);
+
+            passed = vkd.endCommandBuffer(commandBuffer) == VK_SUCCESS && passed;
+
+            loaderQuery.push_back(time([&]() {
+                for (uint32_t call = 0; call < DispatchCalls; ++call)
+                    loaderGetFenceStatus(device, fence);
+            }) * nanosecondsPerCall);
+
+            deviceQuery.push_back(time([&]() {
+                for (uint32_t call = 0; call < DispatchCalls; ++call)
+                    vkd.getFenceStatus(device, fence);
+            }) * nanosecondsPerCall);
+        }
+
+        vkd.freeCommandBuffers(device, kraut.Vulkan.CommandPool, 1, &commandBuffer);
+        return passed;
+    }
+
+    //Not timed. Handles of another resource type passed where an image is expected are refused, not read as images
+    bool MicroBenchmark::handles() {
+        const uint32_t buffer = kraut.Resources.DemoVertexBuffer;
+        const uint32_t pipeline = KrautVK::kvkPipelineLoad(KVK_FRAGMENT_SHADER);
+
+        bool passed = KrautVK::kvkResourceValid(buffer) && pipeline != 0 &&
+                      KrautVK::kvkLayerAdd(nullptr, buffer, BLEND_NORMAL, 1.0f) == 0 &&
+                      KrautVK::kvkLayerAdd(nullptr, pipeline, BLEND_NORMAL, 1.0f) == 0 &&
+                      !KrautVK::kvkResourceSetEvictable(buffer, true);
+
+        if (pipeline != 0)
+            KrautVK::kvkResourceDestroy(pipeline);
+
+        return passed;
+    }
+}
+
+static void kvkMicroBenchUsage() {
+    printf("usage: krautvk_microbench [--iterations n] [--frames n] [--texture path] [--device name] [--root dir] [--out results.json] [--baseline results.json] [--threshold percent]\n");
+}
+
+int main(int argc, char **argv) {
+    using namespace KVKBase;
+
+    std::string root = argv[0];
+    std::string device;
+    std::string texture = "/res/demo.png";
+    std::string output = "microbench.json";
+    std::string baseline;
+    uint32_t iterations = 20;
+    uint32_t frameCount = 500;
+    double threshold = 10.0;
+
+    Tools::findAndReplace(root, std::string("\\"), std::string("/"));
+    root = root.substr(0, root.find_last_of('/') == std::string::npos ? 0 : root.find_last_of('/'));
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--iterations" && hasValue)
+            iterations = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--frames" && hasValue)
+            frameCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (argument == "--texture" && hasValue)
+            texture = argv[++i];
+        else if (argument == "--device" && hasValue)
+            device = argv[++i];
+        else if (argument == "--root" && hasValue)
+            root = argv[++i];
+        else if (argument == "--out" && hasValue)
+            output = argv[++i];
+        else if (argument == "--baseline" && hasValue)
+            baseline = argv[++i];
+        else if (argument == "--threshold" && hasValue)
+            threshold = strtod(argv[++i], nullptr);
+        else {
+            kvkMicroBenchUsage();
+            return 1;
+        }
+    }
+
+    Tools::rootPath = root;
+    const char *preferredDevice = device.empty() ? nullptr : device.c_str();
+
+    std::vector<double> instance, deviceSamples, pipelines, decode, upload, decodeThroughput, uploadThroughput, frames, resize;
+    std::vector<double> loaderRecord, deviceRecord, loaderQuery, deviceQuery;
+
+    bool passed = MicroBenchmark::startup(iterations, preferredDevice, instance, deviceSamples);
+
+    std::string deviceName;
+    if (passed && KrautVK::kvkInit(640, 360, "KrautVK MicroBenchmark", 0, preferredDevice) == SUCCESS) {
+        deviceName = kraut.Vulkan.Device.Properties.deviceName;
+
+        passed = MicroBenchmark::handles() &&
+                 MicroBenchmark::pipelines(iterations, pipelines) &&
+                 MicroBenchmark::textures(iterations, texture, decode, upload, decodeThroughput, uploadThroughput) &&
+                 MicroBenchmark::frames(frameCount, frames) &&
+                 MicroBenchmark::resize(iterations, resize) &&
+                 MicroBenchmark::dispatch(iterations, loaderRecord, deviceRecord, loaderQuery, deviceQuery);
+    }
+    else
+        passed = false;
+
+    KrautVK::kvkTerminate();
+
+    if (!passed) {
+        printf("Microbenchmarks failed\n");
+        return 1;
+    }
+
+    //Names ending in _mbps are throughput, higher is better. Names ending in _ns are nanoseconds per call, everything else
+    //is milliseconds. The dispatch pairs are the before and after of calling through the device table
+    std::vector<std::pair<std::string, BenchmarkStats>> results = {
+            {"create_instance_ms",      Benchmark::summarize(instance)},
+            {"create_device_ms",        Benchmark::summarize(deviceSamples)},
+            {"create_pipelines_ms",     Benchmark::summarize(pipelines)},
+            {"texture_decode_ms",       Benchmark::summarize(decode)},
+            {"texture_decode_mbps",     Benchmark::summarize(decodeThroughput)},
+            {"texture_upload_ms",       Benchmark::summarize(upload)},
+            {"texture_upload_mbps",     Benchmark::summarize(uploadThroughput)},
+            {"frame_record_submit_ms",  Benchmark::summarize(frames)},
+            {"swapchain_recreate_ms",   Benchmark::summarize(resize)},
+            {"cmd_call_loader_ns",      Benchmark::summarize(loaderRecord)},
+            {"cmd_call_device_ns",      Benchmark::summarize(deviceRecord)},
+            {"fence_call_loader_ns",    Benchmark::summarize(loaderQuery)},
+            {"fence_call_device_ns",    Benchmark::summarize(deviceQuery)}
+    };
+
+    for (const auto &result : results)
+        printf("%-24s mean %10.4f  median %10.4f  p95 %10.4f  stddev %10.4f\n", result.first.c_str(), result.second.mean, result.second.median, result.second.p95, result.second.stddev);
+
+    if (!Benchmark::writeSuite(output.c_str(), deviceName, results))
+        printf("Could not write %s\n", output.c_str());
+
+    if (baseline.empty())
+        return 0;
+
+    std::unordered_map<std::string, double> baselineMeans;
+    if (!Benchmark::readSuiteMeans(baseline.c_str(), baselineMeans)) {
+        printf("Could not read the baseline %s\n", baseline.c_str());
+        return 1;
+    }
+
+    uint32_t regressions = 0;
+    for (const auto &result : results) {
+        auto previous = baselineMeans.find(result.first);
+        if (previous == baselineMeans.end() || previous->second == 0.0)
+            continue;
+
+        const bool throughput = result.first.size() > 5 && result.first.compare(result.first.size() - 5, 5, "_mbps") == 0;
+        double change = (result.second.mean - previous->second) / previous->second * 100.0;
+        bool regressed = throughput ? -change > threshold : change > threshold;
+
+        printf("%-24s baseline %10.4f  now %10.4f  %+7.1f%%%s\n", result.first.c_str(), previous->second, result.second.mean, change, regressed ? "  REGRESSION" : "");
+        regressions += regressed ? 1 : 0;
+    }
+
+    return regressions > 0 ? 2 : 0;
+}
@@ -0,0 +1,97 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "KrautVKRegistry.h"
+
+namespace KVKBase {
+
+    HandleAllocator::HandleAllocator(ResourceType type) :
+            Type(type),
+            Generations(),
+            DenseIndices(),
+            Slots(),
+            FreeSlots() {
+    }
+
+    uint32_t HandleAllocator::encode(uint32_t slot) const {
+        return (static_cast<uint32_t>(Type) << (SlotBits + GenerationBits)) | (Generations[slot] << SlotBits) | slot;
+    }
+
+    uint32_t HandleAllocator::allocate() {
+        uint32_t slot;
+        if (!FreeSlots.empty()) {
+            slot = FreeSlots.back();
+            FreeSlots.pop_back();
+        } else {
+            if (Generations.size() >= MaxSlots)
+                return 0;
+
+            slot = static_cast<uint32_t>(Generations.size());
+            Generations.push_back(1);
+            DenseIndices.push_back(0);
+        }
+
+        DenseIndices[slot] = static_cast<uint32_t>(Slots.size());
+        Slots.push_back(slot);
+
+        return encode(slot);
+    }
+
+    bool HandleAllocator::free(uint32_t handle, uint32_t &dense, uint32_t &last) {
+        if (!lookup(handle, dense))
+            return false;
+
+        const uint32_t slot = handle & MaxSlots;
+        last = static_cast<uint32_t>(Slots.size() - 1);
+
+        Slots[dense] = Slots[last];
+        DenseIndices[Slots[dense]] = dense;
+        Slots.pop_back();
+        DenseIndices[slot] = UINT32_MAX;
+
+        //A slot whose generation would wrap is retired instead, its stale handles would resolve again otherwise
+        if (Generations[slot] == (1u << GenerationBits) - 1)
+            return true;
+
+        ++Generations[slot];
+        FreeSlots.push_back(slot);
+
+        return true;
+    }
+
+    bool HandleAllocator::lookup(uint32_t handle, uint32_t &dense) const {
+        const uint32_t slot = handle & MaxSlots;
+        const uint32_t generation = (handle >> SlotBits) & ((1u << GenerationBits) - 1);
+
+        if (type(handle) != Type || slot >= Generations.size() || Generations[slot] != generation || DenseIndices[slot] == UINT32_MAX)
+            return false;
+
+        dense = DenseIndices[slot];
+        return true;
+    }
+
+    uint32_t HandleAllocator::handleAt(uint32_t dense) const {
+        return encode(Slots[dense]);
+    }
+
+    uint32_t HandleAllocator::size() const {
+        return static_cast<uint32_t>(Slots.size());
+    }
+
+    ResourceType HandleAllocator::type(uint32_t handle) {
+        return static_cast<ResourceType>(handle >> (SlotBits + GenerationBits));
+    }
+}
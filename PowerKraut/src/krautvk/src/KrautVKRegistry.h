@@ -0,0 +1,134 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef KRAUTVKREGISTRY_H_
+#define KRAUTVKREGISTRY_H_
+
+#include <vector>
+#include <cstdint>
+
+namespace KVKBase {
+
+    //Handles are 32 bits: [31:30] resource type, [29:20] generation, [19:0] slot. 0 is never a valid handle
+    enum ResourceType : uint32_t {
+        RESOURCE_IMAGE = 1,
+        RESOURCE_BUFFER = 2,
+        RESOURCE_PIPELINE = 3
+    };
+
+    //Hands out generational handles and maps them to indices into a densely packed array. Destroying swaps the
+    //last element into the hole, so the owner of the array has to do the same move
+    class HandleAllocator {
+
+    public:
+
+        static const uint32_t SlotBits = 20;
+        static const uint32_t GenerationBits = 10;
+        static const uint32_t MaxSlots = (1u << SlotBits) - 1;
+
+        explicit HandleAllocator(ResourceType type);
+
+        //Returns 0 once every slot is taken, retired ones included. The new element's dense index is size() - 1
+        uint32_t allocate();
+
+        //On success the element at last has to be moved to dense and the array shrunk by one. A freed handle
+        //never resolves again, a slot is retired once its generation runs out
+        bool free(uint32_t handle, uint32_t &dense, uint32_t &last);
+
+        bool lookup(uint32_t handle, uint32_t &dense) const;
+
+        uint32_t handleAt(uint32_t dense) const;
+
+        uint32_t size() const;
+
+        static ResourceType type(uint32_t handle);
+
+    private:
+
+        uint32_t encode(uint32_t slot) const;
+
+        ResourceType Type;
+
+        //Per slot
+        std::vector<uint32_t> Generations;
+        std::vector<uint32_t> DenseIndices;
+
+        //Per dense element, the slot pointing at it
+        std::vector<uint32_t> Slots;
+
+        std::vector<uint32_t> FreeSlots;
+    };
+
+    //Resources of one type stored back to back, addressed through generational handles. Create, destroy and lookup are
+    //O(1), and a handle whose resource has been destroyed never resolves again
+    template<class T>
+    class ResourcePool {
+
+    public:
+
+        explicit ResourcePool(ResourceType type) :
+                Handles(type),
+                Items() {
+        }
+
+        uint32_t create(const T &item) {
+            uint32_t handle = Handles.allocate();
+            if (handle != 0)
+                Items.push_back(item);
+
+            return handle;
+        }
+
+        //Hands the resource back so the caller can release what it owns
+        bool destroy(uint32_t handle, T &item) {
+            uint32_t dense, last;
+            if (!Handles.free(handle, dense, last))
+                return false;
+
+            item = Items[dense];
+            Items[dense] = Items[last];
+            Items.pop_back();
+
+            return true;
+        }
+
+        T *get(uint32_t handle) {
+            uint32_t dense;
+            return Handles.lookup(handle, dense) ? &Items[dense] : nullptr;
+        }
+
+        bool valid(uint32_t handle) const {
+            uint32_t dense;
+            return Handles.lookup(handle, dense);
+        }
+
+        //Dense iteration, handleAt(i) owns items()[i]
+        std::vector<T> &items() {
+            return Items;
+        }
+
+        uint32_t handleAt(uint32_t dense) const {
+            return Handles.handleAt(dense);
+        }
+
+    private:
+
+        HandleAllocator Handles;
+        std::vector<T> Items;
+    };
+}
+
+#endif
@@ -0,0 +1,267 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "KrautVKRenderGraph.h"
+
+namespace KVKBase {
+
+    RenderGraph::RenderGraph() :
+            Resources(),
+            Passes(),
+            Order(),
+            Barriers(),
+            AliasSlots(0) {
+        clear();
+    }
+
+    void RenderGraph::clear() {
+        Resources.clear();
+        Passes.clear();
+        Order.clear();
+        Barriers.clear();
+        AliasSlots = 0;
+
+        //The format of the backbuffer belongs to the swap chain, so it is left undefined here
+        addImage("Backbuffer", VK_FORMAT_UNDEFINED);
+    }
+
+    uint32_t RenderGraph::addImage(const std::string &name, VkFormat format) {
+        Resources.push_back({name, format, Unused, Unused, Unused, Unused, false, VK_IMAGE_LAYOUT_UNDEFINED});
+        return static_cast<uint32_t>(Resources.size() - 1);
+    }
+
+    uint32_t RenderGraph::addFeedbackImage(const std::string &name, VkFormat format) {
+        Resources.push_back({name, format, Unused, Unused, Unused, Unused, true, VK_IMAGE_LAYOUT_UNDEFINED});
+        return static_cast<uint32_t>(Resources.size() - 1);
+    }
+
+    uint32_t RenderGraph::addPass(const std::string &name, const std::string &fragmentShader, const std::vector<uint32_t> &inputs, uint32_t output) {
+        Passes.push_back({name, fragmentShader, inputs, output});
+        return static_cast<uint32_t>(Passes.size() - 1);
+    }
+
+    bool RenderGraph::empty() const {
+        return Passes.empty();
+    }
+
+    const std::vector<RenderGraph::Resource> &RenderGraph::resources() const {
+        return Resources;
+    }
+
+    const std::vector<RenderGraph::Pass> &RenderGraph::passes() const {
+        return Passes;
+    }
+
+    const std::vector<uint32_t> &RenderGraph::order() const {
+        return Order;
+    }
+
+    const std::vector<RenderGraph::BarrierBatch> &RenderGraph::barriers() const {
+        return Barriers;
+    }
+
+    uint32_t RenderGraph::aliasSlotCount() const {
+        return AliasSlots;
+    }
+
+    bool RenderGraph::hasFeedback() const {
+        return std::any_of(Resources.begin(), Resources.end(), [](const Resource &resource) {
+            return resource.Feedback && resource.FirstUse != Unused;
+        });
+    }
+
+    //Depth first walk from the final pass. Producers are appended before their consumers, and anything the
+    //final pass does not depend on is never reached, which culls it
+    bool RenderGraph::visit(uint32_t pass, std::vector<uint8_t> &state) {
+        if (state[pass] == 2)
+            return true;
+
+        if (state[pass] == 1) {
+            std::cout << "Render graph has a cycle through pass " << Passes[pass].Name << std::endl;
+            return false;
+        }
+
+        state[pass] = 1;
+
+        for (uint32_t input : Passes[pass].Inputs) {
+            //Reading its own feedback image is last frame's, so no dependency
+            if (input == Passes[pass].Output)
+                continue;
+
+            uint32_t producer = Resources[input].Producer;
+            if (producer == Unused) {
+                std::cout << "Render graph pass " << Passes[pass].Name << " reads " << Resources[input].Name << " which is never written" << std::endl;
+                return false;
+            }
+
+            if (!visit(producer, state))
+                return false;
+        }
+
+        state[pass] = 2;
+        Order.push_back(pass);
+        return true;
+    }
+
+    bool RenderGraph::compile() {
+        Order.clear();
+        Barriers.clear();
+        AliasSlots = 0;
+
+        for (Resource &resource : Resources) {
+            resource.Producer = Unused;
+            resource.FirstUse = Unused;
+            resource.LastUse = Unused;
+            resource.AliasSlot = Unused;
+            resource.FinalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+
+        for (uint32_t i = 0; i < Passes.size(); ++i) {
+            const Pass &pass = Passes[i];
+
+            if (pass.Output >= Resources.size()) {
+                std::cout << "Render graph pass " << pass.Name << " writes an unknown image" << std::endl;
+                return false;
+            }
+
+            if (Resources[pass.Output].Producer != Unused) {
+                std::cout << "Render graph image " << Resources[pass.Output].Name << " is written by more than one pass" << std::endl;
+                return false;
+            }
+
+            Resources[pass.Output].Producer = i;
+
+            for (uint32_t input : pass.Inputs) {
+                if (input >= Resources.size() || input == Backbuffer || (input == pass.Output && !Resources[input].Feedback)) {
+                    std::cout << "Render graph pass " << pass.Name << " has an invalid input" << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        if (Resources[Backbuffer].Producer == Unused) {
+            std::cout << "Render graph has no pass writing the backbuffer" << std::endl;
+            return false;
+        }
+
+        std::vector<uint8_t> state(Passes.size(), 0);
+        if (!visit(Resources[Backbuffer].Producer, state))
+            return false;
+
+        //Lifetimes, in execution order
+        for (uint32_t i = 0; i < Order.size(); ++i) {
+            const Pass &pass = Passes[Order[i]];
+
+            Resources[pass.Output].FirstUse = i;
+            Resources[pass.Output].LastUse = i;
+
+            for (uint32_t input : pass.Inputs)
+                Resources[input].LastUse = i;
+        }
+
+        //Greedy interval colouring: an image takes over the memory of any image whose last read happened before
+        //its first write. Everything runs in one command buffer, so "before" is just the execution order.
+        std::vector<uint32_t> byFirstUse;
+        for (uint32_t i = 0; i < Resources.size(); ++i) {
+            if (i != Backbuffer && Resources[i].FirstUse != Unused && !Resources[i].Feedback)
+                byFirstUse.push_back(i);
+        }
+
+        std::sort(byFirstUse.begin(), byFirstUse.end(), [this](uint32_t a, uint32_t b) {
+            return Resources[a].FirstUse < Resources[b].FirstUse;
+        });
+
+        std::vector<uint32_t> slotEnds;
+        for (uint32_t index : byFirstUse) {
+            Resource &resource = Resources[index];
+
+            for (uint32_t slot = 0; slot < slotEnds.size(); ++slot) {
+                if (slotEnds[slot] < resource.FirstUse) {
+                    resource.AliasSlot = slot;
+                    break;
+                }
+            }
+
+            if (resource.AliasSlot == Unused) {
+                resource.AliasSlot = static_cast<uint32_t>(slotEnds.size());
+                slotEnds.push_back(0);
+            }
+
+            slotEnds[resource.AliasSlot] = resource.LastUse;
+        }
+
+        AliasSlots = static_cast<uint32_t>(slotEnds.size());
+
+        //Walk the passes tracking each image's layout, and batch every transition a pass needs into one barrier
+        std::vector<VkImageLayout> layouts(Resources.size(), VK_IMAGE_LAYOUT_UNDEFINED);
+        std::vector<VkPipelineStageFlags> stages(Resources.size(), 0);
+        std::vector<VkAccessFlags> accesses(Resources.size(), 0);
+
+        for (uint32_t i = 0; i < Order.size(); ++i) {
+            const Pass &pass = Passes[Order[i]];
+            BarrierBatch batch = {0, 0, std::vector<Barrier>()};
+
+            for (uint32_t input : pass.Inputs) {
+                if (input == pass.Output || layouts[input] == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+                    continue;
+
+                batch.Barriers.push_back({input, layouts[input], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, accesses[input], VK_ACCESS_SHADER_READ_BIT, false});
+                batch.SrcStages |= stages[input];
+                batch.DstStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+                layouts[input] = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                stages[input] = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+                accesses[input] = VK_ACCESS_SHADER_READ_BIT;
+            }
+
+            //The swap chain image is transitioned by the main render pass
+            if (pass.Output != Backbuffer) {
+                //Old contents are discarded. The source stages cover whatever used this memory last, be it the
+                //previous image in the same alias slot or the previous frame's reads of this image.
+                batch.Barriers.push_back({pass.Output, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, false});
+                batch.SrcStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                batch.DstStages |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+                layouts[pass.Output] = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                stages[pass.Output] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                accesses[pass.Output] = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            }
+
+            Barriers.push_back(batch);
+        }
+
+        for (uint32_t i = 0; i < Resources.size(); ++i)
+            Resources[i].FinalLayout = layouts[i];
+
+        //A pass reading its own feedback image finds last frame's image the way last frame left it
+        for (uint32_t i = 0; i < Order.size(); ++i) {
+            const Pass &pass = Passes[Order[i]];
+            BarrierBatch &batch = Barriers[i];
+
+            const bool readsPrevious = std::find(pass.Inputs.begin(), pass.Inputs.end(), pass.Output) != pass.Inputs.end();
+            if (readsPrevious && layouts[pass.Output] != VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+                batch.Barriers.push_back({pass.Output, layouts[pass.Output], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, accesses[pass.Output], VK_ACCESS_SHADER_READ_BIT, true});
+                batch.SrcStages |= stages[pass.Output];
+                batch.DstStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            }
+
+            if (batch.SrcStages == 0)
+                batch.SrcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,117 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef KRAUTVKRENDERGRAPH_H_
+#define KRAUTVKRENDERGRAPH_H_
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <vulkan/vulkan.h>
+
+namespace KVKBase {
+
+    //Describes a chain of full screen passes (Shadertoy style buffers) and works out, without touching the device,
+    //the order to run them in, the barriers between them and which intermediate images can share memory.
+    //
+    //Feedback images are double buffered and swap roles every frame. The pass writing one can also read it, and
+    //gets the previous frame's contents, every other reader gets this frame's. They keep their contents between
+    //frames, so they never share memory.
+    class RenderGraph {
+
+    public:
+
+        //Resource 0 is always the swap chain image, the final pass must write to it
+        static const uint32_t Backbuffer = 0;
+        static const uint32_t Unused = UINT32_MAX;
+
+        struct Resource {
+            std::string Name;
+            VkFormat Format;
+            uint32_t Producer;      //Index of the pass writing it
+            uint32_t FirstUse;      //Position in the execution order
+            uint32_t LastUse;
+            uint32_t AliasSlot;     //Resources in the same slot never live at the same time and share memory
+            bool Feedback;
+            VkImageLayout FinalLayout;  //At the end of the frame, which is where a feedback image's previous frame starts
+        };
+
+        struct Pass {
+            std::string Name;
+            std::string FragmentShader;
+            std::vector<uint32_t> Inputs;
+            uint32_t Output;
+        };
+
+        struct Barrier {
+            uint32_t Resource;
+            VkImageLayout OldLayout;
+            VkImageLayout NewLayout;
+            VkAccessFlags SrcAccess;
+            VkAccessFlags DstAccess;
+            bool Previous;          //On the image of a feedback resource written last frame
+        };
+
+        //All the barriers needed before a pass, recorded with a single cmdPipelineBarrier
+        struct BarrierBatch {
+            VkPipelineStageFlags SrcStages;
+            VkPipelineStageFlags DstStages;
+            std::vector<Barrier> Barriers;
+        };
+
+        RenderGraph();
+
+        void clear();
+
+        uint32_t addImage(const std::string &name, VkFormat format);
+
+        uint32_t addFeedbackImage(const std::string &name, VkFormat format);
+
+        uint32_t addPass(const std::string &name, const std::string &fragmentShader, const std::vector<uint32_t> &inputs, uint32_t output);
+
+        bool compile();
+
+        bool empty() const;
+
+        const std::vector<Resource> &resources() const;
+
+        const std::vector<Pass> &passes() const;
+
+        //Pass indices in execution order, culled passes are left out. The last one writes the Backbuffer
+        const std::vector<uint32_t> &order() const;
+
+        //Indexed by position in the execution order
+        const std::vector<BarrierBatch> &barriers() const;
+
+        uint32_t aliasSlotCount() const;
+
+        //Whether any feedback image survived culling, the output then changes every frame
+        bool hasFeedback() const;
+
+    private:
+
+        bool visit(uint32_t pass, std::vector<uint8_t> &state);
+
+        std::vector<Resource> Resources;
+        std::vector<Pass> Passes;
+        std::vector<uint32_t> Order;
+        std::vector<BarrierBatch> Barriers;
+        uint32_t AliasSlots;
+    };
+}
+
+#endif
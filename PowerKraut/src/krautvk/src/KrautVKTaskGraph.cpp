@@ -0,0 +1,130 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "KrautVKTaskGraph.h"
+
+namespace KVKBase {
+
+    TaskGraph::TaskGraph() :
+            Tasks(),
+            Timings(),
+            Ready(),
+            Lock(),
+            Wake(),
+            Running(0),
+            Status(0),
+            Start() {
+    }
+
+    uint32_t TaskGraph::add(const std::string &name, std::function<int()> task, const std::vector<uint32_t> &dependencies) {
+        const uint32_t index = static_cast<uint32_t>(Tasks.size());
+        for (uint32_t dependency : dependencies) {
+            if (dependency >= index)
+                return Invalid;
+        }
+
+        Tasks.push_back({name, std::move(task), {}, static_cast<uint32_t>(dependencies.size())});
+        for (uint32_t dependency : dependencies)
+            Tasks[dependency].Dependents.push_back(index);
+
+        return index;
+    }
+
+    int TaskGraph::run(uint32_t threads, const std::function<void()> &enter) {
+        Timings.clear();
+        Ready.clear();
+        Running = 0;
+        Status = 0;
+        Start = std::chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < Tasks.size(); ++i) {
+            if (Tasks[i].Remaining == 0)
+                Ready.push_back(i);
+        }
+
+        if (threads == 0)
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+        threads = std::min(threads, std::max(static_cast<uint32_t>(Tasks.size()), 1u));
+
+        std::vector<std::thread> workers;
+        for (uint32_t i = 1; i < threads; ++i) {
+            workers.emplace_back([this, i, &enter]() {
+                if (enter)
+                    enter();
+
+                work(i);
+            });
+        }
+
+        work(0);
+
+        for (std::thread &worker : workers)
+            worker.join();
+
+        std::sort(Timings.begin(), Timings.end(), [](const Timing &a, const Timing &b) {
+            return a.Start < b.Start;
+        });
+
+        return Status;
+    }
+
+    const std::vector<TaskGraph::Timing> &TaskGraph::timings() const {
+        return Timings;
+    }
+
+    //Nothing ready and nothing running means every task finished, or a failure cut the rest off
+    void TaskGraph::work(uint32_t thread) {
+        std::unique_lock<std::mutex> lock(Lock);
+
+        while (true) {
+            Wake.wait(lock, [this]() { return !Ready.empty() || Running == 0; });
+            if (Ready.empty())
+                return;
+
+            uint32_t index = Ready.front();
+            Ready.pop_front();
+            ++Running;
+            lock.unlock();
+
+            auto taskStart = std::chrono::steady_clock::now();
+            int status = Tasks[index].Function();
+            auto taskEnd = std::chrono::steady_clock::now();
+
+            lock.lock();
+            --Running;
+
+            Timings.push_back({Tasks[index].Name,
+                               std::chrono::duration<double, std::milli>(taskStart - Start).count(),
+                               std::chrono::duration<double, std::milli>(taskEnd - taskStart).count(),
+                               thread});
+
+            if (status != 0 && Status == 0) {
+                Status = status;
+                Ready.clear();
+            }
+
+            if (Status == 0) {
+                for (uint32_t dependent : Tasks[index].Dependents) {
+                    if (--Tasks[dependent].Remaining == 0)
+                        Ready.push_back(dependent);
+                }
+            }
+
+            Wake.notify_all();
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/*
+Copyright 2018 Jonathan Crockett
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef KRAUTVKTASKGRAPH_H_
+#define KRAUTVKTASKGRAPH_H_
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+
+namespace KVKBase {
+
+    //Runs a set of tasks on a pool of threads, each one as soon as every task it depends on has finished. Tasks
+    //return a status the way the kvk functions do, 0 for success. The first failure stops anything not yet started
+    class TaskGraph {
+
+    public:
+
+        static const uint32_t Invalid = UINT32_MAX;
+
+        struct Timing {
+            std::string Name;
+            double Start;               //Milliseconds since run was called
+            double Milliseconds;
+            uint32_t Thread;            //0 is the thread that called run
+        };
+
+        TaskGraph();
+
+        //Dependencies have to be added before the task depending on them, which also keeps the graph acyclic.
+        //Returns Invalid if one was not
+        uint32_t add(const std::string &name, std::function<int()> task, const std::vector<uint32_t> &dependencies = std::vector<uint32_t>());
+
+        //The calling thread works too, so threads is the total. 0 uses one per hardware thread. Every thread run
+        //starts calls enter before its first task, for thread local state the tasks rely on.
+        //Returns 0 or the status of the first task that failed
+        int run(uint32_t threads, const std::function<void()> &enter = std::function<void()>());
+
+        //Tasks that ran, in the order they started
+        const std::vector<Timing> &timings() const;
+
+    private:
+
+        struct Task {
+            std::string Name;
+            std::function<int()> Function;
+            std::vector<uint32_t> Dependents;
+            uint32_t Remaining;             //Dependencies not finished yet
+        };
+
+        void work(uint32_t thread);
+
+        std::vector<Task> Tasks;
+        std::vector<Timing> Timings;
+
+        std::deque<uint32_t> Ready;
+        std::mutex Lock;
+        std::condition_variable Wake;
+        uint32_t Running;
+        int Status;
+        std::chrono::steady_clock::time_point Start;
+    };
+}
+
+#endif